@@ -0,0 +1,399 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <LoadGenerator.h>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iterator>
+#include <iostream>
+#include <dots/io/DescriptorConverter.h>
+#include <dots/type/ProxyProperty.h>
+#include <dots/tools/logging.h>
+
+namespace dots
+{
+    namespace
+    {
+        constexpr uint32_t IdTag = 1;
+        constexpr uint32_t PublisherTag = 2;
+        constexpr uint32_t SequenceTag = 3;
+        constexpr uint32_t FirstValueTag = 4;
+
+        const type::PropertyDescriptor& property_descriptor(const type::StructDescriptor& descriptor, uint32_t tag)
+        {
+            // note: the properties of the generated types are ordered by tag
+            return descriptor.propertyDescriptors()[tag - 1];
+        }
+
+        template <typename T>
+        const T& property_value(const type::Struct& instance, const type::PropertyDescriptor& propertyDescriptor)
+        {
+            return *reinterpret_cast<const T*>(reinterpret_cast<const std::byte*>(&instance._propertyArea()) + propertyDescriptor.offset());
+        }
+
+        double to_milliseconds(tools::LatencyHistogram::duration_t duration)
+        {
+            return std::chrono::duration<double, std::milli>{ duration }.count();
+        }
+    }
+
+    LoadGenerator::LoadGenerator(asio::io_context& ioContext, config_t config) :
+        m_ioContext(&ioContext),
+        m_config{ std::move(config) },
+        m_random(m_config.seed),
+        m_nextPublisherId(1)
+    {
+        if (m_config.types == 0)
+        {
+            throw std::logic_error{ "load generator requires at least one type" };
+        }
+
+        if (m_config.keys == 0)
+        {
+            throw std::logic_error{ "load generator requires a key cardinality of at least one" };
+        }
+
+        for (size_t i = 0; i < m_config.types; ++i)
+        {
+            StructDescriptorData& typeData = m_typeData.emplace_back(StructDescriptorData{
+                .name = "LoadgenType" + std::to_string(i),
+                .properties = vector_t<StructPropertyData>{
+                    StructPropertyData{ .name = "id", .tag = IdTag, .isKey = true, .type = "uint32" },
+                    StructPropertyData{ .name = "publisher", .tag = PublisherTag, .isKey = false, .type = "uint32" },
+                    StructPropertyData{ .name = "sequence", .tag = SequenceTag, .isKey = false, .type = "uint64" }
+                },
+                .flags = DotsStructFlags{
+                    .cached = m_config.cached,
+                    .cleanup = false
+                }
+            });
+
+            for (size_t j = 0; j < m_config.properties; ++j)
+            {
+                constexpr const char* ValueTypes[] = { "int64", "float64", "string" };
+
+                typeData.properties->emplace_back(StructPropertyData{
+                    .name = "value" + std::to_string(j),
+                    .tag = static_cast<uint32_t>(FirstValueTag + j),
+                    .isKey = false,
+                    .type = ValueTypes[j % std::size(ValueTypes)]
+                });
+            }
+        }
+    }
+
+    void LoadGenerator::run()
+    {
+        m_begin = steady_clock_t::now();
+        m_lastReport = m_begin;
+
+        for (size_t i = 0; i < m_config.subscribers; ++i)
+        {
+            createSubscriber(*m_subscribers.emplace_back(std::make_unique<subscriber_t>()));
+        }
+
+        for (size_t i = 0; i < m_config.publishers; ++i)
+        {
+            createPublisher(*m_publishers.emplace_back(std::make_unique<publisher_t>()));
+        }
+
+        m_publishTimer.emplace(*m_ioContext, PublishInterval, Timer::handler_t{ &LoadGenerator::handlePublishTimer, this }, true);
+        m_reportTimer.emplace(*m_ioContext, m_config.reportInterval, Timer::handler_t{ &LoadGenerator::handleReportTimer, this }, true);
+
+        if (!m_config.churnInterval.isZero())
+        {
+            m_churnTimer.emplace(*m_ioContext, m_config.churnInterval, Timer::handler_t{ &LoadGenerator::handleChurnTimer, this }, true);
+        }
+
+        if (!m_config.duration.isZero())
+        {
+            m_durationTimer.emplace(*m_ioContext, m_config.duration, Timer::handler_t{ &LoadGenerator::stop, this });
+        }
+
+        m_ioContext->run();
+
+        m_publishTimer.reset();
+        m_reportTimer.reset();
+        m_churnTimer.reset();
+        m_durationTimer.reset();
+
+        accumulateCounters();
+        report(m_totalCounters, type::Duration{ steady_clock_t::now() - m_begin }, true);
+
+        m_publishers.clear();
+        m_subscribers.clear();
+        m_ioContext->restart();
+        m_ioContext->poll();
+    }
+
+    void LoadGenerator::stop()
+    {
+        m_ioContext->stop();
+    }
+
+    GuestTransceiver& LoadGenerator::openTransceiver(client_t& client, const std::string& name)
+    {
+        GuestTransceiver& transceiver = client.transceiver.emplace(name, *m_ioContext, type::Registry::StaticTypePolicy::InternalOnly, GuestTransceiver::transition_handler_t{ [this, &client](const Connection& connection, std::exception_ptr ePtr)
+        {
+            handleTransition(client, connection, ePtr);
+        } });
+
+        // note: the previous transceiver of the client might have reported
+        // its connection as closed while being destroyed
+        client.lost = false;
+
+        for (const StructDescriptorData& typeData : m_typeData)
+        {
+            io::DescriptorConverter{ transceiver.registry() }(typeData);
+        }
+
+        transceiver.open(m_config.endpoint);
+
+        return transceiver;
+    }
+
+    void LoadGenerator::createPublisher(publisher_t& publisher)
+    {
+        publisher.id = m_nextPublisherId++;
+        publisher.sequence = 0;
+        publisher.issued = 0;
+        publisher.begin = steady_clock_t::now();
+        publisher.instances.clear();
+
+        GuestTransceiver& transceiver = openTransceiver(publisher, "dots-loadgen-publisher-" + std::to_string(publisher.id));
+
+        for (const StructDescriptorData& typeData : m_typeData)
+        {
+            const type::StructDescriptor& descriptor = transceiver.registry().getStructType(*typeData.name);
+            type::AnyStruct& instance = publisher.instances.emplace_back(descriptor);
+            type::ProxyProperty<uint32_t>{ instance->_propertyArea(), property_descriptor(descriptor, PublisherTag) }.emplace(publisher.id);
+        }
+    }
+
+    void LoadGenerator::createSubscriber(subscriber_t& subscriber)
+    {
+        subscriber.subscriptions.clear();
+        subscriber.lastSequences.clear();
+
+        GuestTransceiver& transceiver = openTransceiver(subscriber, "dots-loadgen-subscriber");
+
+        for (const StructDescriptorData& typeData : m_typeData)
+        {
+            subscriber.subscriptions.emplace_back(transceiver.subscribe(transceiver.registry().getStructType(*typeData.name), Transceiver::event_handler_t<>{ [this, &subscriber](const Event<>& event)
+            {
+                handleEvent(subscriber, event);
+            } }));
+        }
+    }
+
+    void LoadGenerator::publish(publisher_t& publisher)
+    {
+        type::Struct& instance = *publisher.instances[publisher.nextType++ % publisher.instances.size()];
+        const type::StructDescriptor& descriptor = instance._descriptor();
+        type::PropertyArea& area = instance._propertyArea();
+
+        type::ProxyProperty<uint32_t>{ area, property_descriptor(descriptor, IdTag) }.emplace(std::uniform_int_distribution<uint32_t>{ 0, m_config.keys - 1 }(m_random));
+        type::ProxyProperty<uint64_t>{ area, property_descriptor(descriptor, SequenceTag) }.emplace(++publisher.sequence);
+        property_set_t includedProperties = property_descriptor(descriptor, IdTag).set() + property_descriptor(descriptor, PublisherTag).set() + property_descriptor(descriptor, SequenceTag).set();
+
+        // note: the updated properties rotate through all value properties,
+        // so that every property is updated regularly even if only a small
+        // subset is included in each update
+        auto updatedProperties = std::min(m_config.properties, static_cast<size_t>(std::ceil(m_config.updateRatio * static_cast<double>(m_config.properties))));
+
+        for (size_t i = 0; i < updatedProperties; ++i)
+        {
+            size_t valueIndex = publisher.nextProperty++ % m_config.properties;
+            const type::PropertyDescriptor& propertyDescriptor = property_descriptor(descriptor, static_cast<uint32_t>(FirstValueTag + valueIndex));
+
+            switch (valueIndex % 3)
+            {
+                case 0:
+                    type::ProxyProperty<int64_t>{ area, propertyDescriptor }.emplace(static_cast<int64_t>(publisher.sequence));
+                    break;
+                case 1:
+                    type::ProxyProperty<double>{ area, propertyDescriptor }.emplace(static_cast<double>(publisher.sequence) / 3.0);
+                    break;
+                default:
+                    type::ProxyProperty<std::string>{ area, propertyDescriptor }.emplace(std::string(m_config.stringSize, static_cast<char>('a' + publisher.sequence % 26)));
+                    break;
+            }
+
+            includedProperties += propertyDescriptor.set();
+        }
+
+        publisher.transceiver->publish(instance, includedProperties);
+        ++m_intervalCounters.published;
+    }
+
+    void LoadGenerator::handleTransition(client_t& client, const Connection& connection, std::exception_ptr ePtr)
+    {
+        if (ePtr != nullptr)
+        {
+            ++m_intervalCounters.connectionErrors;
+
+            try
+            {
+                std::rethrow_exception(ePtr);
+            }
+            catch (const std::exception& e)
+            {
+                LOG_WARN_S("load generator client lost connection to " << connection.peerDescription() << " -> " << e.what());
+            }
+        }
+
+        // note: lost clients can not be replaced from within their own
+        // transition handler and are replaced on the next report instead
+        if (connection.closed())
+        {
+            client.lost = true;
+        }
+    }
+
+    void LoadGenerator::handleEvent(subscriber_t& subscriber, const Event<>& event)
+    {
+        const DotsHeader& header = event.header();
+
+        if (header.fromCache.isValid())
+        {
+            return;
+        }
+
+        const type::Struct& instance = event();
+        const type::StructDescriptor& descriptor = instance._descriptor();
+        ++m_intervalCounters.received;
+
+        if (header.sentTime.isValid())
+        {
+            auto latency = std::chrono::duration_cast<tools::LatencyHistogram::duration_t>(type::TimePoint::Now() - *header.sentTime);
+            m_intervalCounters.latencies.record(latency);
+            m_totalCounters.latencies.record(latency);
+        }
+
+        if (const type::PropertyDescriptor& publisherDescriptor = property_descriptor(descriptor, PublisherTag), & sequenceDescriptor = property_descriptor(descriptor, SequenceTag);
+            publisherDescriptor.set() <= instance._validProperties() && sequenceDescriptor.set() <= instance._validProperties())
+        {
+            auto sequence = property_value<uint64_t>(instance, sequenceDescriptor);
+            auto [it, emplaced] = subscriber.lastSequences.try_emplace(property_value<uint32_t>(instance, publisherDescriptor), sequence);
+
+            if (!emplaced)
+            {
+                if (sequence > it->second + 1)
+                {
+                    m_intervalCounters.drops += sequence - it->second - 1;
+                }
+
+                it->second = std::max(it->second, sequence);
+            }
+        }
+    }
+
+    void LoadGenerator::handlePublishTimer()
+    {
+        auto now = steady_clock_t::now();
+
+        for (const std::unique_ptr<publisher_t>& publisher : m_publishers)
+        {
+            if (!publisher->transceiver->connected())
+            {
+                publisher->begin = now;
+                publisher->issued = 0;
+                continue;
+            }
+
+            // note: the number of due updates is determined from the time
+            // since the publisher connected, so that timer jitter does not
+            // affect the sustained rate
+            auto due = static_cast<uint64_t>(std::chrono::duration<double>{ now - publisher->begin }.count() * m_config.rate);
+
+            for (; publisher->issued < due; ++publisher->issued)
+            {
+                publish(*publisher);
+            }
+        }
+    }
+
+    void LoadGenerator::handleReportTimer()
+    {
+        replaceLostClients();
+
+        auto now = steady_clock_t::now();
+        report(m_intervalCounters, type::Duration{ now - m_lastReport }, false);
+        m_lastReport = now;
+        accumulateCounters();
+    }
+
+    void LoadGenerator::accumulateCounters()
+    {
+        m_totalCounters.published += m_intervalCounters.published;
+        m_totalCounters.received += m_intervalCounters.received;
+        m_totalCounters.drops += m_intervalCounters.drops;
+        m_totalCounters.reconnects += m_intervalCounters.reconnects;
+        m_totalCounters.connectionErrors += m_intervalCounters.connectionErrors;
+        m_intervalCounters = counters_t{};
+    }
+
+    void LoadGenerator::handleChurnTimer()
+    {
+        size_t clients = m_publishers.size() + m_subscribers.size();
+
+        if (clients == 0)
+        {
+            return;
+        }
+
+        // note: the replaced client leaves and a new client with the same
+        // role joins immediately
+        if (size_t i = std::uniform_int_distribution<size_t>{ 0, clients - 1 }(m_random); i < m_publishers.size())
+        {
+            createPublisher(*m_publishers[i]);
+        }
+        else
+        {
+            createSubscriber(*m_subscribers[i - m_publishers.size()]);
+        }
+
+        ++m_intervalCounters.reconnects;
+    }
+
+    void LoadGenerator::replaceLostClients()
+    {
+        for (const std::unique_ptr<publisher_t>& publisher : m_publishers)
+        {
+            if (publisher->lost)
+            {
+                createPublisher(*publisher);
+                ++m_intervalCounters.reconnects;
+            }
+        }
+
+        for (const std::unique_ptr<subscriber_t>& subscriber : m_subscribers)
+        {
+            if (subscriber->lost)
+            {
+                createSubscriber(*subscriber);
+                ++m_intervalCounters.reconnects;
+            }
+        }
+    }
+
+    void LoadGenerator::report(const counters_t& counters, type::Duration interval, bool summary) const
+    {
+        double seconds = std::max(interval.count(), 1e-9);
+        double elapsed = std::chrono::duration<double>{ steady_clock_t::now() - m_begin }.count();
+
+        std::cout << std::fixed << std::setprecision(1)
+            << (summary ? "[total " : "[") << std::setw(7) << elapsed << "s] "
+            << "publish " << std::setw(9) << static_cast<double>(counters.published) / seconds << "/s | "
+            << "receive " << std::setw(9) << static_cast<double>(counters.received) / seconds << "/s | "
+            << "drops " << counters.drops << " | "
+            << "reconnects " << counters.reconnects << " | "
+            << "errors " << counters.connectionErrors << " | "
+            << std::setprecision(3)
+            << "latency p50 " << to_milliseconds(counters.latencies.quantile(0.5)) << "ms "
+            << "p99 " << to_milliseconds(counters.latencies.quantile(0.99)) << "ms "
+            << "p99.9 " << to_milliseconds(counters.latencies.quantile(0.999)) << "ms "
+            << "max " << to_milliseconds(counters.latencies.max()) << "ms"
+            << std::endl;
+    }
+}
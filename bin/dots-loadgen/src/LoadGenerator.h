@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <dots/GuestTransceiver.h>
+#include <dots/Timer.h>
+#include <dots/io/Endpoint.h>
+#include <dots/tools/LatencyHistogram.h>
+#include <StructDescriptorData.dots.h>
+
+namespace dots
+{
+    /*!
+     * @class LoadGenerator LoadGenerator.h <LoadGenerator.h>
+     *
+     * @brief Generates configurable traffic to stress a DOTS host.
+     *
+     * A LoadGenerator creates a set of dynamic types of a configurable shape
+     * and opens a GuestTransceiver for each simulated publisher and
+     * subscriber. Publishers continuously publish updates of random
+     * instances at a fixed rate. Subscribers receive all types and measure
+     * the latency of every live update based on the sent time of its header.
+     *
+     * In addition to the configured properties, every type contains the key
+     * 'id', the id of the publisher that published the update and a
+     * per-publisher sequence number. These are always included in updates,
+     * so that subscribers can detect dropped updates.
+     *
+     * Optionally, a random client is periodically replaced by a new one to
+     * simulate join/leave churn. Clients that lose their connection
+     * unexpectedly are replaced as well.
+     */
+    struct LoadGenerator
+    {
+        struct config_t
+        {
+            io::Endpoint endpoint;
+            size_t publishers;
+            size_t subscribers;
+            size_t types;
+            size_t properties;
+            size_t stringSize;
+            uint32_t keys;
+            double rate;
+            double updateRatio;
+            bool cached;
+            type::Duration churnInterval;
+            type::Duration reportInterval;
+            type::Duration duration;
+            uint32_t seed;
+        };
+
+        LoadGenerator(asio::io_context& ioContext, config_t config);
+        LoadGenerator(const LoadGenerator& other) = delete;
+        LoadGenerator(LoadGenerator&& other) = delete;
+        ~LoadGenerator() = default;
+
+        LoadGenerator& operator = (const LoadGenerator& rhs) = delete;
+        LoadGenerator& operator = (LoadGenerator&& rhs) = delete;
+
+        /*!
+         * @brief Generate load until the configured duration has elapsed or
+         * LoadGenerator::stop() is called.
+         *
+         * A report is printed after every report interval and a summary is
+         * printed when the generator stops.
+         */
+        void run();
+
+        /*!
+         * @brief Stop generating load.
+         */
+        void stop();
+
+    private:
+
+        using steady_clock_t = std::chrono::steady_clock;
+
+        struct client_t
+        {
+            std::optional<GuestTransceiver> transceiver;
+            bool lost = false;
+        };
+
+        struct publisher_t : client_t
+        {
+            uint32_t id = 0;
+            std::vector<type::AnyStruct> instances;
+            uint64_t sequence = 0;
+            uint64_t issued = 0;
+            size_t nextType = 0;
+            size_t nextProperty = 0;
+            steady_clock_t::time_point begin;
+        };
+
+        struct subscriber_t : client_t
+        {
+            std::vector<Subscription> subscriptions;
+            std::unordered_map<uint32_t, uint64_t> lastSequences;
+        };
+
+        struct counters_t
+        {
+            uint64_t published = 0;
+            uint64_t received = 0;
+            uint64_t drops = 0;
+            uint64_t reconnects = 0;
+            uint64_t connectionErrors = 0;
+            tools::LatencyHistogram latencies;
+        };
+
+        static constexpr type::Duration PublishInterval{ 0.001 };
+
+        GuestTransceiver& openTransceiver(client_t& client, const std::string& name);
+        void createPublisher(publisher_t& publisher);
+        void createSubscriber(subscriber_t& subscriber);
+        void publish(publisher_t& publisher);
+
+        void handleTransition(client_t& client, const Connection& connection, std::exception_ptr ePtr);
+        void handleEvent(subscriber_t& subscriber, const Event<>& event);
+        void handlePublishTimer();
+        void handleReportTimer();
+        void handleChurnTimer();
+
+        void replaceLostClients();
+        void accumulateCounters();
+        void report(const counters_t& counters, type::Duration interval, bool summary) const;
+
+        asio::io_context* m_ioContext;
+        config_t m_config;
+        std::mt19937 m_random;
+        std::vector<StructDescriptorData> m_typeData;
+        std::vector<std::unique_ptr<publisher_t>> m_publishers;
+        std::vector<std::unique_ptr<subscriber_t>> m_subscribers;
+        uint32_t m_nextPublisherId;
+        counters_t m_intervalCounters;
+        counters_t m_totalCounters;
+        steady_clock_t::time_point m_begin;
+        steady_clock_t::time_point m_lastReport;
+        std::optional<Timer> m_publishTimer;
+        std::optional<Timer> m_reportTimer;
+        std::optional<Timer> m_churnTimer;
+        std::optional<Timer> m_durationTimer;
+    };
+}
@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <boost/program_options.hpp>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <dots/asio.h>
+#include <dots/tools/logging.h>
+#include <LoadGenerator.h>
+
+namespace po = boost::program_options;
+
+int main(int argc, char* argv[])
+{
+    const std::string AppName = "dots-loadgen";
+
+    // only show errors in log output
+    dots::tools::loggingFrontend().setLogLevel(dots::tools::Level::error);
+
+    try
+    {
+        po::options_description options("Allowed options");
+        options.add_options()
+            ("help", "display help message")
+            ("dots-endpoint", po::value<std::string>()->default_value("tcp://127.0.0.1"), "remote endpoint URI of the host to generate load for (e.g. tcp://127.0.0.1, ws://127.0.0.1:11233, uds:/run/dots.socket)")
+            ("publishers,p", po::value<size_t>()->default_value(4), "the number of publishing clients")
+            ("subscribers,s", po::value<size_t>()->default_value(4), "the number of subscribing clients (each subscribes to all types)")
+            ("types", po::value<size_t>()->default_value(1), "the number of generated types")
+            ("properties", po::value<size_t>()->default_value(8), "the number of value properties of each type (alternating int64, float64 and string)")
+            ("string-size", po::value<size_t>()->default_value(32), "the size of string values in bytes")
+            ("keys", po::value<uint32_t>()->default_value(1000), "the number of distinct keys (i.e. instances) per type")
+            ("rate,r", po::value<double>()->default_value(1000.0), "the number of updates per second and publisher")
+            ("update-ratio", po::value<double>()->default_value(1.0), "the ratio of value properties included in each update (0.0 - 1.0)")
+            ("uncached", "generate uncached types")
+            ("churn-interval", po::value<double>()->default_value(0.0), "the interval in seconds at which a random client leaves and a new one joins (0 = no churn)")
+            ("report-interval", po::value<double>()->default_value(1.0), "the interval in seconds at which statistics are reported")
+            ("duration,d", po::value<double>()->default_value(0.0), "the duration of the run in seconds (0 = until interrupted)")
+            ("seed", po::value<uint32_t>()->default_value(0), "the seed for the selection of keys and churned clients")
+        ;
+
+        po::variables_map args;
+        po::store(po::command_line_parser(argc, argv).options(options).run(), args);
+
+        if (args.count("help"))
+        {
+            std::cout << "Usage: " << AppName << " [options]\n" << options << "\n";
+            return EXIT_SUCCESS;
+        }
+
+        po::notify(args);
+
+        if (double updateRatio = args["update-ratio"].as<double>(); updateRatio < 0.0 || updateRatio > 1.0)
+        {
+            throw std::runtime_error{ "update ratio must be in the range [0.0, 1.0]: " + std::to_string(updateRatio) };
+        }
+
+        if (args["report-interval"].as<double>() <= 0.0)
+        {
+            throw std::runtime_error{ "report interval must be positive" };
+        }
+
+        asio::io_context ioContext;
+        dots::LoadGenerator loadGenerator{ ioContext, dots::LoadGenerator::config_t{
+            .endpoint = dots::io::Endpoint{ args["dots-endpoint"].as<std::string>() },
+            .publishers = args["publishers"].as<size_t>(),
+            .subscribers = args["subscribers"].as<size_t>(),
+            .types = args["types"].as<size_t>(),
+            .properties = args["properties"].as<size_t>(),
+            .stringSize = args["string-size"].as<size_t>(),
+            .keys = args["keys"].as<uint32_t>(),
+            .rate = args["rate"].as<double>(),
+            .updateRatio = args["update-ratio"].as<double>(),
+            .cached = args.count("uncached") == 0,
+            .churnInterval = dots::type::Duration{ args["churn-interval"].as<double>() },
+            .reportInterval = dots::type::Duration{ args["report-interval"].as<double>() },
+            .duration = dots::type::Duration{ args["duration"].as<double>() },
+            .seed = args["seed"].as<uint32_t>()
+        } };
+
+        asio::signal_set signals{ ioContext, SIGINT, SIGTERM };
+        signals.async_wait([&](boost::system::error_code/* error*/, int/* signalNumber*/){ loadGenerator.stop(); });
+
+        loadGenerator.run();
+
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR running " << AppName << " -> " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    catch (...)
+    {
+        std::cerr << "ERROR running " << AppName << " -> <unknown exception>" << "\n";
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <boost/program_options.hpp>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <dots/asio.h>
+#include <dots/GuestTransceiver.h>
+#include <dots/io/Endpoint.h>
+#include <dots/io/Recording.h>
+#include <dots/io/channels/TcpChannel.h>
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+#include <dots/io/channels/UdsChannel.h>
+#endif
+#include <DotsDescriptorRequest.dots.h>
+
+namespace po = boost::program_options;
+
+namespace
+{
+    dots::io::channel_ptr_t make_recordable_channel(asio::io_context& ioContext, const dots::io::Endpoint& endpoint)
+    {
+        // note: only channels that use the binary stream transmission format
+        // provide access to the raw frames
+        if (std::string_view scheme = endpoint.scheme(); scheme == "tcp" || scheme == "tcp-v2")
+        {
+            return dots::io::make_channel<dots::io::v2::TcpChannel>(ioContext, endpoint);
+        }
+        #if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+        else if (scheme == "uds" || scheme == "uds-v2")
+        {
+            return dots::io::make_channel<dots::io::posix::v2::UdsChannel>(ioContext, endpoint);
+        }
+        #endif
+        else
+        {
+            throw std::runtime_error{ "unsupported URI scheme for recording: '" + std::string{ scheme } + "'" };
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::string AppName = "dots-record";
+
+    try
+    {
+        po::options_description options("Allowed options");
+        options.add_options()
+            ("help", "display help message")
+            ("dots-endpoint", po::value<std::string>()->default_value("tcp://127.0.0.1"), "remote endpoint URI of the host to record from (e.g. tcp://127.0.0.1, uds:/run/dots.socket)")
+            ("output,o", po::value<std::string>()->required(), "the directory to store the recording in")
+            ("type,t", po::value<std::vector<std::string>>()->multitoken(), "the names of the types to record (default: all non-internal types)")
+            ("segment-size", po::value<size_t>()->default_value(dots::io::Recording::DefaultSegmentSize / (1024 * 1024)), "the size of each recording segment in megabytes")
+            ("flush-interval", po::value<unsigned>()->default_value(1), "the interval in seconds at which the current segment is flushed to disk (0 = only when sealed)")
+        ;
+
+        po::variables_map args;
+        po::store(po::command_line_parser(argc, argv).options(options).run(), args);
+
+        if (args.count("help"))
+        {
+            std::cout << "Usage: " << AppName << " [options]\n" << options << "\n";
+            return EXIT_SUCCESS;
+        }
+
+        po::notify(args);
+
+        std::optional<std::unordered_set<std::string>> typeFilter;
+
+        if (args.count("type"))
+        {
+            const auto& types = args["type"].as<std::vector<std::string>>();
+            typeFilter.emplace(types.begin(), types.end());
+        }
+
+        dots::io::Endpoint endpoint{ args["dots-endpoint"].as<std::string>() };
+        std::optional<std::string> authSecret;
+
+        if (!endpoint.userPassword().empty())
+        {
+            authSecret = endpoint.userPassword();
+        }
+
+        auto recording = std::make_shared<dots::io::Recording>(args["output"].as<std::string>(), args["segment-size"].as<size_t>() * 1024 * 1024);
+
+        asio::io_context ioContext;
+        std::exception_ptr connectionError;
+        dots::GuestTransceiver transceiver{ AppName, ioContext, dots::type::Registry::StaticTypePolicy::InternalOnly, dots::GuestTransceiver::transition_handler_t{ [&](const dots::Connection& connection, std::exception_ptr ePtr)
+        {
+            connectionError = ePtr;
+
+            if (connection.closed())
+            {
+                ioContext.stop();
+            }
+        } } };
+
+        dots::io::channel_ptr_t channel = make_recordable_channel(ioContext, endpoint);
+        channel->record(recording);
+        transceiver.open({}, {}, std::move(authSecret), std::move(channel));
+
+        while (!transceiver.connected())
+        {
+            if (connectionError != nullptr)
+            {
+                std::rethrow_exception(connectionError);
+            }
+
+            ioContext.run_one();
+        }
+
+        // note: the subscriptions only serve to make the host forward the
+        // corresponding transmissions, which are then recorded directly by
+        // the channel
+        std::vector<dots::Subscription> subscriptions;
+        subscriptions.emplace_back(transceiver.subscribe<dots::type::StructDescriptor>([&](const dots::type::StructDescriptor& descriptor)
+        {
+            bool selected = typeFilter == std::nullopt ? !descriptor.internal() : typeFilter->count(descriptor.name()) > 0;
+
+            if (selected && !descriptor.substructOnly())
+            {
+                subscriptions.emplace_back(transceiver.subscribe(descriptor, dots::Transceiver::transmission_handler_t{ [](const dots::io::Transmission&){} }));
+            }
+        }));
+
+        dots::vector_t<dots::string_t> whitelist;
+
+        if (typeFilter != std::nullopt)
+        {
+            whitelist.assign(typeFilter->begin(), typeFilter->end());
+        }
+
+        transceiver.publish(DotsDescriptorRequest{
+            .whitelist = std::move(whitelist)
+        });
+
+        asio::signal_set signals{ ioContext, SIGINT, SIGTERM };
+        signals.async_wait([&](boost::system::error_code/* error*/, int/* signalNumber*/){ ioContext.stop(); });
+
+        std::optional<dots::Timer> flushTimer;
+
+        if (unsigned flushInterval = args["flush-interval"].as<unsigned>(); flushInterval > 0)
+        {
+            flushTimer.emplace(ioContext, dots::type::Duration{ static_cast<double>(flushInterval) }, dots::Timer::handler_t{ [&]{ recording->flush(); } }, true);
+        }
+
+        ioContext.run();
+        recording->seal();
+
+        std::cout << AppName << ": recorded " << recording->frames() << " frames in " << recording->segments() << " segments\n";
+
+        if (connectionError != nullptr)
+        {
+            std::rethrow_exception(connectionError);
+        }
+
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR running " << AppName << " -> " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    catch (...)
+    {
+        std::cerr << "ERROR running " << AppName << " -> <unknown exception>" << "\n";
+        return EXIT_FAILURE;
+    }
+}
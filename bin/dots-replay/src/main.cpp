@@ -0,0 +1,221 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <dots/asio.h>
+#include <dots/GuestTransceiver.h>
+#include <dots/io/DescriptorConverter.h>
+#include <dots/io/Endpoint.h>
+#include <dots/io/Recording.h>
+#include <dots/serialization/CborSerializer.h>
+#include <DotsHeader.dots.h>
+#include <StructDescriptorData.dots.h>
+#include <EnumDescriptorData.dots.h>
+
+namespace po = boost::program_options;
+
+int main(int argc, char* argv[])
+{
+    const std::string AppName = "dots-replay";
+
+    try
+    {
+        po::options_description options("Allowed options");
+        options.add_options()
+            ("help", "display help message")
+            ("dots-endpoint", po::value<std::string>()->default_value("tcp://127.0.0.1"), "remote endpoint URI of the host to replay to (e.g. tcp://127.0.0.1, ws://127.0.0.1:11233, uds:/run/dots.socket)")
+            ("recording", po::value<std::string>()->required(), "the directory of the recording to replay")
+            ("type,t", po::value<std::vector<std::string>>()->multitoken(), "the names of the types to replay (default: all recorded types)")
+            ("speed,s", po::value<double>()->default_value(1.0), "the replay speed relative to the original timing (e.g. 2 = twice as fast, 0 = as fast as possible)")
+            ("loop", "replay the recording repeatedly until interrupted")
+            ("drain-time", po::value<unsigned>()->default_value(500), "the time in milliseconds to keep the connection open after the last transmission")
+        ;
+
+        po::positional_options_description positionalOptions;
+        positionalOptions.add("recording", 1);
+
+        po::variables_map args;
+        po::store(po::command_line_parser(argc, argv).options(options).positional(positionalOptions).run(), args);
+
+        if (args.count("help"))
+        {
+            std::cout << "Usage: " << AppName << " [options] <recording>\n" << options << "\n";
+            return EXIT_SUCCESS;
+        }
+
+        po::notify(args);
+
+        std::optional<std::unordered_set<std::string>> typeFilter;
+
+        if (args.count("type"))
+        {
+            const auto& types = args["type"].as<std::vector<std::string>>();
+            typeFilter.emplace(types.begin(), types.end());
+        }
+
+        double speed = args["speed"].as<double>();
+
+        if (speed < 0)
+        {
+            throw std::runtime_error{ "replay speed must not be negative: " + std::to_string(speed) };
+        }
+
+        dots::io::RecordingReader reader{ args["recording"].as<std::string>() };
+        std::vector<dots::io::RecordingReader::Frame> frames = reader.read(typeFilter);
+
+        asio::io_context ioContext;
+        std::exception_ptr connectionError;
+        bool interrupted = false;
+        dots::GuestTransceiver transceiver{ AppName, ioContext, dots::type::Registry::StaticTypePolicy::InternalOnly, dots::GuestTransceiver::transition_handler_t{ [&](const dots::Connection& connection, std::exception_ptr ePtr)
+        {
+            connectionError = ePtr;
+
+            if (connection.closed())
+            {
+                ioContext.stop();
+            }
+        } } };
+
+        transceiver.open(dots::io::Endpoint{ args["dots-endpoint"].as<std::string>() });
+
+        while (!transceiver.connected())
+        {
+            if (connectionError != nullptr)
+            {
+                std::rethrow_exception(connectionError);
+            }
+
+            ioContext.run_one();
+        }
+
+        asio::signal_set signals{ ioContext, SIGINT, SIGTERM };
+        signals.async_wait([&](boost::system::error_code/* error*/, int/* signalNumber*/){ interrupted = true; ioContext.stop(); });
+
+        dots::type::Registry& registry = transceiver.registry();
+        dots::serialization::CborSerializer serializer;
+        size_t published = 0;
+
+        do
+        {
+            // note: the original timing is reproduced relative to the first
+            // frame, so that the replay is not affected by the time that is
+            // required to publish the individual frames
+            auto replayBegin = std::chrono::steady_clock::now();
+            std::optional<dots::type::TimePoint> recordingBegin;
+
+            for (const dots::io::RecordingReader::Frame& frame : frames)
+            {
+                if (recordingBegin == std::nullopt)
+                {
+                    recordingBegin = frame.time;
+                }
+
+                if (speed > 0)
+                {
+                    auto offset = std::chrono::duration_cast<std::chrono::steady_clock::duration>((frame.time - *recordingBegin) / speed);
+                    ioContext.run_until(replayBegin + offset);
+                }
+                else
+                {
+                    ioContext.poll();
+                }
+
+                if (interrupted || connectionError != nullptr)
+                {
+                    break;
+                }
+
+                ioContext.restart();
+                serializer.setInput(frame.payload, frame.size);
+
+                auto header = serializer.deserialize<DotsHeader>();
+                const dots::type::StructDescriptor* descriptor = registry.findStructType(*header.typeName);
+
+                if (descriptor == nullptr)
+                {
+                    continue;
+                }
+
+                // note: batch frames contain multiple instances of a regular
+                // type and are replayed as a batch as well
+                if (header.batchSize.isValid())
+                {
+                    std::vector<dots::type::AnyStruct> instances;
+                    std::vector<const dots::type::Struct*> batch;
+                    instances.reserve(*header.batchSize);
+
+                    for (uint32_t i = 0; i < *header.batchSize; ++i)
+                    {
+                        serializer.deserialize(*instances.emplace_back(*descriptor));
+                        batch.emplace_back(&*instances.back());
+                    }
+
+                    std::optional<dots::property_set_t> includedProperties;
+
+                    if (header.attributes.isValid())
+                    {
+                        includedProperties = *header.attributes;
+                    }
+
+                    transceiver.publish(std::span<const dots::type::Struct* const>{ batch }, includedProperties, header.removeObj == true);
+                    ++published;
+
+                    continue;
+                }
+
+                dots::type::AnyStruct instance{ *descriptor };
+                serializer.deserialize(*instance);
+
+                if (const auto* structDescriptorData = instance->_as<StructDescriptorData>(); structDescriptorData != nullptr && registry.findType(*structDescriptorData->name) == nullptr)
+                {
+                    dots::io::DescriptorConverter{ registry }(*structDescriptorData);
+                }
+                else if (const auto* enumDescriptorData = instance->_as<EnumDescriptorData>(); enumDescriptorData != nullptr && registry.findType(*enumDescriptorData->name) == nullptr)
+                {
+                    dots::io::DescriptorConverter{ registry }(*enumDescriptorData);
+                }
+
+                if (descriptor->internal())
+                {
+                    continue;
+                }
+
+                transceiver.publish(*instance, header.attributes.valueOrDefault(instance->_validProperties()), header.removeObj == true);
+                ++published;
+            }
+        }
+        while (args.count("loop") && !interrupted && connectionError == nullptr);
+
+        if (connectionError == nullptr && !interrupted)
+        {
+            ioContext.restart();
+            ioContext.run_for(std::chrono::milliseconds{ args["drain-time"].as<unsigned>() });
+        }
+
+        std::cout << AppName << ": replayed " << published << " of " << reader.frames() << " frames\n";
+
+        if (connectionError != nullptr)
+        {
+            std::rethrow_exception(connectionError);
+        }
+
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR running " << AppName << " -> " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    catch (...)
+    {
+        std::cerr << "ERROR running " << AppName << " -> <unknown exception>" << "\n";
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <boost/program_options.hpp>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <dots/type/Registry.h>
+#include <dots/io/DescriptorConverter.h>
+#include <dots/io/TransmissionTrace.h>
+#include <dots/serialization/CborSerializer.h>
+#include <dots/serialization/StringSerializer.h>
+#include <DotsHeader.dots.h>
+
+namespace po = boost::program_options;
+
+int main(int argc, char* argv[])
+{
+    const std::string AppName = "dots-trace-decode";
+
+    try
+    {
+        po::options_description options("Allowed options");
+        options.add_options()
+            ("help", "display help message")
+            ("trace-file", po::value<std::string>()->required(), "the transmission trace dump to decode")
+            ("peer", po::value<uint32_t>(), "only decode transmissions exchanged with the peer of the given id")
+            ("type", po::value<std::string>(), "only decode transmissions of the given type")
+            ("header", "also print the header of each transmission")
+            ("skip-internal", "do not print transmissions of internal types")
+        ;
+
+        po::positional_options_description positionalOptions;
+        positionalOptions.add("trace-file", 1);
+
+        po::variables_map args;
+        po::store(po::command_line_parser(argc, argv).options(options).positional(positionalOptions).run(), args);
+
+        if (args.count("help"))
+        {
+            std::cout << "Usage: " << AppName << " [options] <trace-file>\n" << options << "\n";
+            return EXIT_SUCCESS;
+        }
+
+        po::notify(args);
+
+        std::ifstream ifs{ args["trace-file"].as<std::string>(), std::ios::binary };
+
+        if (!ifs)
+        {
+            throw std::runtime_error{ "could not open trace file '" + args["trace-file"].as<std::string>() + "'" };
+        }
+
+        std::optional<uint32_t> peerFilter = args.count("peer") ? std::optional{ args["peer"].as<uint32_t>() } : std::nullopt;
+        std::optional<std::string> typeFilter = args.count("type") ? std::optional{ args["type"].as<std::string>() } : std::nullopt;
+        bool printHeader = args.count("header") > 0;
+        bool skipInternal = args.count("skip-internal") > 0;
+
+        // note: descriptor frames are always processed to make dynamic types
+        // known, even if they are not printed
+        dots::type::Registry registry;
+
+        for (const dots::io::TransmissionTrace::Frame& frame : dots::io::TransmissionTrace::Read(ifs))
+        {
+            bool printFrame = peerFilter == std::nullopt || frame.peerId == *peerFilter;
+            std::ostringstream oss;
+            oss << "[" << frame.time.toString() << "] " << (frame.direction == dots::io::TransmissionTrace::Direction::receive ? "RECEIVE from " : "TRANSMIT to ") << frame.peerId << ": ";
+
+            try
+            {
+                dots::serialization::CborSerializer serializer;
+                serializer.setInput(frame.payload.data(), frame.payload.size());
+
+                auto header = serializer.deserialize<DotsHeader>();
+                const dots::type::StructDescriptor* descriptor = registry.findStructType(*header.typeName);
+
+                if (descriptor == nullptr)
+                {
+                    if (printFrame && (typeFilter == std::nullopt || *typeFilter == *header.typeName))
+                    {
+                        std::cout << oss.str() << "<unknown type '" << *header.typeName << "' (" << frame.payload.size() << " bytes)>\n";
+                    }
+
+                    continue;
+                }
+
+                dots::type::AnyStruct instance{ *descriptor };
+                serializer.deserialize(*instance);
+
+                if (const auto* structDescriptorData = instance->_as<StructDescriptorData>(); structDescriptorData != nullptr && registry.findType(*structDescriptorData->name) == nullptr)
+                {
+                    dots::io::DescriptorConverter{ registry }(*structDescriptorData);
+                }
+                else if (const auto* enumDescriptorData = instance->_as<EnumDescriptorData>(); enumDescriptorData != nullptr && registry.findType(*enumDescriptorData->name) == nullptr)
+                {
+                    dots::io::DescriptorConverter{ registry }(*enumDescriptorData);
+                }
+
+                if (!printFrame || (typeFilter != std::nullopt && *typeFilter != *header.typeName) || (skipInternal && descriptor->internal()))
+                {
+                    continue;
+                }
+
+                std::cout << oss.str();
+
+                if (printHeader)
+                {
+                    std::cout << dots::to_string(header) << " ";
+                }
+
+                std::cout << dots::to_string(*instance) << "\n";
+            }
+            catch (const std::exception& e)
+            {
+                if (printFrame)
+                {
+                    std::cout << oss.str() << "<undecodable frame (" << frame.payload.size() << " bytes): " << e.what() << ">\n";
+                }
+            }
+        }
+
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR running " << AppName << " -> " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    catch (...)
+    {
+        std::cerr << "ERROR running " << AppName << " -> <unknown exception>" << "\n";
+        return EXIT_FAILURE;
+    }
+}
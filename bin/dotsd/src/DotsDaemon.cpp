@@ -9,20 +9,25 @@
 #include <dots/tools/logging.h>
 #include <dots/io/Io.h>
 #include <dots/io/auth/LegacyAuthManager.h>
+#include <dots/io/TransmissionTrace.h>
 #include <DotsClient.dots.h>
 #include <DotsContinuousRecorderStatus.dots.h>
 #include <DotsDumpContinuousRecorder.dots.h>
 #include <StructDescriptorData.dots.h>
 #include <DotsStatistics.dots.h>
 #include <DotsCacheStatus.dots.h>
+#include <DotsConnectionStatistics.dots.h>
+#include <DotsTypeStatistics.dots.h>
 
 using namespace dots::literals;
 
 namespace dots
 {
-    DotsDaemon::DotsDaemon(std::string name, int argc, char* argv[]) :
+    DotsDaemon::DotsDaemon(std::string name, int argc, char* argv[], std::vector<std::string> suppressedTypes/* = {}*/, std::optional<cache_persistence_t> cachePersistence/* = std::nullopt*/) :
         Application(argc, argv, HostTransceiver{ std::move(name), io::global_io_context(), type::Registry::StaticTypePolicy::InternalOnly, HostTransceiver::transition_handler_t{&DotsDaemon::handleTransition, this}}),
         m_daemonStatus{ .serverName = transceiver().selfName(), .startTime = timepoint_t::Now() },
+        m_cachePersistence(false),
+        m_suppressedTypes{ std::make_move_iterator(suppressedTypes.begin()), std::make_move_iterator(suppressedTypes.end()) },
         m_updateServerStatusTimer{ io::global_io_context(), 1s, { &DotsDaemon::updateServerStatus, this }, true },
         m_cleanUpClientsTimer{ io::global_io_context(), 10s, { &DotsDaemon::cleanUpClients, this }, true }
     {
@@ -34,6 +39,46 @@ namespace dots
         type::Descriptor<DotsDumpContinuousRecorder>::Instance();
 
         static_cast<HostTransceiver&>(transceiver()).setAuthManager<io::LegacyAuthManager>();
+
+        if (!m_suppressedTypes.empty())
+        {
+            m_newStructTypeSubscription.emplace(transceiver().subscribe<type::StructDescriptor>({ &DotsDaemon::handleNewStructType, this }));
+        }
+
+        #ifdef __unix__
+        if (io::global_transmission_trace() != nullptr)
+        {
+            m_traceDumpSignal.emplace(io::global_io_context(), SIGUSR1);
+            asyncWaitForTraceDumpSignal();
+        }
+        #endif
+
+        // note: the cache snapshot is restored before any guest can connect,
+        // because guests are only accepted once the event loop is running
+        if (cachePersistence != std::nullopt)
+        {
+            auto loadStart = std::chrono::steady_clock::now();
+            size_t restored = static_cast<HostTransceiver&>(transceiver()).enableCachePersistence(cachePersistence->path, cachePersistence->journal);
+            type::Duration loadTime{ std::chrono::steady_clock::now() - loadStart };
+
+            m_cachePersistence = true;
+            m_cacheStatus.persistentInstances = static_cast<uint32_t>(restored);
+            m_cacheStatus.snapshotLoadTime = loadTime;
+            LOG_NOTICE_S("restored " << restored << " persistent instances from cache snapshot '" << cachePersistence->path.string() << "' in " << loadTime.count() * 1000.0 << "ms");
+
+            if (cachePersistence->interval > type::Duration{ 0 })
+            {
+                m_cacheSnapshotTimer.emplace(io::global_io_context(), cachePersistence->interval, Timer::handler_t{ &DotsDaemon::writeCacheSnapshot, this }, true);
+            }
+        }
+    }
+
+    DotsDaemon::~DotsDaemon()
+    {
+        if (m_cachePersistence)
+        {
+            writeCacheSnapshot();
+        }
     }
 
     void DotsDaemon::handleTransition(const Connection& connection, std::exception_ptr/* ePtr*/)
@@ -43,6 +88,56 @@ namespace dots
             .name = connection.peerName(),
             .connectionState = connection.state()
         });
+
+        // note: the final statistics of closed connections have to be
+        // collected here, because the connection will not be managed by the
+        // host anymore when the status is updated the next time
+        if (connection.closed())
+        {
+            updateConnectionStatistics(connection);
+        }
+    }
+
+    void DotsDaemon::handleNewStructType(const type::StructDescriptor& descriptor)
+    {
+        if (m_suppressedTypes.count(descriptor.name()) == 0)
+        {
+            return;
+        }
+
+        if (descriptor.cached())
+        {
+            static_cast<HostTransceiver&>(transceiver()).suppressUnchangedUpdates(descriptor);
+            LOG_INFO_S("suppressing unchanged updates of type '" << descriptor.name() << "'");
+        }
+        else
+        {
+            LOG_WARN_S("unable to suppress unchanged updates of uncached type '" << descriptor.name() << "'");
+        }
+    }
+
+    void DotsDaemon::asyncWaitForTraceDumpSignal()
+    {
+        m_traceDumpSignal->async_wait([this](boost::system::error_code error, int/* signalNumber*/)
+        {
+            if (error)
+            {
+                return;
+            }
+
+            try
+            {
+                std::shared_ptr<io::TransmissionTrace> trace = io::global_transmission_trace();
+                trace->dump();
+                LOG_NOTICE_S("dumped transmission trace to '" << trace->dumpPath()->string() << "'");
+            }
+            catch (const std::exception& e)
+            {
+                LOG_ERROR_S("could not dump transmission trace -> " << e.what());
+            }
+
+            asyncWaitForTraceDumpSignal();
+        });
     }
 
     void DotsDaemon::cleanUpClients()
@@ -85,6 +180,29 @@ namespace dots
         for (Connection::id_t id : expiredClients)
         {
             transceiver().remove(DotsClient{ .id = id });
+
+            if (m_connectionStatistics.erase(id) > 0)
+            {
+                transceiver().remove(DotsConnectionStatistics{ .id = id });
+            }
+        }
+    }
+
+    void DotsDaemon::writeCacheSnapshot()
+    {
+        try
+        {
+            auto snapshotStart = std::chrono::steady_clock::now();
+            size_t written = static_cast<HostTransceiver&>(transceiver()).writeCacheSnapshot();
+            type::Duration snapshotTime{ std::chrono::steady_clock::now() - snapshotStart };
+
+            m_cacheStatus.snapshotTime = snapshotTime;
+            m_cacheStatus.lastSnapshot = timepoint_t::Now();
+            LOG_INFO_S("wrote " << written << " persistent instances to cache snapshot in " << snapshotTime.count() * 1000.0 << "ms");
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR_S("could not write cache snapshot -> " << e.what());
         }
     }
 
@@ -92,35 +210,52 @@ namespace dots
     {
         try
         {
+            for (const Connection* connection : static_cast<HostTransceiver&>(transceiver()).guestConnections())
+            {
+                updateConnectionStatistics(*connection);
+            }
+
+            updateTypeStatistics();
+
             DotsDaemonStatus ds{ m_daemonStatus };
+            ds.received = DotsStatistics{ .bytes = m_totalStatistics.receivedBytes, .packages = m_totalStatistics.receivedFrames };
+            ds.sent = DotsStatistics{ .bytes = m_totalStatistics.transmittedBytes, .packages = m_totalStatistics.transmittedFrames };
 
-            if (m_daemonStatus._diffProperties(ds))
-            {
-                #ifdef __unix__
-                struct rusage usage;
-                ::getrusage(RUSAGE_SELF, &usage);
-
-                ds.resourceUsage = DotsResourceUsage{
-                    .minorFaults = static_cast<int32_t>(usage.ru_minflt),
-                    .majorFaults = static_cast<int32_t>(usage.ru_majflt),
-                    .inBlock = static_cast<int32_t>(usage.ru_inblock),
-                    .outBlock = static_cast<int32_t>(usage.ru_oublock),
-                    .nrSignals = static_cast<int32_t>(usage.ru_nsignals),
-                    .nrSwaps = static_cast<int32_t>(usage.ru_nswap),
-                    .nrVoluntaryContextSwitches = static_cast<int32_t>(usage.ru_nvcsw),
-                    .nrInvoluntaryContextSwitches = static_cast<int32_t>(usage.ru_nivcsw),
-                    .maxRss = static_cast<int32_t>(usage.ru_maxrss),
-                    .userCpuTime = type::posix::Timeval{ usage.ru_utime },
-                    .systemCpuTime = type::posix::Timeval{ usage.ru_stime }
-                };
-                #endif
-                ds.cache = DotsCacheStatus{
-                    .nrTypes = static_cast<uint32_t>(transceiver().pool().size()),
-                    .size = static_cast<uint32_t>(transceiver().pool().totalMemoryUsage())
-                };
+            #ifdef __unix__
+            struct rusage usage;
+            ::getrusage(RUSAGE_SELF, &usage);
+
+            ds.resourceUsage = DotsResourceUsage{
+                .minorFaults = static_cast<int32_t>(usage.ru_minflt),
+                .majorFaults = static_cast<int32_t>(usage.ru_majflt),
+                .inBlock = static_cast<int32_t>(usage.ru_inblock),
+                .outBlock = static_cast<int32_t>(usage.ru_oublock),
+                .nrSignals = static_cast<int32_t>(usage.ru_nsignals),
+                .nrSwaps = static_cast<int32_t>(usage.ru_nswap),
+                .nrVoluntaryContextSwitches = static_cast<int32_t>(usage.ru_nvcsw),
+                .nrInvoluntaryContextSwitches = static_cast<int32_t>(usage.ru_nivcsw),
+                .maxRss = static_cast<int32_t>(usage.ru_maxrss),
+                .userCpuTime = type::posix::Timeval{ usage.ru_utime },
+                .systemCpuTime = type::posix::Timeval{ usage.ru_stime }
+            };
+            #endif
+            ds.cache = m_cacheStatus;
+            ds.cache->nrTypes = static_cast<uint32_t>(transceiver().pool().size());
+            ds.cache->size = static_cast<uint32_t>(transceiver().pool().totalMemoryUsage());
 
+            // note: the traffic counters and the resource usage change
+            // continuously (not least because of the transmission of the
+            // status itself) and are therefore only republished at a lower
+            // rate, unless other properties of the status changed
+            property_set_t changedProperties = m_daemonStatus._diffProperties(ds);
+            property_set_t counterProperties = DotsDaemonStatus::received_p + DotsDaemonStatus::sent_p + DotsDaemonStatus::resourceUsage_p;
+            auto now = std::chrono::steady_clock::now();
+
+            if (!(changedProperties - counterProperties).empty() || (!changedProperties.empty() && now - m_daemonStatusPublished >= DaemonStatusCounterInterval))
+            {
                 transceiver().publish(ds);
                 m_daemonStatus = ds;
+                m_daemonStatusPublished = now;
             }
         }
         catch (const std::exception& e)
@@ -128,4 +263,54 @@ namespace dots
             LOG_ERROR_S("exception in updateServerStatus: " << e.what());
         }
     }
+
+    void DotsDaemon::updateConnectionStatistics(const Connection& connection)
+    {
+        const io::Channel::statistics_t& statistics = connection.statistics();
+        io::Channel::statistics_t& previousStatistics = m_connectionStatistics[connection.peerId()];
+
+        if (statistics == previousStatistics)
+        {
+            return;
+        }
+
+        m_totalStatistics.receivedBytes += statistics.receivedBytes - previousStatistics.receivedBytes;
+        m_totalStatistics.receivedFrames += statistics.receivedFrames - previousStatistics.receivedFrames;
+        m_totalStatistics.transmittedBytes += statistics.transmittedBytes - previousStatistics.transmittedBytes;
+        m_totalStatistics.transmittedFrames += statistics.transmittedFrames - previousStatistics.transmittedFrames;
+        previousStatistics = statistics;
+
+        transceiver().publish(DotsConnectionStatistics{
+            .id = connection.peerId(),
+            .received = DotsStatistics{ .bytes = statistics.receivedBytes, .packages = statistics.receivedFrames },
+            .sent = DotsStatistics{ .bytes = statistics.transmittedBytes, .packages = statistics.transmittedFrames },
+            .writeBatches = statistics.writeBatches,
+            .writeBufferHighWaterMark = statistics.writeBufferHighWaterMark
+        });
+    }
+
+    void DotsDaemon::updateTypeStatistics()
+    {
+        for (const auto& [descriptor, statistics] : static_cast<HostTransceiver&>(transceiver()).typeStatistics())
+        {
+            // note: the traffic of the statistics types themselves is not
+            // reported, because it would otherwise cause them to be
+            // republished indefinitely
+            if (descriptor == &DotsTypeStatistics::_Descriptor() || descriptor == &DotsConnectionStatistics::_Descriptor() || descriptor == &DotsDaemonStatus::_Descriptor())
+            {
+                continue;
+            }
+
+            if (HostTransceiver::type_statistics_t& previousStatistics = m_typeStatistics[descriptor]; statistics != previousStatistics)
+            {
+                previousStatistics = statistics;
+
+                transceiver().publish(DotsTypeStatistics{
+                    .typeName = descriptor->name(),
+                    .published = statistics.publishedFrames,
+                    .sent = DotsStatistics{ .bytes = statistics.transmittedBytes, .packages = statistics.transmittedFrames }
+                });
+            }
+        }
+    }
 }
@@ -1,19 +1,33 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #pragma once
+#include <chrono>
 #include <vector>
+#include <filesystem>
+#include <set>
+#include <string>
 #include <optional>
+#include <unordered_map>
 #include <dots/Application.h>
+#include <dots/HostTransceiver.h>
 #include <DotsDaemonStatus.dots.h>
+#include <DotsCacheStatus.dots.h>
 
 namespace dots
 {
     struct DotsDaemon : Application
     {
-        DotsDaemon(std::string name, int argc, char* argv[]);
+        struct cache_persistence_t
+        {
+            std::filesystem::path path;
+            type::Duration interval;
+            bool journal;
+        };
+
+        DotsDaemon(std::string name, int argc, char* argv[], std::vector<std::string> suppressedTypes = {}, std::optional<cache_persistence_t> cachePersistence = std::nullopt);
         DotsDaemon(const DotsDaemon& other) = delete;
         DotsDaemon(DotsDaemon&& other) = delete;
-        ~DotsDaemon() = default;
+        ~DotsDaemon();
 
         DotsDaemon& operator = (const DotsDaemon& rhs) = delete;
         DotsDaemon& operator = (DotsDaemon&& rhs) = delete;
@@ -21,11 +35,28 @@ namespace dots
     private:
 
         void handleTransition(const Connection& connection, std::exception_ptr ePtr);
+        void handleNewStructType(const type::StructDescriptor& descriptor);
+        void asyncWaitForTraceDumpSignal();
         void cleanUpClients();
+        void writeCacheSnapshot();
 
         void updateServerStatus();
+        void updateConnectionStatistics(const Connection& connection);
+        void updateTypeStatistics();
+
+        static constexpr std::chrono::seconds DaemonStatusCounterInterval{ 30 };
 
         DotsDaemonStatus m_daemonStatus;
+        std::chrono::steady_clock::time_point m_daemonStatusPublished;
+        DotsCacheStatus m_cacheStatus;
+        bool m_cachePersistence;
+        io::Channel::statistics_t m_totalStatistics;
+        std::unordered_map<Connection::id_t, io::Channel::statistics_t> m_connectionStatistics;
+        std::unordered_map<const type::StructDescriptor*, HostTransceiver::type_statistics_t> m_typeStatistics;
+        std::set<std::string, std::less<>> m_suppressedTypes;
+        std::optional<Subscription> m_newStructTypeSubscription;
+        std::optional<asio::signal_set> m_traceDumpSignal;
+        std::optional<Timer> m_cacheSnapshotTimer;
         Timer m_updateServerStatusTimer;
         Timer m_cleanUpClientsTimer;
     };
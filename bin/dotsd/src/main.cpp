@@ -4,8 +4,11 @@
 #include <boost/program_options.hpp>
 #include <iostream>
 #include <optional>
+#include <vector>
+#include <string>
 #include <dots/tools/logging.h>
 #include <dots/io/Endpoint.h>
+#include <dots/io/TransmissionTrace.h>
 #include <DotsDaemon.h>
 
 namespace po = boost::program_options;
@@ -18,6 +21,12 @@ int main(int argc, char* argv[])
         options.add_options()
             ("help", "display help message")
             ("daemon-name,n", po::value<std::string>()->default_value("dotsd"), "the name hat will be used by the host transceiver to identify itself")
+            ("transmission-trace", po::value<size_t>(), "enable the transmission trace with a ring of the given capacity in kilobytes")
+            ("transmission-trace-file", po::value<std::string>()->default_value("dots-transmission-trace.bin"), "the file to dump the transmission trace to on SIGUSR1 (dumps on connection errors are written to timestamped variants of it)")
+            ("cache-snapshot", po::value<std::string>(), "the file to restore the containers of persistent types from on startup and to write snapshots of them to")
+            ("cache-snapshot-interval", po::value<unsigned>()->default_value(60), "the interval in seconds at which cache snapshots are written (0 = only on shutdown)")
+            ("cache-journal", "journal every change of a persistent type between cache snapshots")
+            ("suppress-unchanged-updates", po::value<std::vector<std::string>>()->multitoken()->default_value({}, ""), "the names of cached types for which updates that do not change any property are not forwarded")
             #ifdef __linux__
             ("daemonize,d", "indicates whether to use the Linux 'daemon' syscall to detach the application from the controlling terminal")
             #endif
@@ -35,7 +44,23 @@ int main(int argc, char* argv[])
 
         LOG_NOTICE_S("starting dotsd...");
 
-        dots::DotsDaemon dotsDaemon{ args["daemon-name"].as<std::string>(), argc, argv };
+        if (args.count("transmission-trace"))
+        {
+            dots::io::set_global_transmission_trace(std::make_shared<dots::io::TransmissionTrace>(args["transmission-trace"].as<size_t>() * 1024, args["transmission-trace-file"].as<std::string>()));
+        }
+
+        std::optional<dots::DotsDaemon::cache_persistence_t> cachePersistence;
+
+        if (args.count("cache-snapshot"))
+        {
+            cachePersistence = dots::DotsDaemon::cache_persistence_t{
+                .path = args["cache-snapshot"].as<std::string>(),
+                .interval = std::chrono::seconds{ args["cache-snapshot-interval"].as<unsigned>() },
+                .journal = args.count("cache-journal") > 0
+            };
+        }
+
+        dots::DotsDaemon dotsDaemon{ args["daemon-name"].as<std::string>(), argc, argv, args["suppress-unchanged-updates"].as<std::vector<std::string>>(), std::move(cachePersistence) };
 
         #ifdef __linux__
         if (args.count("daemonize") && ::daemon(0, 0) == -1)
@@ -2,7 +2,9 @@
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #pragma once
 #include <string_view>
+#include <span>
 #include <tuple>
+#include <vector>
 #include <optional>
 #include <dots/tools/Handler.h>
 #include <dots/io/Channel.h>
@@ -49,6 +51,7 @@ namespace dots
         static constexpr id_t FirstGuestId = 2;
 
         using receive_handler_t = tools::Handler<bool(Connection&, io::Transmission)>;
+        using receive_batch_handler_t = tools::Handler<bool(Connection&, std::vector<io::Transmission>)>;
         using transition_handler_t = tools::Handler<void(Connection&, std::exception_ptr)>;
 
         /*!
@@ -178,6 +181,19 @@ namespace dots
          */
         bool closed() const;
 
+        /*!
+         * @brief Indicates whether batch frames are used with the peer.
+         *
+         * Batch frames contain multiple instances of the same type with a
+         * single header (see DotsHeader::batchSize). They are only used if
+         * both peers announced support for them during the handshake (see
+         * DotsMsgHello::batchFrames and DotsMsgConnect::batchFrames).
+         *
+         * @return true If batch frames were negotiated with the peer.
+         * @return false Else.
+         */
+        bool batchFrames() const;
+
         /*!
          * @brief Get a description of the remote peer of this connection.
          *
@@ -206,6 +222,14 @@ namespace dots
          */
         std::string endpointDescription() const;
 
+        /*!
+         * @brief Get the traffic statistics of the underlying channel.
+         *
+         * @return const io::Channel::statistics_t& A reference to the
+         * current traffic statistics.
+         */
+        const io::Channel::statistics_t& statistics() const;
+
         /*!
          * @brief Start to asynchronously receive transmissions via the
          * underlying channel.
@@ -239,6 +263,36 @@ namespace dots
          */
         void asyncReceive(type::Registry& registry, io::AuthManager* authManager, std::string_view name, receive_handler_t receiveHandler, transition_handler_t transitionHandler);
 
+        /*!
+         * @brief Start to asynchronously receive transmissions via the
+         * underlying channel.
+         *
+         * This behaves like Connection::asyncReceive(type::Registry&,
+         * io::AuthManager*, std::string_view, receive_handler_t,
+         * transition_handler_t), but additionally invokes the given batch
+         * handler with all transmissions of a received batch frame at once.
+         *
+         * @param registry The registry to be used by the underlying channel.
+         *
+         * @param authManager The authentication manager to use.
+         *
+         * @param name The self-assigned name to use for identification with
+         * the peer.
+         *
+         * @param receiveHandler The handler to invoke asynchronously when a
+         * transmission is received.
+         *
+         * @param receiveBatchHandler The handler to invoke asynchronously when
+         * a batch frame is received.
+         *
+         * @param transitionHandler The handler to invoke when the Connection
+         * transitions to another state.
+         *
+         * @exception std::logic_error Thrown if another "async receive" is
+         * already active on the connection.
+         */
+        void asyncReceive(type::Registry& registry, io::AuthManager* authManager, std::string_view name, receive_handler_t receiveHandler, receive_batch_handler_t receiveBatchHandler, transition_handler_t transitionHandler);
+
         /*!
          * @brief Transmit a specific instance.
          *
@@ -260,6 +314,31 @@ namespace dots
          */
         void transmit(const type::Struct& instance, std::optional<property_set_t> includedProperties = std::nullopt, bool remove = false);
 
+        /*!
+         * @brief Transmit a batch of instances of the same type.
+         *
+         * This behaves like transmitting each instance individually via
+         * Connection::transmit(const type::Struct&, std::optional<property_set_t>, bool),
+         * but constructs only a single DotsHeader for the entire batch and
+         * transmits all instances via the underlying channel at once.
+         *
+         * Note that all instances of the batch will share the same sent time.
+         *
+         * If batch frames were negotiated with the peer (see
+         * Connection::batchFrames()), the instances will be transmitted in a
+         * single frame.
+         *
+         * @param instances The instances to transmit. All instances must be
+         * of the same type.
+         *
+         * @param includedProperties The property set to include in the
+         * transmit. If no set is given, the valid property set of each
+         * instance will be used.
+         *
+         * @param remove Specifies whether the transmit is a remove.
+         */
+        void transmit(std::span<const type::Struct* const> instances, std::optional<property_set_t> includedProperties = std::nullopt, bool remove = false);
+
         /*!
          * @brief Transmit a specific header and instance.
          *
@@ -277,6 +356,46 @@ namespace dots
          */
         void transmit(const DotsHeader& header, const type::Struct& instance);
 
+        /*!
+         * @brief Transmit a specific header and a batch of instances of the
+         * same type.
+         *
+         * If batch frames were negotiated with the peer (see
+         * Connection::batchFrames()), the instances will be transmitted in a
+         * single frame. Otherwise, each instance will be transmitted
+         * individually with the given header.
+         *
+         * @param header The header to transmit. If the attributes of the
+         * header are invalid, the valid properties of each instance will be
+         * used.
+         *
+         * @param instances The instances to transmit. All instances must be
+         * of the same type.
+         */
+        void transmit(const DotsHeader& header, std::span<const type::Struct* const> instances);
+
+        /*!
+         * @brief Transmit a specific header and instance as part of a cache
+         * transfer.
+         *
+         * This behaves like Connection::transmit(const DotsHeader&, const
+         * type::Struct&), but additionally allows the underlying channel to
+         * reuse a previously serialized form of the instance as long as the
+         * given revision and the attributes of the header are unchanged.
+         *
+         * @param header The header to transmit. Must have the
+         * DotsHeader::fromCache property set.
+         *
+         * @param instance The (cached) instance to transmit. The address of
+         * the instance must remain stable for as long as it is cached.
+         *
+         * @param revision The revision of the instance. Must be unique for
+         * every change of any instance of the type (e.g. the container
+         * version of the clone), because the address of a removed instance
+         * might be reused for a different instance.
+         */
+        void transmitFromCache(const DotsHeader& header, const type::Struct& instance, uint64_t revision);
+
         /*!
          * @brief Transmit a specific transmission.
          *
@@ -311,6 +430,21 @@ namespace dots
          */
         void transmit(const type::StructDescriptor& descriptor);
 
+        /*!
+         * @brief Asynchronously wait until all previous transmissions have
+         * been flushed.
+         *
+         * The given handler will be invoked when all transmissions that were
+         * transmitted via the connection before this call have been handed
+         * over to the underlying transport (e.g. written to the socket). If
+         * the underlying channel does not buffer transmissions, the handler
+         * will be invoked synchronously.
+         *
+         * @param handler The handler to invoke when the transmissions have
+         * been flushed or the channel failed.
+         */
+        void asyncFlush(io::Channel::flush_handler_t handler);
+
         /*!
          * @brief Handle a specific error.
          *
@@ -332,6 +466,8 @@ namespace dots
         static constexpr serialization::TextOptions StringOptions = { serialization::TextOptions::MultiLine };
 
         bool handleReceive(io::Transmission transmission);
+        bool handleReceiveBatch(std::vector<io::Transmission> transmissions);
+        void stampHeader(io::Transmission& transmission) const;
         void handleClose(std::exception_ptr ePtr);
 
         void handleHello(const DotsMsgHello& hello);
@@ -360,9 +496,11 @@ namespace dots
         io::channel_ptr_t m_channel;
         std::optional<std::string> m_authSecret;
         std::optional<io::Nonce> m_nonce;
+        bool m_batchFrames;
 
         io::AuthManager* m_authManager;
         std::optional<receive_handler_t> m_receiveHandler;
+        std::optional<receive_batch_handler_t> m_receiveBatchHandler;
         std::optional<transition_handler_t> m_transitionHandler;
     };
 
@@ -2,6 +2,7 @@
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #pragma once
 #include <map>
+#include <deque>
 #include <functional>
 #include <dots/type/AnyStruct.h>
 #include <DotsHeader.dots.h>
@@ -64,6 +65,9 @@ namespace dots
         using const_iterator_t = container_t::const_iterator;
         using value_t = container_t::value_type;
         using node_t = container_t::node_type;
+        using tombstone_log_t = std::deque<value_t>;
+
+        static constexpr size_t DefaultTombstoneCapacity = 1024;
 
         /*!
          * @brief Construct a new Container object for a given DOTS struct
@@ -120,6 +124,23 @@ namespace dots
         const_iterator_t cend() const &;
         const_iterator_t cend() && = delete;
 
+        /*!
+         * @brief Get a constant iterator to the first clone that is ordered
+         * after a specific instance.
+         *
+         * @attention Non-key properties of the given instance are ignored and
+         * the instance itself does not have to be part of the Container.
+         *
+         * @param instance The key instance to search from (non-key properties
+         * are ignored).
+         *
+         * @return const_iterator_t A constant iterator to the first clone
+         * whose key is greater than the key of the given instance or
+         * Container::end() if there is no such clone.
+         */
+        const_iterator_t upperBound(const type::Struct& instance) const &;
+        const_iterator_t upperBound(const type::Struct& instance) && = delete;
+
         /*!
          * @brief Check whether the Container is empty (i.e. contains no
          * clones).
@@ -138,6 +159,75 @@ namespace dots
         size_t size() const &;
         size_t size() && = delete;
 
+        /*!
+         * @brief Get the epoch of the Container.
+         *
+         * The epoch is a random value that is chosen when the Container is
+         * constructed. Together with the version, it identifies a particular
+         * state of the Container, even across different processes.
+         *
+         * @return uint64_t The epoch of the Container.
+         */
+        uint64_t epoch() const &;
+        uint64_t epoch() && = delete;
+
+        /*!
+         * @brief Get the current version of the Container.
+         *
+         * The version is incremented for every effective insert or remove
+         * and is recorded in the DotsCloneInformation::version property of
+         * the affected clone.
+         *
+         * @return uint64_t The current version of the Container.
+         */
+        uint64_t version() const &;
+        uint64_t version() && = delete;
+
+        /*!
+         * @brief Get the tombstone log of the Container.
+         *
+         * The log contains the key properties and the final clone
+         * information of the most recently removed instances in the order in
+         * which they were removed. It is bounded by the capacity given in
+         * setTombstoneCapacity().
+         *
+         * @return const tombstone_log_t& A reference to the tombstone log.
+         */
+        const tombstone_log_t& tombstones() const &;
+        const tombstone_log_t& tombstones() && = delete;
+
+        /*!
+         * @brief Set the capacity of the tombstone log.
+         *
+         * When the log exceeds its capacity, the oldest tombstones are
+         * discarded. Afterwards, changes can no longer be determined for
+         * versions prior to the discarded tombstones (see canResync()).
+         *
+         * @param capacity The maximum number of tombstones to keep.
+         */
+        void setTombstoneCapacity(size_t capacity) &;
+        void setTombstoneCapacity(size_t capacity) && = delete;
+
+        /*!
+         * @brief Check whether all changes since a given version can be
+         * determined.
+         *
+         * This is the case if the epoch matches the epoch of the Container
+         * and no tombstones have been discarded since the given version. The
+         * changes then consist of all clones with a greater version and all
+         * tombstones with a greater version.
+         *
+         * @param epoch The epoch the version refers to.
+         *
+         * @param version The version to determine the changes since.
+         *
+         * @return true If all changes since the version can be determined.
+         * @return false If the version refers to a different epoch or the
+         * tombstone log was truncated since.
+         */
+        bool canResync(uint64_t epoch, uint64_t version) const &;
+        bool canResync(uint64_t epoch, uint64_t version) && = delete;
+
         /*!
          * @brief Try to find the clone of a specific instance.
          *
@@ -274,6 +364,29 @@ namespace dots
         const value_t& insert(const DotsHeader& header, const type::Struct& instance) &;
         const value_t& insert(const DotsHeader& header, const type::Struct& instance) && = delete;
 
+        /*!
+         * @brief Restore a clone with previously recorded clone information.
+         *
+         * This function inserts a given instance into the Container or
+         * replaces the existing clone entirely. In contrast to insert(), the
+         * clone information is taken as given, except for the
+         * DotsCloneInformation::version property, which is set to the new
+         * version of the Container.
+         *
+         * The function is intended for restoring containers from persistent
+         * storage. Restoring instances in the order of the Container (e.g.
+         * the order in which they were iterated when they were stored)
+         * requires only constant time per instance.
+         *
+         * @param instance The instance to restore.
+         *
+         * @param cloneInfo The clone information to restore.
+         *
+         * @return const value_t& A reference to the restored clone.
+         */
+        const value_t& restore(type::AnyStruct instance, DotsCloneInformation cloneInfo) &;
+        const value_t& restore(type::AnyStruct instance, DotsCloneInformation cloneInfo) && = delete;
+
         /*!
          * @brief Try to remove an instance from the Container and update clone
          * information.
@@ -290,6 +403,9 @@ namespace dots
          * If the remove is ineffective (i.e. no corresponding clone could be
          * found), an empty node will be returned.
          *
+         * The key properties of an effectively removed clone are recorded in
+         * the tombstone log.
+         *
          * @attention This function will always perform a remove even if the
          * remove flag in the \p header is set to false.
          *
@@ -308,6 +424,9 @@ namespace dots
          *
          * Calling this function will erase all clones, resulting in an empty
          * Container.
+         *
+         * Because the erased clones are not recorded as tombstones, the
+         * tombstone log is discarded as well.
          */
         void clear() &;
         void clear() && = delete;
@@ -430,7 +549,11 @@ namespace dots
 
         const type::StructDescriptor* m_descriptor;
         container_t m_instances;
-        type::partial_property_descriptor_container_t m_noKeyPropertyDescriptors;
+        uint64_t m_epoch;
+        uint64_t m_version;
+        uint64_t m_tombstoneFloor;
+        size_t m_tombstoneCapacity;
+        tombstone_log_t m_tombstones;
     };
 
     /*!
@@ -4,7 +4,10 @@
 #include <map>
 #include <unordered_map>
 #include <functional>
+#include <optional>
+#include <vector>
 #include <dots/type/AnyStruct.h>
+#include <dots/type/Chrono.h>
 #include <dots/Event.h>
 #include <dots/ContainerPool.h>
 #include <dots/io/Transmission.h>
@@ -38,6 +41,7 @@ namespace dots
         using transmission_handler_t = tools::Handler<void(const io::Transmission&)>;
         template <typename T = type::Struct>
         using event_handler_t = tools::Handler<void(const Event<T>&)>;
+        using replay_handler_t = tools::Handler<void()>;
 
         /*!
          * @brief Construct a new Dispatcher object.
@@ -133,7 +137,8 @@ namespace dots
          * transmission is dispatched. If the given type is a cached type and
          * the corresponding Container is not empty, the given handler will
          * also be invoked with create events for each contained instance
-         * before this function returns.
+         * before this function returns, unless the replay exceeds the limits
+         * set by Dispatcher::setReplayLimits().
          *
          * @return id_t The unique id of the handler. The id can be used to
          * remove the event handler by calling
@@ -219,6 +224,56 @@ namespace dots
          */
         void removeEventHandler(const type::StructDescriptor& descriptor, id_t id);
 
+        /*!
+         * @brief Limit the replay of cached instances to added event handlers.
+         *
+         * By default, Dispatcher::addEventHandler() invokes the added handler
+         * with create events for all cached instances of the type before it
+         * returns. When limits are set, only the first chunk of the replay is
+         * performed immediately and the remaining instances are replayed in
+         * subsequent chunks by calling Dispatcher::continueReplays().
+         *
+         * While a replay is pending, events of the type are only dispatched
+         * to the corresponding handler for instances that have already been
+         * replayed. Changes to all other instances are reflected by the
+         * remaining replay, so that the handler always observes the creation
+         * of an instance before any of its updates.
+         *
+         * @param maxInstances The maximum number of instances to replay in a
+         * single chunk. Must be greater than zero.
+         *
+         * @param maxDuration The maximum duration of a single chunk. Note that
+         * at least one instance is replayed per chunk.
+         *
+         * @param handler The handler to invoke when a replay is pending and
+         * Dispatcher::continueReplays() has to be called (e.g. by posting it
+         * to an event loop).
+         *
+         * @exception std::logic_error Thrown if @p maxInstances is zero.
+         */
+        void setReplayLimits(size_t maxInstances, type::Duration maxDuration, replay_handler_t handler);
+
+        /*!
+         * @brief Check whether any replay of cached instances is pending.
+         *
+         * @return true If at least one replay is pending.
+         * @return false If no replay is pending.
+         */
+        bool replaying() const;
+
+        /*!
+         * @brief Continue the pending replays of cached instances.
+         *
+         * This replays the next chunk of cached instances within the limits
+         * set by Dispatcher::setReplayLimits(). Pending replays are continued
+         * in the order in which the event handlers were added. If replays are
+         * still pending afterwards, the replay handler will be invoked again.
+         *
+         * Contrary to Dispatcher::addEventHandler(), exceptions thrown by
+         * event handlers are reported to the error handler.
+         */
+        void continueReplays();
+
         /*!
          * @brief Dispatch a transmission.
          *
@@ -338,6 +393,17 @@ namespace dots
         using event_handlers_t = std::map<id_t, event_handler_t<>, std::greater<>>;
         using event_handler_pool_t = std::unordered_map<const type::StructDescriptor*, event_handlers_t>;
 
+        struct replay_t
+        {
+            const type::StructDescriptor* descriptor;
+            Container<>::key_compare compare;
+            std::optional<type::AnyStruct> cursor;
+            uint32_t remaining;
+        };
+
+        using replay_map_t = std::map<id_t, replay_t>;
+        using replay_clock_t = std::chrono::steady_clock;
+
         template <typename HandlerPool>
         void removeHandler(HandlerPool& handlerPool, const type::StructDescriptor& descriptor, id_t id);
 
@@ -347,6 +413,10 @@ namespace dots
         template <typename Handlers, typename Dispatchable>
         void dispatchToHandlers(const type::StructDescriptor& descriptor, Handlers& handlers, const Dispatchable& dispatchable);
 
+        bool continueReplay(id_t id, size_t& budget, replay_clock_t::time_point deadline);
+        bool deferToReplay(id_t id, const Event<>& event);
+        replay_clock_t::time_point replayDeadline() const;
+
         std::optional<id_t> m_currentlyDispatchingId;
         std::vector<id_t> m_removeIds;
         ContainerPool m_containerPool;
@@ -354,6 +424,11 @@ namespace dots
         event_handler_pool_t m_eventHandlerPool;
         id_t m_nextId;
         error_handler_t m_errorHandler;
+        replay_map_t m_replays;
+        std::optional<replay_handler_t> m_replayHandler;
+        size_t m_replayMaxInstances;
+        replay_clock_t::duration m_replayMaxDuration;
+        bool m_replayScheduled = false;
         bool m_clearingHandlers = false;
     };
 }
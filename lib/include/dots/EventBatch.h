@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <vector>
+#include <dots/type/AnyStruct.h>
+#include <dots/Event.h>
+
+namespace dots
+{
+    template<typename = type::Struct>
+    struct EventBatch;
+
+    /*!
+     * @class EventBatch EventBatch.h <dots/EventBatch.h>
+     *
+     * @brief Contiguous sequence of DOTS events of a single type.
+     *
+     * An EventBatch is delivered to batch subscriptions (see
+     * Transceiver::subscribe(const type::StructDescriptor&, event_batch_handler_t<>, size_t, type::Duration))
+     * and contains the events that were collected since the previous
+     * batch, in the order they occurred.
+     *
+     * Contrary to a regular Event, a batch owns copies of the header and
+     * instances of its events. This is required, because the state of a
+     * cached instance in the local Container might have changed between
+     * the occurrence of an event and the delivery of the batch.
+     *
+     * The events can be accessed either by index or by iterating the batch:
+     *
+     * @code{.cpp}
+     * for (const dots::Event<Foobar>& event : batch)
+     * {
+     *     // ...
+     * }
+     * @endcode
+     *
+     * Note that the Event objects are created on access and only refer to
+     * data owned by the batch. They must therefore not outlive the batch.
+     */
+    template<>
+    struct EventBatch<type::Struct>
+    {
+        template <typename T>
+        struct iterator_t
+        {
+            using value_type = Event<T>;
+            using difference_type = std::ptrdiff_t;
+
+            Event<T> operator * () const
+            {
+                return static_cast<const EventBatch<T>&>(*m_batch)[m_index];
+            }
+
+            iterator_t& operator ++ ()
+            {
+                ++m_index;
+                return *this;
+            }
+
+            iterator_t operator ++ (int)
+            {
+                iterator_t it = *this;
+                ++m_index;
+                return it;
+            }
+
+            bool operator == (const iterator_t& rhs) const = default;
+
+        private:
+
+            friend struct EventBatch<type::Struct>;
+
+            iterator_t(const EventBatch<type::Struct>& batch, size_t index) :
+                m_batch(&batch),
+                m_index(index)
+            {
+                /* do nothing */
+            }
+
+            const EventBatch<type::Struct>* m_batch;
+            size_t m_index;
+        };
+
+        EventBatch(const type::StructDescriptor& descriptor);
+        EventBatch(const EventBatch& other) = default;
+        EventBatch(EventBatch&& other) = default;
+        ~EventBatch() = default;
+
+        EventBatch& operator = (const EventBatch& rhs) = default;
+        EventBatch& operator = (EventBatch&& rhs) = default;
+
+        /*!
+         * @brief Get the type of the events in the batch.
+         *
+         * @return const type::StructDescriptor& A reference to the type
+         * descriptor.
+         */
+        const type::StructDescriptor& descriptor() const;
+
+        /*!
+         * @brief Get the number of events in the batch.
+         *
+         * @return size_t The number of events.
+         */
+        size_t size() const;
+
+        /*!
+         * @brief Check whether the batch is empty.
+         *
+         * @return true If the batch does not contain any events.
+         * @return false Else.
+         */
+        bool empty() const;
+
+        /*!
+         * @brief Get a specific event of the batch.
+         *
+         * @param index The index of the event. Must be less than
+         * EventBatch::size().
+         *
+         * @return Event<> The event referring to the data of the batch.
+         */
+        Event<> operator [] (size_t index) const;
+
+        iterator_t<type::Struct> begin() const
+        {
+            return iterator_t<type::Struct>{ *this, 0 };
+        }
+
+        iterator_t<type::Struct> end() const
+        {
+            return iterator_t<type::Struct>{ *this, m_entries.size() };
+        }
+
+        /*!
+         * @brief Append a copy of an event to the batch.
+         *
+         * @param event The event to append. Must be of the type of the batch.
+         */
+        void append(const Event<>& event);
+
+        /*!
+         * @brief Remove all events from the batch.
+         */
+        void clear();
+
+    protected:
+
+        template <typename T>
+        iterator_t<T> makeIterator(size_t index) const
+        {
+            return iterator_t<T>{ *this, index };
+        }
+
+    private:
+
+        struct entry_t
+        {
+            DotsHeader header;
+            type::AnyStruct transmitted;
+            std::optional<type::AnyStruct> updated;
+            DotsCloneInformation cloneInfo;
+            DotsMt mt;
+        };
+
+        const type::StructDescriptor* m_descriptor;
+        std::vector<entry_t> m_entries;
+    };
+
+    template<typename T>
+    struct EventBatch : EventBatch<type::Struct>
+    {
+        static_assert(std::is_base_of_v<type::Struct, T>);
+
+        using EventBatch<type::Struct>::EventBatch;
+
+        Event<T> operator [] (size_t index) const
+        {
+            const Event<> event = EventBatch<type::Struct>::operator[](index);
+            return Event<T>{ event.header(), static_cast<const T&>(event.transmitted()), static_cast<const T&>(event.updated()), event.cloneInfo(), event.mt() };
+        }
+
+        iterator_t<T> begin() const
+        {
+            return makeIterator<T>(0);
+        }
+
+        iterator_t<T> end() const
+        {
+            return makeIterator<T>(size());
+        }
+    };
+}
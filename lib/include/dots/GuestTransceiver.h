@@ -4,9 +4,14 @@
 #include <string_view>
 #include <optional>
 #include <set>
+#include <map>
+#include <unordered_map>
 #include <dots/type/DescriptorMap.h>
 #include <dots/Transceiver.h>
 #include <dots/Connection.h>
+#include <dots/Timer.h>
+#include <dots/tools/LatencyHistogram.h>
+#include <DotsCacheInfo.dots.h>
 
 namespace dots
 {
@@ -255,17 +260,244 @@ namespace dots
          */
         void publish(const type::Struct& instance, std::optional<property_set_t> includedProperties = std::nullopt, bool remove = false) override;
 
+        /*!
+         * @brief Publish a batch of instances of a DOTS struct type.
+         *
+         * This behaves like publishing each instance individually via
+         * GuestTransceiver::publish(const type::Struct&, std::optional<property_set_t>, bool),
+         * but validates the type only once and transmits all instances with a
+         * shared header in a single write to the host connection.
+         *
+         * If batch frames were negotiated with the host (see
+         * Connection::batchFrames()), the instances are transmitted in a
+         * single frame, which the host routes as a unit to all guests that
+         * support batch frames as well.
+         *
+         * @param instances The instances to publish. All instances must be
+         * of the same type.
+         *
+         * @param includedProperties The properties to publish in addition to
+         * the key properties. If no set is given, the valid property set of
+         * each instance will be used.
+         *
+         * @param remove Specifies whether the publish is a remove.
+         *
+         * @exception std::logic_error Thrown if the instances are of a
+         * 'substruct-only' type or not all of the same type.
+         *
+         * @exception std::runtime_error Thrown if a key property of any
+         * instance is invalid.
+         *
+         * @exception std::runtime_error Thrown if no host connection has been
+         * established when the function is called.
+         */
+        void publish(std::span<const type::Struct* const> instances, std::optional<property_set_t> includedProperties = std::nullopt, bool remove = false) override;
+
+        using Transceiver::publish;
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+        /*!
+         * @brief Publish an instance of a DOTS struct type from a coroutine.
+         *
+         * This behaves like
+         * GuestTransceiver::publish(const type::Struct&, std::optional<property_set_t>, bool),
+         * except that the instance is copied and published when the returned
+         * awaitable is awaited. The awaiting coroutine is resumed when the
+         * transmission has been flushed to the host connection (e.g. written
+         * to the socket).
+         *
+         * @code{.cpp}
+         * co_await transceiver.asyncPublish(Foobar{ .foo = 42 });
+         * @endcode
+         *
+         * @param instance The instance to publish.
+         *
+         * @param includedProperties The properties to publish in addition to
+         * the key properties. If no set is given, the valid property set of
+         * @p instance will be used.
+         *
+         * @param remove Specifies whether the publish is a remove.
+         *
+         * @return asio::awaitable<void> The awaitable that resumes when the
+         * transmission has been flushed or throws if the publish failed.
+         */
+        asio::awaitable<void> asyncPublish(const type::Struct& instance, std::optional<property_set_t> includedProperties = std::nullopt, bool remove = false);
+
+        /*!
+         * @brief Await the synchronization of the local cache of a specific
+         * type.
+         *
+         * The awaiting coroutine is resumed when the host has completed the
+         * transfer of its cache for the given type (i.e. a DotsCacheInfo with
+         * the DotsCacheInfo::endTransmission flag was received). If the cache
+         * is already synchronized, the coroutine is resumed immediately.
+         *
+         * Note that this requires an active subscription to the type. The
+         * synchronization state is reset when the connection is closed or the
+         * transceiver leaves the group of the type. In both cases, pending
+         * awaiters are resumed with an exception.
+         *
+         * @param descriptor The type of the cache.
+         *
+         * @return asio::awaitable<void> The awaitable that resumes when the
+         * cache is synchronized.
+         *
+         * @exception std::logic_error Thrown if @p descriptor is not a cached
+         * type.
+         *
+         * @exception std::runtime_error Thrown if the connection is closed or
+         * the group of the type is left before the cache is synchronized.
+         */
+        asio::awaitable<void> cacheSynced(const type::StructDescriptor& descriptor);
+
+        /*!
+         * @brief Await the synchronization of the local cache of a specific
+         * type.
+         *
+         * This is the typed version of
+         * cacheSynced(const type::StructDescriptor&).
+         *
+         * @code{.cpp}
+         * dots::Subscription subscription = transceiver.subscribe<Foobar>(...);
+         * co_await transceiver.cacheSynced<Foobar>();
+         * @endcode
+         *
+         * @tparam T The type of the cache.
+         *
+         * @return asio::awaitable<void> The awaitable that resumes when the
+         * cache is synchronized.
+         */
+        template <typename T, std::enable_if_t<std::is_base_of_v<type::Struct, T>, int> = 0>
+        asio::awaitable<void> cacheSynced()
+        {
+            return cacheSynced(T::_Descriptor());
+        }
+#endif
+
+        /*!
+         * @brief Enable the built-in latency probe.
+         *
+         * When enabled, the transceiver periodically sends a DotsEcho request
+         * to the host and records the round-trip time of each reply. It also
+         * records the delay between the sent time of every received
+         * transmission and the time at which the host received it (i.e.
+         * DotsHeader::serverSentTime - DotsHeader::sentTime) per type.
+         *
+         * The measurements are accumulated in histograms for the duration of
+         * a reporting interval. At the end of each interval, the p50 and p99
+         * of the measurements are optionally published as DotsClientLatency
+         * and DotsTypeLatency instances and the histograms are cleared.
+         *
+         * Echo replies of the probe are consumed by the transceiver and are
+         * not dispatched to subscribers.
+         *
+         * @remark The host delay includes the clock offset between the
+         * publisher and the host and is only meaningful if their clocks are
+         * synchronized.
+         *
+         * @param probeInterval The interval at which to send echo requests.
+         *
+         * @param reportInterval The interval at which the histograms are
+         * reported and cleared.
+         *
+         * @param publishReports Specifies whether the reports are published.
+         */
+        void enableLatencyProbe(type::Duration probeInterval = std::chrono::seconds{ 1 }, type::Duration reportInterval = std::chrono::seconds{ 10 }, bool publishReports = true);
+
+        /*!
+         * @brief Disable the built-in latency probe.
+         *
+         * This stops all measurements and discards the current histograms.
+         */
+        void disableLatencyProbe();
+
+        /*!
+         * @brief Get the round-trip times measured in the current reporting
+         * interval.
+         *
+         * @return const tools::LatencyHistogram& A reference to the
+         * histogram of round-trip times.
+         */
+        const tools::LatencyHistogram& roundTripTimes() const;
+
+        /*!
+         * @brief Get the host delays measured per type in the current
+         * reporting interval.
+         *
+         * @return const std::unordered_map<const type::StructDescriptor*,
+         * tools::LatencyHistogram>& A reference to the histograms of host
+         * delays of all types received in the interval.
+         */
+        const std::unordered_map<const type::StructDescriptor*, tools::LatencyHistogram>& hostDelays() const;
+
     private:
 
         void joinGroup(std::string_view name) override;
+        void joinRestrictedGroup(const type::StructDescriptor& descriptor, Dispatcher::id_t id, SubscriptionFilter::clauses_t clauses, std::optional<property_set_t> projection) override;
+        void leaveRestrictedGroup(const type::StructDescriptor& descriptor, Dispatcher::id_t id) override;
         void leaveGroup(std::string_view name) override;
 
         bool handleTransmission(Connection& connection, io::Transmission transmission);
+        void handleLatencyProbeTimeout();
+        void handleLatencyReportTimeout();
         void handleTransitionImpl(Connection& connection, std::exception_ptr ePtr) noexcept override;
+        void rejoinGroups();
+        void transmitRestriction(const type::StructDescriptor& descriptor);
+        void handleCacheSynced(const std::string& name);
+        void completeCacheSyncHandlers(std::string_view name, std::exception_ptr ePtr);
+        void dispatchRemoves(const type::StructDescriptor& descriptor, std::vector<type::AnyStruct> instances);
+        void completeResync(const DotsCacheInfo& cacheInfo);
 
         std::unique_ptr<Connection> m_hostConnection;
         type::DescriptorMap m_preloadPublishTypes;
         type::DescriptorMap m_preloadSubscribeTypes;
         std::set<std::string> m_joinedGroups;
+
+        struct group_restriction_t
+        {
+            SubscriptionFilter::clauses_t clauses;
+            std::optional<property_set_t> projection;
+        };
+
+        struct restricted_group_t
+        {
+            std::map<Dispatcher::id_t, group_restriction_t> subscriptions;
+            std::optional<group_restriction_t> transmitted;
+        };
+
+        std::map<std::string, restricted_group_t, std::less<>> m_groupRestrictions;
+
+        struct cache_version_t
+        {
+            uint64_t epoch;
+            uint64_t version;
+        };
+
+        std::map<std::string, cache_version_t, std::less<>> m_cacheVersions;
+
+        struct resync_t
+        {
+            std::optional<uint64_t> epoch;
+            uint64_t version;
+        };
+
+        std::map<std::string, resync_t, std::less<>> m_resyncs;
+        std::set<std::string> m_rejoinGroups;
+        std::map<std::string, restricted_group_t, std::less<>> m_rejoinRestrictions;
+        std::set<std::string, std::less<>> m_syncedCaches;
+        std::multimap<std::string, tools::Handler<void(std::exception_ptr)>, std::less<>> m_cacheSyncHandlers;
+
+        static constexpr uint32_t LatencyProbeIdentifier = 0x4C415459;
+        static constexpr size_t LatencyProbeMaxPending = 64;
+
+        using steady_time_point_t = std::chrono::steady_clock::time_point;
+
+        std::optional<Timer> m_latencyProbeTimer;
+        std::optional<Timer> m_latencyReportTimer;
+        bool m_publishLatencyReports = false;
+        uint32_t m_latencyProbeSequenceNumber = 0;
+        std::map<uint32_t, steady_time_point_t> m_pendingLatencyProbes;
+        tools::LatencyHistogram m_roundTripTimes;
+        std::unordered_map<const type::StructDescriptor*, tools::LatencyHistogram> m_hostDelays;
     };
 }
@@ -1,17 +1,26 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #pragma once
+#include <deque>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include <dots/tools/Handler.h>
 #include <dots/Connection.h>
+#include <dots/Timer.h>
 #include <dots/Transceiver.h>
+#include <dots/SubscriptionFilter.h>
 #include <dots/io/Listener.h>
+#include <dots/io/CacheSnapshot.h>
 #include <dots/io/auth/AuthManager.h>
 #include <DotsClearCache.dots.h>
 #include <DotsDescriptorRequest.dots.h>
 #include <DotsMember.dots.h>
 #include <DotsEcho.dots.h>
+#include <DotsRpcReply.dots.h>
+#include <DotsRpcRequest.dots.h>
+#include <DotsSubscriptionFilter.dots.h>
 
 namespace dots
 {
@@ -38,6 +47,25 @@ namespace dots
      */
     struct HostTransceiver : Transceiver
     {
+        /*!
+         * @brief Traffic counters of a specific type.
+         *
+         * The counters cover all transmissions that are distributed by the
+         * host (i.e. publications of guests as well as of the host itself).
+         * Transmitted frames and bytes refer to the fan-out to the guests
+         * and are accumulated over all destination connections.
+         */
+        struct type_statistics_t
+        {
+            uint64_t publishedFrames = 0;
+            uint64_t transmittedFrames = 0;
+            uint64_t transmittedBytes = 0;
+
+            bool operator == (const type_statistics_t& rhs) const = default;
+        };
+
+        using type_statistics_map_t = std::unordered_map<const type::StructDescriptor*, type_statistics_t>;
+
         /*!
          * @brief Construct a new HostTransceiver object.
          *
@@ -147,6 +175,157 @@ namespace dots
          */
         void publish(const type::Struct& instance, std::optional<property_set_t> includedProperties = std::nullopt, bool remove = false) override;
 
+        /*!
+         * @brief Publish a batch of instances of a DOTS struct type.
+         *
+         * This behaves like publishing each instance individually via
+         * HostTransceiver::publish(const type::Struct&, std::optional<property_set_t>, bool),
+         * but routes the instances as a unit. Guests that negotiated batch
+         * frames (see Connection::batchFrames()) receive all instances that
+         * pass their filters in a single frame.
+         *
+         * Note that batches of internal types are published individually.
+         *
+         * @param instances The instances to publish. All instances must be
+         * of the same type.
+         *
+         * @param includedProperties The properties to publish in addition to
+         * the key properties. If no set is given, the valid property set of
+         * each instance will be used.
+         *
+         * @param remove Specifies whether the publish is a remove.
+         *
+         * @exception std::logic_error Thrown if the instances are not all of
+         * the same type or of a 'substruct-only' type.
+         *
+         * @exception std::runtime_error Thrown if a key property of an
+         * instance is invalid.
+         */
+        void publish(std::span<const type::Struct* const> instances, std::optional<property_set_t> includedProperties = std::nullopt, bool remove = false) override;
+        using Transceiver::publish;
+
+        /*!
+         * @brief Enable or disable the suppression of unchanged updates for a
+         * specific cached type.
+         *
+         * When enabled, every update of an existing instance that is received
+         * from a guest is compared with the cached clone before it is
+         * processed. The attributes of the update will then be narrowed to
+         * the properties that actually changed and the update will be dropped
+         * entirely if no property other than the key properties changed.
+         *
+         * This reduces the traffic caused by publishers that periodically
+         * republish identical states (e.g. as a "heartbeat").
+         *
+         * @remark Because dropped updates are not applied to the Container,
+         * they also do not affect the clone information of the respective
+         * instance (e.g. DotsCloneInformation::lastUpdateFrom).
+         *
+         * @remark Instances that are published by the host itself (i.e. via
+         * HostTransceiver::publish()) are never suppressed or narrowed.
+         *
+         * @param descriptor The descriptor of the type to enable or disable
+         * the suppression for.
+         *
+         * @param suppress Specifies whether unchanged updates should be
+         * suppressed.
+         *
+         * @exception std::logic_error Thrown if @p descriptor is not a cached
+         * type.
+         */
+        void suppressUnchangedUpdates(const type::StructDescriptor& descriptor, bool suppress = true);
+
+        /*!
+         * @brief Set the limits of incremental cache transfers.
+         *
+         * When a guest joins a cached group, the instances of the container
+         * are transferred in chunks. Each chunk is limited to the given
+         * maximum number of instances and the given maximum duration. If a
+         * transfer cannot be completed in a single chunk, the remainder is
+         * transferred in subsequent turns of the event loop, interleaved
+         * with the transfers to other guests and all other processing of
+         * the host.
+         *
+         * Live transmissions of the transferred type to the joining guest
+         * are deferred until its transfer has been completed, so that the
+         * guest observes the same order of events as with an immediate
+         * transfer.
+         *
+         * @param maxInstances The maximum number of instances to transfer in
+         * a single chunk. Must not be zero.
+         *
+         * @param maxDuration The maximum duration of a single chunk.
+         *
+         * @exception std::logic_error Thrown if @p maxInstances is zero.
+         */
+        void setCacheTransferLimits(size_t maxInstances, type::Duration maxDuration);
+
+        /*!
+         * @brief Enable the persistence of persistent types.
+         *
+         * This restores the containers of all types that are flagged as
+         * persistent from a snapshot (and optionally a journal) created by
+         * a previous host (see io::CacheSnapshot). Afterwards, snapshots can
+         * be written with writeCacheSnapshot() and, if journaling is
+         * enabled, every change of a persistent type is appended to the
+         * journal.
+         *
+         * The containers are restored directly and without dispatching any
+         * events. This function should therefore be called before the host
+         * starts to accept guests.
+         *
+         * @param path The path of the snapshot file.
+         *
+         * @param journal Specifies whether changes between snapshots are
+         * journaled.
+         *
+         * @return size_t The number of restored instances.
+         *
+         * @exception std::logic_error Thrown if persistence has already been
+         * enabled.
+         *
+         * @exception std::runtime_error Thrown if the snapshot could not be
+         * loaded.
+         */
+        size_t enableCachePersistence(std::filesystem::path path, bool journal = false);
+
+        /*!
+         * @brief Write a snapshot of all persistent types.
+         *
+         * @return size_t The number of written instances.
+         *
+         * @exception std::logic_error Thrown if persistence has not been
+         * enabled.
+         *
+         * @exception std::runtime_error Thrown if the snapshot could not be
+         * written.
+         */
+        size_t writeCacheSnapshot();
+
+        /*!
+         * @brief Get the currently managed guest connections.
+         *
+         * This can be used to inspect the state of all guests, for example
+         * to collect the traffic statistics of each Connection (see
+         * Connection::statistics()).
+         *
+         * Note that the returned pointers are only valid until control is
+         * returned to the event loop.
+         *
+         * @return std::vector<const Connection*> The guest connections,
+         * including connections that have already been closed but were not
+         * yet cleaned up.
+         */
+        std::vector<const Connection*> guestConnections() const;
+
+        /*!
+         * @brief Get the per-type traffic statistics of the host.
+         *
+         * @return type_statistics_map_t The traffic statistics of all types
+         * that have been distributed so far.
+         */
+        type_statistics_map_t typeStatistics() const;
+
         /*!
          * @brief Set the io::AuthManager instance to use for accepted
          * connections.
@@ -177,30 +356,95 @@ namespace dots
 
         using listener_map_t = std::unordered_map<io::Listener*, io::listener_ptr_t>;
         using connection_map_t = std::unordered_map<Connection*, connection_ptr_t>;
-        using group_t = std::unordered_set<Connection*>;
+        using peer_connection_map_t = std::unordered_map<Connection::id_t, Connection*>;
+        using filter_ptr_t = std::shared_ptr<const SubscriptionFilter>;
+        using filter_cache_t = std::unordered_map<std::string, std::weak_ptr<const SubscriptionFilter>>;
+        using filter_match_t = std::pair<const SubscriptionFilter*, bool>;
+        using filter_matches_t = std::vector<filter_match_t>;
+
+        struct cache_transfer_t
+        {
+            const type::StructDescriptor* descriptor;
+            std::vector<const Container<>::value_t*> instances;
+            std::vector<std::pair<const Container<>::value_t*, size_t>> index;
+            std::unordered_map<size_t, Container<>::value_t> retained;
+            std::optional<property_set_t> projection;
+            std::vector<std::pair<DotsHeader, type::AnyStruct>> deferred;
+            size_t next = 0;
+            uint64_t epoch = 0;
+            std::optional<uint64_t> version;
+            bool delta = false;
+        };
+
+        using cache_transfers_t = std::deque<cache_transfer_t>;
+        using cache_transfer_map_t = std::unordered_map<Connection*, cache_transfers_t>;
+
+        struct membership_t
+        {
+            filter_ptr_t filter;
+            std::optional<property_set_t> projection;
+            cache_transfer_t* transfer = nullptr;
+        };
+
+        using group_t = std::unordered_map<Connection*, membership_t>;
         using group_map_t = std::unordered_map<std::string, group_t>;
+        using type_group_map_t = std::vector<group_t*>;
+        using type_statistics_entry_t = std::pair<const type::StructDescriptor*, type_statistics_t>;
+        using type_statistics_vector_t = std::vector<type_statistics_entry_t>;
+        using rpc_call_map_t = std::unordered_map<Connection::id_t, std::set<uint64_t>>;
+        using batch_route_t = std::pair<connection_ptr_t, std::vector<const io::Transmission*>>;
+        using batch_route_map_t = std::unordered_map<Connection*, batch_route_t>;
+
+        static constexpr size_t MaxPendingRpcCalls = 4096;
 
         void joinGroup(std::string_view name) override;
         void leaveGroup(std::string_view name) override;
 
-        void transmit(const io::Transmission& transmission);
+        group_t& typeGroup(const type::StructDescriptor& descriptor);
+        type_statistics_t& typeStatistics(const type::StructDescriptor& descriptor);
+        filter_matches_t matchFilters(const io::Transmission& transmission);
+        void transmit(const io::Transmission& transmission, const filter_matches_t& previousMatches, batch_route_map_t* batchRoutes = nullptr);
+        void transmitBatch(std::vector<io::Transmission> transmissions);
 
         bool handleListenAccept(io::Listener& listener, io::channel_ptr_t channel);
         void handleListenError(io::Listener& listener, std::exception_ptr ePtr);
 
         bool handleTransmission(Connection& connection, io::Transmission transmission);
+        bool handleTransmissionBatch(Connection& connection, std::vector<io::Transmission> transmissions);
         void handleTransitionImpl(Connection& connection, std::exception_ptr ePtr) noexcept override;
+        bool narrowUpdate(io::Transmission& transmission) const;
 
         void handleMemberMessage(Connection& connection, const DotsMember& member);
         void handleDescriptorRequest(Connection& connection, const DotsDescriptorRequest& descriptorRequest);
         void handleClearCache(Connection& connection, const DotsClearCache& clearCache);
         void handleEchoRequest(Connection& connection, const DotsEcho& echoRequest);
+        void handleSubscriptionFilter(Connection& connection, const DotsSubscriptionFilter& subscriptionFilter);
+        void trackRpcCall(Connection::id_t callerId, const DotsRpcRequest& rpcRequest);
+        void routeRpcReply(Connection* replier, const io::Transmission& transmission, const DotsRpcReply& rpcReply);
 
-        void transmitContainer(Connection& connection, const Container<>& container);
+        filter_ptr_t acquireFilter(const type::StructDescriptor& descriptor, const SubscriptionFilter::clauses_t& clauses);
+        void transmitContainer(Connection& connection, const type::StructDescriptor& descriptor, const Container<>* container, const SubscriptionFilter* filter = nullptr, const SubscriptionFilter* previousFilter = nullptr, std::optional<property_set_t> projection = std::nullopt, std::optional<uint64_t> sinceVersion = std::nullopt);
+        bool transmitCacheTransferChunk(Connection& connection, cache_transfer_t& transfer);
+        void retainRemovedInstance(const io::Transmission& transmission);
+        void stampCacheVersion(io::Transmission& transmission);
+        void journalChange(const io::Transmission& transmission);
+        void handleCacheTransferTimeout();
 
         listener_map_t m_listeners;
         connection_map_t m_guestConnections;
+        peer_connection_map_t m_peerConnections;
         group_map_t m_groups;
+        type_group_map_t m_typeGroups;
+        filter_cache_t m_filters;
+        std::unordered_set<const type::StructDescriptor*> m_suppressedTypes;
+        type_statistics_vector_t m_typeStatistics;
+        rpc_call_map_t m_rpcCalls;
+        cache_transfer_map_t m_cacheTransfers;
+        std::deque<Connection*> m_cacheTransferQueue;
+        std::optional<Timer> m_cacheTransferTimer;
+        size_t m_cacheTransferMaxInstances;
+        type::Duration m_cacheTransferMaxDuration;
+        std::unique_ptr<io::CacheSnapshot> m_cacheSnapshot;
         std::unique_ptr<io::AuthManager> m_authManager;
     };
 }
@@ -0,0 +1,245 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <dots/type/Struct.h>
+#include <dots/serialization/StringSerializer.h>
+#include <DotsHeader.dots.h>
+#include <DotsSubscriptionFilter.dots.h>
+
+namespace dots
+{
+    /*!
+     * @class SubscriptionFilter SubscriptionFilter.h <dots/SubscriptionFilter.h>
+     *
+     * @brief Compiled content-based filter for instances of a specific
+     * struct type.
+     *
+     * A SubscriptionFilter is compiled from the clauses of a
+     * DotsSubscriptionFilter for a specific struct type. An instance
+     * matches the filter if all predicates of at least one of the clauses
+     * hold.
+     *
+     * When the filter is constructed, the property paths of all predicates
+     * are resolved to the offsets of the respective property areas and the
+     * constant values are deserialized into the property value types.
+     * Evaluating the filter therefore only requires pointer arithmetic and
+     * the comparison of the values themselves.
+     *
+     * A predicate never holds if the compared property (or any of its
+     * parent properties) is invalid.
+     *
+     * @remark Only properties of non-struct and non-vector types can be
+     * compared.
+     */
+    struct SubscriptionFilter
+    {
+        using clauses_t = vector_t<DotsFilterClause>;
+
+        /*!
+         * @brief Compile a filter for a specific struct type.
+         *
+         * @param descriptor The descriptor of the struct type to filter.
+         *
+         * @param clauses The clauses of the filter. Must not be empty.
+         *
+         * @exception std::runtime_error Thrown if any of the predicates is
+         * invalid (e.g. if it refers to an unknown property or if the value
+         * can not be deserialized into the property type).
+         */
+        SubscriptionFilter(const type::StructDescriptor& descriptor, const clauses_t& clauses);
+        SubscriptionFilter(const SubscriptionFilter& other) = delete;
+        SubscriptionFilter(SubscriptionFilter&& other) = default;
+        ~SubscriptionFilter() = default;
+
+        SubscriptionFilter& operator = (const SubscriptionFilter& rhs) = delete;
+        SubscriptionFilter& operator = (SubscriptionFilter&& rhs) = default;
+
+        /*!
+         * @brief Get the descriptor of the struct type the filter was
+         * compiled for.
+         *
+         * @return const type::StructDescriptor& A reference to the struct
+         * descriptor.
+         */
+        const type::StructDescriptor& descriptor() const;
+
+        /*!
+         * @brief Get the canonical expression of the filter.
+         *
+         * Filters that were compiled from identical clauses have identical
+         * expressions (see SubscriptionFilter::Expression()).
+         *
+         * @return const std::string& A reference to the expression.
+         */
+        const std::string& expression() const;
+
+        /*!
+         * @brief Get the top-level properties referenced by the filter.
+         *
+         * @return property_set_t The set of top-level properties that are
+         * the root of at least one predicate path.
+         */
+        property_set_t properties() const;
+
+        /*!
+         * @brief Check whether a given instance matches the filter.
+         *
+         * @param instance The instance to check. Must be of the struct type
+         * the filter was compiled for.
+         *
+         * @return true If at least one of the clauses holds for the
+         * instance.
+         * @return false Else.
+         */
+        bool matches(const type::Struct& instance) const;
+
+        /*!
+         * @brief The scope of an instance relative to the filter after a
+         * transmission was applied.
+         */
+        enum struct Scope : uint8_t
+        {
+            Outside, ///< The instance neither matches now nor did before.
+            Inside, ///< The instance matches and did so before.
+            Entered, ///< The instance matches, but did not before.
+            Left ///< The instance matched before, but no longer does (or was removed).
+        };
+
+        /*!
+         * @brief Check whether a transmission might change whether an
+         * instance matches the filter.
+         *
+         * This is the case if the instance is of a cached type and the
+         * transmission either removes it or updates any of the properties
+         * referenced by the filter. Instances of uncached types are always
+         * evaluated on their own.
+         *
+         * @param header The header of the transmission.
+         *
+         * @return true If the transmission might move the instance into or
+         * out of the scope of the filter.
+         * @return false Else.
+         */
+        bool affects(const DotsHeader& header) const;
+
+        /*!
+         * @brief Determine the scope of an instance after a transmission was
+         * applied.
+         *
+         * @param header The header of the transmission.
+         *
+         * @param matchedPreviously Whether the state of the instance before
+         * the transmission was applied matched the filter (must be false if
+         * the instance did not exist). Only relevant if the transmission
+         * affects the filter (see SubscriptionFilter::affects()).
+         *
+         * @param instance The complete state of the instance after the
+         * transmission was applied (e.g. the cached clone).
+         *
+         * @return Scope The scope of the instance.
+         */
+        Scope scope(const DotsHeader& header, bool matchedPreviously, const type::Struct& instance) const;
+
+        /*!
+         * @brief Check whether a transmission has to be forwarded to a
+         * subscriber of the filter.
+         *
+         * This is the case if the instance is in the scope of the filter
+         * after the transmission was applied, or if it entered or left the
+         * scope because of it (see SubscriptionFilter::scope()). Removals
+         * are only forwarded if the removed instance matched the filter.
+         *
+         * @param header The header of the transmission.
+         *
+         * @param matchedPreviously Whether the state of the instance before
+         * the transmission was applied matched the filter.
+         *
+         * @param instance The complete state of the instance after the
+         * transmission was applied (e.g. the cached clone).
+         *
+         * @return true If the transmission has to be forwarded.
+         * @return false Else.
+         */
+        bool passes(const DotsHeader& header, bool matchedPreviously, const type::Struct& instance) const;
+
+        /*!
+         * @brief Create the canonical expression of specific clauses.
+         *
+         * @param clauses The clauses to create the expression for.
+         *
+         * @return std::string The canonical expression.
+         */
+        static std::string Expression(const clauses_t& clauses);
+
+    private:
+
+        struct Value
+        {
+            Value(const type::Descriptor<>& descriptor, const std::string& value);
+            Value(const Value& other) = delete;
+            Value(Value&& other) = delete;
+            ~Value();
+
+            Value& operator = (const Value& rhs) = delete;
+            Value& operator = (Value&& rhs) = delete;
+
+            const type::Typeless& get() const;
+
+        private:
+
+            const type::Descriptor<>* m_descriptor;
+            void* m_storage;
+        };
+
+        struct Step
+        {
+            property_set_t property;
+            size_t offset;
+        };
+
+        struct Predicate
+        {
+            std::vector<Step> steps;
+            const type::Descriptor<>* valueDescriptor;
+            DotsFilterOperator operation;
+            std::unique_ptr<Value> value;
+        };
+
+        using clause_t = std::vector<Predicate>;
+
+        bool holds(const type::PropertyArea& area, const Predicate& predicate) const;
+
+        const type::StructDescriptor* m_descriptor;
+        std::string m_expression;
+        property_set_t m_properties;
+        std::vector<clause_t> m_clauses;
+    };
+
+    /*!
+     * @brief Create a predicate for a filtered subscription.
+     *
+     * @tparam T The type of the value to compare the property with.
+     *
+     * @param path The tags of the properties that lead to the compared
+     * property, starting at the root type.
+     *
+     * @param operation The comparison to perform.
+     *
+     * @param value The value to compare the property with. Must have the
+     * same type as the compared property.
+     *
+     * @return DotsFilterPredicate The created predicate.
+     */
+    template <typename T>
+    DotsFilterPredicate make_filter_predicate(vector_t<uint32_t> path, DotsFilterOperator operation, const T& value)
+    {
+        return DotsFilterPredicate{
+            .path = std::move(path),
+            .operation = operation,
+            .value = to_string(value)
+        };
+    }
+}
@@ -2,6 +2,8 @@
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #pragma once
 #include <memory>
+#include <utility>
+#include <boost/asio/awaitable.hpp>
 #include <dots/tools/Handler.h>
 #include <dots/type/Chrono.h>
 #include <dots/asio_forward.h>
@@ -91,4 +93,23 @@ namespace dots
 
         std::shared_ptr<timer_data> m_timerData;
     };
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+    /*!
+     * @brief Suspend the awaiting coroutine for a specific duration.
+     *
+     * The coroutine will be resumed by the executor (i.e. IO context) it
+     * is running on after the given amount of time has passed.
+     *
+     * @code{.cpp}
+     * co_await dots::sleep(std::chrono::milliseconds{ 10 });
+     * @endcode
+     *
+     * @param duration The duration to sleep.
+     *
+     * @return asio::awaitable<void> The awaitable that resumes after the
+     * duration has passed.
+     */
+    asio::awaitable<void> sleep(type::Duration duration);
+#endif
 }
@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <boost/asio/steady_timer.hpp>
+#include <dots/tools/Handler.h>
+#include <dots/type/Chrono.h>
+#include <dots/asio_forward.h>
+
+namespace dots
+{
+    /*!
+     * @class TimerWheel TimerWheel.h <dots/TimerWheel.h>
+     *
+     * @brief Hierarchical timer wheel for large numbers of timers.
+     *
+     * A timer wheel manages an arbitrary number of timers with a fixed
+     * resolution, which are all driven by a single steady timer that ticks
+     * once per resolution while at least one timer is active.
+     *
+     * Contrary to dots::Timer, arming, cancelling and rescheduling a timer
+     * are O(1) operations that do not allocate memory once the internal
+     * timer pool has grown to its peak size. This makes the wheel suitable
+     * for use cases with a high number of timers that are frequently
+     * rescheduled (e.g. per-key staleness detection).
+     *
+     * Timers are represented by TimerWheel::Handle objects, which are
+     * RAII-style resources similar to dots::Timer:
+     *
+     * @code{.cpp}
+     * dots::TimerWheel wheel{ ioContext, std::chrono::milliseconds{ 10 } };
+     * dots::TimerWheel::Handle handle = wheel.add(std::chrono::seconds{ 5 }, []
+     * {
+     *     // ...
+     * });
+     *
+     * // postpone the timeout
+     * handle.reschedule(std::chrono::seconds{ 5 });
+     * @endcode
+     *
+     * The timeouts are rounded up to the next multiple of the resolution.
+     * Timers that run out within the same tick are invoked in no particular
+     * order.
+     *
+     * @remark The wheel consists of four levels of 256 slots each and
+     * therefore covers timeouts of up to 2^32 ticks without cascading
+     * overhead. Longer timeouts are supported, but will be cascaded
+     * repeatedly.
+     *
+     * @warning A TimerWheel must outlive all of its handles.
+     */
+    struct TimerWheel
+    {
+        using handler_t = tools::Handler<void()>;
+
+        /*!
+         * @class Handle TimerWheel.h <dots/TimerWheel.h>
+         *
+         * @brief Scoped resource for timers of a TimerWheel.
+         *
+         * A handle refers to a single timer of a wheel. The timer is
+         * cancelled when the handle is destroyed.
+         *
+         * Note that a handle remains valid after its timer ran out and can
+         * be used to rearm the timer via Handle::reschedule().
+         */
+        struct [[nodiscard]] Handle
+        {
+            Handle(const Handle& other) = delete;
+            Handle(Handle&& other) noexcept;
+            ~Handle();
+
+            Handle& operator = (const Handle& rhs) = delete;
+            Handle& operator = (Handle&& rhs) noexcept;
+
+            /*!
+             * @brief Indicates whether the timer is armed (i.e. did not yet
+             * run out and was not cancelled).
+             *
+             * @return true If the timer is armed.
+             * @return false Else.
+             */
+            bool active() const;
+
+            /*!
+             * @brief Rearm the timer with a specific timeout.
+             *
+             * If the timer is currently armed, the previous timeout will be
+             * replaced.
+             *
+             * @param timeout The duration after which the handler will be
+             * invoked.
+             *
+             * @exception std::logic_error Thrown if the handle is empty.
+             */
+            void reschedule(type::Duration timeout);
+
+            /*!
+             * @brief Cancel the timer without invoking the handler.
+             *
+             * Note that this will have no effect if the timer is not armed.
+             */
+            void cancel();
+
+            /*!
+             * @brief Release management of the timer.
+             *
+             * Calling this function will decouple the timer from the
+             * handle's lifetime, without invoking the handler. As a result,
+             * this handle will be empty when the function returns.
+             *
+             * If the timer is not armed, it will be removed immediately.
+             */
+            void discard();
+
+        private:
+
+            friend struct TimerWheel;
+
+            Handle(TimerWheel& wheel, uint32_t index);
+
+            TimerWheel* m_wheel;
+            uint32_t m_index;
+        };
+
+        /*!
+         * @brief Construct a new TimerWheel object.
+         *
+         * @param ioContext The IO context (i.e. event loop) to associate with
+         * the wheel.
+         *
+         * @param resolution The duration of a tick. All timeouts are rounded
+         * up to a multiple of this duration.
+         *
+         * @exception std::logic_error Thrown if @p resolution is not
+         * positive.
+         */
+        TimerWheel(asio::io_context& ioContext, type::Duration resolution = type::Duration{ 0.001 });
+        TimerWheel(const TimerWheel& other) = delete;
+        TimerWheel(TimerWheel&& other) = delete;
+        ~TimerWheel();
+
+        TimerWheel& operator = (const TimerWheel& rhs) = delete;
+        TimerWheel& operator = (TimerWheel&& rhs) = delete;
+
+        /*!
+         * @brief Get the resolution of the wheel.
+         *
+         * @return type::Duration The duration of a tick.
+         */
+        type::Duration resolution() const;
+
+        /*!
+         * @brief Get the number of armed timers.
+         *
+         * @return size_t The number of timers that did not yet run out.
+         */
+        size_t size() const;
+
+        /*!
+         * @brief Add a timer to the wheel.
+         *
+         * @param timeout The duration after which the handler will be
+         * invoked.
+         *
+         * @param handler The handler to invoke asynchronously after the
+         * timer runs out.
+         *
+         * @return Handle The handle that manages the timer.
+         */
+        Handle add(type::Duration timeout, handler_t handler);
+
+    private:
+
+        using clock_t = std::chrono::steady_clock;
+        using duration_t = clock_t::duration;
+
+        static constexpr uint32_t LevelBits = 8;
+        static constexpr uint32_t Levels = 4;
+        static constexpr uint32_t SlotsPerLevel = 1u << LevelBits;
+        static constexpr uint32_t SlotMask = SlotsPerLevel - 1;
+        static constexpr uint32_t PendingSlot = Levels * SlotsPerLevel;
+        static constexpr uint32_t NoSlot = PendingSlot + 1;
+        static constexpr uint32_t NoNode = UINT32_MAX;
+
+        struct node_t
+        {
+            std::optional<handler_t> handler;
+            uint64_t expiry;
+            uint32_t generation;
+            uint32_t slot;
+            uint32_t prev;
+            uint32_t next;
+            bool discarded;
+        };
+
+        uint32_t acquire(handler_t handler);
+        void release(uint32_t index);
+        void arm(uint32_t index, type::Duration timeout);
+        void disarm(uint32_t index);
+        void insert(uint32_t index);
+        void link(uint32_t index, uint32_t slot);
+        void unlink(uint32_t index);
+        void cascade(uint32_t slot);
+        void fire(uint32_t slot);
+        void advance();
+        uint64_t currentTick() const;
+        void asyncTick();
+        void handleTick();
+
+        std::shared_ptr<TimerWheel*> m_this;
+        asio::steady_timer m_timer;
+        duration_t m_resolution;
+        clock_t::time_point m_start;
+        uint64_t m_tick;
+        bool m_ticking;
+        size_t m_armed;
+        std::vector<node_t> m_nodes;
+        std::vector<uint32_t> m_freeNodes;
+        std::vector<uint32_t> m_slots;
+    };
+}
@@ -4,11 +4,21 @@
 #include <string_view>
 #include <optional>
 #include <functional>
+#include <span>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <boost/asio/awaitable.hpp>
 #include <dots/asio_forward.h>
 #include <dots/Connection.h>
 #include <dots/Dispatcher.h>
+#include <dots/EventBatch.h>
 #include <dots/Subscription.h>
+#include <dots/SubscriptionFilter.h>
 #include <dots/type/Registry.h>
+#include <dots/type/Chrono.h>
+#include <DotsRpcReply.dots.h>
 
 namespace dots
 {
@@ -32,6 +42,14 @@ namespace dots
         using transmission_handler_t = Dispatcher::transmission_handler_t;
         template <typename T = type::Struct>
         using event_handler_t = Dispatcher::event_handler_t<T>;
+        template <typename T = type::Struct>
+        using event_batch_handler_t = tools::Handler<void(const EventBatch<T>&)>;
+        template <typename T = type::Struct>
+        using event_predicate_t = tools::Handler<bool(const Event<T>&)>;
+        template <typename T = type::Struct>
+        using rpc_reply_handler_t = tools::Handler<void(std::exception_ptr, const T*)>;
+        template <typename TRequest = type::Struct, typename TReply = type::AnyStruct>
+        using rpc_handler_t = tools::Handler<TReply(const TRequest&)>;
 
         template <typename TDescriptor = type::Descriptor<>>
         using new_type_handler_t = tools::Handler<void(const TDescriptor&)>;
@@ -128,6 +146,30 @@ namespace dots
          */
         const Container<>& container(const type::StructDescriptor& descriptor) const;
 
+        /*!
+         * @brief Replay cached instances to new event subscriptions
+         * incrementally.
+         *
+         * By default, event subscriptions to cached types are invoked with
+         * create events for all contained instances before
+         * Transceiver::subscribe() returns. After calling this function, only
+         * the first chunk of instances is replayed synchronously and the
+         * remaining instances are replayed in chunks that are posted to the
+         * IO context, so that large containers do not block the event loop.
+         *
+         * Ordering with live events is preserved per instance: a handler
+         * will always observe the creation of an instance before any of its
+         * updates.
+         *
+         * @param maxInstances The maximum number of instances to replay per
+         * chunk. Must be greater than zero.
+         *
+         * @param maxDuration The maximum duration of a single chunk.
+         *
+         * @exception std::logic_error Thrown if @p maxInstances is zero.
+         */
+        void setCacheReplayLimits(size_t maxInstances, type::Duration maxDuration);
+
         /*!
          * @brief Subscribe to transmissions of a specific type.
          *
@@ -244,6 +286,333 @@ namespace dots
             }
         }
 
+        /*!
+         * @brief Subscribe to events of a specific type with a content-based
+         * filter.
+         *
+         * This is similar to subscribe(event_handler_t<T>), but only events
+         * that pass the given filter will be dispatched to the handler (see
+         * SubscriptionFilter::passes()). When connected to a host, the filter
+         * is also evaluated by the host, which will then only transmit
+         * instances that match the filter as long as the type is not
+         * subscribed to without a filter. When the subscription ends, the
+         * host filter is narrowed to the remaining filtered subscriptions of
+         * the type.
+         *
+         * @code{.cpp}
+         * // subscribing to all Foobar instances with a 'value' (tag 2) greater than 42
+         * transceiver.subscribe<Foobar>({ DotsFilterClause{
+         *     .predicates = { dots::make_filter_predicate({ 2 }, DotsFilterOperator::greater, dots::int32_t{ 42 }) }
+         * } }, [](const dots::Event<Foobar>& event)
+         * {
+         *     // ...
+         * });
+         * @endcode
+         *
+         * @remark For cached types, the event of an update that moves an
+         * instance out of the scope of the filter is still dispatched, even
+         * though the updated instance no longer matches the filter. This
+         * allows the handler to observe instances leaving the scope of the
+         * filter. If the host evaluates the filter, it transmits such updates
+         * as removes instead.
+         *
+         * @tparam T The type to subscribe to.
+         *
+         * @param filter The clauses of the filter. An event passes the filter
+         * if all predicates of at least one clause hold.
+         *
+         * @param handler The handler to invoke asynchronously every time a
+         * corresponding DOTS event passes the filter.
+         *
+         * @return Subscription The Subscription object that manages the state
+         * of the subscription.
+         *
+         * @exception std::runtime_error Thrown if the filter is invalid for
+         * the given type.
+         */
+        template<typename T, std::enable_if_t<std::is_base_of_v<type::Struct, T>, int> = 0>
+        Subscription subscribe(SubscriptionFilter::clauses_t filter, event_handler_t<T> handler)
+        {
+            constexpr bool NotSubStructOnly = !T::_SubstructOnly;
+            static_assert(NotSubStructOnly, "it is not allowed to subscribe to a struct that is marked with 'sub-struct only'!");
+
+            if constexpr (NotSubStructOnly)
+            {
+                // note: the scope of cached instances is tracked by the
+                // addresses of their clones, because the previous state of an
+                // updated clone is no longer available when the event is
+                // dispatched
+                auto localFilter = std::make_shared<const SubscriptionFilter>(T::_Descriptor(), filter);
+                auto matchedClones = std::make_shared<std::unordered_set<const type::Struct*>>();
+                Dispatcher::id_t id = m_dispatcher.addEventHandler(event_handler_t<T>{ [localFilter{ std::move(localFilter) }, matchedClones{ std::move(matchedClones) }, handler{ std::move(handler) }](const Event<T>& event)
+                {
+                    const type::Struct& updated = event.updated();
+                    SubscriptionFilter::Scope scope = localFilter->scope(event.header(), matchedClones->count(&updated) != 0, updated);
+
+                    if (scope == SubscriptionFilter::Scope::Outside)
+                    {
+                        return;
+                    }
+
+                    if (T::_Descriptor().cached())
+                    {
+                        if (scope == SubscriptionFilter::Scope::Entered)
+                        {
+                            matchedClones->emplace(&updated);
+                        }
+                        else if (scope == SubscriptionFilter::Scope::Left)
+                        {
+                            matchedClones->erase(&updated);
+                        }
+                    }
+
+                    handler(event);
+                } });
+
+                try
+                {
+                    joinRestrictedGroup(T::_Descriptor(), id, std::move(filter), std::nullopt);
+                }
+                catch (...)
+                {
+                    m_dispatcher.removeEventHandler(T::_Descriptor(), id);
+                    throw;
+                }
+
+                return makeSubscription([&, id]
+                {
+                    m_dispatcher.removeEventHandler(T::_Descriptor(), id);
+                    leaveRestrictedGroup(T::_Descriptor(), id);
+                });
+            }
+            else
+            {
+                return std::declval<Subscription>();
+            }
+        }
+
+        /*!
+         * @brief Subscribe to events of a specific type with a property
+         * projection.
+         *
+         * This is similar to subscribe(event_handler_t<T>), but the handler
+         * is only interested in a subset of the properties of the type. When
+         * connected to a host, the projection is also applied by the host,
+         * which will then only transmit the projected properties and will
+         * skip updates that do not affect any of them as long as the type is
+         * not subscribed to without a projection. When the subscription ends,
+         * the host projection is narrowed to the remaining projected
+         * subscriptions of the type.
+         *
+         * Key properties are always part of the projection.
+         *
+         * @code{.cpp}
+         * // subscribing to Foobar instances, but only to their 'value' property
+         * transceiver.subscribe<Foobar>(Foobar::value_p, [](const dots::Event<Foobar>& event)
+         * {
+         *     // ...
+         * });
+         * @endcode
+         *
+         * @remark Because the projection is shared with other subscriptions
+         * of the type, the handler might still observe properties outside of
+         * the projection. However, update events that do not affect any
+         * projected non-key property will not be dispatched to the handler.
+         *
+         * @tparam T The type to subscribe to.
+         *
+         * @param projection The properties the handler is interested in.
+         *
+         * @param handler The handler to invoke asynchronously every time a
+         * corresponding DOTS event affects the projected properties.
+         *
+         * @return Subscription The Subscription object that manages the state
+         * of the subscription.
+         */
+        template<typename T, std::enable_if_t<std::is_base_of_v<type::Struct, T>, int> = 0>
+        Subscription subscribe(property_set_t projection, event_handler_t<T> handler)
+        {
+            constexpr bool NotSubStructOnly = !T::_SubstructOnly;
+            static_assert(NotSubStructOnly, "it is not allowed to subscribe to a struct that is marked with 'sub-struct only'!");
+
+            if constexpr (NotSubStructOnly)
+            {
+                Dispatcher::id_t id = m_dispatcher.addEventHandler(event_handler_t<T>{ [projection = projection - T::_Descriptor().keyProperties(), handler{ std::move(handler) }](const Event<T>& event)
+                {
+                    if (!event.isUpdate() || !(*event.header().attributes ^ projection).empty())
+                    {
+                        handler(event);
+                    }
+                } });
+
+                try
+                {
+                    joinRestrictedGroup(T::_Descriptor(), id, SubscriptionFilter::clauses_t{}, projection);
+                }
+                catch (...)
+                {
+                    m_dispatcher.removeEventHandler(T::_Descriptor(), id);
+                    throw;
+                }
+
+                return makeSubscription([&, id]
+                {
+                    m_dispatcher.removeEventHandler(T::_Descriptor(), id);
+                    leaveRestrictedGroup(T::_Descriptor(), id);
+                });
+            }
+            else
+            {
+                return std::declval<Subscription>();
+            }
+        }
+
+        /*!
+         * @brief Subscribe to batches of events of a specific type.
+         *
+         * This is similar to subscribe(const type::StructDescriptor&, event_handler_t<>),
+         * but instead of invoking the handler once per event, the events are
+         * collected and delivered to the handler as an EventBatch.
+         *
+         * A batch is delivered as soon as it contains @p maxBatch events or
+         * when @p maxDelay has passed since the first event of the batch
+         * occurred, whichever comes first. With a maximum delay of zero, a
+         * batch contains the events that were dispatched within the same
+         * iteration of the event loop (e.g. all transmissions received in a
+         * single read from the host connection).
+         *
+         * Note that batches are always delivered asynchronously, including
+         * the create events of the instances that are already contained in
+         * the local Container when subscribing to a cached type. Events that
+         * were collected but not yet delivered when the subscription ends
+         * are discarded.
+         *
+         * @param descriptor The type to subscribe to.
+         *
+         * @param handler The handler to invoke asynchronously with every
+         * batch of events.
+         *
+         * @param maxBatch The maximum number of events in a batch. Must not
+         * be zero.
+         *
+         * @param maxDelay The maximum time to delay the delivery of an event.
+         *
+         * @return Subscription The Subscription object that manages the state
+         * of the subscription.
+         *
+         * @exception std::logic_error Thrown if @p descriptor is a sub-struct
+         * only type or if @p maxBatch is zero.
+         */
+        Subscription subscribe(const type::StructDescriptor& descriptor, event_batch_handler_t<> handler, size_t maxBatch, type::Duration maxDelay = type::Duration{ 0 });
+
+        /*!
+         * @brief Subscribe to batches of events of a specific type.
+         *
+         * This is the typed version of
+         * subscribe(const type::StructDescriptor&, event_batch_handler_t<>, size_t, type::Duration).
+         *
+         * @code{.cpp}
+         * // subscribing to batches of at most 1000 Foobar events delayed by at most 10ms
+         * transceiver.subscribe<Foobar>([](const dots::EventBatch<Foobar>& batch)
+         * {
+         *     for (const dots::Event<Foobar>& event : batch)
+         *     {
+         *         // ...
+         *     }
+         * }, 1000, std::chrono::milliseconds{ 10 });
+         * @endcode
+         *
+         * @tparam T The type to subscribe to.
+         *
+         * @param handler The handler to invoke asynchronously with every
+         * batch of events.
+         *
+         * @param maxBatch The maximum number of events in a batch. Must not
+         * be zero.
+         *
+         * @param maxDelay The maximum time to delay the delivery of an event.
+         *
+         * @return Subscription The Subscription object that manages the state
+         * of the subscription.
+         */
+        template<typename T, std::enable_if_t<std::is_base_of_v<type::Struct, T>, int> = 0>
+        Subscription subscribe(event_batch_handler_t<T> handler, size_t maxBatch, type::Duration maxDelay = type::Duration{ 0 })
+        {
+            constexpr bool NotSubStructOnly = !T::_SubstructOnly;
+            static_assert(NotSubStructOnly, "it is not allowed to subscribe to a struct that is marked with 'sub-struct only'!");
+
+            if constexpr (NotSubStructOnly)
+            {
+                return subscribe(T::_Descriptor(), event_batch_handler_t<>{ tools::static_argument_cast, std::move(handler) }, maxBatch, maxDelay);
+            }
+            else
+            {
+                return std::declval<Subscription>();
+            }
+        }
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+        /*!
+         * @brief Await the next event of a specific type.
+         *
+         * This will temporarily subscribe to the given type when the
+         * returned awaitable is awaited and resume the awaiting coroutine
+         * with the updated instance of the first event that satisfies the
+         * given predicate. The temporary subscription is removed
+         * automatically afterwards.
+         *
+         * Note that for cached types this includes the create events of all
+         * instances that are already contained in the local Container.
+         *
+         * @param descriptor The type of the event to await.
+         *
+         * @param predicate The optional predicate the event has to satisfy.
+         * If no predicate is given, the first event will be used.
+         *
+         * @return asio::awaitable<type::AnyStruct> The awaitable that
+         * resumes with a copy of the updated instance of the event.
+         *
+         * @exception std::logic_error Thrown if @p descriptor is a sub-struct
+         * only type.
+         */
+        asio::awaitable<type::AnyStruct> next(const type::StructDescriptor& descriptor, std::optional<event_predicate_t<>> predicate = std::nullopt);
+
+        /*!
+         * @brief Await the next event of a specific type.
+         *
+         * This is the typed version of
+         * next(const type::StructDescriptor&, std::optional<event_predicate_t<>>).
+         *
+         * @code{.cpp}
+         * Foobar foobar = co_await transceiver.next<Foobar>([](const dots::Event<Foobar>& event)
+         * {
+         *     return event.isCreate() && event.updated().foo == 42;
+         * });
+         * @endcode
+         *
+         * @tparam T The type of the event to await.
+         *
+         * @param predicate The optional predicate the event has to satisfy.
+         * If no predicate is given, the first event will be used.
+         *
+         * @return asio::awaitable<T> The awaitable that resumes with a copy
+         * of the updated instance of the event.
+         */
+        template <typename T, std::enable_if_t<std::is_base_of_v<type::Struct, T> && !T::_SubstructOnly, int> = 0>
+        asio::awaitable<T> next(std::optional<event_predicate_t<T>> predicate = std::nullopt)
+        {
+            std::optional<event_predicate_t<>> predicate_;
+
+            if (predicate != std::nullopt)
+            {
+                predicate_.emplace(tools::static_argument_cast, std::move(*predicate));
+            }
+
+            type::AnyStruct instance = co_await next(T::_Descriptor(), std::move(predicate_));
+            co_return std::move(instance.to<T>());
+        }
+#endif
+
         /*!
          * @brief Subscribe to transmissions of a specific type by name.
          *
@@ -391,6 +760,62 @@ namespace dots
          */
         virtual void publish(const type::Struct& instance, std::optional<property_set_t> includedProperties = std::nullopt, bool remove = false) = 0;
 
+        /*!
+         * @brief Publish a batch of instances of a DOTS struct type.
+         *
+         * This is equivalent to publishing each instance individually with
+         * the same @p includedProperties and @p remove arguments, but allows
+         * implementing classes to share the per-publish overhead among all
+         * instances of the batch.
+         *
+         * By default, the instances are published individually via
+         * Transceiver::publish(const type::Struct&, std::optional<property_set_t>, bool).
+         *
+         * @param instances The instances to publish. All instances must be
+         * of the same type.
+         *
+         * @param includedProperties The property set to include in the
+         * publish. If no set is given, the valid property set of each
+         * instance will be used.
+         *
+         * @param remove Specifies whether the publish is a remove.
+         *
+         * @exception std::logic_error Thrown if the instances are not all of
+         * the same type.
+         */
+        virtual void publish(std::span<const type::Struct* const> instances, std::optional<property_set_t> includedProperties = std::nullopt, bool remove = false);
+
+        /*!
+         * @brief Publish a batch of instances of a DOTS struct type.
+         *
+         * This is a convenience overload of
+         * Transceiver::publish(std::span<const type::Struct* const>, std::optional<property_set_t>, bool)
+         * for contiguous sequences of instances of a static or dynamic type.
+         *
+         * @tparam T The type of the instances to publish.
+         *
+         * @param instances The instances to publish.
+         *
+         * @param includedProperties The property set to include in the
+         * publish. If no set is given, the valid property set of each
+         * instance will be used.
+         *
+         * @param remove Specifies whether the publish is a remove.
+         */
+        template <typename T, std::enable_if_t<std::is_base_of_v<type::Struct, T>, int> = 0>
+        void publish(std::span<const T> instances, std::optional<property_set_t> includedProperties = std::nullopt, bool remove = false)
+        {
+            std::vector<const type::Struct*> batch;
+            batch.reserve(instances.size());
+
+            for (const T& instance : instances)
+            {
+                batch.emplace_back(&instance);
+            }
+
+            publish(std::span<const type::Struct* const>{ batch }, includedProperties, remove);
+        }
+
         /*!
          * @brief Remove an instance of a DOTS struct type.
          *
@@ -401,6 +826,175 @@ namespace dots
          */
         void remove(const type::Struct& instance);
 
+        /*!
+         * @brief Call a remote procedure.
+         *
+         * This will publish the given request to all peers that provide the
+         * type of the request (see Transceiver::provide()) and cause the
+         * given handler to be invoked asynchronously with the reply of the
+         * first provider that answers the call. Replies are correlated with
+         * the call automatically and are only transmitted to the calling
+         * transceiver.
+         *
+         * If the call fails, either because the provider failed to handle
+         * the request or because no reply was received within the given
+         * timeout, the handler will be invoked with an exception and a
+         * nullptr reply instead.
+         *
+         * @param request The request to call the procedure with.
+         *
+         * @param replyDescriptor The expected type of the reply.
+         *
+         * @param handler The handler to invoke exactly once with either the
+         * reply or the reason the call failed.
+         *
+         * @param timeout The maximum time to wait for a reply.
+         *
+         * @exception std::logic_error Thrown if @p request or
+         * @p replyDescriptor is a sub-struct only type.
+         */
+        void call(const type::Struct& request, const type::StructDescriptor& replyDescriptor, rpc_reply_handler_t<> handler, type::Duration timeout = type::Duration{ 10.0 });
+
+        /*!
+         * @brief Call a remote procedure.
+         *
+         * This is the typed version of
+         * call(const type::Struct&, const type::StructDescriptor&, rpc_reply_handler_t<>, type::Duration).
+         *
+         * @code{.cpp}
+         * transceiver.call<FoobarReply>(FoobarRequest{ .foo = 42 }, [](std::exception_ptr ePtr, const FoobarReply* reply)
+         * {
+         *     // ...
+         * });
+         * @endcode
+         *
+         * @tparam TReply The expected type of the reply.
+         *
+         * @tparam TRequest The type of the request.
+         *
+         * @param request The request to call the procedure with.
+         *
+         * @param handler The handler to invoke exactly once with either the
+         * reply or the reason the call failed.
+         *
+         * @param timeout The maximum time to wait for a reply.
+         */
+        template <typename TReply, typename TRequest, std::enable_if_t<std::conjunction_v<std::is_base_of<type::Struct, TReply>, std::is_base_of<type::Struct, TRequest>>, int> = 0>
+        void call(const TRequest& request, rpc_reply_handler_t<TReply> handler, type::Duration timeout = type::Duration{ 10.0 })
+        {
+            call(request, TReply::_Descriptor(), rpc_reply_handler_t<>{ [handler{ std::move(handler) }](std::exception_ptr ePtr, const type::Struct* reply)
+            {
+                handler(ePtr, static_cast<const TReply*>(reply));
+            } }, timeout);
+        }
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+        /*!
+         * @brief Call a remote procedure from a coroutine.
+         *
+         * This is the awaitable version of
+         * call(const type::Struct&, const type::StructDescriptor&, rpc_reply_handler_t<>, type::Duration).
+         * The request is copied and published when the returned awaitable is
+         * awaited.
+         *
+         * @param request The request to call the procedure with.
+         *
+         * @param replyDescriptor The expected type of the reply.
+         *
+         * @param timeout The maximum time to wait for a reply.
+         *
+         * @return asio::awaitable<type::AnyStruct> The awaitable that
+         * resumes with the reply or throws the reason the call failed.
+         */
+        asio::awaitable<type::AnyStruct> asyncCall(const type::Struct& request, const type::StructDescriptor& replyDescriptor, type::Duration timeout = type::Duration{ 10.0 });
+
+        /*!
+         * @brief Call a remote procedure from a coroutine.
+         *
+         * This is the typed version of
+         * asyncCall(const type::Struct&, const type::StructDescriptor&, type::Duration).
+         *
+         * @code{.cpp}
+         * FoobarReply reply = co_await transceiver.asyncCall<FoobarReply>(FoobarRequest{ .foo = 42 });
+         * @endcode
+         *
+         * @tparam TReply The expected type of the reply.
+         *
+         * @tparam TRequest The type of the request.
+         *
+         * @param request The request to call the procedure with.
+         *
+         * @param timeout The maximum time to wait for a reply.
+         *
+         * @return asio::awaitable<TReply> The awaitable that resumes with
+         * the reply or throws the reason the call failed.
+         */
+        template <typename TReply, typename TRequest, std::enable_if_t<std::conjunction_v<std::is_base_of<type::Struct, TReply>, std::is_base_of<type::Struct, TRequest>>, int> = 0>
+        asio::awaitable<TReply> asyncCall(TRequest request, type::Duration timeout = type::Duration{ 10.0 })
+        {
+            // note: the request is taken by value because the coroutine is
+            // not started before it is awaited
+            type::AnyStruct reply = co_await asyncCall(static_cast<const type::Struct&>(request), TReply::_Descriptor(), timeout);
+            co_return std::move(reply.to<TReply>());
+        }
+#endif
+
+        /*!
+         * @brief Provide a remote procedure for a specific request type.
+         *
+         * This will cause the given handler to be invoked asynchronously
+         * every time a peer calls a procedure with a request of the given
+         * type (see Transceiver::call()). The instance returned by the
+         * handler will be transmitted to the caller as reply. If the handler
+         * throws, the caller will be notified about the failure instead.
+         *
+         * Note that multiple providers for the same request type are
+         * supported. In that case, the caller will only receive the first
+         * reply.
+         *
+         * @param requestDescriptor The type of the requests to handle.
+         *
+         * @param handler The handler to invoke with every request.
+         *
+         * @return Subscription The Subscription object that manages the
+         * lifetime of the procedure.
+         *
+         * @exception std::logic_error Thrown if @p requestDescriptor is a
+         * sub-struct only type.
+         */
+        Subscription provide(const type::StructDescriptor& requestDescriptor, rpc_handler_t<> handler);
+
+        /*!
+         * @brief Provide a remote procedure for a specific request type.
+         *
+         * This is the typed version of
+         * provide(const type::StructDescriptor&, rpc_handler_t<>).
+         *
+         * @code{.cpp}
+         * dots::Subscription subscription = transceiver.provide<FoobarRequest, FoobarReply>([](const FoobarRequest& request)
+         * {
+         *     return FoobarReply{ .bar = *request.foo + 1 };
+         * });
+         * @endcode
+         *
+         * @tparam TRequest The type of the requests to handle.
+         *
+         * @tparam TReply The type of the replies.
+         *
+         * @param handler The handler to invoke with every request.
+         *
+         * @return Subscription The Subscription object that manages the
+         * lifetime of the procedure.
+         */
+        template <typename TRequest, typename TReply, std::enable_if_t<std::conjunction_v<std::is_base_of<type::Struct, TRequest>, std::is_base_of<type::Struct, TReply>>, int> = 0>
+        Subscription provide(rpc_handler_t<TRequest, TReply> handler)
+        {
+            return provide(TRequest::_Descriptor(), rpc_handler_t<>{ [handler{ std::move(handler) }](const type::Struct& request)
+            {
+                return type::AnyStruct{ handler(static_cast<const TRequest&>(request)) };
+            } });
+        }
+
         /*!
          * @brief Get a specific container by type.
          *
@@ -462,7 +1056,7 @@ namespace dots
          * object is destroyed or Subscription::unsubscribe() is called
          * manually.
          */
-        template<typename T, typename EventHandler, typename... Args, std::enable_if_t<sizeof...(Args) >= 1 && std::is_base_of_v<type::Struct, T>, int> = 0>
+        template<typename T, typename EventHandler, typename... Args, std::enable_if_t<sizeof...(Args) >= 1 && std::is_base_of_v<type::Struct, T> && std::is_constructible_v<event_handler_t<T>, EventHandler, Args...>, int> = 0>
         [[deprecated("superseded by event_handler_t<T> overload")]]
         Subscription subscribe(EventHandler&& handler, Args&&... args)
         {
@@ -555,20 +1149,30 @@ namespace dots
         Dispatcher& dispatcher();
         void handleTransition(Connection& connection, std::exception_ptr ePtr) noexcept;
 
+        static const type::StructDescriptor* VerifyBatch(std::span<const type::Struct* const> instances);
+
     private:
 
         using id_t = uint64_t;
         using new_type_handlers_t = std::map<id_t, new_type_handler_t<>, std::greater<>>;
 
         virtual void joinGroup(std::string_view name) = 0;
+        virtual void joinRestrictedGroup(const type::StructDescriptor& descriptor, Dispatcher::id_t id, SubscriptionFilter::clauses_t clauses, std::optional<property_set_t> projection);
+        virtual void leaveRestrictedGroup(const type::StructDescriptor& descriptor, Dispatcher::id_t id);
         virtual void leaveGroup(std::string_view name) = 0;
         virtual void handleTransitionImpl(Connection& connection, std::exception_ptr ePtr) noexcept = 0;
 
         template <typename UnsubscribeHandler>
         Subscription makeSubscription(UnsubscribeHandler&& unsubscribeHandler);
 
+        struct event_batcher;
+        struct rpc_call;
+
         void handleNewType(const type::Descriptor<>& descriptor) noexcept;
         void handleDispatchError(const type::StructDescriptor& descriptor, std::exception_ptr ePtr) noexcept;
+        void deliverEventBatch(event_batcher& batcher) noexcept;
+        void handleRpcReply(const DotsRpcReply& reply) noexcept;
+        void handleRpcTimeout(id_t callId) noexcept;
 
         id_t m_nextId;
         std::optional<id_t> m_currentlyDispatchingId;
@@ -580,6 +1184,8 @@ namespace dots
         std::reference_wrapper<asio::io_context> m_ioContext;
         std::optional<transition_handler_t> m_transitionHandler;
         new_type_handlers_t m_newTypeHandlers;
+        std::unordered_map<id_t, std::shared_ptr<rpc_call>> m_rpcCalls;
+        std::optional<Dispatcher::id_t> m_rpcReplyHandlerId;
     };
 
     template <typename UnsubscribeHandler>
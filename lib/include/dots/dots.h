@@ -25,6 +25,7 @@
  */
 
 #include <string_view>
+#include <span>
 #include <dots/tools/Handler.h>
 #include <dots/type/Chrono.h>
 #include <dots/Timer.h>
@@ -277,6 +278,42 @@ namespace dots
         remove(static_cast<const type::Struct&>(instance));
     }
 
+    /*!
+     * @brief Publish a batch of instances of a DOTS struct type via the
+     * global transceiver.
+     *
+     * This will effectively call GuestTransceiver::publish() with the given
+     * batch on the global transceiver returned by
+     * dots::global_transceiver().
+     *
+     * Instantiating this template will also register \p T as a global
+     * publish type.
+     *
+     * @tparam T The type of the DOTS struct to publish. Must not be
+     * qualified as "substruct-only".
+     *
+     * @param instances The instances to publish.
+     *
+     * @param includedProperties The properties to publish in addition to
+     * the key properties. If no set is given, the valid property set of
+     * each instance will be used.
+     *
+     * @param remove Specifies whether the publish is a remove.
+     *
+     * @exception std::runtime_error Thrown if a key property of any
+     * instance is invalid.
+     *
+     * @exception std::runtime_error Thrown if no host connection has been
+     * established when the function is called.
+     */
+    template<typename T, std::enable_if_t<std::is_base_of_v<type::Struct, T>, int> = 0>
+    void publish(std::span<const T> instances, std::optional<property_set_t> includedProperties = std::nullopt, bool remove = false)
+    {
+        static_assert(!T::_SubstructOnly, "it is not allowed to publish to a struct that is marked with 'substruct_only'!");
+        io::register_global_publish_type<T>();
+        global_transceiver().publish(instances, includedProperties, remove);
+    }
+
     /*!
      * @brief Subscribe to events of a specific type via the global
      * transceiver.
@@ -361,6 +398,169 @@ namespace dots
         return global_transceiver().subscribe<T>(std::move(handler));
     }
 
+    /*!
+     * @brief Subscribe to batches of events of a specific type via the
+     * global transceiver.
+     *
+     * This will effectively call GuestTransceiver::subscribe() with the
+     * given batch handler on the global transceiver returned by
+     * dots::global_transceiver().
+     *
+     * Instantiating this template will also register \p T as a global
+     * subscribe type.
+     *
+     * @tparam T The type to subscribe to.
+     *
+     * @param handler The handler to invoke asynchronously with every batch
+     * of events.
+     *
+     * @param maxBatch The maximum number of events in a batch. Must not be
+     * zero.
+     *
+     * @param maxDelay The maximum time to delay the delivery of an event.
+     *
+     * @return Subscription The Subscription object that manages the state
+     * of the subscription.
+     */
+    template<typename T, std::enable_if_t<std::is_base_of_v<type::Struct, T>, int> = 0>
+    Subscription subscribe(Transceiver::event_batch_handler_t<T> handler, size_t maxBatch, type::Duration maxDelay = type::Duration{ 0 })
+    {
+        io::register_global_subscribe_type<T>();
+        return global_transceiver().subscribe<T>(std::move(handler), maxBatch, maxDelay);
+    }
+
+    /*!
+     * @brief Call a remote procedure via the global transceiver.
+     *
+     * This will effectively call GuestTransceiver::call() on the global
+     * transceiver returned by dots::global_transceiver().
+     *
+     * Instantiating this template will also register \p TRequest as a
+     * global publish type and \p TReply as a global subscribe type.
+     *
+     * @tparam TReply The expected type of the reply.
+     *
+     * @tparam TRequest The type of the request.
+     *
+     * @param request The request to call the procedure with.
+     *
+     * @param handler The handler to invoke exactly once with either the
+     * reply or the reason the call failed.
+     *
+     * @param timeout The maximum time to wait for a reply.
+     */
+    template <typename TReply, typename TRequest, std::enable_if_t<std::conjunction_v<std::is_base_of<type::Struct, TReply>, std::is_base_of<type::Struct, TRequest>>, int> = 0>
+    void call(const TRequest& request, Transceiver::rpc_reply_handler_t<TReply> handler, type::Duration timeout = type::Duration{ 10.0 })
+    {
+        io::register_global_publish_type<TRequest>();
+        io::register_global_subscribe_type<TReply>();
+        global_transceiver().call<TReply>(request, std::move(handler), timeout);
+    }
+
+    /*!
+     * @brief Provide a remote procedure via the global transceiver.
+     *
+     * This will effectively call GuestTransceiver::provide() on the global
+     * transceiver returned by dots::global_transceiver().
+     *
+     * Instantiating this template will also register \p TRequest as a
+     * global subscribe type and \p TReply as a global publish type.
+     *
+     * @tparam TRequest The type of the requests to handle.
+     *
+     * @tparam TReply The type of the replies.
+     *
+     * @param handler The handler to invoke with every request.
+     *
+     * @return Subscription The Subscription object that manages the
+     * lifetime of the procedure.
+     */
+    template <typename TRequest, typename TReply, std::enable_if_t<std::conjunction_v<std::is_base_of<type::Struct, TRequest>, std::is_base_of<type::Struct, TReply>>, int> = 0>
+    Subscription provide(Transceiver::rpc_handler_t<TRequest, TReply> handler)
+    {
+        io::register_global_subscribe_type<TRequest>();
+        io::register_global_publish_type<TReply>();
+        return global_transceiver().provide<TRequest, TReply>(std::move(handler));
+    }
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+    /*!
+     * @brief Await the next event of a specific type via the global
+     * transceiver.
+     *
+     * This will effectively call GuestTransceiver::next() on the global
+     * transceiver returned by dots::global_transceiver().
+     *
+     * Instantiating this template will also register \p T as a global
+     * subscribe type.
+     *
+     * @tparam T The type of the event to await.
+     *
+     * @param predicate The optional predicate the event has to satisfy.
+     *
+     * @return asio::awaitable<T> The awaitable that resumes with a copy of
+     * the updated instance of the event.
+     */
+    template <typename T, std::enable_if_t<std::is_base_of_v<type::Struct, T>, int> = 0>
+    asio::awaitable<T> next(std::optional<Transceiver::event_predicate_t<T>> predicate = std::nullopt)
+    {
+        io::register_global_subscribe_type<T>();
+        return global_transceiver().next<T>(std::move(predicate));
+    }
+
+    /*!
+     * @brief Await the synchronization of the local cache of a specific type
+     * via the global transceiver.
+     *
+     * This will effectively call GuestTransceiver::cacheSynced() on the
+     * global transceiver returned by dots::global_transceiver().
+     *
+     * Instantiating this template will also register \p T as a global
+     * subscribe type.
+     *
+     * @tparam T The type of the cache.
+     *
+     * @return asio::awaitable<void> The awaitable that resumes when the
+     * cache is synchronized.
+     */
+    template <typename T, std::enable_if_t<std::is_base_of_v<type::Struct, T>, int> = 0>
+    asio::awaitable<void> cacheSynced()
+    {
+        io::register_global_subscribe_type<T>();
+        return global_transceiver().cacheSynced<T>();
+    }
+
+    /*!
+     * @brief Publish an instance of a DOTS struct type via the global
+     * transceiver from a coroutine.
+     *
+     * This will effectively call GuestTransceiver::asyncPublish() on the
+     * global transceiver returned by dots::global_transceiver().
+     *
+     * Instantiating this template will also register \p T as a global
+     * publish type.
+     *
+     * @tparam T The type of the instance to publish.
+     *
+     * @param instance The instance to publish.
+     *
+     * @param includedProperties The properties to publish in addition to
+     * the key properties. If no set is given, the valid property set of
+     * @p instance will be used.
+     *
+     * @param remove Specifies whether the publish is a remove.
+     *
+     * @return asio::awaitable<void> The awaitable that resumes when the
+     * transmission has been flushed.
+     */
+    template <typename T, std::enable_if_t<std::is_base_of_v<type::Struct, T>, int> = 0>
+    asio::awaitable<void> asyncPublish(const T& instance, std::optional<property_set_t> includedProperties = std::nullopt, bool remove = false)
+    {
+        io::register_global_publish_type<T>();
+        return global_transceiver().asyncPublish(instance, std::move(includedProperties), remove);
+    }
+#endif
+
     /*!
      * @brief Subscribe to new types of a specific category via the global
      * transceiver.
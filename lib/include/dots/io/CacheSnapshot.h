@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include <dots/type/Registry.h>
+#include <dots/ContainerPool.h>
+#include <dots/serialization/CborSerializer.h>
+#include <DotsCloneInformation.dots.h>
+
+namespace dots::io
+{
+    /*!
+     * @class CacheSnapshot CacheSnapshot.h <dots/io/CacheSnapshot.h>
+     *
+     * @brief Persistent storage of the containers of persistent types.
+     *
+     * A CacheSnapshot writes the clones of all types that are flagged as
+     * persistent (see type::StructDescriptor::persistent()) together with
+     * their DotsCloneInformation to a snapshot file. If enabled, changes
+     * that occur between two snapshots are additionally appended to a
+     * journal file, which is discarded whenever a new snapshot is written.
+     *
+     * On load, the snapshot and the journal are applied directly to the
+     * containers of a ContainerPool. Because the clones in a snapshot are
+     * stored in the order of the containers, they can be restored without
+     * any lookups.
+     *
+     * File format (snapshot and journal): the magic "DOTSCSN1", followed by
+     * records. Each record consists of the size of its payload (little
+     * endian uint32) and the CBOR encoded payload itself: a DotsHeader
+     * (type name, attributes and remove flag), the DotsCloneInformation
+     * (omitted for descriptor records) and the instance. The descriptors of
+     * dynamic types precede their first instance.
+     *
+     * @remark The snapshot is written to a temporary file first and then
+     * renamed, so that a previous snapshot stays intact if the process is
+     * terminated while writing. Truncated journal records are ignored on
+     * load.
+     */
+    struct CacheSnapshot
+    {
+        static constexpr std::string_view Magic = "DOTSCSN1";
+
+        /*!
+         * @brief Construct a new CacheSnapshot object.
+         *
+         * @param registry The registry to resolve and register the types of
+         * the snapshot with.
+         *
+         * @param path The path of the snapshot file.
+         *
+         * @param journal Specifies whether changes between snapshots are
+         * journaled. The journal is stored next to the snapshot with the
+         * additional extension '.journal'.
+         */
+        CacheSnapshot(type::Registry& registry, std::filesystem::path path, bool journal = false);
+        CacheSnapshot(const CacheSnapshot& other) = delete;
+        CacheSnapshot(CacheSnapshot&& other) = delete;
+        ~CacheSnapshot() = default;
+
+        CacheSnapshot& operator = (const CacheSnapshot& rhs) = delete;
+        CacheSnapshot& operator = (CacheSnapshot&& rhs) = delete;
+
+        const std::filesystem::path& path() const;
+        const std::filesystem::path& journalPath() const;
+        bool journaling() const;
+
+        /*!
+         * @brief Load the snapshot and the journal into a container pool.
+         *
+         * Missing files are treated as empty. If journaling is enabled, the
+         * loaded state is immediately written to a new snapshot and the
+         * journal is started anew.
+         *
+         * @param pool The pool to restore the clones into.
+         *
+         * @return size_t The number of restored clones.
+         *
+         * @exception std::runtime_error Thrown if the snapshot could not be
+         * read or is invalid.
+         */
+        size_t load(ContainerPool& pool);
+
+        /*!
+         * @brief Write a new snapshot of the persistent containers of a
+         * pool.
+         *
+         * If journaling is enabled, the journal is discarded afterwards.
+         *
+         * @param pool The pool to write the snapshot of.
+         *
+         * @return size_t The number of written clones.
+         *
+         * @exception std::runtime_error Thrown if the snapshot could not be
+         * written.
+         */
+        size_t write(const ContainerPool& pool);
+
+        /*!
+         * @brief Append a change of a persistent type to the journal.
+         *
+         * This has no effect if journaling is disabled.
+         *
+         * @param instance The changed instance. For removes, only the key
+         * properties are required.
+         *
+         * @param cloneInfo The clone information of the changed instance.
+         *
+         * @param remove Specifies whether the instance was removed.
+         */
+        void journal(const type::Struct& instance, const DotsCloneInformation& cloneInfo, bool remove = false);
+
+    private:
+
+        using descriptor_set_t = std::unordered_set<const type::Descriptor<>*>;
+
+        void serializeDependencies(const type::Descriptor<>& descriptor, descriptor_set_t& serializedDescriptors);
+        void serializeRecord(const type::Struct& instance, const DotsCloneInformation* cloneInfo, bool remove);
+        size_t loadFile(const std::filesystem::path& path, ContainerPool& pool, bool allowTruncation);
+        void resetJournal();
+
+        type::Registry* m_registry;
+        std::filesystem::path m_path;
+        std::filesystem::path m_journalPath;
+        bool m_journaling;
+        std::ofstream m_journal;
+        descriptor_set_t m_journaledDescriptors;
+        serialization::CborSerializer m_serializer;
+    };
+}
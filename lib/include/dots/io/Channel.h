@@ -1,14 +1,20 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #pragma once
+#include <algorithm>
+#include <cstdint>
+#include <span>
 #include <string>
 #include <system_error>
 #include <type_traits>
 #include <set>
 #include <unordered_set>
+#include <vector>
 #include <dots/tools/Handler.h>
 #include <dots/io/Endpoint.h>
 #include <dots/io/Transmission.h>
+#include <dots/io/TransmissionTrace.h>
+#include <dots/io/Recording.h>
 #include <dots/tools/shared_ptr_only.h>
 #include <DotsHeader.dots.h>
 
@@ -22,7 +28,29 @@ namespace dots::io
     struct Channel : tools::shared_ptr_only, std::enable_shared_from_this<Channel>
     {
         using receive_handler_t = tools::Handler<bool(Transmission)>;
+        using receive_batch_handler_t = tools::Handler<bool(std::vector<Transmission>)>;
         using error_handler_t = tools::Handler<void(std::exception_ptr)>;
+        using flush_handler_t = tools::Handler<void(std::exception_ptr)>;
+
+        /*!
+         * @brief Traffic counters of a channel.
+         *
+         * Frame counters are maintained for all channels. Byte counters,
+         * write batches and the write buffer high-water mark are only
+         * maintained by channels that serialize into a write buffer (e.g.
+         * AsyncStreamChannel).
+         */
+        struct statistics_t
+        {
+            uint64_t receivedBytes = 0;
+            uint64_t receivedFrames = 0;
+            uint64_t transmittedBytes = 0;
+            uint64_t transmittedFrames = 0;
+            uint64_t writeBatches = 0;
+            uint64_t writeBufferHighWaterMark = 0;
+
+            bool operator == (const statistics_t& rhs) const = default;
+        };
 
         Channel(key_t key);
         Channel(const Channel& other) = delete;
@@ -38,10 +66,21 @@ namespace dots::io
         void init(type::Registry& registry);
 
         void asyncReceive(receive_handler_t receiveHandler, error_handler_t errorHandler);
+        void asyncReceive(receive_handler_t receiveHandler, receive_batch_handler_t receiveBatchHandler, error_handler_t errorHandler);
+        bool supportsBatchFrames() const;
         void transmit(const type::Struct& instance);
         void transmit(const DotsHeader& header, const type::Struct& instance);
+        void transmit(const DotsHeader& header, std::span<const type::Struct* const> instances);
+        void transmitBatch(const DotsHeader& header, std::span<const type::Struct* const> instances);
         void transmit(const Transmission& transmission);
         void transmit(const type::Descriptor<>& descriptor);
+        void transmitFromCache(const DotsHeader& header, const type::Struct& instance, uint64_t revision);
+        void asyncFlush(flush_handler_t handler);
+
+        void trace(std::shared_ptr<TransmissionTrace> trace, uint32_t peerId);
+        void record(std::shared_ptr<Recording> recording);
+
+        const statistics_t& statistics() const;
 
     protected:
 
@@ -52,13 +91,61 @@ namespace dots::io
 
         virtual void asyncReceiveImpl() = 0;
         virtual void transmitImpl(const DotsHeader& header, const type::Struct& instance) = 0;
+        virtual void transmitImpl(const DotsHeader& header, std::span<const type::Struct* const> instances);
+        virtual void transmitBatchImpl(const DotsHeader& header, std::span<const type::Struct* const> instances);
         virtual void transmitImpl(const Transmission& transmission);
+        virtual void transmitFromCacheImpl(const DotsHeader& header, const type::Struct& instance, uint64_t revision);
+        virtual void asyncFlushImpl(flush_handler_t handler);
+        virtual bool supportsBatchFramesImpl() const;
 
         void processReceive(Transmission transmission) noexcept;
+        void processReceive(std::vector<Transmission> transmissions) noexcept;
         void processError(std::exception_ptr ePtr);
         void processError(const std::string& what);
         void verifyErrorCode(std::error_code errorCode);
 
+        bool tracing() const
+        {
+            return m_trace != nullptr;
+        }
+
+        bool recording() const
+        {
+            return m_recording != nullptr;
+        }
+
+        void traceFrame(TransmissionTrace::Direction direction, const uint8_t* payload, size_t size, bool descriptor)
+        {
+            if (m_trace != nullptr)
+            {
+                m_trace->record(direction, m_tracePeerId, payload, size, descriptor);
+            }
+        }
+
+        void recordFrame(const Transmission& transmission, const uint8_t* payload, size_t size)
+        {
+            if (m_recording != nullptr)
+            {
+                m_recording->append(type::TimePoint::Now(), transmission.instance()->_descriptor().name(), payload, size);
+            }
+        }
+
+        void countReceivedBytes(size_t size)
+        {
+            m_statistics.receivedBytes += size;
+        }
+
+        void countTransmittedBytes(size_t size, size_t writeBufferSize)
+        {
+            m_statistics.transmittedBytes += size;
+            m_statistics.writeBufferHighWaterMark = std::max<uint64_t>(m_statistics.writeBufferHighWaterMark, writeBufferSize);
+        }
+
+        void countWriteBatch()
+        {
+            ++m_statistics.writeBatches;
+        }
+
     private:
 
         template <typename T, typename... Args>
@@ -76,7 +163,12 @@ namespace dots::io
         std::optional<Endpoint> m_localEndpoint;
         std::optional<Endpoint> m_remoteEndpoint;
         std::optional<receive_handler_t> m_receiveHandler;
+        std::optional<receive_batch_handler_t> m_receiveBatchHandler;
         std::optional<error_handler_t> m_errorHandler;
+        std::shared_ptr<TransmissionTrace> m_trace;
+        uint32_t m_tracePeerId;
+        std::shared_ptr<Recording> m_recording;
+        statistics_t m_statistics;
     };
 
     using channel_ptr_t = std::shared_ptr<Channel>;
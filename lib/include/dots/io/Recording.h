@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <dots/type/Chrono.h>
+
+namespace dots::io
+{
+    /*!
+     * @class Recording Recording.h <dots/io/Recording.h>
+     *
+     * @brief Continuous, segmented recording of raw transmission frames.
+     *
+     * A Recording appends the serialized frames (i.e. the encoded header
+     * and instance) of received transmissions to a directory of segment
+     * files, together with the time of reception. The frames are copied as
+     * they were read from the channel and are never re-serialized.
+     *
+     * Each segment is preallocated with a fixed size and memory-mapped, so
+     * that appending a frame only requires copying it into the mapping.
+     * When a segment is full, it is sealed (i.e. truncated to its actual
+     * size) and an index of the contained frames is written next to it. The
+     * index contains the time, offset and type of every frame and allows a
+     * RecordingReader to select frames by time and type without decoding
+     * the segment. Batch frames (see DotsHeader::batchSize) are recorded
+     * and indexed as a single frame of the type of their instances.
+     *
+     * Recordings can be replayed with the dots-replay tool or read by using
+     * a RecordingReader.
+     *
+     * Segment format ('<sequence>.dotsrec'): the magic "DOTSREC1", followed
+     * by the frames in chronological order. Each frame consists of a header
+     * of FrameHeaderSize bytes (little endian: uint64 timestamp in
+     * nanoseconds since the UNIX epoch, uint32 payload size) and the payload
+     * itself. The unused part of a segment that was not sealed (e.g.
+     * because the process was terminated) is zero-filled.
+     *
+     * Index format ('<sequence>.dotsidx'): the magic "DOTSRIX1", the number
+     * of types (uint32) and their names (each an uint16 size followed by the
+     * name), the number of frames (uint64) and an entry for every frame
+     * (uint64 timestamp, uint64 offset in the segment, uint32 type index).
+     *
+     * @remark Only channels that use the binary stream transmission format
+     * (e.g. TCP and UDS channels) currently record frames (see
+     * Channel::record()).
+     */
+    struct Recording
+    {
+        static constexpr std::string_view SegmentMagic = "DOTSREC1";
+        static constexpr std::string_view IndexMagic = "DOTSRIX1";
+        static constexpr std::string_view SegmentExtension = ".dotsrec";
+        static constexpr std::string_view IndexExtension = ".dotsidx";
+        static constexpr size_t FrameHeaderSize = sizeof(uint64_t) + sizeof(uint32_t);
+        static constexpr size_t DefaultSegmentSize = 64 * 1024 * 1024;
+
+        /*!
+         * @brief Construct a new Recording object.
+         *
+         * If the directory already contains segments, the recording will be
+         * continued with a new segment.
+         *
+         * @param directory The directory to store the segments in. It will
+         * be created if it does not exist.
+         *
+         * @param segmentSize The size of each segment in bytes. Frames that
+         * are larger than a segment are stored in a dedicated segment of
+         * sufficient size.
+         *
+         * @exception std::runtime_error Thrown if the directory could not be
+         * created.
+         */
+        Recording(std::filesystem::path directory, size_t segmentSize = DefaultSegmentSize);
+        Recording(const Recording& other) = delete;
+        Recording(Recording&& other) = delete;
+
+        /*!
+         * @brief Destroy the Recording object.
+         *
+         * This will seal the current segment.
+         */
+        ~Recording();
+
+        Recording& operator = (const Recording& rhs) = delete;
+        Recording& operator = (Recording&& rhs) = delete;
+
+        const std::filesystem::path& directory() const;
+        size_t segmentSize() const;
+        size_t segments() const;
+        size_t frames() const;
+
+        /*!
+         * @brief Append a frame.
+         *
+         * @param time The time the frame was received.
+         *
+         * @param typeName The name of the type of the transmitted instance.
+         *
+         * @param payload The serialized transmission.
+         *
+         * @param size The size of the payload.
+         *
+         * @exception std::runtime_error Thrown if a new segment could not be
+         * created.
+         */
+        void append(type::TimePoint time, std::string_view typeName, const uint8_t* payload, size_t size);
+
+        /*!
+         * @brief Flush the current segment to disk.
+         */
+        void flush();
+
+        /*!
+         * @brief Seal the current segment.
+         *
+         * Subsequent frames will be appended to a new segment.
+         */
+        void seal();
+
+    private:
+
+        struct index_entry_t
+        {
+            uint64_t time;
+            uint64_t offset;
+            uint32_t type;
+        };
+
+        void openSegment(size_t size);
+        void sealSegment();
+        void writeIndex(const std::filesystem::path& path) const;
+
+        mutable std::mutex m_mutex;
+        std::filesystem::path m_directory;
+        size_t m_segmentSize;
+        uint64_t m_sequence;
+        size_t m_segments;
+        size_t m_frames;
+        std::filesystem::path m_segmentPath;
+        std::optional<boost::interprocess::file_mapping> m_mapping;
+        std::optional<boost::interprocess::mapped_region> m_region;
+        size_t m_offset;
+        std::vector<std::string> m_types;
+        std::unordered_map<std::string, uint32_t> m_typeIndices;
+        std::vector<index_entry_t> m_index;
+    };
+
+    /*!
+     * @class RecordingReader Recording.h <dots/io/Recording.h>
+     *
+     * @brief Memory-mapped read access to the frames of a Recording.
+     *
+     * On construction, all segments of the recording are mapped and their
+     * indices are loaded. Segments without an index (i.e. segments that
+     * were not sealed) are scanned instead.
+     *
+     * The frames returned by a RecordingReader refer directly to the mapped
+     * segments and therefore stay valid for the lifetime of the reader.
+     */
+    struct RecordingReader
+    {
+        struct Frame
+        {
+            type::TimePoint time;
+            std::string_view typeName;
+            const uint8_t* payload;
+            size_t size;
+        };
+
+        /*!
+         * @brief Construct a new RecordingReader object.
+         *
+         * @param directory The directory of the recording.
+         *
+         * @exception std::runtime_error Thrown if the directory does not
+         * contain a valid recording.
+         */
+        RecordingReader(const std::filesystem::path& directory);
+        RecordingReader(const RecordingReader& other) = delete;
+        RecordingReader(RecordingReader&& other) = default;
+        ~RecordingReader() = default;
+
+        RecordingReader& operator = (const RecordingReader& rhs) = delete;
+        RecordingReader& operator = (RecordingReader&& rhs) = default;
+
+        size_t segments() const;
+        size_t frames() const;
+
+        /*!
+         * @brief Get the frames of the recording.
+         *
+         * Frames that contain type descriptors (i.e. StructDescriptorData and
+         * EnumDescriptorData) are always included, so that the selected
+         * frames can be decoded.
+         *
+         * @param types The names of the types to select or std::nullopt to
+         * select all types.
+         *
+         * @param from The time of the first frame to select.
+         *
+         * @param to The time after which no more frames are selected.
+         *
+         * @return std::vector<Frame> The selected frames in chronological
+         * order.
+         */
+        std::vector<Frame> read(const std::optional<std::unordered_set<std::string>>& types = std::nullopt, std::optional<type::TimePoint> from = std::nullopt, std::optional<type::TimePoint> to = std::nullopt) const;
+
+    private:
+
+        struct segment_t
+        {
+            boost::interprocess::file_mapping mapping;
+            boost::interprocess::mapped_region region;
+            std::vector<std::string> types;
+            std::vector<uint64_t> times;
+            std::vector<uint64_t> offsets;
+            std::vector<uint32_t> typeIndices;
+        };
+
+        static bool LoadIndex(const std::filesystem::path& path, segment_t& segment);
+        static void ScanSegment(segment_t& segment);
+
+        std::vector<std::unique_ptr<segment_t>> m_segments;
+        size_t m_frames;
+    };
+}
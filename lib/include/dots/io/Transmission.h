@@ -77,6 +77,9 @@ namespace dots::io
             id_t id;
             DotsHeader header;
             type::AnyStruct instance;
+
+            static void* operator new(size_t size);
+            static void operator delete(void* data, size_t size) noexcept;
         };
 
         std::unique_ptr<TransmissionData> m_data;
@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <dots/type/Chrono.h>
+
+namespace dots::io
+{
+    /*!
+     * @class TransmissionTrace TransmissionTrace.h
+     * <dots/io/TransmissionTrace.h>
+     *
+     * @brief Fixed-size memory ring of raw transmission frames.
+     *
+     * A TransmissionTrace records the serialized frames (i.e. the encoded
+     * header and instance) of transmissions as they are written to or read
+     * from a channel, together with a timestamp, the id of the peer and the
+     * direction of the transmission.
+     *
+     * Because recording a frame only requires copying the already
+     * serialized bytes into a preallocated ring buffer, the trace is cheap
+     * enough to be enabled permanently. When the ring is full, the oldest
+     * frames are discarded.
+     *
+     * Frames that contain type descriptors (i.e. StructDescriptorData and
+     * EnumDescriptorData) are additionally kept outside of the ring for the
+     * lifetime of the trace (once per distinct descriptor), so that a dump
+     * can always be decoded, even if the frames that originally introduced
+     * the types have long been discarded.
+     *
+     * The contents of the trace can be dumped to a file on demand or
+     * automatically when a Connection is closed due to an error. Dumps can
+     * then be decoded offline with the dots-trace-decode tool or by using
+     * TransmissionTrace::Read().
+     *
+     * Dump format: the magic "DOTSTRC1", followed by the frames in
+     * chronological order (descriptor frames first). Each frame consists of
+     * a header of FrameHeaderSize bytes (little endian: uint64 timestamp in
+     * nanoseconds since the UNIX epoch, uint32 peer id, uint32 payload size,
+     * uint8 direction) and the payload itself.
+     *
+     * @remark Only channels that use the binary stream transmission format
+     * (e.g. TCP and UDS channels) currently record frames.
+     */
+    struct TransmissionTrace
+    {
+        enum struct Direction : uint8_t
+        {
+            receive,
+            transmit
+        };
+
+        struct Frame
+        {
+            type::TimePoint time;
+            uint32_t peerId;
+            Direction direction;
+            std::vector<uint8_t> payload;
+        };
+
+        static constexpr std::string_view Magic = "DOTSTRC1";
+        static constexpr size_t FrameHeaderSize = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint8_t);
+        static constexpr size_t DefaultCapacity = 4 * 1024 * 1024;
+        static constexpr std::chrono::seconds DefaultIncidentWindow{ 60 };
+
+        /*!
+         * @brief Construct a new TransmissionTrace object.
+         *
+         * @param capacity The size of the ring in bytes. Note that every
+         * frame requires FrameHeaderSize bytes in addition to its payload.
+         *
+         * @param dumpPath The path to dump the trace to in
+         * TransmissionTrace::dump(). If no path is given, the trace can only
+         * be dumped to explicitly specified paths and streams.
+         *
+         * @param incidentWindow The minimum duration between two dumps in
+         * TransmissionTrace::dumpIncident().
+         */
+        TransmissionTrace(size_t capacity = DefaultCapacity, std::optional<std::filesystem::path> dumpPath = std::nullopt, std::chrono::steady_clock::duration incidentWindow = DefaultIncidentWindow);
+        TransmissionTrace(const TransmissionTrace& other) = delete;
+        TransmissionTrace(TransmissionTrace&& other) = delete;
+        ~TransmissionTrace() = default;
+
+        TransmissionTrace& operator = (const TransmissionTrace& rhs) = delete;
+        TransmissionTrace& operator = (TransmissionTrace&& rhs) = delete;
+
+        size_t capacity() const;
+        size_t size() const;
+        size_t discarded() const;
+        const std::optional<std::filesystem::path>& dumpPath() const;
+
+        /*!
+         * @brief Record a frame.
+         *
+         * If the frame is larger than the ring, it is not recorded at all.
+         *
+         * @param direction The direction of the transmission.
+         *
+         * @param peerId The id of the peer the transmission was exchanged
+         * with.
+         *
+         * @param payload The serialized transmission.
+         *
+         * @param size The size of the payload.
+         *
+         * @param descriptor Specifies whether the frame contains a type
+         * descriptor that has to be retained.
+         */
+        void record(Direction direction, uint32_t peerId, const uint8_t* payload, size_t size, bool descriptor = false);
+
+        /*!
+         * @brief Discard all recorded frames, except for descriptor frames.
+         */
+        void clear();
+
+        /*!
+         * @brief Dump the trace to the dump path specified on construction.
+         *
+         * @exception std::logic_error Thrown if the trace has no dump path.
+         *
+         * @exception std::runtime_error Thrown if the dump file could not be
+         * written.
+         */
+        void dump() const;
+
+        /*!
+         * @brief Dump the trace after an incident (e.g. a connection error).
+         *
+         * Contrary to dump(), the trace is written to a unique file that is
+         * derived from the dump path by appending the time of the incident
+         * and the id of the affected peer (e.g.
+         * 'dots-transmission-trace-20220101T120000.123-peer7.bin').
+         *
+         * Incidents that occur within the incident window of the previous
+         * dump are ignored. This ensures that a burst of incidents (e.g. when
+         * many connections are dropped at once) only results in a single
+         * dump of the frames that led up to the first incident.
+         *
+         * @param peerId The id of the peer that is affected by the incident.
+         *
+         * @return std::optional<std::filesystem::path> The path of the dump
+         * file or std::nullopt if the incident was ignored.
+         *
+         * @exception std::logic_error Thrown if the trace has no dump path.
+         *
+         * @exception std::runtime_error Thrown if the dump file could not be
+         * written.
+         */
+        std::optional<std::filesystem::path> dumpIncident(uint32_t peerId);
+
+        /*!
+         * @brief Dump the trace to a specific file.
+         *
+         * The file will be overwritten if it already exists.
+         *
+         * @param path The path of the file to dump the trace to.
+         *
+         * @exception std::runtime_error Thrown if the dump file could not be
+         * written.
+         */
+        void dump(const std::filesystem::path& path) const;
+
+        /*!
+         * @brief Dump the trace to a specific stream.
+         *
+         * @param os The (binary) stream to dump the trace to.
+         */
+        void dump(std::ostream& os) const;
+
+        /*!
+         * @brief Read the frames of a dump.
+         *
+         * @param is The (binary) stream to read the dump from.
+         *
+         * @return std::vector<Frame> The frames of the dump in chronological
+         * order (descriptor frames first).
+         *
+         * @exception std::runtime_error Thrown if the stream does not contain
+         * a valid dump.
+         */
+        static std::vector<Frame> Read(std::istream& is);
+
+    private:
+
+        void write(const uint8_t* data, size_t size);
+        void read(size_t offset, uint8_t* data, size_t size) const;
+        void discardOldest();
+
+        mutable std::mutex m_mutex;
+        std::vector<uint8_t> m_ring;
+        size_t m_begin;
+        size_t m_end;
+        size_t m_size;
+        size_t m_discarded;
+        std::vector<uint8_t> m_descriptorFrames;
+        std::unordered_set<std::string> m_descriptorPayloads;
+        std::optional<std::filesystem::path> m_dumpPath;
+        std::chrono::steady_clock::duration m_incidentWindow;
+        std::optional<std::chrono::steady_clock::time_point> m_lastIncident;
+    };
+
+    /*!
+     * @brief Get the global transmission trace.
+     *
+     * Unless set explicitly via set_global_transmission_trace(), the global
+     * trace is created on first access if the environment variable
+     * DOTS_TRANSMISSION_TRACE is set to the capacity of the ring in
+     * kilobytes (e.g. DOTS_TRANSMISSION_TRACE=4096). The dump path can be
+     * specified with DOTS_TRANSMISSION_TRACE_FILE and defaults to
+     * 'dots-transmission-trace.bin'.
+     *
+     * @return std::shared_ptr<TransmissionTrace> The global trace or
+     * nullptr if tracing is disabled.
+     */
+    std::shared_ptr<TransmissionTrace> global_transmission_trace();
+
+    /*!
+     * @brief Set the global transmission trace.
+     *
+     * Note that only channels that are initialized after the call will use
+     * the given trace.
+     *
+     * @param trace The trace to use or nullptr to disable tracing.
+     */
+    void set_global_transmission_trace(std::shared_ptr<TransmissionTrace> trace);
+}
@@ -4,15 +4,21 @@
 #define DOTS_ACKNOWLEDGE_DEPRECATION_OF_DotsTransportHeader_destinationGroup
 #define DOTS_ACKNOWLEDGE_DEPRECATION_OF_DotsTransportHeader_nameSpace
 #define DOTS_ACKNOWLEDGE_DEPRECATION_OF_DotsTransportHeader_destinationClientId
+#include <chrono>
+#include <deque>
 #include <optional>
+#include <unordered_map>
 #include <dots/asio.h>
 #include <dots/type/Registry.h>
 #include <dots/io/Channel.h>
+#include <dots/tools/LoopTime.h>
 #include <dots/serialization/CborSerializer.h>
 #include <dots/serialization/SerializerException.h>
 #include <dots/serialization/ExperimentalCborSerializer.h>
 #include <DotsClient.dots.h>
 #include <DotsDescriptorRequest.dots.h>
+#include <EnumDescriptorData.dots.h>
+#include <StructDescriptorData.dots.h>
 #include <DotsTransportHeader.dots.h>
 
 namespace dots::io
@@ -75,7 +81,46 @@ namespace dots::io
         using serializer_t = Serializer;
 
         using buffer_t = typename serializer_t::data_t;
-        using payload_cache_t = std::pair<Transmission::id_t, buffer_t>;
+
+        /*!
+         * @brief Pre-serialized image of the instances of a cached type.
+         *
+         * The image contains the serialized instances that were transmitted
+         * in cache transfers, which allows subsequent transfers of the same
+         * instances to skip their serialization. Entries that have not been
+         * used for at least CacheImageSweepInterval (e.g. because their
+         * instances were removed) are discarded at the end of a transfer.
+         */
+        struct cache_image_t
+        {
+            struct entry_t
+            {
+                uint64_t revision;
+                property_set_t properties;
+                uint64_t generation;
+                buffer_t data;
+            };
+
+            uint64_t generation = 0;
+            std::chrono::steady_clock::time_point sweepTime = std::chrono::steady_clock::now();
+            std::unordered_map<const type::Struct*, entry_t> entries;
+        };
+
+        /*!
+         * @brief Serialization cache that can be shared among channels.
+         *
+         * The 'id' and 'buffer' members hold the last serialized
+         * transmission, which is reused when the same transmission is
+         * distributed to multiple channels. The cache images are used for
+         * transfers of cached instances (see
+         * AsyncStreamChannel::transmitFromCacheImpl()).
+         */
+        struct payload_cache_t
+        {
+            Transmission::id_t id;
+            buffer_t buffer;
+            std::unordered_map<const type::StructDescriptor*, cache_image_t> cacheImages;
+        };
 
         /*!
          * @brief Construct a new AsyncStreamChannel object.
@@ -134,7 +179,22 @@ namespace dots::io
 
         AsyncStreamChannel(const AsyncStreamChannel& other) = delete;
         AsyncStreamChannel(AsyncStreamChannel&& other) = delete;
-        ~AsyncStreamChannel() override = default;
+        ~AsyncStreamChannel() override
+        {
+            // note: flush handlers are always completed, so that awaiting
+            // publishers are not suspended indefinitely
+            if (!m_flushHandlers.empty())
+            {
+                try
+                {
+                    failFlushHandlers(std::make_exception_ptr(std::runtime_error{ "channel was destroyed before payloads were written" }));
+                }
+                catch (...)
+                {
+                    /* do nothing */
+                }
+            }
+        }
 
         AsyncStreamChannel& operator = (const AsyncStreamChannel& rhs) = delete;
         AsyncStreamChannel& operator = (AsyncStreamChannel&& rhs) = delete;
@@ -231,8 +291,7 @@ namespace dots::io
             {
                 auto process_transmission = [this]
                 {
-                    Transmission transmission = deserializeTransmission();
-                    processReceive(std::move(transmission));
+                    processFrame();
                 };
 
                 auto process_transmission_size = [this, process_transmission]
@@ -269,7 +328,61 @@ namespace dots::io
          */
         void transmitImpl(const DotsHeader& header, const type::Struct& instance) override
         {
-            serializeTransmission(header, instance);
+            iterator_t begin = serializeTransmission(header, instance);
+            countTransmittedBytes(static_cast<size_t>(m_serializer.output().end() - begin), m_serializer.output().size());
+
+            if (tracing())
+            {
+                traceTransmission(begin, instance);
+            }
+
+            if (!m_asyncWriting)
+            {
+                asyncWrite();
+            }
+        }
+
+        /*!
+         * @brief Asynchronously transmit a batch of instances through the
+         * channel.
+         *
+         * This will serialize all instances of the batch into the current
+         * write buffer before initiating an asynchronous write, so that the
+         * batch is written to the underlying stream in a single bulk
+         * operation if the channel is not already writing.
+         *
+         * Each instance is still transmitted in its own frame. If the
+         * attributes of the header are invalid, the valid properties of the
+         * respective instance will be used as attributes.
+         *
+         * @param header The header to use in the transmissions.
+         *
+         * @param instances The instances to transmit.
+         */
+        void transmitImpl(const DotsHeader& header, std::span<const type::Struct* const> instances) override
+        {
+            std::optional<DotsHeader> instanceHeader;
+
+            if (!header.attributes.isValid())
+            {
+                instanceHeader.emplace(header);
+            }
+
+            for (const type::Struct* instance : instances)
+            {
+                if (instanceHeader)
+                {
+                    instanceHeader->attributes = instance->_validProperties();
+                }
+
+                iterator_t begin = serializeTransmission(instanceHeader ? *instanceHeader : header, *instance);
+                countTransmittedBytes(static_cast<size_t>(m_serializer.output().end() - begin), m_serializer.output().size());
+
+                if (tracing())
+                {
+                    traceTransmission(begin, *instance);
+                }
+            }
 
             if (!m_asyncWriting)
             {
@@ -277,6 +390,46 @@ namespace dots::io
             }
         }
 
+        /*!
+         * @brief Asynchronously transmit a batch of instances through the
+         * channel in a single frame.
+         *
+         * The frame consists of a single header, in which
+         * DotsHeader::batchSize is set to the number of instances, followed
+         * by the serialized instances. If the attributes of the header are
+         * invalid, each instance is serialized with its valid properties.
+         *
+         * Note that batch frames are only available if @p TransmissionFormat
+         * is set to v2 and must only be transmitted to peers that announced
+         * support for them during the handshake.
+         *
+         * @param header The header to use for all instances of the batch.
+         *
+         * @param instances The instances to transmit.
+         */
+        void transmitBatchImpl(const DotsHeader& header, std::span<const type::Struct* const> instances) override
+        {
+            if constexpr (TransmissionFormat == TransmissionFormat::v1)
+            {
+                Channel::transmitBatchImpl(header, instances);
+            }
+            else
+            {
+                iterator_t begin = serializeBatch(header, instances);
+                countTransmittedBytes(static_cast<size_t>(m_serializer.output().end() - begin), m_serializer.output().size());
+
+                if (tracing())
+                {
+                    traceTransmission(begin, *instances.front());
+                }
+
+                if (!m_asyncWriting)
+                {
+                    asyncWrite();
+                }
+            }
+        }
+
         /*!
          * @brief Asynchronously transmit a transmission through the channel.
          *
@@ -292,7 +445,13 @@ namespace dots::io
          */
         void transmitImpl(const Transmission& transmission) override
         {
-            serializeTransmission(transmission);
+            iterator_t begin = serializeTransmission(transmission);
+            countTransmittedBytes(static_cast<size_t>(m_serializer.output().end() - begin), m_serializer.output().size());
+
+            if (tracing())
+            {
+                traceTransmission(begin, transmission.instance());
+            }
 
             if (!m_asyncWriting)
             {
@@ -300,10 +459,104 @@ namespace dots::io
             }
         }
 
+        /*!
+         * @brief Asynchronously transmit a cached instance through the
+         * channel.
+         *
+         * If a payload cache was provided in
+         * AsyncStreamChannel(key_t, stream_t&&, payload_cache_t*), the
+         * serialized instance will be retrieved from the cache image of its
+         * type, as long as its revision and the attributes of the header did
+         * not change since it was last serialized. Only the header will then
+         * be serialized for the transmission.
+         *
+         * Because the cache images are shared among all channels of the
+         * payload cache, a cached type has to be serialized only once,
+         * regardless of how many peers request it.
+         *
+         * Note that the cache images are only used if @p TransmissionFormat
+         * is set to v2. Otherwise, the transmission will be transmitted as in
+         * AsyncStreamChannel::transmitImpl(const DotsHeader&, const
+         * type::Struct&).
+         *
+         * @param header The header to use in the transmission.
+         *
+         * @param instance The cached instance to transmit.
+         *
+         * @param revision The revision of the instance.
+         */
+        void transmitFromCacheImpl(const DotsHeader& header, const type::Struct& instance, uint64_t revision) override
+        {
+            if constexpr (TransmissionFormat == TransmissionFormat::v1)
+            {
+                (void)revision;
+                transmitImpl(header, instance);
+            }
+            else
+            {
+                if (m_payloadCache == nullptr)
+                {
+                    transmitImpl(header, instance);
+                    return;
+                }
+
+                iterator_t begin = serializeTransmission(header, instance, revision);
+                countTransmittedBytes(static_cast<size_t>(m_serializer.output().end() - begin), m_serializer.output().size());
+
+                if (tracing())
+                {
+                    traceTransmission(begin, instance);
+                }
+
+                if (!m_asyncWriting)
+                {
+                    asyncWrite();
+                }
+            }
+        }
+
+        /*!
+         * @brief Asynchronously wait until all outstanding payloads have been
+         * written.
+         *
+         * The handler will be invoked when the write operation that contains
+         * the last payload transmitted before this call has completed. If the
+         * channel is not writing, the handler will be invoked immediately.
+         *
+         * @param handler The handler to invoke when the payloads have been
+         * written or the channel failed.
+         */
+        void asyncFlushImpl(flush_handler_t handler) override
+        {
+            if (!m_asyncWriting)
+            {
+                handler(nullptr);
+            }
+            else
+            {
+                // note: payloads transmitted while the channel is writing are
+                // written by the subsequent write operation
+                uint64_t writeOperation = m_serializer.output().empty() ? m_writeOperations : m_writeOperations + 1;
+                m_flushHandlers.emplace_back(writeOperation, std::move(handler));
+            }
+        }
+
+        /*!
+         * @brief Check whether the channel supports batch frames.
+         *
+         * @return true If @p TransmissionFormat is set to v2.
+         * @return false Else.
+         */
+        bool supportsBatchFramesImpl() const override
+        {
+            return TransmissionFormat == TransmissionFormat::v2;
+        }
+
     private:
 
         static constexpr size_t ReadBufferMinSize = 16 * 128;
         static constexpr size_t WriteBufferMaxSize = 10 * 1024 * 1024;
+        static constexpr std::chrono::seconds CacheImageSweepInterval{ 60 };
 
         using transmission_size_t = std::conditional_t<TransmissionFormat == TransmissionFormat::v1, dots::uint16_t, dots::uint32_t>;
         static constexpr size_t TransmissionSizeSize = TransmissionFormat == TransmissionFormat::v1 ? sizeof(dots::uint16_t) : sizeof(dots::uint32_t) + 1;
@@ -354,7 +607,7 @@ namespace dots::io
                     }
                     catch (...)
                     {
-                        processError(std::current_exception());
+                        processReadError(std::current_exception());
                     }
                 });
 
@@ -380,6 +633,12 @@ namespace dots::io
 
                 m_stream.async_read_some(asio::buffer(readBufferBegin, readBufferEnd - readBufferBegin), [this, this_{ weak_from_this() }, requiredBytes, handler{ std::forward<Handler>(handler)}](boost::system::error_code ec, size_t bytesRead)
                 {
+                    // note: all transmissions that are contained in the read
+                    // data are processed within this scope (see
+                    // AsyncStreamChannel::asyncRead()), which allows them to
+                    // share the same loop time
+                    tools::LoopTime::Scope loopTimeScope;
+
                     try
                     {
                         if (this_.expired() || (this_.use_count() == 1 && m_asyncWriting))
@@ -388,6 +647,7 @@ namespace dots::io
                         }
 
                         verifyErrorCode(ec);
+                        countReceivedBytes(bytesRead);
 
                         m_serializer.setInput(m_serializer.inputData(), m_serializer.inputAvailable() + bytesRead);
 
@@ -402,12 +662,40 @@ namespace dots::io
                     }
                     catch (...)
                     {
-                        processError(std::current_exception());
+                        processReadError(std::current_exception());
                     }
                 });
             }
         }
 
+        /*!
+         * @brief Process an error that occurred while reading or processing
+         * received data.
+         *
+         * Pending flush handlers are failed before the error is processed,
+         * because no further payloads are written after the channel failed.
+         *
+         * @param ePtr The error that occurred.
+         */
+        void processReadError(std::exception_ptr ePtr)
+        {
+            failFlushHandlers(ePtr);
+            processError(ePtr);
+        }
+
+        /*!
+         * @brief Fail all pending flush handlers.
+         *
+         * @param ePtr The error to invoke the flush handlers with.
+         */
+        void failFlushHandlers(std::exception_ptr ePtr)
+        {
+            for (auto flushHandlers = std::exchange(m_flushHandlers, {}); auto& [writeOperation, handler] : flushHandlers)
+            {
+                handler(ePtr);
+            }
+        }
+
         /*!
          * @brief Asynchronously write all outstanding payloads.
          *
@@ -431,18 +719,30 @@ namespace dots::io
             }
             else
             {
+                countWriteBatch();
+                ++m_writeOperations;
                 asio::async_write(m_stream, asio::buffer(m_writeBuffer.data(), m_writeBuffer.size()), [&, this_{ shared_from_this() }](boost::system::error_code ec, size_t/* numBytes*/)
                 {
                     try
                     {
                         verifyErrorCode(ec);
+
+                        while (!m_flushHandlers.empty() && m_flushHandlers.front().first <= m_writeOperations)
+                        {
+                            flush_handler_t handler = std::move(m_flushHandlers.front().second);
+                            m_flushHandlers.pop_front();
+                            handler(nullptr);
+                        }
+
                         asyncWrite();
                     }
                     catch (...)
                     {
                         if (this_.use_count() > 1)
                         {
-                            processError(std::current_exception());
+                            std::exception_ptr ePtr = std::current_exception();
+                            failFlushHandlers(ePtr);
+                            processError(ePtr);
                         }
                     }
                 });
@@ -494,28 +794,135 @@ namespace dots::io
             }
             else
             {
-                return static_cast<size_t>(m_serializer.template deserialize<transmission_size_t>());
+                m_transmissionSize = static_cast<size_t>(m_serializer.template deserialize<transmission_size_t>());
+                return m_transmissionSize;
             }
         }
 
         /*!
-         * @brief Deserialize a transmission from the current input data.
+         * @brief Deserialize a v1 transmission from the current input data.
          *
          * @return Transmission The deserialized transmission.
          */
         Transmission deserializeTransmission()
         {
-            if constexpr (TransmissionFormat == TransmissionFormat::v1)
+            type::AnyStruct instance{ registry().getStructType(*m_transportHeader.dotsHeader->typeName) };
+            m_serializer.deserialize(*instance);
+
+            return Transmission{ std::move(*m_transportHeader.dotsHeader), std::move(instance) };
+        }
+
+        /*!
+         * @brief Deserialize and process a v2 frame from the current input
+         * data.
+         *
+         * Frames that contain a batch of instances (i.e. in which
+         * DotsHeader::batchSize is set) are processed as a whole via
+         * Channel::processReceive(std::vector<Transmission>).
+         */
+        void processFrame()
+        {
+            // note: the frame is also traced if it can not be deserialized,
+            // because it is most relevant in that case
+            const auto* frameBegin = reinterpret_cast<const uint8_t*>(m_serializer.inputData());
+            std::optional<Transmission> transmission;
+            std::vector<Transmission> transmissions;
+
+            try
             {
-                type::AnyStruct instance{ registry().getStructType(*m_transportHeader.dotsHeader->typeName) };
-                m_serializer.deserialize(*instance);
+                if (auto header = m_serializer.template deserialize<DotsHeader>(); header.batchSize.isValid())
+                {
+                    transmissions = deserializeBatchPayload(std::move(header));
+                }
+                else
+                {
+                    transmission.emplace(deserializeTransmissionPayload(std::move(header)));
+                }
+            }
+            catch (...)
+            {
+                traceFrame(TransmissionTrace::Direction::receive, frameBegin, m_transmissionSize, false);
+                throw;
+            }
+
+            if (transmission == std::nullopt)
+            {
+                traceFrame(TransmissionTrace::Direction::receive, frameBegin, m_transmissionSize, false);
+
+                if (!transmissions.empty())
+                {
+                    recordFrame(transmissions.front(), frameBegin, m_transmissionSize);
+                }
 
-                return Transmission{ std::move(*m_transportHeader.dotsHeader), std::move(instance) };
+                processReceive(std::move(transmissions));
             }
             else
             {
-                auto header = m_serializer.template deserialize<DotsHeader>();
-                type::AnyStruct instance{registry().getStructType(*header.typeName)};
+                if (tracing())
+                {
+                    traceFrame(TransmissionTrace::Direction::receive, frameBegin, m_transmissionSize, transmission->instance()->_isAny<StructDescriptorData, EnumDescriptorData>());
+                }
+
+                recordFrame(*transmission, frameBegin, m_transmissionSize);
+                processReceive(std::move(*transmission));
+            }
+        }
+
+        /*!
+         * @brief Deserialize the instance of a v2 transmission from the
+         * current input data.
+         *
+         * @param header The previously deserialized header of the
+         * transmission.
+         *
+         * @return Transmission The deserialized transmission.
+         */
+        Transmission deserializeTransmissionPayload(DotsHeader header)
+        {
+            type::AnyStruct instance{ registry().getStructType(*header.typeName) };
+
+            try
+            {
+                m_serializer.deserialize(*instance);
+            }
+            catch (serialization::SerializerException& se)
+            {
+                throw std::runtime_error("deserialization exception in type '" + instance->_descriptor().name() + "': " + se.what());
+            }
+
+            return Transmission{ std::move(header), std::move(instance) };
+        }
+
+        /*!
+         * @brief Deserialize the instances of a v2 batch frame from the
+         * current input data.
+         *
+         * Each instance is combined with a copy of the given header, in which
+         * the batch size is reset. If the attributes of the header are
+         * invalid, the valid properties of the instance are used instead.
+         *
+         * @param header The previously deserialized header of the batch.
+         *
+         * @return std::vector<Transmission> The deserialized transmissions.
+         */
+        std::vector<Transmission> deserializeBatchPayload(DotsHeader header)
+        {
+            const type::StructDescriptor& descriptor = registry().getStructType(*header.typeName);
+
+            if (descriptor.internal())
+            {
+                throw std::runtime_error{ "received batch frame of internal type '" + descriptor.name() + "'" };
+            }
+
+            uint32_t batchSize = *header.batchSize;
+            header.batchSize.reset();
+
+            std::vector<Transmission> transmissions;
+            transmissions.reserve(batchSize);
+
+            for (uint32_t i = 0; i < batchSize; ++i)
+            {
+                type::AnyStruct instance{ descriptor };
 
                 try
                 {
@@ -523,11 +930,20 @@ namespace dots::io
                 }
                 catch (serialization::SerializerException& se)
                 {
-                    throw std::runtime_error("deserialization exception in type '" + instance->_descriptor().name() + "': " + se.what());
+                    throw std::runtime_error("deserialization exception in type '" + descriptor.name() + "': " + se.what());
                 }
 
-                return Transmission{std::move(header), std::move(instance)};
+                DotsHeader instanceHeader = header;
+
+                if (!instanceHeader.attributes.isValid())
+                {
+                    instanceHeader.attributes = instance->_validProperties();
+                }
+
+                transmissions.emplace_back(std::move(instanceHeader), std::move(instance));
             }
+
+            return transmissions;
         }
 
         /*!
@@ -613,23 +1029,75 @@ namespace dots::io
                 m_serializer.serialize(header);
                 m_serializer.serialize(instance, *header.attributes);
 
-                // serialize transmission size into previously created storage
-                // area. note that the transmission size is encoded as a fixed size
-                // unsigned CBOR integer
-                size_t payloadSize = writeBuffer.size() - beginIndex;
-                auto transmissionSize = static_cast<transmission_size_t>(payloadSize - TransmissionSizeSize);
-                size_t sizeIndex = beginIndex;
-                writeBuffer[sizeIndex++] = static_cast<uint8_t>(0x1A);
-
-                for (int16_t i = sizeof(transmission_size_t) - 1; i >= 0; --i)
-                {
-                    writeBuffer[sizeIndex++] = static_cast<uint8_t>(transmissionSize >> i * 8);
-                }
+                serializeTransmissionSize(beginIndex);
 
                 return writeBuffer.begin() + beginIndex;
             }
         }
 
+        /*!
+         * @brief Serialize a batch of instances into a single v2 frame in the
+         * current write buffer.
+         *
+         * @param header The header to use for all instances of the batch.
+         *
+         * @param instances The instances to serialize.
+         *
+         * @return iterator_t An iterator to the begin of the area of the write
+         * buffer that is used by the serialized frame.
+         */
+        iterator_t serializeBatch(const DotsHeader& header, std::span<const type::Struct* const> instances)
+        {
+            if (m_serializer.output().size() > WriteBufferMaxSize)
+            {
+                throw std::runtime_error{ "async write buffer exceeded maximum size" };
+            }
+
+            buffer_t& writeBuffer = m_serializer.output();
+
+            // create storage area for transmission size
+            size_t beginIndex = writeBuffer.size();
+            writeBuffer.resize(writeBuffer.size() + TransmissionSizeSize);
+
+            // serialize header and instances
+            DotsHeader batchHeader = header;
+            batchHeader.batchSize = static_cast<uint32_t>(instances.size());
+            m_serializer.serialize(batchHeader);
+
+            for (const type::Struct* instance : instances)
+            {
+                m_serializer.serialize(*instance, header.attributes.isValid() ? *header.attributes : instance->_validProperties());
+            }
+
+            serializeTransmissionSize(beginIndex);
+
+            return writeBuffer.begin() + beginIndex;
+        }
+
+        /*!
+         * @brief Serialize the size of a v2 transmission into the storage
+         * area at the begin of the transmission.
+         *
+         * Note that the transmission size is encoded as a fixed size unsigned
+         * CBOR integer.
+         *
+         * @param beginIndex The index of the begin of the transmission in the
+         * write buffer.
+         */
+        void serializeTransmissionSize(size_t beginIndex)
+        {
+            buffer_t& writeBuffer = m_serializer.output();
+            size_t payloadSize = writeBuffer.size() - beginIndex;
+            auto transmissionSize = static_cast<transmission_size_t>(payloadSize - TransmissionSizeSize);
+            size_t sizeIndex = beginIndex;
+            writeBuffer[sizeIndex++] = static_cast<uint8_t>(0x1A);
+
+            for (int16_t i = sizeof(transmission_size_t) - 1; i >= 0; --i)
+            {
+                writeBuffer[sizeIndex++] = static_cast<uint8_t>(transmissionSize >> i * 8);
+            }
+        }
+
         /*!
          * @brief Serialize a transmission into the current write buffer.
          *
@@ -643,33 +1111,144 @@ namespace dots::io
          * type::Struct&).
          *
          * @param transmission The transmission to serialize.
+         *
+         * @return iterator_t An iterator to the begin of the area of the write
+         * buffer that is used by the serialized payload.
          */
-        void serializeTransmission(const Transmission& transmission)
+        iterator_t serializeTransmission(const Transmission& transmission)
         {
             if (m_payloadCache == nullptr)
             {
-                serializeTransmission(transmission.header(), transmission.instance());
+                return serializeTransmission(transmission.header(), transmission.instance());
             }
             else
             {
-                auto& [cacheId, cacheBuffer] = *m_payloadCache;
                 buffer_t& writeBuffer = m_serializer.output();
 
-                if (transmission.id() == cacheId)
+                if (transmission.id() == m_payloadCache->id)
                 {
-                    writeBuffer.insert(writeBuffer.end(), cacheBuffer.begin(), cacheBuffer.end());
+                    size_t beginIndex = writeBuffer.size();
+                    writeBuffer.insert(writeBuffer.end(), m_payloadCache->buffer.begin(), m_payloadCache->buffer.end());
+
+                    return writeBuffer.begin() + beginIndex;
                 }
                 else
                 {
                     iterator_t begin = serializeTransmission(transmission.header(), transmission.instance());
-                    cacheId = transmission.id();
-                    cacheBuffer.assign(begin, writeBuffer.end());
+                    m_payloadCache->id = transmission.id();
+                    m_payloadCache->buffer.assign(begin, writeBuffer.end());
+
+                    return begin;
                 }
             }
         }
 
+        /*!
+         * @brief Serialize a cached instance into the current write buffer.
+         *
+         * This will serialize the header of the transmission and append the
+         * serialized instance from the cache image of the instance's type.
+         * The instance will only be serialized (and stored in the image) if
+         * it is not contained in the image yet or if its revision or the
+         * attributes of the header have changed.
+         *
+         * When the header indicates the last instance of a cache transfer
+         * (i.e. DotsHeader::fromCache is zero), entries of the image that
+         * have not been used for at least CacheImageSweepInterval will be
+         * discarded.
+         *
+         * Note that this function requires a payload cache and is only
+         * available if v2 transmissions are used.
+         *
+         * @param header The header to serialize.
+         *
+         * @param instance The cached instance to serialize.
+         *
+         * @param revision The revision of the instance. Must be unique for
+         * every change of any instance of the type (e.g. the container
+         * version of the clone).
+         *
+         * @return iterator_t An iterator to the begin of the area of the write
+         * buffer that is used by the serialized payload.
+         */
+        iterator_t serializeTransmission(const DotsHeader& header, const type::Struct& instance, uint64_t revision)
+        {
+            if (m_serializer.output().size() > WriteBufferMaxSize)
+            {
+                throw std::runtime_error{ "async write buffer exceeded maximum size" };
+            }
+
+            cache_image_t& image = m_payloadCache->cacheImages[&instance._descriptor()];
+            auto [it, emplaced] = image.entries.try_emplace(&instance);
+            typename cache_image_t::entry_t& entry = it->second;
+
+            if (emplaced || entry.revision != revision || entry.properties != *header.attributes)
+            {
+                serializer_t serializer;
+                serializer.serialize(instance, *header.attributes);
+                entry.revision = revision;
+                entry.properties = *header.attributes;
+                entry.data = std::move(serializer.output());
+            }
+
+            entry.generation = image.generation;
+
+            buffer_t& writeBuffer = m_serializer.output();
+
+            // create storage area for transmission size
+            size_t beginIndex = writeBuffer.size();
+            writeBuffer.resize(writeBuffer.size() + TransmissionSizeSize);
+
+            // serialize header and append previously serialized instance
+            m_serializer.serialize(header);
+            writeBuffer.insert(writeBuffer.end(), entry.data.begin(), entry.data.end());
+
+            serializeTransmissionSize(beginIndex);
+
+            // note: the image is only swept periodically instead of after
+            // every transfer, because partial transfers (e.g. resyncs of
+            // reconnecting peers or filtered transfers) and interleaved
+            // transfers to multiple peers would otherwise discard entries
+            // that are still in use
+            if (auto now = std::chrono::steady_clock::now(); header.fromCache == 0u && now - image.sweepTime >= CacheImageSweepInterval)
+            {
+                std::erase_if(image.entries, [&](const auto& element){ return element.second.generation != image.generation; });
+                ++image.generation;
+                image.sweepTime = now;
+            }
+
+            return writeBuffer.begin() + beginIndex;
+        }
+
+        /*!
+         * @brief Record a serialized transmission in the transmission trace.
+         *
+         * Note that only transmissions in the v2 format are traced.
+         *
+         * @param begin An iterator to the begin of the area of the write
+         * buffer that is used by the serialized payload.
+         *
+         * @param instance The transmitted instance.
+         */
+        void traceTransmission(iterator_t begin, const type::Struct& instance)
+        {
+            if constexpr (TransmissionFormat == TransmissionFormat::v2)
+            {
+                buffer_t& writeBuffer = m_serializer.output();
+                auto frameIndex = static_cast<size_t>(begin - writeBuffer.begin()) + TransmissionSizeSize;
+                const auto* frameBegin = reinterpret_cast<const uint8_t*>(writeBuffer.data() + frameIndex);
+                traceFrame(TransmissionTrace::Direction::transmit, frameBegin, writeBuffer.size() - frameIndex, instance._isAny<StructDescriptorData, EnumDescriptorData>());
+            }
+            else
+            {
+                (void)begin;
+                (void)instance;
+            }
+        }
+
 
         DotsTransportHeader m_transportHeader;
+        size_t m_transmissionSize = 0;
         buffer_t m_readBuffer;
         buffer_t m_writeBuffer;
         serializer_t m_serializer;
@@ -677,5 +1256,7 @@ namespace dots::io
         bool m_readDispatching;
         stream_t m_stream;
         payload_cache_t* m_payloadCache;
+        uint64_t m_writeOperations = 0;
+        std::deque<std::pair<uint64_t, flush_handler_t>> m_flushHandlers;
     };
 }
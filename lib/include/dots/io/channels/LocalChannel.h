@@ -25,6 +25,8 @@ namespace dots::io
 
         void asyncReceiveImpl() override;
         void transmitImpl(const DotsHeader& header, const type::Struct& instance) override;
+        void transmitBatchImpl(const DotsHeader& header, std::span<const type::Struct* const> instances) override;
+        bool supportsBatchFramesImpl() const override;
 
     private:
 
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <dots/tools/logging.h>
+#include <dots/type/Chrono.h>
+
+namespace dots::tools
+{
+    /**
+     * Asynchronous logging backend.
+     *
+     * Log messages are copied into compact fixed-size records of a bounded
+     * lock-free ring buffer on the logging thread. A background writer
+     * thread formats the records and writes them in batches, so that the
+     * logging thread is never blocked by terminal or journal I/O.
+     *
+     * The timestamp of a message is taken on the logging thread, while the
+     * (comparatively expensive) formatting is done by the writer thread.
+     *
+     * If the ring buffer is full, messages are either dropped (the default)
+     * or the logging thread waits until the writer has made room, depending
+     * on the overflow policy. Dropped messages are counted and reported by
+     * the writer as soon as the buffer has room again.
+     *
+     * Messages that exceed MaxTextLength are truncated.
+     *
+     * Note that the file and function names of the given Flf objects are
+     * not copied and therefore must have static storage duration (which is
+     * the case for the FLF macro).
+     *
+     * Select this backend either by setting g_loggingBackend or by using the
+     * environment variable DOTS_LOG_BACKEND:
+     *
+     * Example:
+     * DOTS_LOG_BACKEND=async (log asynchronously to console)
+     */
+    class AsyncLogBackend: public LogBackend
+    {
+    public:
+        enum class OverflowPolicy: uint8_t {
+            drop,
+            block
+        };
+
+        static constexpr size_t DefaultCapacity = 1024;
+        static constexpr size_t MaxTextLength = 472;
+        static constexpr size_t MaxBatchSize = 64;
+
+        explicit AsyncLogBackend(size_t capacity = DefaultCapacity, OverflowPolicy overflowPolicy = OverflowPolicy::drop, FILE* destination = stderr);
+        AsyncLogBackend(const AsyncLogBackend& other) = delete;
+        AsyncLogBackend(AsyncLogBackend&& other) = delete;
+        ~AsyncLogBackend() override;
+
+        AsyncLogBackend& operator = (const AsyncLogBackend& rhs) = delete;
+        AsyncLogBackend& operator = (AsyncLogBackend&& rhs) = delete;
+
+        void log_p(Level level, const Flf &flf, const char* text) override;
+        void log(Level level, const Flf &flf, const std::string& text) override;
+
+        /**
+         * Block until all messages that have been logged before the call
+         * have been written.
+         */
+        void flush();
+
+        [[nodiscard]] size_t capacity() const;
+        [[nodiscard]] uint64_t overflowCount() const;
+
+    private:
+
+        struct Record
+        {
+            type::TimePoint time;
+            std::string_view file;
+            std::string_view func;
+            int line;
+            Level level;
+            bool truncated;
+            uint16_t length;
+            char text[MaxTextLength];
+        };
+
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            Record record;
+        };
+
+        void enqueue(Level level, const Flf& flf, std::string_view text);
+        bool tryEnqueue(const type::TimePoint& time, Level level, const Flf& flf, std::string_view text);
+        bool empty() const;
+        size_t dequeue(std::string& batch);
+        void format(std::string& batch, const type::TimePoint& time, Level level, std::string_view file, int line, std::string_view func, std::string_view text) const;
+        void write(std::string& batch);
+        void run();
+
+        std::unique_ptr<Slot[]> m_slots;
+        size_t m_mask;
+        OverflowPolicy m_overflowPolicy;
+        FILE* m_destination;
+        bool m_colorOut;
+        alignas(64) std::atomic<size_t> m_enqueuePos;
+        alignas(64) size_t m_dequeuePos;
+        std::atomic<size_t> m_writtenPos;
+        std::atomic<uint64_t> m_overflowCount;
+        uint64_t m_reportedOverflowCount;
+        std::atomic_bool m_sleeping;
+        std::atomic_bool m_stop;
+        std::mutex m_mutex;
+        std::condition_variable m_wakeUp;
+        std::condition_variable m_written;
+        std::thread m_writer;
+    };
+}
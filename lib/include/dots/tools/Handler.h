@@ -3,11 +3,191 @@
 #pragma once
 #include <type_traits>
 #include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
 
 namespace dots::tools
 {
     namespace details
     {
+        /*!
+         * @class HandlerStorage Handler.h <dots/tools/Handler.h>
+         *
+         * @brief Type-erased storage for the invocable object of a handler.
+         *
+         * Invocable objects that fit into the inline buffer (e.g. a member
+         * function pointer with an object pointer or a lambda capturing a
+         * few pointers) are stored without any dynamic allocation. Larger
+         * invocable objects and objects that are not nothrow move
+         * constructible are stored on the heap instead.
+         *
+         * @warning This class is an implementation detail and should not be
+         * used directly.
+         */
+        struct HandlerStorage
+        {
+            using erased_fn_t = void(*)();
+
+            static constexpr size_t InlineSize = 6 * sizeof(void*);
+            static constexpr size_t InlineAlignment = alignof(void*);
+
+            template <typename Invocable>
+            static constexpr bool is_inline_storable_v = sizeof(Invocable) <= InlineSize && alignof(Invocable) <= InlineAlignment && std::is_nothrow_move_constructible_v<Invocable>;
+
+            HandlerStorage() = default;
+
+            HandlerStorage(const HandlerStorage& other)
+            {
+                if (other.m_manager != nullptr)
+                {
+                    other.m_manager(Operation::Copy, *this, const_cast<HandlerStorage&>(other));
+                }
+            }
+
+            HandlerStorage(HandlerStorage&& other) noexcept
+            {
+                if (other.m_manager != nullptr)
+                {
+                    other.m_manager(Operation::Move, *this, other);
+                }
+            }
+
+            ~HandlerStorage()
+            {
+                reset();
+            }
+
+            HandlerStorage& operator = (const HandlerStorage& rhs)
+            {
+                if (this != &rhs)
+                {
+                    HandlerStorage copy{ rhs };
+                    *this = std::move(copy);
+                }
+
+                return *this;
+            }
+
+            HandlerStorage& operator = (HandlerStorage&& rhs) noexcept
+            {
+                if (this != &rhs)
+                {
+                    reset();
+
+                    if (rhs.m_manager != nullptr)
+                    {
+                        rhs.m_manager(Operation::Move, *this, rhs);
+                    }
+                }
+
+                return *this;
+            }
+
+            template <typename Invocable, typename... InvocableArgs>
+            void emplace(InvocableArgs&&... args)
+            {
+                // note: as with std::function, invocable objects have to be
+                // copyable, because the handler itself is copyable
+                static_assert(std::is_copy_constructible_v<Invocable>, "invocable object of handler has to be copy constructible");
+                reset();
+
+                if constexpr (is_inline_storable_v<Invocable>)
+                {
+                    ::new(static_cast<void*>(m_data.buffer)) Invocable(std::forward<InvocableArgs>(args)...);
+                }
+                else
+                {
+                    m_data.heap = new Invocable(std::forward<InvocableArgs>(args)...);
+                }
+
+                m_manager = &Manage<Invocable>;
+            }
+
+            void reset() noexcept
+            {
+                if (m_manager != nullptr)
+                {
+                    m_manager(Operation::Destroy, *this, *this);
+                    m_manager = nullptr;
+                    m_chained = nullptr;
+                }
+            }
+
+            template <typename Invocable>
+            Invocable& get() noexcept
+            {
+                if constexpr (is_inline_storable_v<Invocable>)
+                {
+                    return *std::launder(reinterpret_cast<Invocable*>(m_data.buffer));
+                }
+                else
+                {
+                    return *static_cast<Invocable*>(m_data.heap);
+                }
+            }
+
+            erased_fn_t chained() const noexcept
+            {
+                return m_chained;
+            }
+
+            void chain(erased_fn_t chained) noexcept
+            {
+                m_chained = chained;
+            }
+
+        private:
+
+            enum struct Operation : uint8_t { Copy, Move, Destroy };
+            using manager_t = void(*)(Operation, HandlerStorage&, HandlerStorage&);
+
+            template <typename Invocable>
+            static void Manage(Operation operation, HandlerStorage& self, HandlerStorage& other)
+            {
+                switch (operation)
+                {
+                    case Operation::Copy:
+                        self.emplace<Invocable>(other.get<Invocable>());
+                        self.m_chained = other.m_chained;
+                        break;
+                    case Operation::Move:
+                        if constexpr (is_inline_storable_v<Invocable>)
+                        {
+                            ::new(static_cast<void*>(self.m_data.buffer)) Invocable(std::move(other.get<Invocable>()));
+                            other.get<Invocable>().~Invocable();
+                        }
+                        else
+                        {
+                            self.m_data.heap = std::exchange(other.m_data.heap, nullptr);
+                        }
+
+                        self.m_manager = std::exchange(other.m_manager, nullptr);
+                        self.m_chained = std::exchange(other.m_chained, nullptr);
+                        break;
+                    case Operation::Destroy:
+                        if constexpr (is_inline_storable_v<Invocable>)
+                        {
+                            self.get<Invocable>().~Invocable();
+                        }
+                        else
+                        {
+                            delete &self.get<Invocable>();
+                        }
+                        break;
+                }
+            }
+
+            union
+            {
+                alignas(InlineAlignment) std::byte buffer[InlineSize];
+                void* heap;
+            } m_data;
+            manager_t m_manager = nullptr;
+            erased_fn_t m_chained = nullptr;
+        };
+
         /*!
          * @class HandlerBase Handler.h <dots/tools/Handler.h>
          *
@@ -25,7 +205,8 @@ namespace dots::tools
             template <typename Invocable>
             static constexpr bool is_compatible_v = std::conjunction_v<
                 std::negation<std::is_same<std::decay_t<Invocable>, HandlerBase>>,
-                std::is_invocable_r<R, std::decay_t<Invocable>, Args...>
+                std::is_invocable_r<R, std::decay_t<Invocable>, Args...>,
+                std::is_copy_constructible<std::decay_t<Invocable>>
             >;
 
             template <typename MemFn, typename Obj>
@@ -38,14 +219,17 @@ namespace dots::tools
             template <typename Invocable, typename... BindArgs>
             static constexpr bool is_bind_compatible_v = std::conjunction_v<
                 std::negation<std::is_member_function_pointer<std::decay_t<Invocable>>>,
-                std::is_invocable_r<R, std::decay_t<Invocable>, std::decay_t<BindArgs>&..., Args...>
+                std::is_invocable_r<R, std::decay_t<Invocable>, std::decay_t<BindArgs>&..., Args...>,
+                std::is_copy_constructible<std::decay_t<Invocable>>,
+                std::is_copy_constructible<std::decay_t<BindArgs>>...
             >;
 
             template <typename MemFn, typename Obj, typename... BindArgs>
             static constexpr bool is_bind_compatible_member_function_v = std::conjunction_v<
                 std::is_member_function_pointer<std::decay_t<MemFn>>,
                 std::is_pointer<std::decay_t<Obj>>,
-                std::is_invocable_r<R, std::decay_t<MemFn>, std::decay_t<Obj>, std::decay_t<BindArgs>&..., Args...>
+                std::is_invocable_r<R, std::decay_t<MemFn>, std::decay_t<Obj>, std::decay_t<BindArgs>&..., Args...>,
+                std::is_copy_constructible<std::decay_t<BindArgs>>...
             >;
 
             /*!
@@ -59,10 +243,9 @@ namespace dots::tools
              * function) that is compatible with the signature \p  R(Args...) .
              */
             template <typename Invocable, std::enable_if_t<is_compatible_v<Invocable>, int> = 0>
-            HandlerBase(Invocable&& invocable) :
-                m_invocable{ std::forward<Invocable>(invocable) }
+            HandlerBase(Invocable&& invocable)
             {
-                /* do nothing */
+                emplace(std::forward<Invocable>(invocable));
             }
 
             /*!
@@ -79,10 +262,9 @@ namespace dots::tools
              * @param obj The object to invoke the member function on.
              */
             template <typename MemFn, typename Obj, std::enable_if_t<is_compatible_member_function_v<MemFn, Obj>, int> = 0>
-            HandlerBase(MemFn&& memFn, Obj&& obj) :
-                m_invocable{ wrapInvocable(std::forward<MemFn>(memFn), std::forward<Obj>(obj)) }
+            HandlerBase(MemFn&& memFn, Obj&& obj)
             {
-                /* do nothing */
+                emplace(wrapInvocable(std::forward<MemFn>(memFn), std::forward<Obj>(obj)));
             }
 
             /*!
@@ -103,10 +285,9 @@ namespace dots::tools
              * the handler is invoked.
              */
             template <typename Invocable, typename... BindArgs, std::enable_if_t<is_bind_compatible_v<Invocable, BindArgs...>, int> = 0>
-            HandlerBase(Invocable&& invocable, BindArgs&&... bindArgs) :
-                m_invocable{ wrapInvocable(std::forward<Invocable>(invocable), std::forward<BindArgs>(bindArgs)...) }
+            HandlerBase(Invocable&& invocable, BindArgs&&... bindArgs)
             {
-                /* do nothing */
+                emplace(wrapInvocable(std::forward<Invocable>(invocable), std::forward<BindArgs>(bindArgs)...));
             }
 
             /*!
@@ -129,12 +310,35 @@ namespace dots::tools
              * the handler is invoked.
              */
             template <typename MemFn, typename Obj, typename... BindArgs, std::enable_if_t<is_bind_compatible_member_function_v<MemFn, Obj, BindArgs...>, int> = 0>
-            HandlerBase(MemFn&& memFn, Obj&& obj, BindArgs&&... bindArgs) :
-                m_invocable{ wrapInvocable(std::forward<MemFn>(memFn), std::forward<Obj>(obj), std::forward<BindArgs>(bindArgs)...) }
+            HandlerBase(MemFn&& memFn, Obj&& obj, BindArgs&&... bindArgs)
+            {
+                emplace(wrapInvocable(std::forward<MemFn>(memFn), std::forward<Obj>(obj), std::forward<BindArgs>(bindArgs)...));
+            }
+
+            HandlerBase(const HandlerBase& other) = default;
+
+            HandlerBase(HandlerBase&& other) noexcept :
+                m_storage{ std::move(other.m_storage) },
+                m_invoker{ std::exchange(other.m_invoker, &InvokeEmpty) }
             {
                 /* do nothing */
             }
 
+            ~HandlerBase() = default;
+
+            HandlerBase& operator = (const HandlerBase& rhs) = default;
+
+            HandlerBase& operator = (HandlerBase&& rhs) noexcept
+            {
+                if (this != &rhs)
+                {
+                    m_storage = std::move(rhs.m_storage);
+                    m_invoker = std::exchange(rhs.m_invoker, &InvokeEmpty);
+                }
+
+                return *this;
+            }
+
             /*!
              * @brief Invoke the handler.
              *
@@ -146,14 +350,30 @@ namespace dots::tools
              */
             R operator () (Args... args) const
             {
-                return m_invocable(std::forward<Args>(args)...);
+                return m_invoker(m_storage, std::forward<Args>(args)...);
             }
 
         protected:
 
+            using invoker_t = R(*)(HandlerStorage&, Args...);
+
             HandlerBase() = default;
 
-            std::function<R(Args...)> m_invocable;
+            template <typename Invocable>
+            void emplace(Invocable&& invocable)
+            {
+                using invocable_t = std::decay_t<Invocable>;
+                m_storage.template emplace<invocable_t>(std::forward<Invocable>(invocable));
+                m_invoker = &Invoke<invocable_t>;
+            }
+
+            static R InvokeEmpty(HandlerStorage&/* storage*/, Args.../* args*/)
+            {
+                throw std::bad_function_call{};
+            }
+
+            mutable HandlerStorage m_storage;
+            invoker_t m_invoker = &InvokeEmpty;
 
         private:
 
@@ -166,8 +386,21 @@ namespace dots::tools
                 std::is_invocable_r<R, std::decay_t<Invocable>, std::decay_t<BindArgs>&..., Args...>
             >;
 
+            template <typename Invocable>
+            static R Invoke(HandlerStorage& storage, Args... args)
+            {
+                if constexpr (std::is_void_v<R>)
+                {
+                    std::invoke(storage.get<Invocable>(), std::forward<Args>(args)...);
+                }
+                else
+                {
+                    return std::invoke(storage.get<Invocable>(), std::forward<Args>(args)...);
+                }
+            }
+
             template <typename Invocable, typename... BindArgs, std::enable_if_t<is_const_wrappable<Invocable, BindArgs...>::value, int> = 0>
-            auto wrapInvocable(Invocable&& invocable, BindArgs&&... bindArgs)
+            static auto wrapInvocable(Invocable&& invocable, BindArgs&&... bindArgs)
             {
                 return [invocable{ std::forward<Invocable>(invocable) }, bindTuple = std::make_tuple(std::forward<BindArgs>(bindArgs)...)](Args... args) -> R
                 {
@@ -179,7 +412,7 @@ namespace dots::tools
             }
 
             template <typename Invocable, typename... BindArgs, std::enable_if_t<is_mutable_wrappable<Invocable, BindArgs...>::value, int> = 0>
-            auto wrapInvocable(Invocable&& invocable, BindArgs&&... bindArgs)
+            static auto wrapInvocable(Invocable&& invocable, BindArgs&&... bindArgs)
             {
                 return [invocable{ std::forward<Invocable>(invocable) }, bindTuple = std::make_tuple(std::forward<BindArgs>(bindArgs)...)](Args... args) mutable -> R
                 {
@@ -261,6 +494,9 @@ namespace dots::tools
          * When the handler is invoked, the argument will statically be
          * downcasted from \p Arg to \p ArgOther.
          *
+         * @remark The invocable object of \p other is taken over directly
+         * and does not require an additional allocation.
+         *
          * @warning The implementation only enforces that type \p Arg is
          * statically downcastable to \p ArgOther. There are no runtime checks
          * that a particular argument is actually of that type. It is the
@@ -278,14 +514,33 @@ namespace dots::tools
         Handler(static_argument_cast_tag tag, Handler<R(ArgOther)>&& other)
         {
             (void)tag;
-            details::HandlerBase<R, Arg>::m_invocable = [handler{ std::move(other.m_invocable)}](Arg arg) -> R
+
+            if (other.m_storage.chained() == nullptr)
             {
-                return std::invoke(handler, static_cast<ArgOther>(arg));
-            };
+                base_t::m_storage = std::move(other.m_storage);
+                base_t::m_storage.chain(reinterpret_cast<details::HandlerStorage::erased_fn_t>(std::exchange(other.m_invoker, &Handler<R(ArgOther)>::InvokeEmpty)));
+                base_t::m_invoker = &InvokeStaticArgumentCast<ArgOther>;
+            }
+            else
+            {
+                base_t::emplace([handler{ std::move(other) }](Arg arg) -> R
+                {
+                    return handler(static_cast<ArgOther>(arg));
+                });
+            }
         }
 
     private:
 
+        using base_t = details::HandlerBase<R, Arg>;
+
+        template <typename ArgOther>
+        static R InvokeStaticArgumentCast(details::HandlerStorage& storage, Arg arg)
+        {
+            using other_invoker_t = R(*)(details::HandlerStorage&, ArgOther);
+            return reinterpret_cast<other_invoker_t>(storage.chained())(storage, static_cast<ArgOther>(arg));
+        }
+
         template <typename>
         friend struct Handler;
     };
@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace dots::tools
+{
+    /*!
+     * @class LatencyHistogram LatencyHistogram.h
+     * <dots/tools/LatencyHistogram.h>
+     *
+     * @brief Fixed-size log-linear histogram of latencies.
+     *
+     * Latencies are recorded with nanosecond resolution into buckets whose
+     * width grows with the magnitude of the value (i.e. every power of two
+     * is split into 2^SubBucketBits linear sub-buckets). This bounds the
+     * relative error of quantiles to 1 / 2^SubBucketBits while keeping
+     * recording constant in time and free of allocations.
+     *
+     * Latencies beyond 2^(MaxExponent + 1) nanoseconds (roughly 73 minutes)
+     * are clamped. Negative latencies (e.g. due to clock skew) are recorded
+     * as zero.
+     */
+    struct LatencyHistogram
+    {
+        using duration_t = std::chrono::nanoseconds;
+
+        static constexpr uint32_t SubBucketBits = 3;
+        static constexpr uint32_t MaxExponent = 41;
+        static constexpr size_t BucketCount = (MaxExponent - SubBucketBits + 2) << SubBucketBits;
+
+        LatencyHistogram();
+        LatencyHistogram(const LatencyHistogram& other) = default;
+        LatencyHistogram(LatencyHistogram&& other) = default;
+        ~LatencyHistogram() = default;
+
+        LatencyHistogram& operator = (const LatencyHistogram& rhs) = default;
+        LatencyHistogram& operator = (LatencyHistogram&& rhs) = default;
+
+        /*!
+         * @brief Record a latency.
+         *
+         * @param latency The latency to record.
+         */
+        void record(duration_t latency);
+
+        /*!
+         * @brief Get the number of recorded latencies.
+         *
+         * @return uint64_t The number of recorded latencies.
+         */
+        uint64_t count() const;
+
+        /*!
+         * @brief Get the smallest recorded latency.
+         *
+         * @return duration_t The smallest recorded latency or zero if no
+         * latencies have been recorded.
+         */
+        duration_t min() const;
+
+        /*!
+         * @brief Get the largest recorded latency.
+         *
+         * @return duration_t The largest recorded latency or zero if no
+         * latencies have been recorded.
+         */
+        duration_t max() const;
+
+        /*!
+         * @brief Get a quantile of the recorded latencies.
+         *
+         * The result is the upper bound of the bucket that contains the
+         * quantile, but never exceeds the largest recorded latency.
+         *
+         * @param q The quantile to get in the range [0.0, 1.0] (e.g. 0.99 for
+         * the 99th percentile).
+         *
+         * @return duration_t The quantile or zero if no latencies have been
+         * recorded.
+         */
+        duration_t quantile(double q) const;
+
+        /*!
+         * @brief Discard all recorded latencies.
+         */
+        void clear();
+
+    private:
+
+        static size_t BucketIndex(uint64_t value);
+        static uint64_t BucketUpperBound(size_t index);
+
+        std::array<uint64_t, BucketCount> m_buckets;
+        uint64_t m_count;
+        uint64_t m_min;
+        uint64_t m_max;
+    };
+}
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#pragma once
+#include <dots/type/Chrono.h>
+#include <dots/type/StructDescriptor.h>
+
+namespace dots::tools
+{
+    /*!
+     * @class LoopTime LoopTime.h <dots/tools/LoopTime.h>
+     *
+     * @brief Coarse clock for metadata timestamps.
+     *
+     * The loop time is a system time point that is captured at most once
+     * per dispatch scope (e.g. while processing all transmissions of a
+     * single read from a channel) and then reused for all metadata
+     * timestamps within that scope, such as the sent times of headers and
+     * the local update times of container entries. This avoids repeatedly
+     * querying the system clock when processing a high number of updates.
+     *
+     * The loop time is disabled by default, in which case LoopTime::Now()
+     * is equivalent to type::TimePoint::Now(). Outside of a dispatch scope,
+     * the system clock is always queried.
+     *
+     * Types that require precise timestamps can be exempted individually
+     * (see type::StructDescriptor::setPreciseTimestamps()).
+     *
+     * @remark Dispatch scopes are maintained per thread.
+     */
+    struct LoopTime
+    {
+        /*!
+         * @class Scope LoopTime.h <dots/tools/LoopTime.h>
+         *
+         * @brief RAII guard for a dispatch scope.
+         *
+         * The loop time is discarded when the outermost scope of the
+         * current thread ends. Scopes can be nested.
+         */
+        struct Scope
+        {
+            Scope();
+            Scope(const Scope& other) = delete;
+            Scope(Scope&& other) = delete;
+            ~Scope();
+
+            Scope& operator = (const Scope& rhs) = delete;
+            Scope& operator = (Scope&& rhs) = delete;
+        };
+
+        /*!
+         * @brief Enable or disable the loop time globally.
+         *
+         * @param enable Specifies whether the loop time is enabled.
+         */
+        static void Enable(bool enable = true);
+
+        /*!
+         * @brief Indicates whether the loop time is enabled.
+         *
+         * @return true if the loop time is enabled, false otherwise.
+         */
+        static bool Enabled();
+
+        /*!
+         * @brief Get the current loop time.
+         *
+         * If the loop time is enabled and a dispatch scope is active on the
+         * current thread, this returns the time point that was captured on
+         * the first call within the scope. Otherwise, this returns the
+         * current system time.
+         *
+         * @return type::TimePoint The current loop time.
+         */
+        static type::TimePoint Now();
+
+        /*!
+         * @brief Get the current loop time for metadata of a specific type.
+         *
+         * This is equivalent to LoopTime::Now(), unless the type requires
+         * precise timestamps, in which case the current system time is
+         * returned.
+         *
+         * @param descriptor The type the timestamp is used for.
+         *
+         * @return type::TimePoint The current loop time.
+         */
+        static type::TimePoint Now(const type::StructDescriptor& descriptor)
+        {
+            return descriptor.preciseTimestamps() ? type::TimePoint::Now() : Now();
+        }
+    };
+}
@@ -42,6 +42,7 @@
  *
  * Example:
  * DOTS_LOG_BACKEND=syslog (log to syslog)
+ * DOTS_LOG_BACKEND=async (log asynchronously to console, see AsyncLogBackend.h)
  *
  * When logging to console, you can disable colors by setting
  * DOTS_DISABLE_LOG_COLORS=1
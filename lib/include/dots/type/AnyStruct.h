@@ -24,13 +24,7 @@ namespace dots::type
 
         AnyStruct(AnyStruct&& other) = default;
 
-        ~AnyStruct()
-        {
-            if (_instance != nullptr)
-            {
-                _instance->_descriptor().destruct(Typeless::From(*_instance));
-            }
-        }
+        ~AnyStruct() = default;
 
         AnyStruct& operator = (const AnyStruct& rhs)
         {
@@ -127,7 +121,12 @@ namespace dots::type
 
     private:
 
-        std::unique_ptr<Struct> _instance;
+        struct deleter
+        {
+            void operator () (Struct* instance) const noexcept;
+        };
+
+        std::unique_ptr<Struct, deleter> _instance;
     };
 
     inline property_iterator begin(AnyStruct& instance)
@@ -3,6 +3,7 @@
 #pragma once
 #include <map>
 #include <memory>
+#include <unordered_map>
 #include <dots/type/Descriptor.h>
 
 namespace dots::type
@@ -55,6 +56,11 @@ namespace dots::type
 
     private:
 
+        // note: the ordered map is retained for deterministic iteration,
+        // while lookups by name are performed via a hash-based index
+        using index_t = std::unordered_map<std::string_view, Descriptor<>*>;
+
         underlying_map_t m_underlyingMap;
+        index_t m_index;
     };
 }
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#pragma once
+#include <cstddef>
+
+namespace dots::type
+{
+    /*!
+     * @class InstancePool InstancePool.h <dots/type/InstancePool.h>
+     *
+     * @brief Thread-local pool for the memory of short-lived instances.
+     *
+     * The InstancePool recycles the memory blocks of type-erased instances
+     * (see type::AnyStruct) and transmission data (see io::Transmission)
+     * instead of returning them to the global allocator.
+     *
+     * Blocks are grouped into size classes of InstancePool::Granularity
+     * bytes. Because all instances of a given struct type have the same
+     * size, every descriptor effectively draws from its own free list,
+     * which is shared with other descriptors of the same size class.
+     *
+     * Each thread maintains its own free lists, which therefore do not
+     * require any synchronization. A block can safely be released by a
+     * different thread than the one that allocated it.
+     *
+     * @remark Blocks larger than InstancePool::MaxBlockSize are always
+     * allocated and released via the global allocator.
+     */
+    struct InstancePool
+    {
+        static constexpr size_t Granularity = 16;
+        static constexpr size_t MaxBlockSize = 1024;
+        static constexpr size_t MaxPooledBlocks = 256;
+
+        /*!
+         * @brief Allocate a block of memory.
+         *
+         * This will reuse a previously released block of the same size
+         * class if available and otherwise allocate a new block.
+         *
+         * @param size The size of the block in bytes.
+         *
+         * @return void* A pointer to the block. The block is suitably
+         * aligned for any object of size @p size .
+         */
+        static void* Allocate(size_t size);
+
+        /*!
+         * @brief Release a block of memory.
+         *
+         * The block will be kept for reuse by the current thread unless the
+         * corresponding free list already holds InstancePool::MaxPooledBlocks
+         * blocks.
+         *
+         * @param block The block to release. Must have been allocated by
+         * InstancePool::Allocate().
+         *
+         * @param size The size that was used to allocate the block.
+         */
+        static void Deallocate(void* block, size_t size) noexcept;
+
+        /*!
+         * @brief Release all blocks pooled by the current thread to the
+         * global allocator.
+         */
+        static void Trim() noexcept;
+    };
+}
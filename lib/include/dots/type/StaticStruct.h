@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #pragma once
+#include <algorithm>
+#include <cstring>
 #include <type_traits>
 #include <utility>
 #include <dots/type/Struct.h>
@@ -87,6 +89,14 @@ namespace dots::type
 
         Derived& _assign(const Derived& other, PropertySet includedProperties = PropertySet::All)
         {
+            if constexpr (_IsTriviallyCopyable())
+            {
+                copyTrivially(other);
+                m_propertyArea.validProperties() = other.m_propertyArea.validProperties() ^ includedProperties;
+
+                return static_cast<Derived&>(*this);
+            }
+
             _applyPropertyPairs(other, [&](const auto&... propertyPairs)
             {
                 auto assign = [&](auto& propertyThis, auto& propertyOther)
@@ -133,6 +143,17 @@ namespace dots::type
 
         Derived& _copy(const Derived& other, PropertySet includedProperties = PropertySet::All)
         {
+            if constexpr (_IsTriviallyCopyable())
+            {
+                if (_Properties() <= includedProperties)
+                {
+                    copyTrivially(other);
+                    m_propertyArea.validProperties() = other.m_propertyArea.validProperties();
+
+                    return static_cast<Derived&>(*this);
+                }
+            }
+
             _applyPropertyPairs(other, [&](const auto&... propertyPairs)
             {
                 auto copy = [&](auto& propertyThis, auto& propertyOther)
@@ -152,6 +173,17 @@ namespace dots::type
 
         Derived& _merge(const Derived& other, PropertySet includedProperties = PropertySet::All)
         {
+            if constexpr (_IsTriviallyCopyable())
+            {
+                if (PropertySet mergeProperties = other.m_propertyArea.validProperties() ^ includedProperties; (m_propertyArea.validProperties() - mergeProperties).empty())
+                {
+                    copyTrivially(other);
+                    m_propertyArea.validProperties() = mergeProperties;
+
+                    return static_cast<Derived&>(*this);
+                }
+            }
+
             _applyPropertyPairs(other, [&](const auto&... propertyPairs)
             {
                 auto merge = [&](auto& propertyThis, auto& propertyOther)
@@ -370,6 +402,14 @@ namespace dots::type
             return Properties;
         }
 
+        static constexpr bool _IsTriviallyCopyable()
+        {
+            return std::apply([](auto&&... args)
+            {
+                return (std::is_trivially_copyable_v<typename strip_t<decltype(args)>::value_t> && ...);
+            }, typename Derived::_properties_t{});
+        }
+
         static property_descriptor_container_t _MakePropertyDescriptors()
         {
             return _MakePropertyDescriptors(typename Derived::_properties_t{});
@@ -416,6 +456,29 @@ namespace dots::type
             return static_cast<Derived&>(*this).template _getProperty<P>();
         }
 
+        void copyTrivially(const Derived& other)
+        {
+            // note: not constexpr to support DOTS_PROPERTIES_NO_CONSTEXPR_OFFSETS
+            auto propertyRange = std::apply([](auto&&... args)
+            {
+                if constexpr (sizeof...(args) == 0)
+                {
+                    return std::pair<size_t, size_t>{ 0, 0 };
+                }
+                else
+                {
+                    return std::pair<size_t, size_t>{
+                        std::min({ strip_t<decltype(args)>::Offset().offset()... }),
+                        std::max({ strip_t<decltype(args)>::Offset().offset() + sizeof(typename strip_t<decltype(args)>::value_t)... })
+                    };
+                }
+            }, typename Derived::_properties_t{});
+
+            // note: copying the storage of invalid properties is fine here,
+            // because their values are never observed
+            std::memcpy(reinterpret_cast<char*>(&m_propertyArea) + propertyRange.first, reinterpret_cast<const char*>(&other.m_propertyArea) + propertyRange.first, propertyRange.second - propertyRange.first);
+        }
+
         template <typename... Properties>
         static property_descriptor_container_t _MakePropertyDescriptors(std::tuple<Properties...>)
         {
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #pragma once
+#include <atomic>
 #include <dots/type/Descriptor.h>
 #include <dots/type/StaticDescriptor.h>
 #include <dots/type/Property.h>
@@ -99,6 +100,20 @@ namespace dots::type
         virtual const PropertyArea& propertyArea(const Struct& instance) const = 0;
         virtual PropertyArea& propertyArea(Struct& instance) const = 0;
 
+        /*!
+         * @brief Get the interned id of the descriptor.
+         *
+         * Ids are assigned consecutively to struct descriptors upon
+         * construction and are unique within the process. They can be used
+         * to index per-type data directly instead of looking it up by name.
+         *
+         * @return The id of the descriptor.
+         */
+        uint32_t id() const
+        {
+            return m_id;
+        }
+
         uint8_t flags() const
         {
             return m_flags;
@@ -158,6 +173,49 @@ namespace dots::type
             return m_dynamicMemoryProperties;
         }
 
+        /*!
+         * @brief Indicates whether all properties of the struct are of
+         * trivially copyable types (i.e. fundamental types except strings,
+         * and enums).
+         *
+         * Instances of such types are copied, assigned and merged by a
+         * single memcpy of their property storage and a masking of their
+         * valid property sets.
+         *
+         * @return true if the struct is trivially copyable, false otherwise.
+         */
+        bool triviallyCopyable() const
+        {
+            return m_triviallyCopyable;
+        }
+
+        /*!
+         * @brief Indicates whether the metadata timestamps of instances of
+         * the struct (e.g. the local update time) are always taken from the
+         * system clock, even if the loop time is enabled (see
+         * dots::tools::LoopTime).
+         *
+         * @return true if precise timestamps are required, false otherwise.
+         */
+        bool preciseTimestamps() const
+        {
+            return m_preciseTimestamps.load(std::memory_order_relaxed);
+        }
+
+        /*!
+         * @brief Specify whether the metadata timestamps of instances of the
+         * struct are always taken from the system clock.
+         *
+         * Note that this is a runtime setting that is not part of the type
+         * definition and can therefore also be changed for static types.
+         *
+         * @param precise Specifies whether precise timestamps are required.
+         */
+        void setPreciseTimestamps(bool precise) const
+        {
+            m_preciseTimestamps.store(precise, std::memory_order_relaxed);
+        }
+
         template <typename T, std::enable_if_t<!std::is_same_v<T, Struct>, int> = 0>
         static T& assign(T& instance, const T& other, PropertySet includedProperties)
         {
@@ -250,6 +308,51 @@ namespace dots::type
 
     private:
 
+        static uint32_t NextId();
+
+        /*!
+         * @brief Flattened representation of a single property that is used
+         * to execute operations without going through the generic property
+         * range.
+         */
+        struct plan_element_t
+        {
+            PropertySet set;
+            size_t offset;
+            size_t size;
+            bool trivial;
+            const Descriptor<>* valueDescriptor;
+            bool(*equal)(const Descriptor<>& descriptor, const Typeless& lhs, const Typeless& rhs);
+            bool(*less)(const Descriptor<>& descriptor, const Typeless& lhs, const Typeless& rhs);
+        };
+
+        /*!
+         * @brief A run of adjacent plan elements of the same kind.
+         *
+         * The elements of a bitwise run can be compared with a single memcmp
+         * and the elements of a bitwise or trivial run can be copied with a
+         * single memcpy if all of them are part of the affected properties.
+         */
+        struct plan_run_t
+        {
+            enum struct kind_t : uint8_t { Bitwise, Trivial, Generic };
+
+            kind_t kind;
+            PropertySet set;
+            size_t offset;
+            size_t size;
+            size_t first;
+            size_t last;
+        };
+
+        void buildPlan();
+
+        void copyTrivially(PropertyArea& lhsArea, const PropertyArea& rhsArea) const;
+
+        static void CopyElement(const plan_element_t& element, PropertyArea& lhsArea, const PropertyArea& rhsArea);
+        static void DestructElement(const plan_element_t& element, PropertyArea& lhsArea);
+
+        uint32_t m_id;
         uint8_t m_flags;
         property_descriptor_container_t m_propertyDescriptors;
         size_t m_areaOffset;
@@ -258,6 +361,12 @@ namespace dots::type
         size_t m_numSubStructs;
         PropertySet m_dynamicMemoryProperties;
         mutable std::vector<PropertyPath> m_propertyPaths;
+        std::vector<plan_element_t> m_planElements;
+        std::vector<plan_run_t> m_planRuns;
+        bool m_triviallyCopyable;
+        size_t m_trivialOffset;
+        size_t m_trivialSize;
+        mutable std::atomic<bool> m_preciseTimestamps;
     };
 
     template <typename TDescriptor>
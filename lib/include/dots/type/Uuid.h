@@ -17,6 +17,14 @@ namespace dots::type
 
         const value_t& data() const;
 
+        /*!
+         * @brief Get the version of the UUID as encoded in its data.
+         *
+         * @return The version of the UUID (e.g. 4 for random and 7 for
+         * time-ordered UUIDs).
+         */
+        uint8_t version() const;
+
         bool operator == (const Uuid&) const;
         bool operator < (const Uuid& rhs) const;
         bool operator != (const Uuid&) const;
@@ -25,8 +33,35 @@ namespace dots::type
 
         static Uuid FromString(std::string_view value);
         static Uuid FromData(std::string_view data);
+
+        /*!
+         * @brief Create a random (version 4) UUID.
+         *
+         * The UUID is created from the cryptographically secure entropy
+         * source of the operating system and is therefore suitable to be used
+         * as an unguessable id.
+         *
+         * @return The random UUID.
+         */
         static Uuid Random();
 
+        /*!
+         * @brief Create a time-ordered (version 7) UUID.
+         *
+         * The first 48 bits of the UUID contain the current Unix time in
+         * milliseconds, followed by a 12-bit counter that is incremented for
+         * UUIDs created within the same millisecond on the same thread and
+         * 62 random bits. UUIDs created consecutively on the same thread are
+         * therefore strictly increasing, which results in better locality
+         * when they are used as keys in ordered containers.
+         *
+         * Note that time-ordered UUIDs are predictable and must not be used
+         * as unguessable ids.
+         *
+         * @return The time-ordered UUID.
+         */
+        static Uuid TimeOrdered();
+
     private:
 
         value_t m_data;
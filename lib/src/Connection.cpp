@@ -4,6 +4,8 @@
 #include <dots/type/Registry.h>
 #include <dots/io/auth/Digest.h>
 #include <dots/tools/logging.h>
+#include <dots/tools/LoopTime.h>
+#include <dots/io/TransmissionTrace.h>
 #include <dots/serialization/StringSerializer.h>
 #include <DotsMsgConnect.dots.h>
 #include <DotsClient.dots.h>
@@ -44,7 +46,8 @@ namespace dots
         m_peerId(host ? M_nextGuestId++ : HostId),
         m_peerName("<not_set>"),
         m_channel(std::move(channel)),
-        m_authSecret{ std::move(authSecret) }
+        m_authSecret{ std::move(authSecret) },
+        m_batchFrames(false)
     {
         /* do nothing */
     }
@@ -109,6 +112,11 @@ namespace dots
         return m_connectionState == DotsConnectionState::closed;
     }
 
+    bool Connection::batchFrames() const
+    {
+        return m_batchFrames;
+    }
+
     std::string Connection::peerDescription() const
     {
         return (m_selfId == HostId ? "guest '" : "host '") + m_peerName + " [" + std::to_string(m_peerId) + "]'";
@@ -119,6 +127,22 @@ namespace dots
         return "from '" + std::string{ m_channel->localEndpoint().uriStr() } + "' at '" + std::string{ m_channel->remoteEndpoint().uriStr() } + "'";
     }
 
+    const io::Channel::statistics_t& Connection::statistics() const
+    {
+        return m_channel->statistics();
+    }
+
+    void Connection::asyncReceive(type::Registry& registry, io::AuthManager* authManager, std::string_view name, receive_handler_t receiveHandler, receive_batch_handler_t receiveBatchHandler, transition_handler_t transitionHandler)
+    {
+        if (m_connectionState != DotsConnectionState::suspended)
+        {
+            throw std::logic_error{ "only one async receive can be started on a connection" };
+        }
+
+        m_receiveBatchHandler = std::move(receiveBatchHandler);
+        asyncReceive(registry, authManager, name, std::move(receiveHandler), std::move(transitionHandler));
+    }
+
     void Connection::asyncReceive(type::Registry& registry, io::AuthManager* authManager, std::string_view name, receive_handler_t receiveHandler, transition_handler_t transitionHandler)
     {
         if (m_connectionState != DotsConnectionState::suspended)
@@ -132,8 +156,15 @@ namespace dots
 
         setConnectionState(DotsConnectionState::connecting);
         m_channel->init(registry);
+
+        if (std::shared_ptr<io::TransmissionTrace> trace = io::global_transmission_trace(); trace != nullptr)
+        {
+            m_channel->trace(std::move(trace), m_peerId);
+        }
+
         m_channel->asyncReceive(
             { &Connection::handleReceive, this },
+            { &Connection::handleReceiveBatch, this },
             { &Connection::handleError, this }
         );
 
@@ -143,7 +174,8 @@ namespace dots
             {
                 transmit(DotsMsgHello{
                     .serverName = name,
-                    .authChallenge = 0
+                    .authChallenge = 0,
+                    .batchFrames = m_channel->supportsBatchFrames()
                 });
             }
             else
@@ -151,7 +183,8 @@ namespace dots
                 transmit(DotsMsgHello{
                     .serverName = name,
                     .authChallenge = m_nonce->value(),
-                    .authenticationRequired = true
+                    .authenticationRequired = true,
+                    .batchFrames = m_channel->supportsBatchFrames()
                 });
             }
 
@@ -177,18 +210,68 @@ namespace dots
 
         transmit(DotsHeader{
             .typeName = instance._descriptor().name(),
-            .sentTime = timepoint_t::Now(),
+            .sentTime = tools::LoopTime::Now(instance._descriptor()),
             .attributes = *includedProperties,
             .removeObj = remove
         }, instance);
     }
 
+    void Connection::transmit(std::span<const type::Struct* const> instances, std::optional<property_set_t> includedProperties/* = std::nullopt*/, bool remove/* = false*/)
+    {
+        if (instances.empty())
+        {
+            return;
+        }
+
+        const type::Struct& front = *instances.front();
+        DotsHeader header{
+            .typeName = front._descriptor().name(),
+            .sentTime = tools::LoopTime::Now(front._descriptor()),
+            .removeObj = remove
+        };
+
+        // note: the attributes remain invalid if no included properties are
+        // given, in which case the channel uses the valid properties of each
+        // instance
+        if (includedProperties != std::nullopt)
+        {
+            header.attributes = *includedProperties ^ front._properties();
+        }
+
+        transmit(header, instances);
+    }
+
     void Connection::transmit(const DotsHeader& header, const type::Struct& instance)
     {
         LOG_TRANSMIT_TRANSMISSION(header, instance);
         m_channel->transmit(header, instance);
     }
 
+    void Connection::transmit(const DotsHeader& header, std::span<const type::Struct* const> instances)
+    {
+#if defined(DOTS_ENABLE_TRANSMISSION_LOGGING)
+        for (const type::Struct* instance : instances)
+        {
+            LOG_TRANSMIT_TRANSMISSION(header, *instance);
+        }
+#endif
+
+        if (m_batchFrames)
+        {
+            m_channel->transmitBatch(header, instances);
+        }
+        else
+        {
+            m_channel->transmit(header, instances);
+        }
+    }
+
+    void Connection::transmitFromCache(const DotsHeader& header, const type::Struct& instance, uint64_t revision)
+    {
+        LOG_TRANSMIT_TRANSMISSION(header, instance);
+        m_channel->transmitFromCache(header, instance, revision);
+    }
+
     void Connection::transmit(const io::Transmission& transmission)
     {
         LOG_TRANSMIT_TRANSMISSION(transmission.header(), *transmission.instance());
@@ -200,6 +283,11 @@ namespace dots
         m_channel->transmit(descriptor);
     }
 
+    void Connection::asyncFlush(io::Channel::flush_handler_t handler)
+    {
+        m_channel->asyncFlush(std::move(handler));
+    }
+
     void Connection::handleError(std::exception_ptr ePtr)
     {
         if (m_connectionState == DotsConnectionState::connected)
@@ -261,52 +349,127 @@ namespace dots
             if (m_connectionState == DotsConnectionState::connected || m_connectionState == DotsConnectionState::early_subscribe)
             {
                 instance._assertHasProperties(instance._keyProperties());
-                DotsHeader& header = transmission.header();
+                stampHeader(transmission);
 
-                if (m_selfId == HostId)
-                {
-                    header.sender = m_peerId;
+                return (*m_receiveHandler)(*this, std::move(transmission));
+            }
+            else
+            {
+                throw std::logic_error{ "received instance of non-system type " + instance._descriptor().name() + " while not in early_subscribe or connected state " + to_string(m_connectionState) };
+            }
+        }
+    }
 
-                    header.serverSentTime = timepoint_t::Now();
+    bool Connection::handleReceiveBatch(std::vector<io::Transmission> transmissions)
+    {
+#if defined(DOTS_ENABLE_TRANSMISSION_LOGGING)
+        for (const io::Transmission& transmission : transmissions)
+        {
+            LOG_RECEIVE_TRANSMISSION(transmission.header(), *transmission.instance());
+        }
+#endif
 
-                    if (!header.sentTime.isValid())
-                    {
-                        header.sentTime = header.serverSentTime;
-                    }
+        if (m_connectionState == DotsConnectionState::closed)
+        {
+            return false;
+        }
 
-                    header.isFromMyself = header.sender == m_selfId;
-                    return (*m_receiveHandler)(*this, std::move(transmission));
-                }
-                else
-                {
-                    if (!header.sentTime.isValid())
-                    {
-                        header.sentTime.emplace(timepoint_t::Now());
-                    }
+        if (!m_batchFrames)
+        {
+            throw std::logic_error{ "received batch frame although batch frames were not negotiated" };
+        }
 
-                    if (header.sender.isValid())
-                    {
-                        header.isFromMyself = header.sender == m_selfId;
-                        return (*m_receiveHandler)(*this, std::move(transmission));
-                    }
-                    else
-                    {
-                        header.sender.emplace(m_peerId);
-                        header.isFromMyself = false;
-                        return (*m_receiveHandler)(*this, std::move(transmission));
-                    }
+        if (m_connectionState != DotsConnectionState::connected && m_connectionState != DotsConnectionState::early_subscribe)
+        {
+            throw std::logic_error{ "received batch frame while not in early_subscribe or connected state " + to_string(m_connectionState) };
+        }
+
+        for (io::Transmission& transmission : transmissions)
+        {
+            const type::Struct& instance = transmission.instance();
+
+            if (instance._descriptor().internal())
+            {
+                throw std::logic_error{ "received batch frame of internal type " + instance._descriptor().name() };
+            }
+
+            instance._assertHasProperties(instance._keyProperties());
+            stampHeader(transmission);
+        }
+
+        if (m_receiveBatchHandler == std::nullopt)
+        {
+            for (io::Transmission& transmission : transmissions)
+            {
+                if (!(*m_receiveHandler)(*this, std::move(transmission)))
+                {
+                    return false;
                 }
             }
+
+            return true;
+        }
+        else
+        {
+            return (*m_receiveBatchHandler)(*this, std::move(transmissions));
+        }
+    }
+
+    void Connection::stampHeader(io::Transmission& transmission) const
+    {
+        const type::Struct& instance = transmission.instance();
+        DotsHeader& header = transmission.header();
+
+        if (m_selfId == HostId)
+        {
+            header.sender = m_peerId;
+            header.serverSentTime = tools::LoopTime::Now(instance._descriptor());
+
+            if (!header.sentTime.isValid())
+            {
+                header.sentTime = header.serverSentTime;
+            }
+
+            header.isFromMyself = header.sender == m_selfId;
+        }
+        else
+        {
+            if (!header.sentTime.isValid())
+            {
+                header.sentTime.emplace(tools::LoopTime::Now(instance._descriptor()));
+            }
+
+            if (header.sender.isValid())
+            {
+                header.isFromMyself = header.sender == m_selfId;
+            }
             else
             {
-                throw std::logic_error{ "received instance of non-system type " + instance._descriptor().name() + " while not in early_subscribe or connected state " + to_string(m_connectionState) };
+                header.sender.emplace(m_peerId);
+                header.isFromMyself = false;
             }
         }
     }
 
     void Connection::handleClose(std::exception_ptr ePtr)
     {
+        if (std::shared_ptr<io::TransmissionTrace> trace = io::global_transmission_trace(); ePtr != nullptr && trace != nullptr && trace->dumpPath() != std::nullopt)
+        {
+            try
+            {
+                if (std::optional<std::filesystem::path> path = trace->dumpIncident(m_peerId); path != std::nullopt)
+                {
+                    LOG_NOTICE_S("dumped transmission trace to '" << path->string() << "' after error of connection to " << peerDescription());
+                }
+            }
+            catch (const std::exception& e)
+            {
+                LOG_ERROR_S("could not dump transmission trace -> " << e.what());
+            }
+        }
+
         m_receiveHandler = std::nullopt;
+        m_receiveBatchHandler = std::nullopt;
         expectSystemType<DotsMsgError>(property_set_t::None, nullptr);
         setConnectionState(DotsConnectionState::closed, ePtr);
     }
@@ -314,12 +477,21 @@ namespace dots
     void Connection::handleHello(const DotsMsgHello& hello)
     {
         m_peerName = *hello.serverName;
+        m_batchFrames = hello.batchFrames == true && m_channel->supportsBatchFrames();
 
         DotsMsgConnect connect{
             .clientName = m_selfName,
             .preloadCache = true
         };
 
+        // note: support for batch frames is only announced to hosts that
+        // support them as well, to keep the handshake unchanged for legacy
+        // hosts
+        if (m_batchFrames)
+        {
+            connect.batchFrames = true;
+        }
+
         if (hello.authenticationRequired == true)
         {
             if (m_authSecret == std::nullopt)
@@ -373,6 +545,7 @@ namespace dots
         }
 
         m_peerName = *connect.clientName;
+        m_batchFrames = connect.batchFrames == true && m_channel->supportsBatchFrames();
 
         transmit(DotsMsgConnectResponse{
             .clientId = m_peerId,
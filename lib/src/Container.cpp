@@ -1,11 +1,22 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #include <dots/Container.h>
+#include <dots/tools/LoopTime.h>
 #include <algorithm>
 #include <numeric>
+#include <random>
 
 namespace dots
 {
+    namespace
+    {
+        uint64_t make_epoch()
+        {
+            std::random_device randomDevice;
+            return (static_cast<uint64_t>(randomDevice()) << 32) | static_cast<uint64_t>(randomDevice());
+        }
+    }
+
     Container<type::Struct>::key_compare::key_compare(const type::StructDescriptor& descriptor)
     {
         for (const type::PropertyDescriptor& propertyDescriptor : descriptor.propertyDescriptors())
@@ -60,15 +71,13 @@ namespace dots
 
     Container<type::Struct>::Container(const type::StructDescriptor& descriptor) :
         m_descriptor(&descriptor),
-        m_instances{ descriptor }
+        m_instances{ descriptor },
+        m_epoch(make_epoch()),
+        m_version(0),
+        m_tombstoneFloor(0),
+        m_tombstoneCapacity(DefaultTombstoneCapacity)
     {
-        for (const type::PropertyDescriptor& propertyDescriptor : descriptor.propertyDescriptors())
-        {
-            if (!propertyDescriptor.isKey())
-            {
-                m_noKeyPropertyDescriptors.emplace_back(propertyDescriptor);
-            }
-        }
+        /* do nothing */
     }
 
     const type::StructDescriptor& Container<type::Struct>::descriptor() const &
@@ -96,6 +105,11 @@ namespace dots
         return m_instances.cend();
     }
 
+    auto Container<type::Struct>::upperBound(const type::Struct& instance) const & -> const_iterator_t
+    {
+        return m_instances.upper_bound(instance);
+    }
+
     bool Container<type::Struct>::empty() const &
     {
         return m_instances.empty();
@@ -106,6 +120,37 @@ namespace dots
         return m_instances.size();
     }
 
+    uint64_t Container<type::Struct>::epoch() const &
+    {
+        return m_epoch;
+    }
+
+    uint64_t Container<type::Struct>::version() const &
+    {
+        return m_version;
+    }
+
+    auto Container<type::Struct>::tombstones() const & -> const tombstone_log_t&
+    {
+        return m_tombstones;
+    }
+
+    void Container<type::Struct>::setTombstoneCapacity(size_t capacity) &
+    {
+        m_tombstoneCapacity = capacity;
+
+        while (m_tombstones.size() > m_tombstoneCapacity)
+        {
+            m_tombstoneFloor = *m_tombstones.front().second.version;
+            m_tombstones.pop_front();
+        }
+    }
+
+    bool Container<type::Struct>::canResync(uint64_t epoch, uint64_t version) const &
+    {
+        return epoch == m_epoch && version >= m_tombstoneFloor && version <= m_version;
+    }
+
     auto Container<type::Struct>::findClone(const type::Struct& instance) const & -> const value_t*
     {
         auto it = m_instances.find(instance);
@@ -148,7 +193,8 @@ namespace dots
                 .created = header.sentTime,
                 .createdFrom = header.sender,
                 .modified = header.sentTime,
-                .localUpdateTime = timepoint_t::Now()
+                .localUpdateTime = tools::LoopTime::Now(*m_descriptor),
+                .version = ++m_version
             });
 
             return *itCreated;
@@ -163,7 +209,8 @@ namespace dots
             cloneInfo.lastOperation = DotsMt::update;
             cloneInfo.lastUpdateFrom = header.sender;
             cloneInfo.modified = header.sentTime;
-            cloneInfo.localUpdateTime = timepoint_t::Now();
+            cloneInfo.localUpdateTime = tools::LoopTime::Now(*m_descriptor);
+            cloneInfo.version = ++m_version;
 
             auto itUpdated = m_instances.insert(itUpper, std::move(node));
 
@@ -171,6 +218,25 @@ namespace dots
         }
     }
 
+    auto Container<type::Struct>::restore(type::AnyStruct instance, DotsCloneInformation cloneInfo) & -> const value_t &
+    {
+        cloneInfo.version = ++m_version;
+        size_t size = m_instances.size();
+        auto it = m_instances.try_emplace(m_instances.end(), std::move(instance), std::move(cloneInfo));
+
+        if (m_instances.size() == size)
+        {
+            // note: the instance and the clone information have not been
+            // moved if the clone already existed
+            node_t node = m_instances.extract(it);
+            node.key()->_assign(*instance);
+            node.mapped() = std::move(cloneInfo);
+            it = m_instances.insert(std::move(node)).position;
+        }
+
+        return *it;
+    }
+
     auto Container<type::Struct>::remove(const DotsHeader& header, const type::Struct& instance) & -> node_t
     {
         node_t node = m_instances.extract(instance);
@@ -184,7 +250,13 @@ namespace dots
             cloneInfo.lastOperation = DotsMt::remove;
             cloneInfo.lastUpdateFrom = header.sender;
             cloneInfo.modified = header.sentTime;
-            cloneInfo.localUpdateTime = timepoint_t::Now();
+            cloneInfo.localUpdateTime = tools::LoopTime::Now(*m_descriptor);
+            cloneInfo.version = ++m_version;
+
+            type::AnyStruct tombstone{ *m_descriptor };
+            tombstone->_copy(removed, m_descriptor->keyProperties());
+            m_tombstones.emplace_back(std::move(tombstone), cloneInfo);
+            setTombstoneCapacity(m_tombstoneCapacity);
         }
 
         return node;
@@ -193,6 +265,8 @@ namespace dots
     void Container<type::Struct>::clear() &
     {
         m_instances.clear();
+        m_tombstones.clear();
+        m_tombstoneFloor = ++m_version;
     }
 
     void Container<type::Struct>::forEachClone(const std::function<void(const value_t&)>& f) const &
@@ -222,45 +296,8 @@ namespace dots
 
     void Container<type::Struct>::updateWithoutKeys(type::Struct& lhs, const type::Struct& rhs, property_set_t includedSet)
     {
-        using namespace type;
-
-        property_set_t updateSet = (lhs._validProperties() + rhs._validProperties()) ^ includedSet;
-
-        PropertyArea& lhsArea = lhs._propertyArea();
-        const PropertyArea& rhsArea = rhs._propertyArea();
-
-        property_set_t& lhsValidSet = lhsArea.validProperties();
-        property_set_t rhsValidSet = rhsArea.validProperties();
-
-        for (const auto& propertyDescriptor_ : m_noKeyPropertyDescriptors)
-        {
-            const PropertyDescriptor& propertyDescriptor = propertyDescriptor_.get();
-
-            if (property_set_t propertySet = propertyDescriptor.set(); propertySet <= updateSet)
-            {
-                const Descriptor<>& valueDescriptor = propertyDescriptor.valueDescriptor();
-                auto& lhsValue = lhsArea.getProperty<Typeless>(propertyDescriptor.offset());
-
-                if (propertySet <= rhsValidSet)
-                {
-                    const auto& rhsValue = rhsArea.getProperty<Typeless>(propertyDescriptor.offset());
-
-                    if (propertySet <= lhsValidSet)
-                    {
-                        valueDescriptor.assign(lhsValue, rhsValue);
-                    }
-                    else
-                    {
-                        valueDescriptor.constructInPlace(lhsValue, rhsValue);
-                        lhsValidSet += propertySet;
-                    }
-                }
-                else
-                {
-                    valueDescriptor.destruct(lhsValue);
-                    lhsValidSet -= propertySet;
-                }
-            }
-        }
+        // note: copying executes the precomputed plan of the descriptor,
+        // which handles adjacent trivially copyable properties in bulk
+        m_descriptor->copy(lhs, rhs, includedSet - m_descriptor->keyProperties());
     }
 }
@@ -1,12 +1,17 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #include <dots/Dispatcher.h>
+#include <algorithm>
+#include <limits>
+#include <dots/tools/LoopTime.h>
 
 namespace dots
 {
     Dispatcher::Dispatcher(error_handler_t handler) :
         m_nextId(0),
-        m_errorHandler{ std::move(handler) }
+        m_errorHandler{ std::move(handler) },
+        m_replayMaxInstances(std::numeric_limits<size_t>::max()),
+        m_replayMaxDuration(replay_clock_t::duration::zero())
     {
         /* do nothing */
     }
@@ -21,6 +26,7 @@ namespace dots
         m_clearingHandlers = true;
         m_transmissionHandlerPool.clear();
         m_eventHandlerPool.clear();
+        m_replays.clear();
         m_clearingHandlers = false;
     }
 
@@ -57,25 +63,34 @@ namespace dots
     {
         id_t id = m_nextId++;
         if (m_clearingHandlers) return id;
-        event_handlers_t& handlers = m_eventHandlerPool[&descriptor];
-        const event_handler_t<>& handler_ = handlers.emplace(id, std::move(handler)).first->second;
-
-        const Container<>& container = m_containerPool.get(descriptor);
+        m_eventHandlerPool[&descriptor].emplace(id, std::move(handler));
 
-        if (!container.empty())
+        if (const Container<>& container = m_containerPool.get(descriptor); !container.empty())
         {
-            DotsHeader header{
-                .typeName = descriptor.name(),
-                .fromCache = static_cast<uint32_t>(container.size()),
-                .removeObj = false,
-                .isFromMyself = false
-            };
+            m_replays.emplace(id, replay_t{
+                .descriptor = &descriptor,
+                .compare = Container<>::key_compare{ descriptor },
+                .cursor = std::nullopt,
+                .remaining = static_cast<uint32_t>(container.size())
+            });
 
-            for (const auto& [instance, cloneInfo] : container)
+            size_t budget = m_replayMaxInstances;
+            bool completed;
+
+            try
             {
-                header.attributes = instance->_validProperties();
-                --*header.fromCache;
-                handler_(Event<>{ header, instance, instance, cloneInfo, DotsMt::create });
+                completed = continueReplay(id, budget, replayDeadline());
+            }
+            catch (...)
+            {
+                m_replays.erase(id);
+                throw;
+            }
+
+            if (!completed && !m_replayScheduled)
+            {
+                m_replayScheduled = true;
+                (*m_replayHandler)();
             }
         }
 
@@ -92,6 +107,63 @@ namespace dots
     {
         if (m_clearingHandlers) return;
         removeHandler(m_eventHandlerPool, descriptor, id);
+
+        if (id != m_currentlyDispatchingId)
+        {
+            m_replays.erase(id);
+        }
+    }
+
+    void Dispatcher::setReplayLimits(size_t maxInstances, type::Duration maxDuration, replay_handler_t handler)
+    {
+        if (maxInstances == 0)
+        {
+            throw std::logic_error{ "replay chunks must contain at least one instance" };
+        }
+
+        m_replayMaxInstances = maxInstances;
+        m_replayMaxDuration = std::chrono::ceil<replay_clock_t::duration>(maxDuration);
+        m_replayHandler.emplace(std::move(handler));
+    }
+
+    bool Dispatcher::replaying() const
+    {
+        return !m_replays.empty();
+    }
+
+    void Dispatcher::continueReplays()
+    {
+        m_replayScheduled = false;
+        size_t budget = m_replayMaxInstances;
+        replay_clock_t::time_point deadline = replayDeadline();
+
+        for (auto it = m_replays.begin(); it != m_replays.end();)
+        {
+            id_t id = it->first;
+            const type::StructDescriptor& descriptor = *it->second.descriptor;
+
+            try
+            {
+                continueReplay(id, budget, deadline);
+            }
+            catch (...)
+            {
+                m_errorHandler(descriptor, std::current_exception());
+            }
+
+            if (budget == 0 || replay_clock_t::now() >= deadline)
+            {
+                break;
+            }
+
+            it = m_replays.upper_bound(id);
+        }
+
+        if (!m_replays.empty() && m_replayHandler != std::nullopt)
+        {
+            m_replayScheduled = true;
+            (*m_replayHandler)();
+        }
     }
 
     void Dispatcher::dispatch(const io::Transmission& transmission)
@@ -174,7 +246,7 @@ namespace dots
                 .lastOperation = DotsMt::create,
                 .created = header.sentTime,
                 .createdFrom = header.sender,
-                .localUpdateTime = timepoint_t::Now()
+                .localUpdateTime = tools::LoopTime::Now(descriptor)
             };
 
             dispatchToHandlers(descriptor, handlers, Event<>{ header, instance, instance, cloneInfo });
@@ -186,6 +258,14 @@ namespace dots
     {
         for (const auto& [id, handler] : handlers)
         {
+            if constexpr (std::is_same_v<Dispatchable, Event<>>)
+            {
+                if (!m_replays.empty() && deferToReplay(id, dispatchable))
+                {
+                    continue;
+                }
+            }
+
             try
             {
                 m_currentlyDispatchingId = id;
@@ -206,4 +286,129 @@ namespace dots
 
         m_removeIds.clear();
     }
+
+    bool Dispatcher::continueReplay(id_t id, size_t& budget, replay_clock_t::time_point deadline)
+    {
+        for (size_t count = 0;; ++count)
+        {
+            auto itReplay = m_replays.find(id);
+
+            if (itReplay == m_replays.end())
+            {
+                return true;
+            }
+
+            replay_t& replay = itReplay->second;
+            event_handlers_t& handlers = m_eventHandlerPool[replay.descriptor];
+            auto itHandler = handlers.find(id);
+            const Container<>& container = m_containerPool.get(*replay.descriptor);
+
+            // note: the replay is resumed by key instead of by iterator,
+            // because the container might have been modified in between
+            auto it = replay.cursor == std::nullopt ? container.begin() : container.upperBound(*replay.cursor);
+
+            if (itHandler == handlers.end() || it == container.end())
+            {
+                m_replays.erase(itReplay);
+                return true;
+            }
+
+            if (budget == 0 || (count > 0 && replay_clock_t::now() >= deadline))
+            {
+                return false;
+            }
+
+            const auto& [instance, cloneInfo] = *it;
+
+            if (replay.cursor == std::nullopt)
+            {
+                replay.cursor.emplace(*replay.descriptor);
+            }
+
+            (*replay.cursor)->_assign(*instance, replay.descriptor->keyProperties());
+            replay.remaining = replay.remaining == 0 ? 0 : replay.remaining - 1;
+            --budget;
+
+            DotsHeader header{
+                .typeName = replay.descriptor->name(),
+                .fromCache = replay.remaining,
+                .removeObj = false,
+                .isFromMyself = false
+            };
+            header.attributes = instance->_validProperties();
+
+            // note: removals of the handler from within itself are deferred
+            // unless the replay is performed as part of another dispatch
+            bool dispatching = m_currentlyDispatchingId != std::nullopt;
+
+            if (!dispatching)
+            {
+                m_currentlyDispatchingId = id;
+            }
+
+            try
+            {
+                itHandler->second(Event<>{ header, instance, instance, cloneInfo, DotsMt::create });
+            }
+            catch (...)
+            {
+                if (!dispatching)
+                {
+                    m_currentlyDispatchingId = std::nullopt;
+                }
+
+                throw;
+            }
+
+            if (!dispatching)
+            {
+                m_currentlyDispatchingId = std::nullopt;
+
+                if (auto itRemove = std::find(m_removeIds.begin(), m_removeIds.end(), id); itRemove != m_removeIds.end())
+                {
+                    m_removeIds.erase(itRemove);
+                    handlers.erase(id);
+                    m_replays.erase(id);
+
+                    return true;
+                }
+            }
+        }
+    }
+
+    auto Dispatcher::replayDeadline() const -> replay_clock_t::time_point
+    {
+        return m_replayHandler == std::nullopt ? replay_clock_t::time_point::max() : replay_clock_t::now() + m_replayMaxDuration;
+    }
+
+    bool Dispatcher::deferToReplay(id_t id, const Event<>& event)
+    {
+        auto it = m_replays.find(id);
+
+        if (it == m_replays.end())
+        {
+            return false;
+        }
+
+        // note: events of instances that have already been replayed are
+        // dispatched regularly. all other instances are still pending in the
+        // replay, which will reflect their state at the time they are reached
+        if (replay_t& replay = it->second; replay.cursor == std::nullopt || replay.compare(*replay.cursor, event.updated()))
+        {
+            if (event.isCreate())
+            {
+                ++replay.remaining;
+            }
+            else if (event.isRemove() && replay.remaining > 0)
+            {
+                --replay.remaining;
+            }
+
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
 }
@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/EventBatch.h>
+
+namespace dots
+{
+    EventBatch<type::Struct>::EventBatch(const type::StructDescriptor& descriptor) :
+        m_descriptor(&descriptor)
+    {
+        /* do nothing */
+    }
+
+    const type::StructDescriptor& EventBatch<type::Struct>::descriptor() const
+    {
+        return *m_descriptor;
+    }
+
+    size_t EventBatch<type::Struct>::size() const
+    {
+        return m_entries.size();
+    }
+
+    bool EventBatch<type::Struct>::empty() const
+    {
+        return m_entries.empty();
+    }
+
+    Event<> EventBatch<type::Struct>::operator [] (size_t index) const
+    {
+        const entry_t& entry = m_entries[index];
+        const type::AnyStruct& updated = entry.updated == std::nullopt ? entry.transmitted : *entry.updated;
+
+        return Event<>{ entry.header, *entry.transmitted, *updated, entry.cloneInfo, entry.mt };
+    }
+
+    void EventBatch<type::Struct>::append(const Event<>& event)
+    {
+        // note: the updated instance is only copied separately if it differs
+        // from the transmitted one, which is never the case for uncached types
+        m_entries.emplace_back(entry_t{
+            .header = event.header(),
+            .transmitted = type::AnyStruct{ event.transmitted() },
+            .updated = &event.updated() == &event.transmitted() ? std::nullopt : std::optional<type::AnyStruct>{ event.updated() },
+            .cloneInfo = event.cloneInfo(),
+            .mt = event.mt()
+        });
+    }
+
+    void EventBatch<type::Struct>::clear()
+    {
+        m_entries.clear();
+    }
+}
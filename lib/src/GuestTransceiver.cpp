@@ -1,10 +1,20 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #include <dots/GuestTransceiver.h>
+#include <algorithm>
 #include <dots/tools/logging.h>
 #include <dots/serialization/AsciiSerialization.h>
 #include <DotsMember.dots.h>
 #include <DotsCacheInfo.dots.h>
+#include <DotsSubscriptionFilter.dots.h>
+#include <DotsEcho.dots.h>
+#include <DotsClientLatency.dots.h>
+#include <DotsTypeLatency.dots.h>
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#endif
 
 namespace dots
 {
@@ -23,6 +33,18 @@ namespace dots
         {
             auto hostConnection = std::move(m_hostConnection);
         }
+
+        try
+        {
+            for (auto& [name, syncHandler] : m_cacheSyncHandlers)
+            {
+                syncHandler(std::make_exception_ptr(std::runtime_error{ "transceiver was destroyed before cache of type '" + name + "' was synchronized" }));
+            }
+        }
+        catch (...)
+        {
+            /* do nothing */
+        }
     }
 
     bool GuestTransceiver::connected() const
@@ -96,18 +118,265 @@ namespace dots
         }
     }
 
+    void GuestTransceiver::publish(std::span<const type::Struct* const> instances, std::optional<property_set_t> includedProperties/* = std::nullopt*/, bool remove/* = false*/)
+    {
+        const type::StructDescriptor* descriptor = VerifyBatch(instances);
+
+        if (descriptor == nullptr)
+        {
+            return;
+        }
+
+        if (descriptor->substructOnly())
+        {
+            throw std::logic_error{ "attempt to publish substruct-only type '" + descriptor->name() + "'" };
+        }
+
+        property_set_t keyProperties = descriptor->keyProperties();
+
+        for (const type::Struct* instance : instances)
+        {
+            if (!(keyProperties <= instance->_validProperties()))
+            {
+                throw std::runtime_error("attempt to publish instance with missing key properties '" + (keyProperties - instance->_validProperties()).toString() + "'");
+            }
+        }
+
+        if (includedProperties != std::nullopt)
+        {
+            *includedProperties += keyProperties;
+        }
+
+        if (m_hostConnection == nullptr)
+        {
+            throw std::runtime_error{ "attempt to publish on closed connection" };
+        }
+
+        try
+        {
+            m_hostConnection->transmit(instances, includedProperties, remove);
+        }
+        catch (...)
+        {
+            m_hostConnection->handleError(std::current_exception());
+        }
+    }
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+    asio::awaitable<void> GuestTransceiver::asyncPublish(const type::Struct& instance, std::optional<property_set_t> includedProperties/* = std::nullopt*/, bool remove/* = false*/)
+    {
+        // note: the initiation is deferred until the awaitable is awaited,
+        // which is why the instance is copied
+        return asio::async_initiate<const asio::use_awaitable_t<>, void(std::exception_ptr)>([this](auto completionHandler, const type::AnyStruct& instance_, std::optional<property_set_t> includedProperties_, bool remove_)
+        {
+            auto completionHandler_ = std::make_shared<decltype(completionHandler)>(std::move(completionHandler));
+            io::Channel::flush_handler_t flushHandler{ [completionHandler_](std::exception_ptr ePtr)
+            {
+                auto executor = asio::get_associated_executor(*completionHandler_);
+                asio::post(executor, [completionHandler{ std::move(*completionHandler_) }, ePtr]() mutable
+                {
+                    std::move(completionHandler)(ePtr);
+                });
+            } };
+
+            try
+            {
+                publish(*instance_, std::move(includedProperties_), remove_);
+
+                // note: transmission errors are not thrown by publish(), but
+                // close the connection instead
+                if (m_hostConnection == nullptr || m_hostConnection->closed())
+                {
+                    throw std::runtime_error{ "connection was closed while publishing instance of type '" + instance_->_descriptor().name() + "'" };
+                }
+            }
+            catch (...)
+            {
+                flushHandler(std::current_exception());
+                return;
+            }
+
+            m_hostConnection->asyncFlush(std::move(flushHandler));
+        }, asio::use_awaitable, type::AnyStruct{ instance }, std::move(includedProperties), remove);
+    }
+
+    asio::awaitable<void> GuestTransceiver::cacheSynced(const type::StructDescriptor& descriptor)
+    {
+        if (!descriptor.cached())
+        {
+            throw std::logic_error{ "attempt to await cache synchronization of uncached type '" + descriptor.name() + "'" };
+        }
+
+        return asio::async_initiate<const asio::use_awaitable_t<>, void(std::exception_ptr)>([this, &descriptor](auto completionHandler)
+        {
+            auto completionHandler_ = std::make_shared<decltype(completionHandler)>(std::move(completionHandler));
+            tools::Handler<void(std::exception_ptr)> syncHandler{ [completionHandler_](std::exception_ptr ePtr)
+            {
+                auto executor = asio::get_associated_executor(*completionHandler_);
+                asio::post(executor, [completionHandler{ std::move(*completionHandler_) }, ePtr]() mutable
+                {
+                    std::move(completionHandler)(ePtr);
+                });
+            } };
+
+            if (m_syncedCaches.contains(descriptor.name()))
+            {
+                syncHandler(nullptr);
+            }
+            else
+            {
+                m_cacheSyncHandlers.emplace(descriptor.name(), std::move(syncHandler));
+            }
+        }, asio::use_awaitable);
+    }
+#endif
+
+    void GuestTransceiver::enableLatencyProbe(type::Duration probeInterval/* = std::chrono::seconds{ 1 }*/, type::Duration reportInterval/* = std::chrono::seconds{ 10 }*/, bool publishReports/* = true*/)
+    {
+        disableLatencyProbe();
+        m_publishLatencyReports = publishReports;
+        m_latencyProbeTimer.emplace(ioContext(), probeInterval, Timer::handler_t{ &GuestTransceiver::handleLatencyProbeTimeout, this }, true);
+        m_latencyReportTimer.emplace(ioContext(), reportInterval, Timer::handler_t{ &GuestTransceiver::handleLatencyReportTimeout, this }, true);
+    }
+
+    void GuestTransceiver::disableLatencyProbe()
+    {
+        m_latencyProbeTimer.reset();
+        m_latencyReportTimer.reset();
+        m_pendingLatencyProbes.clear();
+        m_roundTripTimes.clear();
+        m_hostDelays.clear();
+    }
+
+    const tools::LatencyHistogram& GuestTransceiver::roundTripTimes() const
+    {
+        return m_roundTripTimes;
+    }
+
+    const std::unordered_map<const type::StructDescriptor*, tools::LatencyHistogram>& GuestTransceiver::hostDelays() const
+    {
+        return m_hostDelays;
+    }
+
     void GuestTransceiver::joinGroup(std::string_view name)
     {
-        if (m_joinedGroups.count(std::string(name)) == 0)
+        if (auto it = m_groupRestrictions.find(name); it != m_groupRestrictions.end())
         {
-            publish(DotsMember{
+            // note: an empty filter without projection causes the host to
+            // transmit all instances that did not match the previous filter
+            // or lacked properties of the previous projection
+            publish(DotsSubscriptionFilter{
                 .groupName = name,
-                .event = DotsMemberEvent::join
+                .clauses = SubscriptionFilter::clauses_t{}
             });
+            m_groupRestrictions.erase(it);
+        }
+        else if (m_joinedGroups.count(std::string(name)) == 0)
+        {
+            DotsMember member{
+                .groupName = name,
+                .event = DotsMemberEvent::join
+            };
+
+            // note: presenting the last received version of the host
+            // container allows the host to transmit only the changes since
+            // then (e.g. after a reconnect)
+            if (auto it = m_cacheVersions.find(name); it != m_cacheVersions.end())
+            {
+                member.cacheEpoch = it->second.epoch;
+                member.cacheVersion = it->second.version;
+            }
+
+            publish(member);
             m_joinedGroups.insert(std::string(name));
         }
     }
 
+    void GuestTransceiver::joinRestrictedGroup(const type::StructDescriptor& descriptor, Dispatcher::id_t id, SubscriptionFilter::clauses_t clauses, std::optional<property_set_t> projection)
+    {
+        if (m_hostConnection == nullptr)
+        {
+            throw std::runtime_error{ "attempt to join restricted group on closed connection" };
+        }
+
+        const std::string& name = descriptor.name();
+        auto it = m_groupRestrictions.find(name);
+
+        if (it == m_groupRestrictions.end())
+        {
+            if (m_joinedGroups.count(name) != 0)
+            {
+                // the group has already been joined without restrictions
+                return;
+            }
+
+            it = m_groupRestrictions.emplace(name, restricted_group_t{}).first;
+            m_joinedGroups.insert(name);
+        }
+
+        it->second.subscriptions.emplace(id, group_restriction_t{ std::move(clauses), std::move(projection) });
+        transmitRestriction(descriptor);
+    }
+
+    void GuestTransceiver::leaveRestrictedGroup(const type::StructDescriptor& descriptor, Dispatcher::id_t id)
+    {
+        const std::string& name = descriptor.name();
+
+        // note: subscriptions that end while the connection is closed are
+        // not restored when the group is joined again
+        if (auto it = m_rejoinRestrictions.find(name); it != m_rejoinRestrictions.end() && it->second.subscriptions.erase(id) != 0)
+        {
+            if (it->second.subscriptions.empty())
+            {
+                m_rejoinRestrictions.erase(it);
+                m_rejoinGroups.erase(name);
+                m_cacheVersions.erase(name);
+            }
+
+            return;
+        }
+
+        auto it = m_groupRestrictions.find(name);
+
+        if (it == m_groupRestrictions.end() || it->second.subscriptions.erase(id) == 0 || m_hostConnection == nullptr)
+        {
+            return;
+        }
+
+        try
+        {
+            if (it->second.subscriptions.empty())
+            {
+                // note: the local container is cleared, because it will no
+                // longer receive updates of the group. the remaining
+                // instances are removed by dispatching removes, so that
+                // other handlers of the type observe them being removed
+                leaveGroup(name);
+
+                if (descriptor.cached())
+                {
+                    std::vector<type::AnyStruct> instances;
+
+                    for (const auto& [instance, cloneInfo] : dispatcher().container(descriptor))
+                    {
+                        (void)cloneInfo;
+                        instances.emplace_back(*instance);
+                    }
+
+                    dispatchRemoves(descriptor, std::move(instances));
+                }
+            }
+            else
+            {
+                transmitRestriction(descriptor);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR_S("error while narrowing restriction of group '" << name << "' -> " << e.what());
+        }
+    }
+
     void GuestTransceiver::leaveGroup(std::string_view name)
     {
         if (m_joinedGroups.count(std::string(name)))
@@ -117,15 +386,126 @@ namespace dots
                 .event = DotsMemberEvent::leave
             });
             m_joinedGroups.erase(std::string(name));
+            m_groupRestrictions.erase(std::string(name));
+            m_cacheVersions.erase(std::string(name));
+            m_resyncs.erase(std::string(name));
+            m_syncedCaches.erase(std::string(name));
+            completeCacheSyncHandlers(name, std::make_exception_ptr(std::runtime_error{ "group of type '" + std::string(name) + "' was left before cache was synchronized" }));
         }
     }
 
     bool GuestTransceiver::handleTransmission(Connection&/* connection*/, io::Transmission transmission)
     {
+        if (m_latencyProbeTimer != std::nullopt)
+        {
+            const auto& [header, instance] = transmission;
+
+            if (const auto* echo = instance.as<DotsEcho>(); echo != nullptr && echo->identifier == LatencyProbeIdentifier && echo->request == false)
+            {
+                if (auto it = m_pendingLatencyProbes.find(*echo->sequenceNumber); it != m_pendingLatencyProbes.end())
+                {
+                    m_roundTripTimes.record(std::chrono::duration_cast<tools::LatencyHistogram::duration_t>(std::chrono::steady_clock::now() - it->second));
+                    m_pendingLatencyProbes.erase(m_pendingLatencyProbes.begin(), std::next(it));
+                }
+
+                return true;
+            }
+
+            // note: instances from the cache are skipped, because their
+            // timestamps refer to the time at which they were originally
+            // published
+            if (!header.fromCache.isValid() && header.sentTime.isValid() && header.serverSentTime.isValid())
+            {
+                type::Duration hostDelay = *header.serverSentTime - *header.sentTime;
+                m_hostDelays[&instance->_descriptor()].record(std::chrono::duration_cast<tools::LatencyHistogram::duration_t>(hostDelay));
+            }
+        }
+
+        if (const auto& [header, instance] = transmission; header.cacheVersion.isValid() && !header.fromCache.isValid())
+        {
+            if (auto it = m_cacheVersions.find(*header.typeName); it != m_cacheVersions.end())
+            {
+                it->second.version = *header.cacheVersion;
+            }
+        }
+        else if (const auto* cacheInfo = instance.as<DotsCacheInfo>(); cacheInfo != nullptr && cacheInfo->endTransmission == true && cacheInfo->cacheEpoch.isValid() && cacheInfo->cacheVersion.isValid())
+        {
+            m_cacheVersions.insert_or_assign(*cacheInfo->typeName, cache_version_t{ *cacheInfo->cacheEpoch, *cacheInfo->cacheVersion });
+        }
+
+        if (const auto* cacheInfo = transmission.instance().as<DotsCacheInfo>(); cacheInfo != nullptr && cacheInfo->endTransmission == true && cacheInfo->typeName.isValid())
+        {
+            completeResync(*cacheInfo);
+            handleCacheSynced(*cacheInfo->typeName);
+        }
+
         dispatcher().dispatch(transmission);
         return true;
     }
 
+    void GuestTransceiver::handleLatencyProbeTimeout()
+    {
+        if (!connected())
+        {
+            return;
+        }
+
+        // note: probes that remain unanswered (e.g. because they were
+        // transmitted while the connection was suspended) are eventually
+        // discarded
+        if (m_pendingLatencyProbes.size() >= LatencyProbeMaxPending)
+        {
+            m_pendingLatencyProbes.erase(m_pendingLatencyProbes.begin());
+        }
+
+        uint32_t sequenceNumber = ++m_latencyProbeSequenceNumber;
+        m_pendingLatencyProbes.emplace(sequenceNumber, std::chrono::steady_clock::now());
+
+        publish(DotsEcho{
+            .request = true,
+            .identifier = LatencyProbeIdentifier,
+            .sequenceNumber = sequenceNumber
+        });
+    }
+
+    void GuestTransceiver::handleLatencyReportTimeout()
+    {
+        if (m_publishLatencyReports && connected())
+        {
+            auto make_statistics = [](const tools::LatencyHistogram& histogram)
+            {
+                return DotsLatencyStatistics{
+                    .samples = histogram.count(),
+                    .p50 = type::Duration::base_t{ histogram.quantile(0.5) },
+                    .p99 = type::Duration::base_t{ histogram.quantile(0.99) },
+                    .max = type::Duration::base_t{ histogram.max() }
+                };
+            };
+
+            Connection::id_t selfId = m_hostConnection->selfId();
+
+            publish(DotsClientLatency{
+                .id = selfId,
+                .roundTrip = make_statistics(m_roundTripTimes)
+            });
+
+            for (const auto& [descriptor, histogram] : m_hostDelays)
+            {
+                if (!descriptor->internal())
+                {
+                    publish(DotsTypeLatency{
+                        .clientId = selfId,
+                        .typeName = descriptor->name(),
+                        .hostDelay = make_statistics(histogram)
+                    });
+                }
+            }
+        }
+
+        m_roundTripTimes.clear();
+        m_hostDelays.clear();
+    }
+
     void GuestTransceiver::handleTransitionImpl(Connection& connection, std::exception_ptr/* e*/) noexcept
     {
         try
@@ -146,9 +526,29 @@ namespace dots
 
                 m_preloadPublishTypes.clear();
                 m_preloadSubscribeTypes.clear();
+
+                rejoinGroups();
+            }
+            else if (connection.state() == DotsConnectionState::connected)
+            {
+                rejoinGroups();
             }
             else if (connection.state() == DotsConnectionState::closed)
             {
+                // note: the groups are joined again when a new connection is
+                // established
+                m_rejoinGroups.merge(m_joinedGroups);
+                m_rejoinRestrictions.merge(m_groupRestrictions);
+                m_joinedGroups.clear();
+                m_groupRestrictions.clear();
+                m_resyncs.clear();
+                m_syncedCaches.clear();
+
+                for (auto cacheSyncHandlers = std::exchange(m_cacheSyncHandlers, {}); auto& [name, syncHandler] : cacheSyncHandlers)
+                {
+                    syncHandler(std::make_exception_ptr(std::runtime_error{ "connection was closed before cache of type '" + name + "' was synchronized" }));
+                }
+
                 if (m_hostConnection != nullptr)
                 {
                     m_hostConnection = nullptr;
@@ -161,6 +561,189 @@ namespace dots
             m_hostConnection = nullptr;
         }
     }
+
+    void GuestTransceiver::handleCacheSynced(const std::string& name)
+    {
+        m_syncedCaches.emplace(name);
+        completeCacheSyncHandlers(name, nullptr);
+    }
+
+    void GuestTransceiver::completeCacheSyncHandlers(std::string_view name, std::exception_ptr ePtr)
+    {
+        auto [first, last] = m_cacheSyncHandlers.equal_range(name);
+        std::vector<tools::Handler<void(std::exception_ptr)>> syncHandlers;
+
+        for (auto it = first; it != last; ++it)
+        {
+            syncHandlers.emplace_back(std::move(it->second));
+        }
+
+        m_cacheSyncHandlers.erase(first, last);
+
+        for (const tools::Handler<void(std::exception_ptr)>& syncHandler : syncHandlers)
+        {
+            syncHandler(ePtr);
+        }
+    }
+
+    void GuestTransceiver::dispatchRemoves(const type::StructDescriptor& descriptor, std::vector<type::AnyStruct> instances)
+    {
+        timepoint_t sentTime = timepoint_t::Now();
+
+        for (type::AnyStruct& instance : instances)
+        {
+            DotsHeader header{
+                .typeName = descriptor.name(),
+                .sentTime = sentTime,
+                .attributes = instance->_keyProperties(),
+                .sender = Connection::HostId,
+                .removeObj = true
+            };
+
+            dispatcher().dispatch(io::Transmission{ std::move(header), std::move(instance) });
+        }
+    }
+
+    void GuestTransceiver::completeResync(const DotsCacheInfo& cacheInfo)
+    {
+        auto it = m_resyncs.find(*cacheInfo.typeName);
+
+        if (it == m_resyncs.end())
+        {
+            return;
+        }
+
+        resync_t resync = it->second;
+        m_resyncs.erase(it);
+
+        // note: the transfer only contains the changes since the presented
+        // version if the host confirms both the delta and the presented
+        // epoch. otherwise the host transmitted its entire container and
+        // all clones that have not been updated since the group was joined
+        // again are stale
+        if (resync.epoch != std::nullopt && cacheInfo.cacheEpoch.isValid() && *cacheInfo.cacheEpoch == *resync.epoch && cacheInfo.deltaTransmission.valueOrDefault(true))
+        {
+            return;
+        }
+
+        const type::StructDescriptor* descriptor = registry().findStructType(*cacheInfo.typeName);
+
+        if (descriptor == nullptr)
+        {
+            return;
+        }
+
+        std::vector<type::AnyStruct> staleInstances;
+
+        for (const auto& [instance, cloneInfo] : dispatcher().container(*descriptor))
+        {
+            if (*cloneInfo.version <= resync.version)
+            {
+                staleInstances.emplace_back(*instance);
+            }
+        }
+
+        dispatchRemoves(*descriptor, std::move(staleInstances));
+    }
+
+    void GuestTransceiver::rejoinGroups()
+    {
+        std::set<std::string> rejoinGroups = std::exchange(m_rejoinGroups, {});
+
+        // note: the local containers are kept when the groups are joined
+        // again. the current versions of the containers are recorded, so
+        // that instances that are not transmitted again by a complete
+        // transfer can be removed afterwards (see completeResync())
+        for (const std::string& name : rejoinGroups)
+        {
+            if (const type::StructDescriptor* descriptor = registry().findStructType(name); descriptor != nullptr && descriptor->cached())
+            {
+                std::optional<uint64_t> epoch;
+
+                if (auto it = m_cacheVersions.find(name); it != m_cacheVersions.end() && m_rejoinRestrictions.count(name) == 0)
+                {
+                    epoch = it->second.epoch;
+                }
+
+                m_resyncs.insert_or_assign(name, resync_t{ epoch, dispatcher().container(*descriptor).version() });
+            }
+        }
+
+        // note: restricted groups are always transferred completely, because
+        // the host can only determine the changes for unrestricted groups
+        for (auto& [name, restrictedGroup] : std::exchange(m_rejoinRestrictions, {}))
+        {
+            rejoinGroups.erase(name);
+
+            if (const type::StructDescriptor* descriptor = registry().findStructType(name); descriptor != nullptr)
+            {
+                restrictedGroup.transmitted = std::nullopt;
+                m_groupRestrictions.insert_or_assign(name, std::move(restrictedGroup));
+                m_joinedGroups.insert(name);
+                transmitRestriction(*descriptor);
+            }
+        }
+
+        for (const std::string& name : rejoinGroups)
+        {
+            joinGroup(name);
+        }
+    }
+
+    void GuestTransceiver::transmitRestriction(const type::StructDescriptor& descriptor)
+    {
+        restricted_group_t& restrictedGroup = m_groupRestrictions.at(descriptor.name());
+        const auto& subscriptions = restrictedGroup.subscriptions;
+
+        // note: the host restriction is the union of the restrictions of all
+        // active subscriptions of the group. an empty list of clauses and an
+        // unset projection respectively do not restrict the group at all
+        bool filtered = std::all_of(subscriptions.begin(), subscriptions.end(), [](const auto& entry){ return !entry.second.clauses.empty(); });
+        bool projected = std::all_of(subscriptions.begin(), subscriptions.end(), [](const auto& entry){ return entry.second.projection != std::nullopt; });
+        group_restriction_t restriction;
+
+        if (projected)
+        {
+            restriction.projection.emplace();
+        }
+
+        for (const auto& [id, subscriptionRestriction] : subscriptions)
+        {
+            (void)id;
+
+            if (filtered)
+            {
+                restriction.clauses.insert(restriction.clauses.end(), subscriptionRestriction.clauses.begin(), subscriptionRestriction.clauses.end());
+            }
+
+            if (projected)
+            {
+                *restriction.projection += *subscriptionRestriction.projection;
+            }
+        }
+
+        if (const std::optional<group_restriction_t>& transmitted = restrictedGroup.transmitted; transmitted != std::nullopt)
+        {
+            if (transmitted->projection == restriction.projection && SubscriptionFilter::Expression(transmitted->clauses) == SubscriptionFilter::Expression(restriction.clauses))
+            {
+                return;
+            }
+        }
+
+        DotsSubscriptionFilter subscriptionFilter{
+            .groupName = descriptor.name(),
+            .clauses = restriction.clauses
+        };
+
+        if (restriction.projection != std::nullopt)
+        {
+            subscriptionFilter.projection = *restriction.projection;
+        }
+
+        m_hostConnection->transmit(descriptor);
+        publish(subscriptionFilter);
+        restrictedGroup.transmitted = std::move(restriction);
+    }
 }
 
 #include <dots/io/channels/TcpChannel.h>
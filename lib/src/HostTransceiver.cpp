@@ -2,7 +2,9 @@
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #include <dots/HostTransceiver.h>
 #include <vector>
+#include <algorithm>
 #include <dots/tools/logging.h>
+#include <dots/tools/LoopTime.h>
 #include <DotsCacheInfo.dots.h>
 #include <DotsClient.dots.h>
 
@@ -12,14 +14,18 @@ namespace dots
                                      asio::io_context& ioContext,
                                      type::Registry::StaticTypePolicy staticTypePolicy /*= type::Registry::StaticTypePolicy::All*/,
                                      std::optional<transition_handler_t> transitionHandler/* = std::nullopt*/) :
-        Transceiver(std::move(selfName), ioContext, staticTypePolicy, std::move(transitionHandler))
+        Transceiver(std::move(selfName), ioContext, staticTypePolicy, std::move(transitionHandler)),
+        m_cacheTransferMaxInstances(1024),
+        m_cacheTransferMaxDuration(std::chrono::milliseconds{ 2 })
     {
         /* do nothing */
     }
 
     HostTransceiver::~HostTransceiver()
     {
+        m_typeGroups.clear();
         m_groups.clear();
+        m_peerConnections.clear();
         connection_map_t guestConnections = std::move(m_guestConnections);
         guestConnections.clear();
     }
@@ -59,10 +65,11 @@ namespace dots
             *includedProperties ^= instance._properties();
         }
 
+        timepoint_t sentTime = tools::LoopTime::Now(instance._descriptor());
         DotsHeader header{
             .typeName = instance._descriptor().name(),
-            .sentTime = timepoint_t::Now(),
-            .serverSentTime = timepoint_t::Now(),
+            .sentTime = sentTime,
+            .serverSentTime = sentTime,
             .attributes = *includedProperties,
             .sender = Connection::HostId,
             .removeObj = remove,
@@ -70,8 +77,158 @@ namespace dots
         };
 
         io::Transmission transmission{ std::move(header), instance };
+
+        if (const auto* rpcReply = instance._as<DotsRpcReply>(); rpcReply != nullptr)
+        {
+            routeRpcReply(nullptr, transmission, *rpcReply);
+            return;
+        }
+        else if (const auto* rpcRequest = instance._as<DotsRpcRequest>(); rpcRequest != nullptr)
+        {
+            trackRpcCall(Connection::HostId, *rpcRequest);
+        }
+
+        retainRemovedInstance(transmission);
+        filter_matches_t previousMatches = matchFilters(transmission);
         dispatcher().dispatch(transmission);
-        transmit(transmission);
+        stampCacheVersion(transmission);
+        journalChange(transmission);
+        transmit(transmission, previousMatches);
+    }
+
+    void HostTransceiver::publish(std::span<const type::Struct* const> instances, std::optional<property_set_t> includedProperties/* = std::nullopt*/, bool remove/* = false*/)
+    {
+        const type::StructDescriptor* descriptor = VerifyBatch(instances);
+
+        if (descriptor == nullptr)
+        {
+            return;
+        }
+
+        // note: internal types are published individually, because some of
+        // them (e.g. RPC requests and replies) are routed specifically
+        if (descriptor->internal())
+        {
+            Transceiver::publish(instances, includedProperties, remove);
+            return;
+        }
+
+        if (descriptor->substructOnly())
+        {
+            throw std::logic_error{ "attempt to publish substruct-only type '" + descriptor->name() + "'" };
+        }
+
+        property_set_t keyProperties = descriptor->keyProperties();
+
+        for (const type::Struct* instance : instances)
+        {
+            if (!(keyProperties <= instance->_validProperties()))
+            {
+                throw std::runtime_error("attempt to publish instance with missing key properties '" + (keyProperties - instance->_validProperties()).toString() + "'");
+            }
+        }
+
+        timepoint_t sentTime = tools::LoopTime::Now(*descriptor);
+        std::vector<io::Transmission> transmissions;
+        transmissions.reserve(instances.size());
+
+        for (const type::Struct* instance : instances)
+        {
+            property_set_t attributes = includedProperties == std::nullopt ? instance->_validProperties() : (*includedProperties + keyProperties) ^ instance->_properties();
+
+            transmissions.emplace_back(DotsHeader{
+                .typeName = descriptor->name(),
+                .sentTime = sentTime,
+                .serverSentTime = sentTime,
+                .attributes = attributes,
+                .sender = Connection::HostId,
+                .removeObj = remove,
+                .isFromMyself = true
+            }, *instance);
+        }
+
+        transmitBatch(std::move(transmissions));
+    }
+
+    void HostTransceiver::suppressUnchangedUpdates(const type::StructDescriptor& descriptor, bool suppress/* = true*/)
+    {
+        if (!descriptor.cached())
+        {
+            throw std::logic_error{ "attempt to suppress unchanged updates of uncached type '" + descriptor.name() + "'" };
+        }
+
+        if (suppress)
+        {
+            m_suppressedTypes.emplace(&descriptor);
+        }
+        else
+        {
+            m_suppressedTypes.erase(&descriptor);
+        }
+    }
+
+    void HostTransceiver::setCacheTransferLimits(size_t maxInstances, type::Duration maxDuration)
+    {
+        if (maxInstances == 0)
+        {
+            throw std::logic_error{ "cache transfer chunks must contain at least one instance" };
+        }
+
+        m_cacheTransferMaxInstances = maxInstances;
+        m_cacheTransferMaxDuration = maxDuration;
+    }
+
+    size_t HostTransceiver::enableCachePersistence(std::filesystem::path path, bool journal/* = false*/)
+    {
+        if (m_cacheSnapshot != nullptr)
+        {
+            throw std::logic_error{ "cache persistence has already been enabled" };
+        }
+
+        auto cacheSnapshot = std::make_unique<io::CacheSnapshot>(registry(), std::move(path), journal);
+        size_t restored = cacheSnapshot->load(dispatcher().pool());
+        m_cacheSnapshot = std::move(cacheSnapshot);
+
+        return restored;
+    }
+
+    size_t HostTransceiver::writeCacheSnapshot()
+    {
+        if (m_cacheSnapshot == nullptr)
+        {
+            throw std::logic_error{ "cache persistence has not been enabled" };
+        }
+
+        return m_cacheSnapshot->write(pool());
+    }
+
+    std::vector<const Connection*> HostTransceiver::guestConnections() const
+    {
+        std::vector<const Connection*> guestConnections;
+        guestConnections.reserve(m_guestConnections.size());
+
+        for (const auto& [connection, connectionPtr] : m_guestConnections)
+        {
+            (void)connectionPtr;
+            guestConnections.emplace_back(connection);
+        }
+
+        return guestConnections;
+    }
+
+    auto HostTransceiver::typeStatistics() const -> type_statistics_map_t
+    {
+        type_statistics_map_t typeStatistics;
+
+        for (const auto& [descriptor, statistics] : m_typeStatistics)
+        {
+            if (descriptor != nullptr)
+            {
+                typeStatistics.emplace(descriptor, statistics);
+            }
+        }
+
+        return typeStatistics;
     }
 
     void HostTransceiver::joinGroup(std::string_view/* name*/)
@@ -84,23 +241,287 @@ namespace dots
         /* do nothing */
     }
 
-    void HostTransceiver::transmit(const io::Transmission& transmission)
+    HostTransceiver::group_t& HostTransceiver::typeGroup(const type::StructDescriptor& descriptor)
+    {
+        // note: groups are never erased, so the groups of types can be
+        // resolved by name once and then be accessed by descriptor id
+        if (descriptor.id() >= m_typeGroups.size())
+        {
+            m_typeGroups.resize(descriptor.id() + 1, nullptr);
+        }
+
+        group_t*& group = m_typeGroups[descriptor.id()];
+
+        if (group == nullptr)
+        {
+            group = &m_groups[descriptor.name()];
+        }
+
+        return *group;
+    }
+
+    auto HostTransceiver::typeStatistics(const type::StructDescriptor& descriptor) -> type_statistics_t&
+    {
+        // note: statistics are accessed by descriptor id for the same reason
+        // as type groups, because they are updated for every transmission
+        if (descriptor.id() >= m_typeStatistics.size())
+        {
+            m_typeStatistics.resize(descriptor.id() + 1);
+        }
+
+        auto& [statisticsDescriptor, statistics] = m_typeStatistics[descriptor.id()];
+        statisticsDescriptor = &descriptor;
+
+        return statistics;
+    }
+
+    auto HostTransceiver::matchFilters(const io::Transmission& transmission) -> filter_matches_t
+    {
+        // note: whether the instance matched the filters of the members
+        // before the transmission is applied has to be determined in
+        // advance, because the cached clone is updated in place. this is
+        // only necessary for filters that are affected by the transmission
+        filter_matches_t previousMatches;
+        const auto& [header, instance] = transmission;
+        const type::StructDescriptor& descriptor = instance->_descriptor();
+
+        if (!descriptor.cached())
+        {
+            return previousMatches;
+        }
+
+        std::optional<const Container<>::value_t*> clone;
+
+        for (const auto& [connection, membership] : typeGroup(descriptor))
+        {
+            const SubscriptionFilter* filter = membership.filter.get();
+
+            if (filter == nullptr || !filter->affects(header) || std::any_of(previousMatches.begin(), previousMatches.end(), [&](const filter_match_t& previousMatch){ return previousMatch.first == filter; }))
+            {
+                continue;
+            }
+
+            if (clone == std::nullopt)
+            {
+                const Container<>* container = pool().find(descriptor);
+                clone = container == nullptr ? nullptr : container->findClone(*instance);
+            }
+
+            previousMatches.emplace_back(filter, *clone != nullptr && filter->matches(*(*clone)->first));
+        }
+
+        return previousMatches;
+    }
+
+    void HostTransceiver::transmit(const io::Transmission& transmission, const filter_matches_t& previousMatches, batch_route_map_t* batchRoutes/* = nullptr*/)
     {
         using dirty_connection_t = std::pair<Connection*, std::exception_ptr>;
         std::vector<dirty_connection_t> dirtyConnections;
 
-        for (Connection* destinationConnection : m_groups[*transmission.header().typeName])
+        const auto& [header, instance] = transmission;
+        const type::StructDescriptor& descriptor = instance->_descriptor();
+        std::optional<const Container<>::value_t*> clone;
+
+        auto updated_clone = [&]() -> const Container<>::value_t*
+        {
+            if (clone == std::nullopt)
+            {
+                const Container<>* container = descriptor.cached() && header.removeObj != true ? pool().find(descriptor) : nullptr;
+                clone = container == nullptr ? nullptr : container->findClone(*instance);
+            }
+
+            return *clone;
+        };
+
+        // note that identical filters are shared among connections and are
+        // therefore only evaluated once per transmission
+        using filter_scope_t = std::pair<const SubscriptionFilter*, SubscriptionFilter::Scope>;
+        std::vector<filter_scope_t> filterScopes;
+
+        auto scope_of = [&](const SubscriptionFilter& filter)
+        {
+            if (auto it = std::find_if(filterScopes.begin(), filterScopes.end(), [&](const filter_scope_t& filterScope){ return filterScope.first == &filter; }); it != filterScopes.end())
+            {
+                return it->second;
+            }
+
+            // filters are evaluated against the updated clone for cached
+            // types, because the transmission might only contain a subset of
+            // the properties
+            const Container<>::value_t* updated = updated_clone();
+            auto itPrevious = std::find_if(previousMatches.begin(), previousMatches.end(), [&](const filter_match_t& previousMatch){ return previousMatch.first == &filter; });
+            bool matchedPreviously = itPrevious != previousMatches.end() && itPrevious->second;
+
+            SubscriptionFilter::Scope scope = filter.scope(header, matchedPreviously, updated == nullptr ? *instance : *updated->first);
+            filterScopes.emplace_back(&filter, scope);
+
+            return scope;
+        };
+
+        // note that members for which the instance enters the scope of their
+        // filter receive the complete instance, while members for which it
+        // leaves the scope receive a remove
+        std::optional<DotsHeader> enteredHeader;
+        std::optional<DotsHeader> leftHeader;
+
+        auto enter = [&]() -> const DotsHeader*
         {
-            if (destinationConnection->state() != DotsConnectionState::closed)
+            const Container<>::value_t* updated = updated_clone();
+
+            if (updated == nullptr || updated->first->_validProperties() <= *header.attributes)
+            {
+                return &header;
+            }
+
+            if (enteredHeader == std::nullopt)
+            {
+                enteredHeader.emplace(header);
+                enteredHeader->attributes = updated->first->_validProperties();
+            }
+
+            return &*enteredHeader;
+        };
+
+        auto leave = [&]() -> const DotsHeader*
+        {
+            if (header.removeObj == true)
+            {
+                return &header;
+            }
+
+            if (leftHeader == std::nullopt)
+            {
+                leftHeader.emplace(header);
+                leftHeader->attributes = instance->_keyProperties();
+                leftHeader->removeObj = true;
+            }
+
+            return &*leftHeader;
+        };
+
+        // note that members with a projection only receive the projected
+        // properties and are skipped entirely for updates that do not touch
+        // any of them
+        std::optional<DotsHeader> projectedHeader;
+        const DotsHeader* projectedSource = nullptr;
+
+        auto project = [&](const DotsHeader& sourceHeader, property_set_t projection) -> const DotsHeader*
+        {
+            property_set_t keyProperties = instance->_keyProperties();
+            property_set_t attributes = *sourceHeader.attributes ^ projection;
+
+            if (sourceHeader.removeObj != true && (attributes - keyProperties).empty())
             {
-                try
+                if (!descriptor.cached())
+                {
+                    return nullptr;
+                }
+
+                const Container<>::value_t* updated = updated_clone();
+
+                if (updated == nullptr || updated->second.lastOperation != DotsMt::create)
+                {
+                    return nullptr;
+                }
+            }
+
+            if (projectedSource != &sourceHeader)
+            {
+                projectedHeader.emplace(sourceHeader);
+                projectedSource = &sourceHeader;
+            }
+
+            projectedHeader->attributes = attributes;
+
+            return &*projectedHeader;
+        };
+
+        type_statistics_t& typeStatistics = this->typeStatistics(descriptor);
+        ++typeStatistics.publishedFrames;
+
+        for (const auto& [destinationConnection, membership] : typeGroup(descriptor))
+        {
+            if (destinationConnection->state() == DotsConnectionState::closed)
+            {
+                continue;
+            }
+
+            const DotsHeader* memberHeader = &header;
+            const type::Struct* memberInstance = &*instance;
+
+            if (membership.filter != nullptr)
+            {
+                switch (scope_of(*membership.filter))
+                {
+                    case SubscriptionFilter::Scope::Outside:
+                        continue;
+                    case SubscriptionFilter::Scope::Inside:
+                        break;
+                    case SubscriptionFilter::Scope::Entered:
+                        memberHeader = enter();
+                        memberInstance = memberHeader == &header ? &*instance : &*updated_clone()->first;
+                        break;
+                    case SubscriptionFilter::Scope::Left:
+                        memberHeader = leave();
+                        break;
+                }
+            }
+
+            // note: members that negotiated batch frames and receive the
+            // transmission unaltered are routed after the entire batch has
+            // been processed
+            if (batchRoutes != nullptr && memberHeader == &header && membership.transfer == nullptr && membership.projection == std::nullopt && destinationConnection->batchFrames())
+            {
+                auto it = batchRoutes->find(destinationConnection);
+
+                if (it == batchRoutes->end())
+                {
+                    it = batchRoutes->try_emplace(destinationConnection, m_guestConnections.find(destinationConnection)->second, std::vector<const io::Transmission*>{}).first;
+                }
+
+                it->second.second.emplace_back(&transmission);
+                continue;
+            }
+
+            try
+            {
+                // note: the transmitted bytes are determined from the
+                // counters of the connection, because the serialized size is
+                // only known to the channel
+                const io::Channel::statistics_t& connectionStatistics = destinationConnection->statistics();
+                uint64_t transmittedFrames = connectionStatistics.transmittedFrames;
+                uint64_t transmittedBytes = connectionStatistics.transmittedBytes;
+
+                if (membership.projection != std::nullopt)
+                {
+                    memberHeader = project(*memberHeader, *membership.projection);
+                }
+
+                if (memberHeader == nullptr)
+                {
+                    /* do nothing */
+                }
+                else if (membership.transfer != nullptr)
+                {
+                    // note: live transmissions are deferred until the pending
+                    // cache transfer to the member is completed
+                    membership.transfer->deferred.emplace_back(*memberHeader, *memberInstance);
+                }
+                else if (memberHeader == &header)
                 {
                     destinationConnection->transmit(transmission);
                 }
-                catch (...)
+                else
                 {
-                    dirtyConnections.emplace_back(destinationConnection, std::current_exception());
+                    destinationConnection->transmit(*memberHeader, *memberInstance);
                 }
+
+                typeStatistics.transmittedFrames += connectionStatistics.transmittedFrames - transmittedFrames;
+                typeStatistics.transmittedBytes += connectionStatistics.transmittedBytes - transmittedBytes;
+            }
+            catch (...)
+            {
+                dirtyConnections.emplace_back(destinationConnection, std::current_exception());
             }
         }
 
@@ -113,14 +534,112 @@ namespace dots
         }
     }
 
+    void HostTransceiver::transmitBatch(std::vector<io::Transmission> transmissions)
+    {
+        if (transmissions.empty())
+        {
+            return;
+        }
+
+        // note: each transmission is processed and its filters are evaluated
+        // as if it was received individually, but the transmissions to
+        // members that negotiated batch frames are collected and
+        // transmitted in a single frame per member
+        batch_route_map_t batchRoutes;
+
+        for (io::Transmission& transmission : transmissions)
+        {
+            retainRemovedInstance(transmission);
+            filter_matches_t previousMatches = matchFilters(transmission);
+            dispatcher().dispatch(transmission);
+            stampCacheVersion(transmission);
+            journalChange(transmission);
+            transmit(transmission, previousMatches, &batchRoutes);
+        }
+
+        type_statistics_t& typeStatistics = this->typeStatistics(transmissions.front().instance()->_descriptor());
+        std::vector<const type::Struct*> instances;
+
+        for (auto& [connection, batchRoute] : batchRoutes)
+        {
+            const auto& [connectionPtr, routedTransmissions] = batchRoute;
+
+            if (connectionPtr->closed())
+            {
+                continue;
+            }
+
+            try
+            {
+                const io::Channel::statistics_t& connectionStatistics = connectionPtr->statistics();
+                uint64_t transmittedFrames = connectionStatistics.transmittedFrames;
+                uint64_t transmittedBytes = connectionStatistics.transmittedBytes;
+
+                const DotsHeader& frontHeader = routedTransmissions.front()->header();
+                DotsHeader header = frontHeader;
+
+                if (const DotsHeader& backHeader = routedTransmissions.back()->header(); backHeader.cacheVersion.isValid())
+                {
+                    header.cacheVersion = *backHeader.cacheVersion;
+                }
+
+                // note: the attributes of the frame are omitted if they
+                // differ among the transmissions but equal the valid
+                // properties of each instance, in which case the peer
+                // restores them from the instances
+                bool batchable = std::all_of(routedTransmissions.begin(), routedTransmissions.end(), [&](const io::Transmission* transmission)
+                {
+                    return transmission->header().attributes == frontHeader.attributes;
+                });
+
+                if (!batchable && std::all_of(routedTransmissions.begin(), routedTransmissions.end(), [](const io::Transmission* transmission)
+                {
+                    return transmission->header().attributes == transmission->instance()->_validProperties();
+                }))
+                {
+                    header.attributes.reset();
+                    batchable = true;
+                }
+
+                if (batchable)
+                {
+                    instances.clear();
+
+                    for (const io::Transmission* transmission : routedTransmissions)
+                    {
+                        instances.emplace_back(&*transmission->instance());
+                    }
+
+                    connectionPtr->transmit(header, std::span<const type::Struct* const>{ instances });
+                }
+                else
+                {
+                    for (const io::Transmission* transmission : routedTransmissions)
+                    {
+                        connectionPtr->transmit(*transmission);
+                    }
+                }
+
+                typeStatistics.transmittedFrames += connectionStatistics.transmittedFrames - transmittedFrames;
+                typeStatistics.transmittedBytes += connectionStatistics.transmittedBytes - transmittedBytes;
+            }
+            catch (...)
+            {
+                connectionPtr->handleError(std::current_exception());
+            }
+        }
+    }
+
     bool HostTransceiver::handleListenAccept(io::Listener&/* listener*/, io::channel_ptr_t channel)
     {
         auto connection = std::make_shared<Connection>(std::move(channel), true);
         connection->asyncReceive(registry(), m_authManager.get(), selfName(),
             { &HostTransceiver::handleTransmission, this },
+            { &HostTransceiver::handleTransmissionBatch, this },
             { &HostTransceiver::handleTransition, this }
         );
         m_guestConnections.emplace(connection.get(), connection);
+        m_peerConnections.emplace(connection->peerId(), connection.get());
 
         return true;
     }
@@ -170,10 +689,55 @@ namespace dots
                 handleEchoRequest(connection, *echoRequest);
                 return !connection.closed();
             }
+            else if (auto* subscriptionFilter = instance.as<DotsSubscriptionFilter>())
+            {
+                handleSubscriptionFilter(connection, *subscriptionFilter);
+                return !connection.closed();
+            }
+            else if (auto* rpcReply = instance.as<DotsRpcReply>())
+            {
+                routeRpcReply(&connection, transmission, *rpcReply);
+                return !connection.closed();
+            }
+            else if (auto* rpcRequest = instance.as<DotsRpcRequest>())
+            {
+                // note: the request is still distributed to the group of the
+                // request type after the call has been recorded
+                trackRpcCall(connection.peerId(), *rpcRequest);
+            }
+        }
+
+        if (!m_suppressedTypes.empty() && !narrowUpdate(transmission))
+        {
+            return !connection.closed();
         }
 
+        retainRemovedInstance(transmission);
+        filter_matches_t previousMatches = matchFilters(transmission);
         dispatcher().dispatch(transmission);
-        transmit(transmission);
+        stampCacheVersion(transmission);
+        journalChange(transmission);
+        transmit(transmission, previousMatches);
+
+        return !connection.closed();
+    }
+
+    bool HostTransceiver::handleTransmissionBatch(Connection& connection, std::vector<io::Transmission> transmissions)
+    {
+        // ensure that the connection is alive until the handler returns,
+        // because it might get removed during processing of the batch if it
+        // gets dirty
+        connection_ptr_t connectionPtr = m_guestConnections.find(&connection)->second;
+        (void)connectionPtr;
+
+        // note: batch frames never contain instances of internal types,
+        // which is verified by the connection
+        if (!m_suppressedTypes.empty())
+        {
+            std::erase_if(transmissions, [this](io::Transmission& transmission){ return !narrowUpdate(transmission); });
+        }
+
+        transmitBatch(std::move(transmissions));
 
         return !connection.closed();
     }
@@ -189,6 +753,10 @@ namespace dots
                     group.erase(&connection);
                 }
 
+                m_cacheTransfers.erase(&connection);
+                std::erase(m_cacheTransferQueue, &connection);
+                m_rpcCalls.erase(connection.peerId());
+
                 std::vector<const type::Struct*> cleanupInstances;
 
                 for (const auto& [descriptor, container] : pool())
@@ -210,6 +778,7 @@ namespace dots
                     remove(*instance);
                 }
 
+                m_peerConnections.erase(connection.peerId());
                 m_guestConnections.erase(&connection);
             }
         }
@@ -219,6 +788,41 @@ namespace dots
         }
     }
 
+    bool HostTransceiver::narrowUpdate(io::Transmission& transmission) const
+    {
+        DotsHeader& header = transmission.header();
+        const type::Struct& instance = *transmission.instance();
+        const type::StructDescriptor& descriptor = instance._descriptor();
+
+        if (header.removeObj == true || !header.attributes.isValid() || m_suppressedTypes.count(&descriptor) == 0)
+        {
+            return true;
+        }
+
+        const Container<>* container = pool().find(descriptor);
+        const Container<>::value_t* clone = container == nullptr ? nullptr : container->findClone(instance);
+
+        if (clone == nullptr)
+        {
+            return true;
+        }
+
+        // note: properties that are included in the attributes but are
+        // invalid in the instance are invalidated by the update and
+        // therefore also count as changed if they are valid in the clone
+        property_set_t keyProperties = instance._keyProperties();
+        property_set_t changedProperties = instance._diffProperties(*clone->first, *header.attributes) - keyProperties;
+
+        if (changedProperties.empty())
+        {
+            return false;
+        }
+
+        header.attributes = changedProperties + keyProperties;
+
+        return true;
+    }
+
     void HostTransceiver::handleMemberMessage(Connection& connection, const DotsMember& member)
     {
         member._assertHasProperties(DotsMember::groupName_p + DotsMember::event_p);
@@ -237,7 +841,7 @@ namespace dots
         }
         else if (member.event == DotsMemberEvent::join)
         {
-            if (auto [it, emplaced] = m_groups[groupName].emplace(&connection); emplaced)
+            if (auto [it, emplaced] = m_groups[groupName].try_emplace(&connection); emplaced)
             {
                 LOG_DEBUG_S(connection.peerDescription() << " is now a member of group '" << groupName << "'");
             }
@@ -251,15 +855,18 @@ namespace dots
             auto structDescriptor = registry().findStructType(groupName);
             if (structDescriptor && structDescriptor->cached())
             {
-                if (const Container<> *container = pool().find(*structDescriptor); container != nullptr)
+                // note: a guest that presents the last version it received of
+                // the container only requires the changes since then, as long
+                // as these can still be determined
+                const Container<>* container = pool().find(*structDescriptor);
+                std::optional<uint64_t> sinceVersion;
+
+                if (container != nullptr && member.cacheEpoch.isValid() && member.cacheVersion.isValid() && container->canResync(*member.cacheEpoch, *member.cacheVersion))
                 {
-                    transmitContainer(connection, *container);
+                    sinceVersion = *member.cacheVersion;
                 }
 
-                connection.transmit(DotsCacheInfo{
-                    .typeName = member.groupName,
-                    .endTransmission = true
-                });
+                transmitContainer(connection, *structDescriptor, container, nullptr, nullptr, std::nullopt, sinceVersion);
             }
         }
     }
@@ -327,28 +934,458 @@ namespace dots
         }
     }
 
-    void HostTransceiver::transmitContainer(Connection& connection, const Container<>& container)
+    void HostTransceiver::handleSubscriptionFilter(Connection& connection, const DotsSubscriptionFilter& subscriptionFilter)
+    {
+        subscriptionFilter._assertHasProperties(DotsSubscriptionFilter::groupName_p);
+        const std::string& groupName = *subscriptionFilter.groupName;
+        const type::StructDescriptor* structDescriptor = registry().findStructType(groupName);
+
+        if (structDescriptor == nullptr)
+        {
+            throw std::runtime_error{ "attempt to filter group of unknown type '" + groupName + "'" };
+        }
+
+        membership_t membership;
+
+        if (subscriptionFilter.clauses.isValid() && !subscriptionFilter.clauses->empty())
+        {
+            membership.filter = acquireFilter(*structDescriptor, *subscriptionFilter.clauses);
+        }
+
+        if (subscriptionFilter.projection.isValid())
+        {
+            membership.projection = (*subscriptionFilter.projection + structDescriptor->keyProperties()) ^ structDescriptor->properties();
+        }
+
+        auto [it, emplaced] = m_groups[groupName].try_emplace(&connection, membership);
+        membership_t previousMembership;
+
+        if (emplaced)
+        {
+            LOG_DEBUG_S(connection.peerDescription() << " is now a member of group '" << groupName << "' with filter '" << (membership.filter == nullptr ? "" : membership.filter->expression()) << "'");
+        }
+        else
+        {
+            membership.transfer = it->second.transfer;
+            previousMembership = std::exchange(it->second, membership);
+            LOG_DEBUG_S(connection.peerDescription() << " changed filter of group '" << groupName << "' to '" << (membership.filter == nullptr ? "" : membership.filter->expression()) << "'");
+        }
+
+        if (structDescriptor->cached())
+        {
+            // note: when only the filter was extended, only the instances
+            // that did not match the previous filter have to be transmitted.
+            // when the projection was extended, all matching instances have
+            // to be transmitted again to provide the additional properties
+            bool projectionExtended = previousMembership.projection != std::nullopt && (membership.projection == std::nullopt || !(*membership.projection <= *previousMembership.projection));
+            bool filterExtended = previousMembership.filter != nullptr;
+
+            if (emplaced || projectionExtended || filterExtended)
+            {
+                const SubscriptionFilter* previousFilter = emplaced || projectionExtended ? nullptr : previousMembership.filter.get();
+                transmitContainer(connection, *structDescriptor, pool().find(*structDescriptor), membership.filter.get(), previousFilter, membership.projection);
+            }
+            else
+            {
+                transmitContainer(connection, *structDescriptor, nullptr);
+            }
+        }
+    }
+
+    void HostTransceiver::trackRpcCall(Connection::id_t callerId, const DotsRpcRequest& rpcRequest)
+    {
+        // note: the caller is always determined by the connection the request
+        // was received from, so that guests cannot record calls of others
+        std::set<uint64_t>& calls = m_rpcCalls[callerId];
+        calls.emplace(rpcRequest.callId.valueOrDefault(0));
+
+        // note: calls that are never replied to (e.g. because no provider
+        // exists) are evicted oldest first to limit the number of records
+        if (calls.size() > MaxPendingRpcCalls)
+        {
+            calls.erase(calls.begin());
+        }
+    }
+
+    void HostTransceiver::routeRpcReply(Connection* replier, const io::Transmission& transmission, const DotsRpcReply& rpcReply)
     {
-        if (container.empty())
+        // note: replies are only relevant to the caller and are therefore
+        // not distributed to the group of the reply type
+        Connection::id_t callerId = rpcReply.callerId.valueOrDefault(Connection::HostId);
+        uint64_t callId = rpcReply.callId.valueOrDefault(0);
+
+        if (replier != nullptr)
+        {
+            auto group = m_groups.find(DotsRpcRequest::_Descriptor().name());
+
+            if (group == m_groups.end() || !group->second.contains(replier))
+            {
+                LOG_DEBUG_S("discarding reply to call " << callId << " of caller " << callerId << " from non-provider " << replier->peerDescription());
+                return;
+            }
+        }
+
+        if (auto calls = m_rpcCalls.find(callerId); calls == m_rpcCalls.end() || calls->second.erase(callId) == 0)
+        {
+            LOG_DEBUG_S("discarding reply to unknown or already replied call " << callId << " of caller " << callerId);
+            return;
+        }
+
+        if (callerId == Connection::HostId)
+        {
+            dispatcher().dispatch(transmission);
+            return;
+        }
+
+        auto it = m_peerConnections.find(callerId);
+
+        if (it == m_peerConnections.end())
         {
+            LOG_DEBUG_S("discarding reply to call " << callId << " of disconnected caller " << callerId);
             return;
         }
 
+        Connection& connection = *it->second;
+
+        try
+        {
+            connection.transmit(transmission);
+        }
+        catch (...)
+        {
+            connection.handleError(std::current_exception());
+        }
+    }
+
+    auto HostTransceiver::acquireFilter(const type::StructDescriptor& descriptor, const SubscriptionFilter::clauses_t& clauses) -> filter_ptr_t
+    {
+        std::string key = descriptor.name() + ':' + SubscriptionFilter::Expression(clauses);
+
+        if (auto it = m_filters.find(key); it != m_filters.end())
+        {
+            if (filter_ptr_t filter = it->second.lock(); filter != nullptr)
+            {
+                return filter;
+            }
+        }
+
+        std::erase_if(m_filters, [](const auto& entry){ return entry.second.expired(); });
+
+        auto filter = std::make_shared<const SubscriptionFilter>(descriptor, clauses);
+        m_filters.emplace(std::move(key), filter);
+
+        return filter;
+    }
+
+    void HostTransceiver::transmitContainer(Connection& connection, const type::StructDescriptor& descriptor, const Container<>* container, const SubscriptionFilter* filter/* = nullptr*/, const SubscriptionFilter* previousFilter/* = nullptr*/, std::optional<property_set_t> projection/* = std::nullopt*/, std::optional<uint64_t> sinceVersion/* = std::nullopt*/)
+    {
+        cache_transfers_t& transfers = m_cacheTransfers[&connection];
+        cache_transfer_t& transfer = transfers.emplace_back(cache_transfer_t{
+            .descriptor = &descriptor,
+            .projection = std::move(projection)
+        });
+
+        if (container != nullptr)
+        {
+            transfer.epoch = container->epoch();
+            transfer.version = container->version();
+
+            auto matches = [&](const type::Struct& instance)
+            {
+                return (filter == nullptr || filter->matches(instance)) && (previousFilter == nullptr || !previousFilter->matches(instance));
+            };
+
+            if (sinceVersion == std::nullopt)
+            {
+                transfer.instances.reserve(container->size());
+
+                for (const Container<>::value_t& value : *container)
+                {
+                    if (matches(*value.first))
+                    {
+                        transfer.instances.emplace_back(&value);
+                    }
+                }
+            }
+            else
+            {
+                transfer.delta = true;
+
+                // note: changed clones and tombstones are transferred in the
+                // order of their versions, so that an instance that was
+                // removed and created again is removed first. tombstones are
+                // retained as copies, because the log might be truncated
+                // before the transfer is completed
+                for (const Container<>::value_t& value : *container)
+                {
+                    if (*value.second.version > *sinceVersion && matches(*value.first))
+                    {
+                        transfer.instances.emplace_back(&value);
+                    }
+                }
+
+                for (const Container<>::value_t& tombstone : container->tombstones())
+                {
+                    if (*tombstone.second.version > *sinceVersion && matches(*tombstone.first))
+                    {
+                        transfer.instances.emplace_back(&tombstone);
+                    }
+                }
+
+                std::sort(transfer.instances.begin(), transfer.instances.end(), [](const Container<>::value_t* lhs, const Container<>::value_t* rhs)
+                {
+                    return *lhs->second.version < *rhs->second.version;
+                });
+
+                for (size_t i = 0; i < transfer.instances.size(); ++i)
+                {
+                    if (transfer.instances[i]->second.lastOperation == DotsMt::remove)
+                    {
+                        transfer.instances[i] = &transfer.retained.try_emplace(i, *transfer.instances[i]).first->second;
+                    }
+                }
+            }
+        }
+
+        group_t& group = typeGroup(descriptor);
+
+        if (auto it = group.find(&connection); it != group.end())
+        {
+            it->second.transfer = &transfer;
+        }
+
+        // note: the transfer is started immediately if no other transfer to
+        // the connection is pending. otherwise it will be continued after
+        // the preceding transfers have been completed
+        if (transfers.size() == 1)
+        {
+            if (transmitCacheTransferChunk(connection, transfer))
+            {
+                m_cacheTransfers.erase(&connection);
+            }
+            else
+            {
+                m_cacheTransferQueue.emplace_back(&connection);
+
+                if (m_cacheTransferTimer == std::nullopt)
+                {
+                    m_cacheTransferTimer.emplace(ioContext(), type::Duration{ 0 }, Timer::handler_t{ &HostTransceiver::handleCacheTransferTimeout, this });
+                }
+            }
+        }
+    }
+
+    bool HostTransceiver::transmitCacheTransferChunk(Connection& connection, cache_transfer_t& transfer)
+    {
+        tools::LoopTime::Scope loopTimeScope;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(m_cacheTransferMaxDuration);
         DotsHeader header{
-            .typeName = container.descriptor().name(),
-            .fromCache = static_cast<uint32_t>(container.size()),
-            .removeObj = false
+            .typeName = transfer.descriptor->name()
         };
 
-        for (const auto& [instance, cloneInfo] : container)
+        for (size_t count = 0; transfer.next < transfer.instances.size(); ++count)
         {
+            if (count == m_cacheTransferMaxInstances || (count > 0 && std::chrono::steady_clock::now() >= deadline))
+            {
+                return false;
+            }
+
+            const auto& [instance, cloneInfo] = *transfer.instances[transfer.next++];
             header.sentTime = *cloneInfo.modified;
-            header.serverSentTime = timepoint_t::Now();
-            header.attributes = instance->_validProperties();
+            header.serverSentTime = tools::LoopTime::Now(*transfer.descriptor);
+            header.attributes = transfer.projection == std::nullopt ? instance->_validProperties() : instance->_validProperties() ^ *transfer.projection;
             header.sender = *cloneInfo.lastUpdateFrom;
-            --*header.fromCache;
+            header.fromCache = static_cast<uint32_t>(transfer.instances.size() - transfer.next);
+            header.removeObj = cloneInfo.lastOperation == DotsMt::remove;
+
+            // note: the container version of the clone is used as the
+            // revision, because it is unique for every change of the
+            // container. this allows channels to reuse the serialized
+            // instance for subsequent transfers as long as the clone has not
+            // been updated, even if its memory is reused for a different clone
+            connection.transmitFromCache(header, instance, *cloneInfo.version);
+        }
+
+        DotsCacheInfo cacheInfo{
+            .typeName = transfer.descriptor->name(),
+            .endTransmission = true
+        };
+
+        if (transfer.version != std::nullopt)
+        {
+            cacheInfo.cacheEpoch = transfer.epoch;
+            cacheInfo.cacheVersion = *transfer.version;
+            cacheInfo.deltaTransmission = transfer.delta;
+        }
+
+        connection.transmit(cacheInfo);
+
+        for (const auto& [deferredHeader, deferredInstance] : transfer.deferred)
+        {
+            connection.transmit(deferredHeader, deferredInstance);
+        }
+
+        group_t& group = typeGroup(*transfer.descriptor);
+
+        if (auto it = group.find(&connection); it != group.end() && it->second.transfer == &transfer)
+        {
+            it->second.transfer = nullptr;
+        }
+
+        return true;
+    }
+
+    void HostTransceiver::retainRemovedInstance(const io::Transmission& transmission)
+    {
+        const auto& [header, instance] = transmission;
+
+        if (m_cacheTransfers.empty() || header.removeObj != true)
+        {
+            return;
+        }
+
+        const type::StructDescriptor& descriptor = instance->_descriptor();
+        const Container<>* container = pool().find(descriptor);
+        const Container<>::value_t* clone = container == nullptr ? nullptr : container->findClone(*instance);
+
+        if (clone == nullptr)
+        {
+            return;
+        }
+
+        // note: instances that are removed while they are still part of a
+        // pending cache transfer are retained as copies, so that the number
+        // of transferred instances matches the initially announced count.
+        // the guest will receive the removal afterwards as a deferred live
+        // transmission
+        for (auto& [connection, transfers] : m_cacheTransfers)
+        {
+            (void)connection;
+
+            for (cache_transfer_t& transfer : transfers)
+            {
+                if (transfer.descriptor != &descriptor || transfer.next == transfer.instances.size())
+                {
+                    continue;
+                }
+
+                if (transfer.index.empty())
+                {
+                    transfer.index.reserve(transfer.instances.size());
+
+                    for (size_t i = 0; i < transfer.instances.size(); ++i)
+                    {
+                        transfer.index.emplace_back(transfer.instances[i], i);
+                    }
+
+                    std::sort(transfer.index.begin(), transfer.index.end(), [](const auto& lhs, const auto& rhs){ return std::less{}(lhs.first, rhs.first); });
+                }
+
+                auto it = std::lower_bound(transfer.index.begin(), transfer.index.end(), clone, [](const auto& entry, const Container<>::value_t* value){ return std::less{}(entry.first, value); });
 
-            connection.transmit(header, instance);
+                if (it != transfer.index.end() && it->first == clone && it->second >= transfer.next && transfer.instances[it->second] == clone)
+                {
+                    transfer.instances[it->second] = &transfer.retained.try_emplace(it->second, *clone).first->second;
+                }
+            }
+        }
+    }
+
+    void HostTransceiver::stampCacheVersion(io::Transmission& transmission)
+    {
+        if (const type::StructDescriptor& descriptor = transmission.instance()->_descriptor(); descriptor.cached())
+        {
+            if (const Container<>* container = pool().find(descriptor); container != nullptr)
+            {
+                transmission.header().cacheVersion = container->version();
+            }
+        }
+    }
+
+    void HostTransceiver::journalChange(const io::Transmission& transmission)
+    {
+        if (m_cacheSnapshot == nullptr || !m_cacheSnapshot->journaling())
+        {
+            return;
+        }
+
+        const auto& [header, instance] = transmission;
+
+        if (!instance->_descriptor().persistent())
+        {
+            return;
+        }
+
+        // note: a failure to journal a change must not affect the guest
+        // that published it
+        try
+        {
+            if (header.removeObj == true)
+            {
+                m_cacheSnapshot->journal(instance, DotsCloneInformation{}, true);
+            }
+            else if (const Container<>* container = pool().find(instance->_descriptor()); container != nullptr)
+            {
+                if (const Container<>::value_t* clone = container->findClone(instance); clone != nullptr)
+                {
+                    m_cacheSnapshot->journal(clone->first, clone->second);
+                }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR_S("could not journal change of type '" << instance->_descriptor().name() << "' -> " << e.what());
+        }
+    }
+
+    void HostTransceiver::handleCacheTransferTimeout()
+    {
+        m_cacheTransferTimer.reset();
+
+        if (m_cacheTransferQueue.empty())
+        {
+            return;
+        }
+
+        Connection* connection = m_cacheTransferQueue.front();
+        m_cacheTransferQueue.pop_front();
+        std::exception_ptr ePtr;
+
+        if (auto it = m_cacheTransfers.find(connection); it != m_cacheTransfers.end())
+        {
+            cache_transfers_t& transfers = it->second;
+
+            try
+            {
+                if (transmitCacheTransferChunk(*connection, transfers.front()))
+                {
+                    transfers.pop_front();
+                }
+
+                if (transfers.empty())
+                {
+                    m_cacheTransfers.erase(it);
+                }
+                else
+                {
+                    m_cacheTransferQueue.emplace_back(connection);
+                }
+            }
+            catch (...)
+            {
+                m_cacheTransfers.erase(it);
+                ePtr = std::current_exception();
+            }
+        }
+
+        if (!m_cacheTransferQueue.empty())
+        {
+            m_cacheTransferTimer.emplace(ioContext(), type::Duration{ 0 }, Timer::handler_t{ &HostTransceiver::handleCacheTransferTimeout, this });
+        }
+
+        if (ePtr != nullptr)
+        {
+            connection->handleError(ePtr);
         }
     }
 }
@@ -0,0 +1,274 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/SubscriptionFilter.h>
+#include <algorithm>
+#include <new>
+
+namespace dots
+{
+    namespace
+    {
+        const char* operation_symbol(DotsFilterOperator operation)
+        {
+            switch (operation)
+            {
+                case DotsFilterOperator::equal:        return "==";
+                case DotsFilterOperator::notEqual:     return "!=";
+                case DotsFilterOperator::less:         return "<";
+                case DotsFilterOperator::lessEqual:    return "<=";
+                case DotsFilterOperator::greater:      return ">";
+                case DotsFilterOperator::greaterEqual: return ">=";
+            }
+
+            throw std::runtime_error{ "unknown filter operation: " + std::to_string(static_cast<int>(operation)) };
+        }
+
+        void assert_valid_predicate(const DotsFilterPredicate& predicate)
+        {
+            predicate._assertHasProperties(DotsFilterPredicate::path_p + DotsFilterPredicate::operation_p + DotsFilterPredicate::value_p);
+
+            if (predicate.path->empty())
+            {
+                throw std::runtime_error{ "filter predicate has an empty property path" };
+            }
+        }
+    }
+
+    SubscriptionFilter::SubscriptionFilter(const type::StructDescriptor& descriptor, const clauses_t& clauses) :
+        m_descriptor(&descriptor),
+        m_expression{ Expression(clauses) },
+        m_properties{ property_set_t::None }
+    {
+        if (clauses.empty())
+        {
+            throw std::runtime_error{ "attempt to create filter without clauses for type '" + descriptor.name() + "'" };
+        }
+
+        for (const DotsFilterClause& filterClause : clauses)
+        {
+            clause_t& clause = m_clauses.emplace_back();
+
+            for (const DotsFilterPredicate& filterPredicate : *filterClause.predicates)
+            {
+                Predicate& predicate = clause.emplace_back();
+                predicate.operation = *filterPredicate.operation;
+                const type::StructDescriptor* structDescriptor = &descriptor;
+                const vector_t<uint32_t>& path = *filterPredicate.path;
+
+                for (size_t i = 0; i < path.size(); ++i)
+                {
+                    const type::property_descriptor_container_t& propertyDescriptors = structDescriptor->propertyDescriptors();
+                    auto it = std::find_if(propertyDescriptors.begin(), propertyDescriptors.end(), [tag = path[i]](const type::PropertyDescriptor& propertyDescriptor)
+                    {
+                        return propertyDescriptor.tag() == tag;
+                    });
+
+                    if (it == propertyDescriptors.end())
+                    {
+                        throw std::runtime_error{ "filter refers to unknown property tag " + std::to_string(path[i]) + " in type '" + structDescriptor->name() + "'" };
+                    }
+
+                    const type::PropertyDescriptor& propertyDescriptor = *it;
+
+                    if (i == 0)
+                    {
+                        m_properties += propertyDescriptor.set();
+                    }
+
+                    if (i < path.size() - 1)
+                    {
+                        structDescriptor = propertyDescriptor.valueDescriptor().as<type::StructDescriptor>();
+
+                        if (structDescriptor == nullptr)
+                        {
+                            throw std::runtime_error{ "filter path traverses non-struct property '" + propertyDescriptor.name() + "'" };
+                        }
+
+                        predicate.steps.push_back(Step{ propertyDescriptor.set(), propertyDescriptor.offset() + *propertyDescriptor.subAreaOffset() });
+                    }
+                    else
+                    {
+                        const type::Descriptor<>& valueDescriptor = propertyDescriptor.valueDescriptor();
+
+                        if (valueDescriptor.type() == type::Type::Struct || valueDescriptor.type() == type::Type::Vector)
+                        {
+                            throw std::runtime_error{ "filter compares unsupported property '" + propertyDescriptor.name() + "' of type '" + valueDescriptor.name() + "'" };
+                        }
+
+                        predicate.steps.push_back(Step{ propertyDescriptor.set(), propertyDescriptor.offset() });
+                        predicate.valueDescriptor = &valueDescriptor;
+                        predicate.value = std::make_unique<Value>(valueDescriptor, *filterPredicate.value);
+                    }
+                }
+            }
+        }
+    }
+
+    const type::StructDescriptor& SubscriptionFilter::descriptor() const
+    {
+        return *m_descriptor;
+    }
+
+    const std::string& SubscriptionFilter::expression() const
+    {
+        return m_expression;
+    }
+
+    property_set_t SubscriptionFilter::properties() const
+    {
+        return m_properties;
+    }
+
+    bool SubscriptionFilter::matches(const type::Struct& instance) const
+    {
+        const type::PropertyArea& area = m_descriptor->propertyArea(instance);
+
+        return std::any_of(m_clauses.begin(), m_clauses.end(), [&](const clause_t& clause)
+        {
+            return std::all_of(clause.begin(), clause.end(), [&](const Predicate& predicate)
+            {
+                return holds(area, predicate);
+            });
+        });
+    }
+
+    bool SubscriptionFilter::affects(const DotsHeader& header) const
+    {
+        if (!m_descriptor->cached())
+        {
+            return false;
+        }
+
+        return header.removeObj == true || (header.attributes.isValid() && !(*header.attributes ^ m_properties).empty());
+    }
+
+    auto SubscriptionFilter::scope(const DotsHeader& header, bool matchedPreviously, const type::Struct& instance) const -> Scope
+    {
+        if (!affects(header))
+        {
+            return matches(instance) ? Scope::Inside : Scope::Outside;
+        }
+
+        if (header.removeObj == true)
+        {
+            return matchedPreviously ? Scope::Left : Scope::Outside;
+        }
+
+        if (matches(instance))
+        {
+            return matchedPreviously ? Scope::Inside : Scope::Entered;
+        }
+        else
+        {
+            return matchedPreviously ? Scope::Left : Scope::Outside;
+        }
+    }
+
+    bool SubscriptionFilter::passes(const DotsHeader& header, bool matchedPreviously, const type::Struct& instance) const
+    {
+        return scope(header, matchedPreviously, instance) != Scope::Outside;
+    }
+
+    std::string SubscriptionFilter::Expression(const clauses_t& clauses)
+    {
+        std::string expression;
+
+        for (const DotsFilterClause& clause : clauses)
+        {
+            clause._assertHasProperties(DotsFilterClause::predicates_p);
+
+            if (!expression.empty())
+            {
+                expression += " || ";
+            }
+
+            expression += '(';
+
+            for (const DotsFilterPredicate& predicate : *clause.predicates)
+            {
+                assert_valid_predicate(predicate);
+
+                if (expression.back() != '(')
+                {
+                    expression += " && ";
+                }
+
+                for (uint32_t tag : *predicate.path)
+                {
+                    expression += std::to_string(tag);
+                    expression += '.';
+                }
+
+                expression.back() = ' ';
+                expression += operation_symbol(*predicate.operation);
+                expression += ' ';
+                expression += *predicate.value;
+            }
+
+            expression += ')';
+        }
+
+        return expression;
+    }
+
+    bool SubscriptionFilter::holds(const type::PropertyArea& area, const Predicate& predicate) const
+    {
+        const auto* data = reinterpret_cast<const std::byte*>(&area);
+
+        for (const Step& step : predicate.steps)
+        {
+            if (!(step.property <= reinterpret_cast<const type::PropertyArea*>(data)->validProperties()))
+            {
+                return false;
+            }
+
+            data += step.offset;
+        }
+
+        const type::Typeless& lhs = *reinterpret_cast<const type::Typeless*>(data);
+        const type::Typeless& rhs = predicate.value->get();
+        const type::Descriptor<>& descriptor = *predicate.valueDescriptor;
+
+        switch (predicate.operation)
+        {
+            case DotsFilterOperator::equal:        return descriptor.equal(lhs, rhs);
+            case DotsFilterOperator::notEqual:     return !descriptor.equal(lhs, rhs);
+            case DotsFilterOperator::less:         return descriptor.less(lhs, rhs);
+            case DotsFilterOperator::lessEqual:    return descriptor.lessEqual(lhs, rhs);
+            case DotsFilterOperator::greater:      return descriptor.greater(lhs, rhs);
+            case DotsFilterOperator::greaterEqual: return descriptor.greaterEqual(lhs, rhs);
+        }
+
+        return false;
+    }
+
+    SubscriptionFilter::Value::Value(const type::Descriptor<>& descriptor, const std::string& value) :
+        m_descriptor(&descriptor),
+        m_storage(::operator new(descriptor.size(), std::align_val_t{ descriptor.alignment() }))
+    {
+        type::Typeless& typeless = *static_cast<type::Typeless*>(m_storage);
+        descriptor.constructInPlace(typeless);
+
+        try
+        {
+            from_string(value, typeless, descriptor);
+        }
+        catch (const std::exception& e)
+        {
+            descriptor.destruct(typeless);
+            ::operator delete(m_storage, std::align_val_t{ descriptor.alignment() });
+            throw std::runtime_error{ "invalid filter value '" + value + "' for type '" + descriptor.name() + "': " + e.what() };
+        }
+    }
+
+    SubscriptionFilter::Value::~Value()
+    {
+        m_descriptor->destruct(*static_cast<type::Typeless*>(m_storage));
+        ::operator delete(m_storage, std::align_val_t{ m_descriptor->alignment() });
+    }
+
+    const type::Typeless& SubscriptionFilter::Value::get() const
+    {
+        return *static_cast<const type::Typeless*>(m_storage);
+    }
+}
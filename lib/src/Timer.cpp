@@ -93,4 +93,12 @@ namespace dots
             }
         });
     }
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+    asio::awaitable<void> sleep(type::Duration duration)
+    {
+        timer_t timer{ co_await asio::this_coro::executor, std::chrono::duration_cast<duration_t>(duration) };
+        co_await timer.async_wait(asio::use_awaitable);
+    }
+#endif
 }
@@ -0,0 +1,400 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/TimerWheel.h>
+#include <algorithm>
+#include <utility>
+#include <dots/asio.h>
+#include <dots/tools/logging.h>
+
+namespace dots
+{
+    TimerWheel::Handle::Handle(TimerWheel& wheel, uint32_t index) :
+        m_wheel(&wheel),
+        m_index(index)
+    {
+        /* do nothing */
+    }
+
+    TimerWheel::Handle::Handle(Handle&& other) noexcept :
+        m_wheel(std::exchange(other.m_wheel, nullptr)),
+        m_index(other.m_index)
+    {
+        /* do nothing */
+    }
+
+    TimerWheel::Handle::~Handle()
+    {
+        if (m_wheel != nullptr)
+        {
+            m_wheel->release(m_index);
+        }
+    }
+
+    auto TimerWheel::Handle::operator = (Handle&& rhs) noexcept -> Handle&
+    {
+        if (this == &rhs)
+        {
+            return *this;
+        }
+
+        if (m_wheel != nullptr)
+        {
+            m_wheel->release(m_index);
+        }
+
+        m_wheel = std::exchange(rhs.m_wheel, nullptr);
+        m_index = rhs.m_index;
+
+        return *this;
+    }
+
+    bool TimerWheel::Handle::active() const
+    {
+        return m_wheel != nullptr && m_wheel->m_nodes[m_index].slot != NoSlot;
+    }
+
+    void TimerWheel::Handle::reschedule(type::Duration timeout)
+    {
+        if (m_wheel == nullptr)
+        {
+            throw std::logic_error{ "attempt to reschedule timer of empty handle" };
+        }
+
+        m_wheel->arm(m_index, timeout);
+    }
+
+    void TimerWheel::Handle::cancel()
+    {
+        if (m_wheel != nullptr)
+        {
+            m_wheel->disarm(m_index);
+        }
+    }
+
+    void TimerWheel::Handle::discard()
+    {
+        if (m_wheel != nullptr)
+        {
+            if (TimerWheel* wheel = std::exchange(m_wheel, nullptr); wheel->m_nodes[m_index].slot == NoSlot)
+            {
+                wheel->release(m_index);
+            }
+            else
+            {
+                wheel->m_nodes[m_index].discarded = true;
+            }
+        }
+    }
+
+    TimerWheel::TimerWheel(asio::io_context& ioContext, type::Duration resolution/* = type::Duration{ 0.001 }*/) :
+        m_this(std::make_shared<TimerWheel*>(this)),
+        m_timer{ ioContext },
+        m_resolution(std::chrono::ceil<duration_t>(resolution)),
+        m_start(clock_t::now()),
+        m_tick(0),
+        m_ticking(false),
+        m_armed(0),
+        m_slots(PendingSlot + 1, NoNode)
+    {
+        if (m_resolution <= duration_t::zero())
+        {
+            throw std::logic_error{ "attempt to create timer wheel with non-positive resolution" };
+        }
+    }
+
+    TimerWheel::~TimerWheel()
+    {
+        try
+        {
+            m_timer.cancel();
+        }
+        catch (...)
+        {
+            /* do nothing */
+        }
+    }
+
+    type::Duration TimerWheel::resolution() const
+    {
+        return type::Duration{ m_resolution };
+    }
+
+    size_t TimerWheel::size() const
+    {
+        return m_armed;
+    }
+
+    auto TimerWheel::add(type::Duration timeout, handler_t handler) -> Handle
+    {
+        uint32_t index = acquire(std::move(handler));
+        arm(index, timeout);
+
+        return Handle{ *this, index };
+    }
+
+    uint32_t TimerWheel::acquire(handler_t handler)
+    {
+        uint32_t index;
+
+        if (m_freeNodes.empty())
+        {
+            index = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.emplace_back(node_t{
+                .handler = std::move(handler),
+                .expiry = 0,
+                .generation = 0,
+                .slot = NoSlot,
+                .prev = NoNode,
+                .next = NoNode,
+                .discarded = false
+            });
+        }
+        else
+        {
+            index = m_freeNodes.back();
+            m_freeNodes.pop_back();
+
+            node_t& node = m_nodes[index];
+            node.handler.emplace(std::move(handler));
+            node.discarded = false;
+        }
+
+        return index;
+    }
+
+    void TimerWheel::release(uint32_t index)
+    {
+        disarm(index);
+
+        node_t& node = m_nodes[index];
+        node.handler.reset();
+        ++node.generation;
+        m_freeNodes.emplace_back(index);
+    }
+
+    void TimerWheel::arm(uint32_t index, type::Duration timeout)
+    {
+        disarm(index);
+
+        // note: the wheel is rebased when it becomes active, because all
+        // slots are empty while no timer is armed
+        if (m_armed == 0 && !m_ticking)
+        {
+            m_tick = currentTick();
+        }
+
+        // note: the expiry is rounded up to the next tick after the absolute
+        // deadline, so that no timer is invoked before its timeout elapsed
+        duration_t deadline = clock_t::now() - m_start + std::max(std::chrono::ceil<duration_t>(timeout), duration_t::zero());
+        uint64_t expiry = static_cast<uint64_t>((deadline + m_resolution - duration_t{ 1 }) / m_resolution);
+
+        node_t& node = m_nodes[index];
+        node.expiry = std::max(m_tick + 1, expiry);
+        insert(index);
+        ++m_armed;
+
+        if (!m_ticking)
+        {
+            asyncTick();
+        }
+    }
+
+    void TimerWheel::disarm(uint32_t index)
+    {
+        if (m_nodes[index].slot != NoSlot)
+        {
+            unlink(index);
+            --m_armed;
+        }
+    }
+
+    void TimerWheel::insert(uint32_t index)
+    {
+        uint64_t expiry = m_nodes[index].expiry;
+        uint64_t delta = expiry > m_tick ? expiry - m_tick : 0;
+        uint32_t slot;
+
+        if (delta < SlotsPerLevel)
+        {
+            // note: timers that are already due are placed into the slot of
+            // the current tick, which is fired after all cascades
+            slot = static_cast<uint32_t>(std::max(expiry, m_tick) & SlotMask);
+        }
+        else
+        {
+            uint32_t level = 1;
+
+            while (level < Levels - 1 && delta >= (uint64_t{ 1 } << (LevelBits * (level + 1))))
+            {
+                ++level;
+            }
+
+            // note: timeouts beyond the range of the wheel are placed into
+            // the last slot of the top level and cascaded repeatedly
+            uint64_t maxDelta = (uint64_t{ 1 } << (LevelBits * Levels)) - 1;
+            uint64_t wheelExpiry = m_tick + std::min(delta, maxDelta);
+            slot = level * SlotsPerLevel + static_cast<uint32_t>((wheelExpiry >> (LevelBits * level)) & SlotMask);
+        }
+
+        link(index, slot);
+    }
+
+    void TimerWheel::link(uint32_t index, uint32_t slot)
+    {
+        node_t& node = m_nodes[index];
+        node.slot = slot;
+        node.prev = NoNode;
+        node.next = m_slots[slot];
+
+        if (node.next != NoNode)
+        {
+            m_nodes[node.next].prev = index;
+        }
+
+        m_slots[slot] = index;
+    }
+
+    void TimerWheel::unlink(uint32_t index)
+    {
+        node_t& node = m_nodes[index];
+
+        if (node.prev == NoNode)
+        {
+            m_slots[node.slot] = node.next;
+        }
+        else
+        {
+            m_nodes[node.prev].next = node.next;
+        }
+
+        if (node.next != NoNode)
+        {
+            m_nodes[node.next].prev = node.prev;
+        }
+
+        node.slot = NoSlot;
+        node.prev = NoNode;
+        node.next = NoNode;
+    }
+
+    void TimerWheel::cascade(uint32_t slot)
+    {
+        uint32_t index = std::exchange(m_slots[slot], NoNode);
+
+        while (index != NoNode)
+        {
+            uint32_t next = m_nodes[index].next;
+            insert(index);
+            index = next;
+        }
+    }
+
+    void TimerWheel::fire(uint32_t slot)
+    {
+        // note: the timers are moved to a separate slot before any handler
+        // is invoked, so that handlers can safely add, cancel and reschedule
+        // timers of the same slot
+        for (uint32_t index = std::exchange(m_slots[slot], NoNode); index != NoNode;)
+        {
+            uint32_t next = m_nodes[index].next;
+            link(index, PendingSlot);
+            index = next;
+        }
+
+        while (m_slots[PendingSlot] != NoNode)
+        {
+            uint32_t index = m_slots[PendingSlot];
+            unlink(index);
+            --m_armed;
+
+            // note: the handler is moved out of the pool, because it might
+            // be reallocated when the handler adds timers
+            node_t& node = m_nodes[index];
+            uint32_t generation = node.generation;
+            handler_t handler = std::move(*node.handler);
+            node.handler.reset();
+
+            try
+            {
+                handler();
+            }
+            catch (const std::exception& e)
+            {
+                LOG_ERROR_S("error in timer wheel handler -> " << e.what());
+            }
+            catch (...)
+            {
+                LOG_ERROR_S("error in timer wheel handler -> <unknown>");
+            }
+
+            if (node_t& node_ = m_nodes[index]; node_.generation == generation)
+            {
+                node_.handler.emplace(std::move(handler));
+
+                if (node_.discarded && node_.slot == NoSlot)
+                {
+                    release(index);
+                }
+            }
+        }
+    }
+
+    void TimerWheel::advance()
+    {
+        ++m_tick;
+
+        // note: when a level wraps around, the timers of the current slot of
+        // the next level are redistributed to the lower levels
+        uint64_t index = m_tick & SlotMask;
+
+        for (uint32_t level = 1; index == 0 && level < Levels; ++level)
+        {
+            index = (m_tick >> (LevelBits * level)) & SlotMask;
+            cascade(level * SlotsPerLevel + static_cast<uint32_t>(index));
+        }
+
+        fire(static_cast<uint32_t>(m_tick & SlotMask));
+    }
+
+    uint64_t TimerWheel::currentTick() const
+    {
+        return static_cast<uint64_t>((clock_t::now() - m_start) / m_resolution);
+    }
+
+    void TimerWheel::asyncTick()
+    {
+        m_ticking = true;
+        m_timer.expires_at(m_start + m_resolution * static_cast<duration_t::rep>(m_tick + 1));
+        m_timer.async_wait([this_{ std::weak_ptr<TimerWheel*>{ m_this } }](boost::system::error_code error)
+        {
+            if (error == asio::error::operation_aborted)
+            {
+                return;
+            }
+
+            if (std::shared_ptr<TimerWheel*> wheel = this_.lock(); wheel != nullptr)
+            {
+                (*wheel)->handleTick();
+            }
+        });
+    }
+
+    void TimerWheel::handleTick()
+    {
+        // note: ticks that were missed (e.g. because the IO context was
+        // blocked) are caught up, so that no timer is skipped
+        for (uint64_t tick = currentTick(); m_tick < tick && m_armed > 0;)
+        {
+            advance();
+        }
+
+        if (m_armed > 0)
+        {
+            asyncTick();
+        }
+        else
+        {
+            m_ticking = false;
+        }
+    }
+}
@@ -1,12 +1,38 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #include <dots/Transceiver.h>
+#include <dots/Timer.h>
+#include <dots/asio.h>
 #include <dots/tools/logging.h>
 #include <dots/serialization/AsciiSerialization.h>
+#include <dots/serialization/CborSerializer.h>
 #include <DotsMember.dots.h>
+#include <DotsRpcRequest.dots.h>
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#endif
 
 namespace dots
 {
+    struct Transceiver::event_batcher
+    {
+        EventBatch<> batch;
+        event_batch_handler_t<> handler;
+        size_t maxBatch;
+        type::Duration maxDelay;
+        std::optional<Timer> deliveryTimer;
+    };
+
+    struct Transceiver::rpc_call
+    {
+        const type::StructDescriptor* requestDescriptor;
+        const type::StructDescriptor* replyDescriptor;
+        rpc_reply_handler_t<> handler;
+        std::optional<Timer> timeoutTimer;
+    };
+
     Transceiver::Transceiver(std::string selfName,
                              asio::io_context& ioContext,
                              type::Registry::StaticTypePolicy staticTypePolicy/* = StaticTypePolicy::All*/,
@@ -32,7 +58,9 @@ namespace dots
         m_selfName{ std::move(other.m_selfName) },
         m_ioContext{ other.m_ioContext },
         m_transitionHandler{ std::move(other.m_transitionHandler) },
-        m_newTypeHandlers{ std::move(other.m_newTypeHandlers) }
+        m_newTypeHandlers{ std::move(other.m_newTypeHandlers) },
+        m_rpcCalls{ std::move(other.m_rpcCalls) },
+        m_rpcReplyHandlerId{ other.m_rpcReplyHandlerId }
     {
         *m_this = this;
     }
@@ -49,6 +77,8 @@ namespace dots
         m_ioContext = rhs.m_ioContext;
         m_transitionHandler = std::move(rhs.m_transitionHandler);
         m_newTypeHandlers = std::move(rhs.m_newTypeHandlers);
+        m_rpcCalls = std::move(rhs.m_rpcCalls);
+        m_rpcReplyHandlerId = rhs.m_rpcReplyHandlerId;
 
         *m_this = this;
 
@@ -112,6 +142,23 @@ namespace dots
         return m_dispatcher.container(descriptor);
     }
 
+    void Transceiver::setCacheReplayLimits(size_t maxInstances, type::Duration maxDuration)
+    {
+        m_dispatcher.setReplayLimits(maxInstances, maxDuration, [this_{ std::weak_ptr<Transceiver*>{ m_this } }]
+        {
+            if (std::shared_ptr<Transceiver*> transceiver = this_.lock(); transceiver != nullptr)
+            {
+                asio::post((*transceiver)->ioContext(), [this_]
+                {
+                    if (std::shared_ptr<Transceiver*> transceiver = this_.lock(); transceiver != nullptr)
+                    {
+                        (*transceiver)->m_dispatcher.continueReplays();
+                    }
+                });
+            }
+        });
+    }
+
     Subscription Transceiver::subscribe(const type::StructDescriptor& descriptor, transmission_handler_t handler)
     {
         if (descriptor.substructOnly())
@@ -138,6 +185,96 @@ namespace dots
         return makeSubscription([&, id]{ m_dispatcher.removeEventHandler(descriptor, id); });
     }
 
+    Subscription Transceiver::subscribe(const type::StructDescriptor& descriptor, event_batch_handler_t<> handler, size_t maxBatch, type::Duration maxDelay/* = type::Duration{ 0 }*/)
+    {
+        if (descriptor.substructOnly())
+        {
+            throw std::logic_error{ "attempt to subscribe to substruct-only type '" + descriptor.name() + "'" };
+        }
+
+        if (maxBatch == 0)
+        {
+            throw std::logic_error{ "attempt to subscribe to type '" + descriptor.name() + "' with maximum batch size of zero" };
+        }
+
+        // note: the batcher is solely owned by the event handler, so that
+        // removing the handler also discards pending events and cancels the
+        // delivery timer
+        auto batcher = std::make_shared<event_batcher>(event_batcher{
+            .batch = EventBatch<>{ descriptor },
+            .handler = std::move(handler),
+            .maxBatch = maxBatch,
+            .maxDelay = maxDelay,
+            .deliveryTimer = std::nullopt
+        });
+
+        joinGroup(descriptor.name());
+        Dispatcher::id_t id = m_dispatcher.addEventHandler(descriptor, event_handler_t<>{ [this_{ m_this }, batcher{ std::move(batcher) }](const Event<>& event)
+        {
+            batcher->batch.append(event);
+
+            if (batcher->batch.size() >= batcher->maxBatch)
+            {
+                (*this_)->deliverEventBatch(*batcher);
+            }
+            else if (batcher->deliveryTimer == std::nullopt)
+            {
+                batcher->deliveryTimer.emplace((*this_)->ioContext(), batcher->maxDelay, [this_, weakBatcher{ std::weak_ptr<event_batcher>{ batcher } }]
+                {
+                    if (std::shared_ptr<event_batcher> pendingBatcher = weakBatcher.lock(); pendingBatcher != nullptr)
+                    {
+                        (*this_)->deliverEventBatch(*pendingBatcher);
+                    }
+                });
+            }
+        } });
+
+        return makeSubscription([&, id]{ m_dispatcher.removeEventHandler(descriptor, id); });
+    }
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+    asio::awaitable<type::AnyStruct> Transceiver::next(const type::StructDescriptor& descriptor, std::optional<event_predicate_t<>> predicate/* = std::nullopt*/)
+    {
+        if (descriptor.substructOnly())
+        {
+            throw std::logic_error{ "attempt to await substruct-only type '" + descriptor.name() + "'" };
+        }
+
+        return asio::async_initiate<const asio::use_awaitable_t<>, void(std::exception_ptr, type::AnyStruct)>([this_{ m_this }, &descriptor](auto completionHandler, std::optional<event_predicate_t<>> predicate_)
+        {
+            using completion_handler_t = decltype(completionHandler);
+
+            // note: the completion handler is released on the first matching
+            // event, which might already occur synchronously during the
+            // subscription for cached types
+            auto completionHandler_ = std::make_shared<std::optional<completion_handler_t>>(std::move(completionHandler));
+            auto subscription = std::make_shared<std::optional<Subscription>>();
+
+            Subscription subscription_ = (*this_)->subscribe(descriptor, event_handler_t<>{ [completionHandler_, subscription, predicate{ std::move(predicate_) }](const Event<>& event)
+            {
+                if (*completionHandler_ == std::nullopt || (predicate != std::nullopt && !(*predicate)(event)))
+                {
+                    return;
+                }
+
+                auto executor = asio::get_associated_executor(**completionHandler_);
+                asio::post(executor, [completionHandler{ std::move(**completionHandler_) }, instance{ type::AnyStruct{ event.updated() } }]() mutable
+                {
+                    std::move(completionHandler)(nullptr, std::move(instance));
+                });
+
+                completionHandler_->reset();
+                subscription->reset();
+            } });
+
+            if (*completionHandler_ != std::nullopt)
+            {
+                subscription->emplace(std::move(subscription_));
+            }
+        }, asio::use_awaitable, std::move(predicate));
+    }
+#endif
+
     Subscription Transceiver::subscribe(std::string_view name, transmission_handler_t handler)
     {
         return subscribe(m_registry.getStructType(name), std::move(handler));
@@ -166,11 +303,177 @@ namespace dots
         });
     }
 
+    void Transceiver::publish(std::span<const type::Struct* const> instances, std::optional<property_set_t> includedProperties/* = std::nullopt*/, bool remove/* = false*/)
+    {
+        VerifyBatch(instances);
+
+        for (const type::Struct* instance : instances)
+        {
+            publish(*instance, includedProperties, remove);
+        }
+    }
+
     void Transceiver::remove(const type::Struct& instance)
     {
         publish(instance, instance._keyProperties(), true);
     }
 
+    void Transceiver::call(const type::Struct& request, const type::StructDescriptor& replyDescriptor, rpc_reply_handler_t<> handler, type::Duration timeout/* = type::Duration{ 10.0 }*/)
+    {
+        const type::StructDescriptor& requestDescriptor = request._descriptor();
+
+        if (requestDescriptor.substructOnly())
+        {
+            throw std::logic_error{ "attempt to call remote procedure with substruct-only request type '" + requestDescriptor.name() + "'" };
+        }
+
+        if (replyDescriptor.substructOnly())
+        {
+            throw std::logic_error{ "attempt to call remote procedure with substruct-only reply type '" + replyDescriptor.name() + "'" };
+        }
+
+        if (m_rpcReplyHandlerId == std::nullopt)
+        {
+            // note: replies are transmitted directly to the caller and
+            // therefore do not require joining the group of the reply type
+            m_rpcReplyHandlerId = m_dispatcher.addEventHandler(DotsRpcReply::_Descriptor(), event_handler_t<>{ [this_{ m_this }](const Event<>& event)
+            {
+                (*this_)->handleRpcReply(static_cast<const DotsRpcReply&>(event.transmitted()));
+            } });
+        }
+
+        id_t callId = m_nextId++;
+        auto rpcCall = std::make_shared<rpc_call>(rpc_call{
+            .requestDescriptor = &requestDescriptor,
+            .replyDescriptor = &replyDescriptor,
+            .handler = std::move(handler),
+            .timeoutTimer = std::nullopt
+        });
+        rpcCall->timeoutTimer.emplace(ioContext(), timeout, [this_{ m_this }, callId]{ (*this_)->handleRpcTimeout(callId); });
+        m_rpcCalls.emplace(callId, std::move(rpcCall));
+
+        DotsRpcRequest rpcRequest{
+            .callId = callId,
+            .requestType = requestDescriptor.name()
+        };
+        rpcRequest.request = to_cbor(request);
+
+        try
+        {
+            publish(rpcRequest);
+        }
+        catch (...)
+        {
+            m_rpcCalls.erase(callId);
+            throw;
+        }
+    }
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+    asio::awaitable<type::AnyStruct> Transceiver::asyncCall(const type::Struct& request, const type::StructDescriptor& replyDescriptor, type::Duration timeout/* = type::Duration{ 10.0 }*/)
+    {
+        // note: the initiation is deferred until the awaitable is awaited,
+        // which is why the request is copied
+        return asio::async_initiate<const asio::use_awaitable_t<>, void(std::exception_ptr, type::AnyStruct)>([this_{ m_this }, &replyDescriptor, timeout](auto completionHandler, const type::AnyStruct& request_)
+        {
+            // note: the completion handler is move-only and is therefore
+            // shared with the copyable reply handler
+            auto completionHandler_ = std::make_shared<decltype(completionHandler)>(std::move(completionHandler));
+
+            (*this_)->call(*request_, replyDescriptor, rpc_reply_handler_t<>{ [&replyDescriptor, completionHandler_](std::exception_ptr ePtr, const type::Struct* reply)
+            {
+                type::AnyStruct result{ replyDescriptor };
+
+                if (reply != nullptr)
+                {
+                    result = *reply;
+                }
+
+                auto executor = asio::get_associated_executor(*completionHandler_);
+                asio::post(executor, [completionHandler{ std::move(*completionHandler_) }, ePtr, result{ std::move(result) }]() mutable
+                {
+                    std::move(completionHandler)(ePtr, std::move(result));
+                });
+            } }, timeout);
+        }, asio::use_awaitable, type::AnyStruct{ request });
+    }
+#endif
+
+    Subscription Transceiver::provide(const type::StructDescriptor& requestDescriptor, rpc_handler_t<> handler)
+    {
+        if (requestDescriptor.substructOnly())
+        {
+            throw std::logic_error{ "attempt to provide remote procedure for substruct-only type '" + requestDescriptor.name() + "'" };
+        }
+
+        // note: requests of all types share the same envelope type and are
+        // therefore filtered locally
+        return subscribe(DotsRpcRequest::_Descriptor(), event_handler_t<>{ [this_{ m_this }, &requestDescriptor, handler{ std::move(handler) }](const Event<>& event)
+        {
+            const auto& rpcRequest = static_cast<const DotsRpcRequest&>(event.transmitted());
+
+            if (!rpcRequest.requestType.isValid() || *rpcRequest.requestType != requestDescriptor.name())
+            {
+                return;
+            }
+
+            DotsRpcReply rpcReply{
+                .callerId = *event.header().sender,
+                .callId = *rpcRequest.callId
+            };
+
+            try
+            {
+                type::AnyStruct request{ requestDescriptor };
+                from_cbor(*rpcRequest.request, *request);
+
+                type::AnyStruct reply = handler(*request);
+                rpcReply.replyType = reply->_descriptor().name();
+                rpcReply.reply = to_cbor(*reply);
+            }
+            catch (const std::exception& e)
+            {
+                rpcReply.error = e.what();
+            }
+            catch (...)
+            {
+                rpcReply.error = "<unknown>";
+            }
+
+            (*this_)->publish(rpcReply);
+        } });
+    }
+
+    void Transceiver::joinRestrictedGroup(const type::StructDescriptor& descriptor, Dispatcher::id_t/* id*/, SubscriptionFilter::clauses_t/* clauses*/, std::optional<property_set_t>/* projection*/)
+    {
+        joinGroup(descriptor.name());
+    }
+
+    void Transceiver::leaveRestrictedGroup(const type::StructDescriptor&/* descriptor*/, Dispatcher::id_t/* id*/)
+    {
+        /* do nothing */
+    }
+
+    const type::StructDescriptor* Transceiver::VerifyBatch(std::span<const type::Struct* const> instances)
+    {
+        if (instances.empty())
+        {
+            return nullptr;
+        }
+
+        const type::StructDescriptor& descriptor = instances.front()->_descriptor();
+
+        for (const type::Struct* instance : instances)
+        {
+            if (&instance->_descriptor() != &descriptor)
+            {
+                throw std::logic_error{ "attempt to publish batch with mixed types '" + descriptor.name() + "' and '" + instance->_descriptor().name() + "'" };
+            }
+        }
+
+        return &descriptor;
+    }
+
     void Transceiver::handleNewType(const type::Descriptor<>& descriptor) noexcept
     {
         for (const auto& [id, handler] : m_newTypeHandlers)
@@ -196,6 +499,97 @@ namespace dots
         m_removeIds.clear();
     }
 
+    void Transceiver::deliverEventBatch(event_batcher& batcher) noexcept
+    {
+        batcher.deliveryTimer.reset();
+
+        // note: the batch is moved out before invoking the handler, so that
+        // events dispatched by the handler itself start a new batch
+        EventBatch<> batch{ batcher.batch.descriptor() };
+        std::swap(batch, batcher.batch);
+
+        try
+        {
+            batcher.handler(batch);
+        }
+        catch (...)
+        {
+            handleDispatchError(batch.descriptor(), std::current_exception());
+        }
+    }
+
+    void Transceiver::handleRpcReply(const DotsRpcReply& reply) noexcept
+    {
+        auto it = m_rpcCalls.find(*reply.callId);
+
+        // note: replies to completed calls are ignored (e.g. if multiple
+        // peers provide the same procedure or the call already timed out)
+        if (it == m_rpcCalls.end())
+        {
+            return;
+        }
+
+        std::shared_ptr<rpc_call> rpcCall = std::move(it->second);
+        m_rpcCalls.erase(it);
+        rpcCall->timeoutTimer.reset();
+
+        std::exception_ptr ePtr;
+        std::optional<type::AnyStruct> instance;
+
+        if (reply.error.isValid())
+        {
+            ePtr = std::make_exception_ptr(std::runtime_error{ "remote procedure for request type '" + rpcCall->requestDescriptor->name() + "' failed -> " + *reply.error });
+        }
+        else if (!reply.replyType.isValid() || *reply.replyType != rpcCall->replyDescriptor->name())
+        {
+            ePtr = std::make_exception_ptr(std::runtime_error{ "remote procedure for request type '" + rpcCall->requestDescriptor->name() + "' replied with unexpected type '" + reply.replyType.valueOrDefault("<none>") + "'" });
+        }
+        else
+        {
+            try
+            {
+                instance.emplace(*rpcCall->replyDescriptor);
+                from_cbor(*reply.reply, **instance);
+            }
+            catch (...)
+            {
+                ePtr = std::current_exception();
+                instance.reset();
+            }
+        }
+
+        try
+        {
+            rpcCall->handler(ePtr, instance == std::nullopt ? nullptr : &**instance);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR_S("error in reply handler for request type '" << rpcCall->requestDescriptor->name() << "' -> " << e.what());
+        }
+    }
+
+    void Transceiver::handleRpcTimeout(id_t callId) noexcept
+    {
+        auto it = m_rpcCalls.find(callId);
+
+        if (it == m_rpcCalls.end())
+        {
+            return;
+        }
+
+        std::shared_ptr<rpc_call> rpcCall = std::move(it->second);
+        m_rpcCalls.erase(it);
+
+        try
+        {
+            rpcCall->handler(std::make_exception_ptr(std::runtime_error{ "remote procedure for request type '" + rpcCall->requestDescriptor->name() + "' timed out" }), nullptr);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR_S("error in reply handler for request type '" << rpcCall->requestDescriptor->name() << "' -> " << e.what());
+        }
+    }
+
     void Transceiver::handleDispatchError(const type::StructDescriptor& descriptor, std::exception_ptr ePtr) noexcept
     {
         try
@@ -0,0 +1,302 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/io/CacheSnapshot.h>
+#include <cstring>
+#include <dots/type/VectorDescriptor.h>
+#include <dots/io/DescriptorConverter.h>
+#include <DotsHeader.dots.h>
+#include <StructDescriptorData.dots.h>
+#include <EnumDescriptorData.dots.h>
+
+namespace dots::io
+{
+    namespace
+    {
+        constexpr size_t RecordSizeSize = sizeof(uint32_t);
+
+        void encode_record_size(uint8_t* data, uint32_t size)
+        {
+            for (size_t i = 0; i < RecordSizeSize; ++i)
+            {
+                data[i] = static_cast<uint8_t>(size >> (i * 8));
+            }
+        }
+
+        uint32_t decode_record_size(const uint8_t* data)
+        {
+            uint32_t size = 0;
+
+            for (size_t i = 0; i < RecordSizeSize; ++i)
+            {
+                size |= static_cast<uint32_t>(data[i]) << (i * 8);
+            }
+
+            return size;
+        }
+    }
+
+    CacheSnapshot::CacheSnapshot(type::Registry& registry, std::filesystem::path path, bool journal/* = false*/) :
+        m_registry(&registry),
+        m_path{ std::move(path) },
+        m_journalPath{ m_path.string() + ".journal" },
+        m_journaling(journal)
+    {
+        /* do nothing */
+    }
+
+    const std::filesystem::path& CacheSnapshot::path() const
+    {
+        return m_path;
+    }
+
+    const std::filesystem::path& CacheSnapshot::journalPath() const
+    {
+        return m_journalPath;
+    }
+
+    bool CacheSnapshot::journaling() const
+    {
+        return m_journaling;
+    }
+
+    size_t CacheSnapshot::load(ContainerPool& pool)
+    {
+        size_t restored = loadFile(m_path, pool, false);
+
+        if (m_journaling)
+        {
+            restored += loadFile(m_journalPath, pool, true);
+
+            // note: the loaded state is compacted into a new snapshot right
+            // away, so that new journal records are never appended to a
+            // truncated record
+            write(pool);
+        }
+
+        return restored;
+    }
+
+    size_t CacheSnapshot::write(const ContainerPool& pool)
+    {
+        m_serializer.output().clear();
+        m_serializer.output().insert(m_serializer.output().end(), Magic.begin(), Magic.end());
+
+        descriptor_set_t serializedDescriptors;
+        size_t written = 0;
+
+        for (const auto& [descriptor, container] : pool)
+        {
+            if (!descriptor->persistent() || container.empty())
+            {
+                continue;
+            }
+
+            serializeDependencies(*descriptor, serializedDescriptors);
+
+            for (const auto& [instance, cloneInfo] : container)
+            {
+                serializeRecord(instance, &cloneInfo, false);
+                ++written;
+            }
+        }
+
+        std::filesystem::path tmpPath = m_path.string() + ".tmp";
+
+        {
+            std::ofstream ofs{ tmpPath, std::ios::binary | std::ios::trunc };
+            ofs.write(reinterpret_cast<const char*>(m_serializer.output().data()), static_cast<std::streamsize>(m_serializer.output().size()));
+
+            if (!ofs)
+            {
+                throw std::runtime_error{ "could not write cache snapshot file: " + tmpPath.string() };
+            }
+        }
+
+        std::filesystem::rename(tmpPath, m_path);
+        m_serializer.output().clear();
+
+        if (m_journaling)
+        {
+            resetJournal();
+        }
+
+        return written;
+    }
+
+    void CacheSnapshot::journal(const type::Struct& instance, const DotsCloneInformation& cloneInfo, bool remove/* = false*/)
+    {
+        if (!m_journal.is_open())
+        {
+            return;
+        }
+
+        m_serializer.output().clear();
+        serializeDependencies(instance._descriptor(), m_journaledDescriptors);
+        serializeRecord(instance, &cloneInfo, remove);
+
+        m_journal.write(reinterpret_cast<const char*>(m_serializer.output().data()), static_cast<std::streamsize>(m_serializer.output().size()));
+        m_journal.flush();
+        m_serializer.output().clear();
+
+        if (!m_journal)
+        {
+            throw std::runtime_error{ "could not write cache journal file: " + m_journalPath.string() };
+        }
+    }
+
+    void CacheSnapshot::serializeDependencies(const type::Descriptor<>& descriptor, descriptor_set_t& serializedDescriptors)
+    {
+        if (bool isNewType = serializedDescriptors.emplace(&descriptor).second; !isNewType)
+        {
+            return;
+        }
+
+        if (const auto* vectorDescriptor = descriptor.as<type::VectorDescriptor>(); vectorDescriptor != nullptr)
+        {
+            serializeDependencies(vectorDescriptor->valueDescriptor(), serializedDescriptors);
+        }
+        else if (const auto* enumDescriptor = descriptor.as<type::EnumDescriptor>(); enumDescriptor != nullptr)
+        {
+            serializeDependencies(enumDescriptor->underlyingDescriptor(), serializedDescriptors);
+            serializeRecord(DescriptorConverter{ *m_registry }(*enumDescriptor), nullptr, false);
+        }
+        else if (const auto* structDescriptor = descriptor.as<type::StructDescriptor>(); structDescriptor != nullptr && !structDescriptor->internal())
+        {
+            for (const type::PropertyDescriptor& propertyDescriptor : structDescriptor->propertyDescriptors())
+            {
+                serializeDependencies(propertyDescriptor.valueDescriptor(), serializedDescriptors);
+            }
+
+            serializeRecord(DescriptorConverter{ *m_registry }(*structDescriptor), nullptr, false);
+        }
+    }
+
+    void CacheSnapshot::serializeRecord(const type::Struct& instance, const DotsCloneInformation* cloneInfo, bool remove)
+    {
+        std::vector<uint8_t>& output = m_serializer.output();
+        size_t sizeOffset = output.size();
+        output.resize(sizeOffset + RecordSizeSize);
+
+        m_serializer.serialize(DotsHeader{
+            .typeName = instance._descriptor().name(),
+            .attributes = instance._validProperties(),
+            .removeObj = remove
+        });
+
+        if (cloneInfo != nullptr)
+        {
+            m_serializer.serialize(*cloneInfo);
+        }
+
+        m_serializer.serialize(instance);
+        encode_record_size(output.data() + sizeOffset, static_cast<uint32_t>(output.size() - sizeOffset - RecordSizeSize));
+    }
+
+    size_t CacheSnapshot::loadFile(const std::filesystem::path& path, ContainerPool& pool, bool allowTruncation)
+    {
+        std::error_code error;
+        uintmax_t fileSize = std::filesystem::file_size(path, error);
+
+        if (error)
+        {
+            return 0;
+        }
+
+        // note: the entire file is read at once and the records are
+        // deserialized directly from the buffer
+        std::vector<uint8_t> data(static_cast<size_t>(fileSize));
+
+        if (std::ifstream ifs{ path, std::ios::binary }; !ifs.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())))
+        {
+            throw std::runtime_error{ "could not read cache snapshot file: " + path.string() };
+        }
+
+        if (data.size() < Magic.size() || std::memcmp(data.data(), Magic.data(), Magic.size()) != 0)
+        {
+            throw std::runtime_error{ "file does not contain a cache snapshot: " + path.string() };
+        }
+
+        size_t restored = 0;
+        const uint8_t* recordBegin = data.data() + Magic.size();
+        const uint8_t* dataEnd = data.data() + data.size();
+        serialization::CborSerializer serializer;
+
+        while (recordBegin != dataEnd)
+        {
+            uint32_t recordSize = static_cast<size_t>(dataEnd - recordBegin) < RecordSizeSize ? 0 : decode_record_size(recordBegin);
+
+            if (recordSize == 0 || recordSize > static_cast<size_t>(dataEnd - recordBegin) - RecordSizeSize)
+            {
+                if (allowTruncation)
+                {
+                    break;
+                }
+
+                throw std::runtime_error{ "cache snapshot contains truncated record: " + path.string() };
+            }
+
+            serializer.setInput(recordBegin + RecordSizeSize, recordSize);
+            recordBegin += RecordSizeSize + recordSize;
+
+            auto header = serializer.deserialize<DotsHeader>();
+            const type::StructDescriptor* descriptor = m_registry->findStructType(*header.typeName);
+
+            if (descriptor == nullptr)
+            {
+                throw std::runtime_error{ "cache snapshot contains instance of unknown type '" + *header.typeName + "': " + path.string() };
+            }
+
+            if (descriptor == &StructDescriptorData::_Descriptor() || descriptor == &EnumDescriptorData::_Descriptor())
+            {
+                type::AnyStruct descriptorData{ *descriptor };
+                serializer.deserialize(*descriptorData);
+
+                if (const auto* structDescriptorData = descriptorData->_as<StructDescriptorData>(); structDescriptorData != nullptr && m_registry->findType(*structDescriptorData->name) == nullptr)
+                {
+                    DescriptorConverter{ *m_registry }(*structDescriptorData);
+                }
+                else if (const auto* enumDescriptorData = descriptorData->_as<EnumDescriptorData>(); enumDescriptorData != nullptr && m_registry->findType(*enumDescriptorData->name) == nullptr)
+                {
+                    DescriptorConverter{ *m_registry }(*enumDescriptorData);
+                }
+
+                continue;
+            }
+
+            auto cloneInfo = serializer.deserialize<DotsCloneInformation>();
+            type::AnyStruct instance{ *descriptor };
+            serializer.deserialize(*instance);
+            Container<>& container = pool.get(*descriptor);
+
+            if (header.removeObj == true)
+            {
+                container.remove(header, *instance);
+            }
+            else
+            {
+                container.restore(std::move(instance), std::move(cloneInfo));
+                ++restored;
+            }
+        }
+
+        return restored;
+    }
+
+    void CacheSnapshot::resetJournal()
+    {
+        if (m_journal.is_open())
+        {
+            m_journal.close();
+        }
+
+        m_journaledDescriptors.clear();
+        m_journal.open(m_journalPath, std::ios::binary | std::ios::out | std::ios::trunc);
+        m_journal.write(Magic.data(), static_cast<std::streamsize>(Magic.size()));
+        m_journal.flush();
+
+        if (!m_journal)
+        {
+            throw std::runtime_error{ "could not open cache journal file: " + m_journalPath.string() };
+        }
+    }
+}
@@ -12,7 +12,8 @@ namespace dots::io
         shared_ptr_only(key),
         m_asyncReceiving(false),
         m_initialized(false),
-        m_registry(nullptr)
+        m_registry(nullptr),
+        m_tracePeerId(0)
     {
         /* do nothing */
     }
@@ -63,6 +64,17 @@ namespace dots::io
         asyncReceiveImpl();
     }
 
+    void Channel::asyncReceive(receive_handler_t receiveHandler, receive_batch_handler_t receiveBatchHandler, error_handler_t errorHandler)
+    {
+        m_receiveBatchHandler = std::move(receiveBatchHandler);
+        asyncReceive(std::move(receiveHandler), std::move(errorHandler));
+    }
+
+    bool Channel::supportsBatchFrames() const
+    {
+        return supportsBatchFramesImpl();
+    }
+
     void Channel::transmit(const type::Struct& instance)
     {
       transmit(DotsHeader{
@@ -76,6 +88,35 @@ namespace dots::io
         assert(m_initialized);
         exportDependencies(instance._descriptor());
         transmitImpl(header, instance);
+        ++m_statistics.transmittedFrames;
+    }
+
+    void Channel::transmit(const DotsHeader& header, std::span<const type::Struct* const> instances)
+    {
+        assert(m_initialized);
+
+        if (instances.empty())
+        {
+            return;
+        }
+
+        exportDependencies(instances.front()->_descriptor());
+        transmitImpl(header, instances);
+        m_statistics.transmittedFrames += instances.size();
+    }
+
+    void Channel::transmitBatch(const DotsHeader& header, std::span<const type::Struct* const> instances)
+    {
+        assert(m_initialized);
+
+        if (instances.empty())
+        {
+            return;
+        }
+
+        exportDependencies(instances.front()->_descriptor());
+        transmitBatchImpl(header, instances);
+        ++m_statistics.transmittedFrames;
     }
 
     void Channel::transmit(const Transmission& transmission)
@@ -83,6 +124,7 @@ namespace dots::io
         assert(m_initialized);
         exportDependencies(transmission.instance());
         transmitImpl(transmission);
+        ++m_statistics.transmittedFrames;
     }
 
     void Channel::transmit(const type::Descriptor<>& descriptor)
@@ -90,6 +132,35 @@ namespace dots::io
         exportDependencies(descriptor);
     }
 
+    void Channel::transmitFromCache(const DotsHeader& header, const type::Struct& instance, uint64_t revision)
+    {
+        assert(m_initialized);
+        exportDependencies(instance._descriptor());
+        transmitFromCacheImpl(header, instance, revision);
+        ++m_statistics.transmittedFrames;
+    }
+
+    void Channel::asyncFlush(flush_handler_t handler)
+    {
+        asyncFlushImpl(std::move(handler));
+    }
+
+    void Channel::trace(std::shared_ptr<TransmissionTrace> trace, uint32_t peerId)
+    {
+        m_trace = std::move(trace);
+        m_tracePeerId = peerId;
+    }
+
+    void Channel::record(std::shared_ptr<Recording> recording)
+    {
+        m_recording = std::move(recording);
+    }
+
+    auto Channel::statistics() const -> const statistics_t&
+    {
+        return m_statistics;
+    }
+
     void Channel::initEndpoints(Endpoint localEndpoint, Endpoint remoteEndpoint)
     {
         if (m_localEndpoint != std::nullopt)
@@ -113,15 +184,61 @@ namespace dots::io
         return *m_registry;
     }
 
+    void Channel::transmitImpl(const DotsHeader& header, std::span<const type::Struct* const> instances)
+    {
+        // note: the header is only copied if the attributes have to be set
+        // individually for each instance
+        if (header.attributes.isValid())
+        {
+            for (const type::Struct* instance : instances)
+            {
+                transmitImpl(header, *instance);
+            }
+        }
+        else
+        {
+            DotsHeader instanceHeader = header;
+
+            for (const type::Struct* instance : instances)
+            {
+                instanceHeader.attributes = instance->_validProperties();
+                transmitImpl(instanceHeader, *instance);
+            }
+        }
+    }
+
+    void Channel::transmitBatchImpl(const DotsHeader&/* header*/, std::span<const type::Struct* const>/* instances*/)
+    {
+        throw std::logic_error{ "channel does not support batch frames" };
+    }
+
     void Channel::transmitImpl(const Transmission& transmission)
     {
         transmitImpl(transmission.header(), transmission.instance());
     }
 
+    void Channel::transmitFromCacheImpl(const DotsHeader& header, const type::Struct& instance, uint64_t/* revision*/)
+    {
+        transmitImpl(header, instance);
+    }
+
+    void Channel::asyncFlushImpl(flush_handler_t handler)
+    {
+        // note: channels without a write buffer hand over transmissions
+        // immediately and are therefore always flushed
+        handler(nullptr);
+    }
+
+    bool Channel::supportsBatchFramesImpl() const
+    {
+        return false;
+    }
+
     void Channel::processReceive(Transmission transmission) noexcept
     {
         try
         {
+            ++m_statistics.receivedFrames;
             importDependencies(transmission.instance());
 
             // note: if the receive handler yields 'false', the channel must no
@@ -138,6 +255,40 @@ namespace dots::io
         }
     }
 
+    void Channel::processReceive(std::vector<Transmission> transmissions) noexcept
+    {
+        try
+        {
+            ++m_statistics.receivedFrames;
+
+            // note: batch frames only contain instances of regular types and
+            // therefore never import any dependencies
+            if (m_receiveBatchHandler != std::nullopt)
+            {
+                if ((*m_receiveBatchHandler)(std::move(transmissions)))
+                {
+                    asyncReceiveImpl();
+                }
+            }
+            else
+            {
+                for (Transmission& transmission : transmissions)
+                {
+                    if (!(*m_receiveHandler)(std::move(transmission)))
+                    {
+                        return;
+                    }
+                }
+
+                asyncReceiveImpl();
+            }
+        }
+        catch (...)
+        {
+            processError(std::current_exception());
+        }
+    }
+
     void Channel::processError(std::exception_ptr ePtr)
     {
         try
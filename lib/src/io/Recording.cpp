@@ -0,0 +1,486 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/io/Recording.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <dots/serialization/CborSerializer.h>
+#include <DotsHeader.dots.h>
+#include <StructDescriptorData.dots.h>
+#include <EnumDescriptorData.dots.h>
+
+namespace dots::io
+{
+    namespace
+    {
+        template <typename T>
+        void encode_le(uint8_t*& data, T value)
+        {
+            for (size_t i = 0; i < sizeof(T); ++i)
+            {
+                *data++ = static_cast<uint8_t>(value >> (i * 8));
+            }
+        }
+
+        template <typename T>
+        T decode_le(const uint8_t*& data)
+        {
+            T value = 0;
+
+            for (size_t i = 0; i < sizeof(T); ++i)
+            {
+                value |= static_cast<T>(*data++) << (i * 8);
+            }
+
+            return value;
+        }
+
+        template <typename T>
+        void write_le(std::ostream& os, T value)
+        {
+            uint8_t buffer[sizeof(T)];
+            uint8_t* data = buffer;
+            encode_le(data, value);
+            os.write(reinterpret_cast<const char*>(buffer), sizeof(T));
+        }
+
+        template <typename T>
+        bool read_le(std::istream& is, T& value)
+        {
+            uint8_t buffer[sizeof(T)];
+
+            if (!is.read(reinterpret_cast<char*>(buffer), sizeof(T)))
+            {
+                return false;
+            }
+
+            const uint8_t* data = buffer;
+            value = decode_le<T>(data);
+
+            return true;
+        }
+
+        uint64_t to_nanoseconds(type::TimePoint time)
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.duration()).count());
+        }
+
+        type::TimePoint from_nanoseconds(uint64_t time)
+        {
+            return type::TimePoint{ std::chrono::duration_cast<type::Duration::base_t>(std::chrono::nanoseconds{ time }) };
+        }
+
+        std::filesystem::path segment_path(const std::filesystem::path& directory, uint64_t sequence)
+        {
+            std::string name = std::to_string(sequence);
+            name.insert(0, name.size() < 8 ? 8 - name.size() : 0, '0');
+
+            return directory / (name + std::string{ Recording::SegmentExtension });
+        }
+
+        std::filesystem::path index_path(std::filesystem::path segmentPath)
+        {
+            return segmentPath.replace_extension(Recording::IndexExtension);
+        }
+    }
+
+    Recording::Recording(std::filesystem::path directory, size_t segmentSize/* = DefaultSegmentSize*/) :
+        m_directory{ std::move(directory) },
+        m_segmentSize(segmentSize),
+        m_sequence(0),
+        m_segments(0),
+        m_frames(0),
+        m_offset(0)
+    {
+        if (m_segmentSize <= SegmentMagic.size() + FrameHeaderSize)
+        {
+            throw std::logic_error{ "recording segment size is too small: " + std::to_string(m_segmentSize) };
+        }
+
+        if (std::error_code error; !std::filesystem::create_directories(m_directory, error) && error)
+        {
+            throw std::runtime_error{ "could not create recording directory: " + m_directory.string() + " -> " + error.message() };
+        }
+
+        // note: an existing recording is continued after its last segment
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator{ m_directory })
+        {
+            if (entry.path().extension() == SegmentExtension)
+            {
+                try
+                {
+                    m_sequence = std::max<uint64_t>(m_sequence, std::stoull(entry.path().stem().string()));
+                }
+                catch (const std::exception&)
+                {
+                    /* do nothing */
+                }
+            }
+        }
+    }
+
+    Recording::~Recording()
+    {
+        try
+        {
+            seal();
+        }
+        catch (...)
+        {
+            /* do nothing */
+        }
+    }
+
+    const std::filesystem::path& Recording::directory() const
+    {
+        return m_directory;
+    }
+
+    size_t Recording::segmentSize() const
+    {
+        return m_segmentSize;
+    }
+
+    size_t Recording::segments() const
+    {
+        std::lock_guard lock{ m_mutex };
+        return m_segments;
+    }
+
+    size_t Recording::frames() const
+    {
+        std::lock_guard lock{ m_mutex };
+        return m_frames;
+    }
+
+    void Recording::append(type::TimePoint time, std::string_view typeName, const uint8_t* payload, size_t size)
+    {
+        std::lock_guard lock{ m_mutex };
+        size_t frameSize = FrameHeaderSize + size;
+
+        if (m_region != std::nullopt && m_offset + frameSize > m_region->get_size())
+        {
+            sealSegment();
+        }
+
+        if (m_region == std::nullopt)
+        {
+            openSegment(std::max(m_segmentSize, SegmentMagic.size() + frameSize));
+        }
+
+        auto* frameBegin = static_cast<uint8_t*>(m_region->get_address()) + m_offset;
+        uint8_t* data = frameBegin;
+        uint64_t timeNs = to_nanoseconds(time);
+        encode_le(data, timeNs);
+        encode_le(data, static_cast<uint32_t>(size));
+        std::memcpy(data, payload, size);
+
+        auto [it, emplaced] = m_typeIndices.try_emplace(std::string{ typeName }, static_cast<uint32_t>(m_types.size()));
+
+        if (emplaced)
+        {
+            m_types.emplace_back(typeName);
+        }
+
+        m_index.emplace_back(index_entry_t{ timeNs, m_offset, it->second });
+        m_offset += frameSize;
+        ++m_frames;
+    }
+
+    void Recording::flush()
+    {
+        std::lock_guard lock{ m_mutex };
+
+        if (m_region != std::nullopt)
+        {
+            m_region->flush(0, m_offset);
+        }
+    }
+
+    void Recording::seal()
+    {
+        std::lock_guard lock{ m_mutex };
+        sealSegment();
+    }
+
+    void Recording::sealSegment()
+    {
+        if (m_region == std::nullopt)
+        {
+            return;
+        }
+
+        m_region->flush(0, m_offset);
+        m_region.reset();
+        m_mapping.reset();
+
+        std::filesystem::resize_file(m_segmentPath, m_offset);
+        writeIndex(index_path(m_segmentPath));
+
+        m_types.clear();
+        m_typeIndices.clear();
+        m_index.clear();
+        m_offset = 0;
+    }
+
+    void Recording::openSegment(size_t size)
+    {
+        m_segmentPath = segment_path(m_directory, ++m_sequence);
+
+        {
+            std::ofstream ofs{ m_segmentPath, std::ios::binary | std::ios::trunc };
+            ofs.write(SegmentMagic.data(), static_cast<std::streamsize>(SegmentMagic.size()));
+
+            if (!ofs)
+            {
+                throw std::runtime_error{ "could not create recording segment: " + m_segmentPath.string() };
+            }
+        }
+
+        // note: resizing the file zero-fills the preallocated part, which
+        // marks the end of the frames if the segment is never sealed
+        std::filesystem::resize_file(m_segmentPath, size);
+        m_mapping.emplace(m_segmentPath.string().c_str(), boost::interprocess::read_write);
+        m_region.emplace(*m_mapping, boost::interprocess::read_write);
+        m_offset = SegmentMagic.size();
+        ++m_segments;
+    }
+
+    void Recording::writeIndex(const std::filesystem::path& path) const
+    {
+        std::ofstream ofs{ path, std::ios::binary | std::ios::trunc };
+        ofs.write(IndexMagic.data(), static_cast<std::streamsize>(IndexMagic.size()));
+        write_le(ofs, static_cast<uint32_t>(m_types.size()));
+
+        for (const std::string& type : m_types)
+        {
+            write_le(ofs, static_cast<uint16_t>(type.size()));
+            ofs.write(type.data(), static_cast<std::streamsize>(type.size()));
+        }
+
+        write_le(ofs, static_cast<uint64_t>(m_index.size()));
+
+        for (const index_entry_t& entry : m_index)
+        {
+            write_le(ofs, entry.time);
+            write_le(ofs, entry.offset);
+            write_le(ofs, entry.type);
+        }
+
+        if (!ofs)
+        {
+            throw std::runtime_error{ "could not write recording index: " + path.string() };
+        }
+    }
+
+    RecordingReader::RecordingReader(const std::filesystem::path& directory) :
+        m_frames(0)
+    {
+        if (!std::filesystem::is_directory(directory))
+        {
+            throw std::runtime_error{ "recording directory does not exist: " + directory.string() };
+        }
+
+        std::vector<std::filesystem::path> segmentPaths;
+
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator{ directory })
+        {
+            if (entry.path().extension() == Recording::SegmentExtension)
+            {
+                segmentPaths.emplace_back(entry.path());
+            }
+        }
+
+        std::sort(segmentPaths.begin(), segmentPaths.end());
+
+        for (const std::filesystem::path& segmentPath : segmentPaths)
+        {
+            if (std::filesystem::file_size(segmentPath) < Recording::SegmentMagic.size())
+            {
+                continue;
+            }
+
+            auto segment = std::make_unique<segment_t>();
+            segment->mapping = boost::interprocess::file_mapping{ segmentPath.string().c_str(), boost::interprocess::read_only };
+            segment->region = boost::interprocess::mapped_region{ segment->mapping, boost::interprocess::read_only };
+
+            if (std::memcmp(segment->region.get_address(), Recording::SegmentMagic.data(), Recording::SegmentMagic.size()) != 0)
+            {
+                throw std::runtime_error{ "file does not contain a recording segment: " + segmentPath.string() };
+            }
+
+            if (!LoadIndex(index_path(segmentPath), *segment))
+            {
+                ScanSegment(*segment);
+            }
+
+            m_frames += segment->times.size();
+            m_segments.emplace_back(std::move(segment));
+        }
+    }
+
+    size_t RecordingReader::segments() const
+    {
+        return m_segments.size();
+    }
+
+    size_t RecordingReader::frames() const
+    {
+        return m_frames;
+    }
+
+    auto RecordingReader::read(const std::optional<std::unordered_set<std::string>>& types/* = std::nullopt*/, std::optional<type::TimePoint> from/* = std::nullopt*/, std::optional<type::TimePoint> to/* = std::nullopt*/) const -> std::vector<Frame>
+    {
+        uint64_t fromNs = from == std::nullopt ? 0 : to_nanoseconds(*from);
+        uint64_t toNs = to == std::nullopt ? std::numeric_limits<uint64_t>::max() : to_nanoseconds(*to);
+        std::vector<Frame> frames;
+
+        for (const std::unique_ptr<segment_t>& segment : m_segments)
+        {
+            if (segment->times.empty() || segment->times.back() < fromNs || segment->times.front() > toNs)
+            {
+                continue;
+            }
+
+            std::vector<bool> selectedTypes(segment->types.size());
+
+            for (size_t i = 0; i < segment->types.size(); ++i)
+            {
+                const std::string& type = segment->types[i];
+                selectedTypes[i] = types == std::nullopt || types->count(type) > 0 || type == StructDescriptorData::_Descriptor().name() || type == EnumDescriptorData::_Descriptor().name();
+            }
+
+            const auto* segmentBegin = static_cast<const uint8_t*>(segment->region.get_address());
+            auto first = static_cast<size_t>(std::lower_bound(segment->times.begin(), segment->times.end(), fromNs) - segment->times.begin());
+
+            // note: descriptor frames that precede the selected time range
+            // are included as well, because they might be required to decode
+            // the selected frames
+            for (size_t i = 0; i < segment->times.size() && segment->times[i] <= toNs; ++i)
+            {
+                const std::string& typeName = segment->types[segment->typeIndices[i]];
+
+                if (!selectedTypes[segment->typeIndices[i]] || (i < first && typeName != StructDescriptorData::_Descriptor().name() && typeName != EnumDescriptorData::_Descriptor().name()))
+                {
+                    continue;
+                }
+
+                const uint8_t* data = segmentBegin + segment->offsets[i] + sizeof(uint64_t);
+                auto size = decode_le<uint32_t>(data);
+                frames.emplace_back(Frame{ from_nanoseconds(segment->times[i]), typeName, data, size });
+            }
+        }
+
+        return frames;
+    }
+
+    bool RecordingReader::LoadIndex(const std::filesystem::path& path, segment_t& segment)
+    {
+        std::ifstream ifs{ path, std::ios::binary };
+
+        if (!ifs)
+        {
+            return false;
+        }
+
+        std::string magic(Recording::IndexMagic.size(), '\0');
+        uint32_t typeCount;
+
+        if (!ifs.read(magic.data(), static_cast<std::streamsize>(magic.size())) || magic != Recording::IndexMagic || !read_le(ifs, typeCount))
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < typeCount; ++i)
+        {
+            uint16_t typeSize;
+
+            if (!read_le(ifs, typeSize))
+            {
+                return false;
+            }
+
+            std::string& type = segment.types.emplace_back(typeSize, '\0');
+
+            if (!ifs.read(type.data(), typeSize))
+            {
+                return false;
+            }
+        }
+
+        uint64_t frameCount;
+
+        if (!read_le(ifs, frameCount))
+        {
+            return false;
+        }
+
+        segment.times.resize(frameCount);
+        segment.offsets.resize(frameCount);
+        segment.typeIndices.resize(frameCount);
+
+        for (uint64_t i = 0; i < frameCount; ++i)
+        {
+            if (!read_le(ifs, segment.times[i]) || !read_le(ifs, segment.offsets[i]) || !read_le(ifs, segment.typeIndices[i]) || segment.typeIndices[i] >= typeCount)
+            {
+                segment.types.clear();
+                segment.times.clear();
+                segment.offsets.clear();
+                segment.typeIndices.clear();
+
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void RecordingReader::ScanSegment(segment_t& segment)
+    {
+        const auto* segmentBegin = static_cast<const uint8_t*>(segment.region.get_address());
+        size_t segmentSize = segment.region.get_size();
+        size_t offset = Recording::SegmentMagic.size();
+        std::unordered_map<std::string, uint32_t> typeIndices;
+        serialization::CborSerializer serializer;
+
+        while (segmentSize - offset >= Recording::FrameHeaderSize)
+        {
+            const uint8_t* data = segmentBegin + offset;
+            auto time = decode_le<uint64_t>(data);
+            auto size = decode_le<uint32_t>(data);
+
+            // note: a zero size marks the zero-filled end of a segment that
+            // was not sealed
+            if (size == 0 || size > segmentSize - offset - Recording::FrameHeaderSize)
+            {
+                break;
+            }
+
+            DotsHeader header;
+
+            try
+            {
+                serializer.setInput(data, size);
+                header = serializer.deserialize<DotsHeader>();
+            }
+            catch (const std::exception&)
+            {
+                // note: the last frame might only have been partially
+                // written if the process was terminated
+                break;
+            }
+            auto [it, emplaced] = typeIndices.try_emplace(*header.typeName, static_cast<uint32_t>(segment.types.size()));
+
+            if (emplaced)
+            {
+                segment.types.emplace_back(*header.typeName);
+            }
+
+            segment.times.emplace_back(time);
+            segment.offsets.emplace_back(offset);
+            segment.typeIndices.emplace_back(it->second);
+            offset += Recording::FrameHeaderSize + size;
+        }
+    }
+}
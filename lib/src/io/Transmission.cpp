@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #include <dots/io/Transmission.h>
+#include <dots/type/InstancePool.h>
 
 namespace dots::io
 {
@@ -39,4 +40,14 @@ namespace dots::io
     {
         return type::AnyStruct{ std::move(m_data->instance) };
     }
+
+    void* Transmission::TransmissionData::operator new(size_t size)
+    {
+        return type::InstancePool::Allocate(size);
+    }
+
+    void Transmission::TransmissionData::operator delete(void* data, size_t size) noexcept
+    {
+        type::InstancePool::Deallocate(data, size);
+    }
 }
@@ -0,0 +1,301 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/io/TransmissionTrace.h>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+
+namespace dots::io
+{
+    namespace
+    {
+        using frame_header_t = std::array<uint8_t, TransmissionTrace::FrameHeaderSize>;
+
+        template <typename T>
+        void encode_le(uint8_t*& data, T value)
+        {
+            for (size_t i = 0; i < sizeof(T); ++i)
+            {
+                *data++ = static_cast<uint8_t>(value >> (i * 8));
+            }
+        }
+
+        template <typename T>
+        T decode_le(const uint8_t*& data)
+        {
+            T value = 0;
+
+            for (size_t i = 0; i < sizeof(T); ++i)
+            {
+                value |= static_cast<T>(*data++) << (i * 8);
+            }
+
+            return value;
+        }
+
+        frame_header_t encode_frame_header(uint64_t time, uint32_t peerId, uint32_t size, TransmissionTrace::Direction direction)
+        {
+            frame_header_t frameHeader;
+            uint8_t* data = frameHeader.data();
+            encode_le(data, time);
+            encode_le(data, peerId);
+            encode_le(data, size);
+            encode_le(data, static_cast<uint8_t>(direction));
+
+            return frameHeader;
+        }
+
+        uint32_t decode_frame_size(const frame_header_t& frameHeader)
+        {
+            const uint8_t* data = frameHeader.data() + sizeof(uint64_t) + sizeof(uint32_t);
+            return decode_le<uint32_t>(data);
+        }
+
+        std::shared_ptr<TransmissionTrace> create_global_transmission_trace()
+        {
+            const char* capacity = std::getenv("DOTS_TRANSMISSION_TRACE");
+
+            if (capacity == nullptr)
+            {
+                return nullptr;
+            }
+
+            const char* dumpPath = std::getenv("DOTS_TRANSMISSION_TRACE_FILE");
+
+            return std::make_shared<TransmissionTrace>(std::stoul(capacity) * 1024, dumpPath == nullptr ? "dots-transmission-trace.bin" : dumpPath);
+        }
+
+        std::shared_ptr<TransmissionTrace>& global_transmission_trace_storage()
+        {
+            static std::shared_ptr<TransmissionTrace> GlobalTransmissionTrace = create_global_transmission_trace();
+            return GlobalTransmissionTrace;
+        }
+    }
+
+    TransmissionTrace::TransmissionTrace(size_t capacity/* = DefaultCapacity*/, std::optional<std::filesystem::path> dumpPath/* = std::nullopt*/, std::chrono::steady_clock::duration incidentWindow/* = DefaultIncidentWindow*/) :
+        m_ring(capacity),
+        m_begin(0),
+        m_end(0),
+        m_size(0),
+        m_discarded(0),
+        m_dumpPath{ std::move(dumpPath) },
+        m_incidentWindow(incidentWindow)
+    {
+        if (capacity < FrameHeaderSize)
+        {
+            throw std::logic_error{ "transmission trace capacity is too small: " + std::to_string(capacity) };
+        }
+    }
+
+    size_t TransmissionTrace::capacity() const
+    {
+        return m_ring.size();
+    }
+
+    size_t TransmissionTrace::size() const
+    {
+        std::lock_guard lock{ m_mutex };
+        return m_size;
+    }
+
+    size_t TransmissionTrace::discarded() const
+    {
+        std::lock_guard lock{ m_mutex };
+        return m_discarded;
+    }
+
+    const std::optional<std::filesystem::path>& TransmissionTrace::dumpPath() const
+    {
+        return m_dumpPath;
+    }
+
+    void TransmissionTrace::record(Direction direction, uint32_t peerId, const uint8_t* payload, size_t size, bool descriptor/* = false*/)
+    {
+        auto time = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        frame_header_t frameHeader = encode_frame_header(time, peerId, static_cast<uint32_t>(size), direction);
+
+        std::lock_guard lock{ m_mutex };
+
+        if (descriptor)
+        {
+            if (auto [it, emplaced] = m_descriptorPayloads.emplace(reinterpret_cast<const char*>(payload), size); emplaced)
+            {
+                m_descriptorFrames.insert(m_descriptorFrames.end(), frameHeader.begin(), frameHeader.end());
+                m_descriptorFrames.insert(m_descriptorFrames.end(), payload, payload + size);
+            }
+        }
+
+        size_t frameSize = FrameHeaderSize + size;
+
+        if (frameSize > m_ring.size())
+        {
+            ++m_discarded;
+            return;
+        }
+
+        while (m_ring.size() - m_size < frameSize)
+        {
+            discardOldest();
+        }
+
+        write(frameHeader.data(), frameHeader.size());
+        write(payload, size);
+    }
+
+    void TransmissionTrace::clear()
+    {
+        std::lock_guard lock{ m_mutex };
+        m_begin = 0;
+        m_end = 0;
+        m_size = 0;
+    }
+
+    void TransmissionTrace::dump() const
+    {
+        if (m_dumpPath == std::nullopt)
+        {
+            throw std::logic_error{ "transmission trace has no dump path" };
+        }
+
+        dump(*m_dumpPath);
+    }
+
+    std::optional<std::filesystem::path> TransmissionTrace::dumpIncident(uint32_t peerId)
+    {
+        if (m_dumpPath == std::nullopt)
+        {
+            throw std::logic_error{ "transmission trace has no dump path" };
+        }
+
+        {
+            std::lock_guard lock{ m_mutex };
+            auto now = std::chrono::steady_clock::now();
+
+            if (m_lastIncident != std::nullopt && now - *m_lastIncident < m_incidentWindow)
+            {
+                return std::nullopt;
+            }
+
+            m_lastIncident = now;
+        }
+
+        std::filesystem::path path = *m_dumpPath;
+        std::string fileName = path.stem().string() + '-' + type::TimePoint::Now().toString("%Y%m%dT%H%M%S", true) + "-peer" + std::to_string(peerId) + path.extension().string();
+        path.replace_filename(fileName);
+        dump(path);
+
+        return path;
+    }
+
+    void TransmissionTrace::dump(const std::filesystem::path& path) const
+    {
+        std::ofstream ofs{ path, std::ios::binary | std::ios::trunc };
+
+        if (!ofs)
+        {
+            throw std::runtime_error{ "could not open transmission trace dump file: " + path.string() };
+        }
+
+        dump(ofs);
+
+        if (!ofs)
+        {
+            throw std::runtime_error{ "could not write transmission trace dump file: " + path.string() };
+        }
+    }
+
+    void TransmissionTrace::dump(std::ostream& os) const
+    {
+        std::lock_guard lock{ m_mutex };
+
+        os.write(Magic.data(), static_cast<std::streamsize>(Magic.size()));
+        os.write(reinterpret_cast<const char*>(m_descriptorFrames.data()), static_cast<std::streamsize>(m_descriptorFrames.size()));
+
+        size_t firstPartSize = std::min(m_size, m_ring.size() - m_begin);
+        os.write(reinterpret_cast<const char*>(m_ring.data() + m_begin), static_cast<std::streamsize>(firstPartSize));
+        os.write(reinterpret_cast<const char*>(m_ring.data()), static_cast<std::streamsize>(m_size - firstPartSize));
+    }
+
+    auto TransmissionTrace::Read(std::istream& is) -> std::vector<Frame>
+    {
+        std::string magic(Magic.size(), '\0');
+        is.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+
+        if (!is || magic != Magic)
+        {
+            throw std::runtime_error{ "stream does not contain a transmission trace" };
+        }
+
+        std::vector<Frame> frames;
+
+        for (frame_header_t frameHeader; is.read(reinterpret_cast<char*>(frameHeader.data()), frameHeader.size());)
+        {
+            const uint8_t* data = frameHeader.data();
+            auto time = decode_le<uint64_t>(data);
+            auto peerId = decode_le<uint32_t>(data);
+            auto size = decode_le<uint32_t>(data);
+            auto direction = decode_le<uint8_t>(data);
+
+            if (direction > static_cast<uint8_t>(Direction::transmit))
+            {
+                throw std::runtime_error{ "transmission trace contains invalid direction: " + std::to_string(direction) };
+            }
+
+            Frame& frame = frames.emplace_back(Frame{
+                .time = type::TimePoint{ std::chrono::duration_cast<type::Duration::base_t>(std::chrono::nanoseconds{ time }) },
+                .peerId = peerId,
+                .direction = static_cast<Direction>(direction),
+                .payload = std::vector<uint8_t>(size)
+            });
+
+            if (!is.read(reinterpret_cast<char*>(frame.payload.data()), static_cast<std::streamsize>(size)))
+            {
+                throw std::runtime_error{ "transmission trace contains truncated frame" };
+            }
+        }
+
+        return frames;
+    }
+
+    void TransmissionTrace::write(const uint8_t* data, size_t size)
+    {
+        size_t firstPartSize = std::min(size, m_ring.size() - m_end);
+        std::memcpy(m_ring.data() + m_end, data, firstPartSize);
+        std::memcpy(m_ring.data(), data + firstPartSize, size - firstPartSize);
+
+        m_end = (m_end + size) % m_ring.size();
+        m_size += size;
+    }
+
+    void TransmissionTrace::read(size_t offset, uint8_t* data, size_t size) const
+    {
+        size_t firstPartSize = std::min(size, m_ring.size() - offset);
+        std::memcpy(data, m_ring.data() + offset, firstPartSize);
+        std::memcpy(data + firstPartSize, m_ring.data(), size - firstPartSize);
+    }
+
+    void TransmissionTrace::discardOldest()
+    {
+        frame_header_t frameHeader;
+        read(m_begin, frameHeader.data(), frameHeader.size());
+        size_t frameSize = FrameHeaderSize + decode_frame_size(frameHeader);
+
+        m_begin = (m_begin + frameSize) % m_ring.size();
+        m_size -= frameSize;
+        ++m_discarded;
+    }
+
+    std::shared_ptr<TransmissionTrace> global_transmission_trace()
+    {
+        return global_transmission_trace_storage();
+    }
+
+    void set_global_transmission_trace(std::shared_ptr<TransmissionTrace> trace)
+    {
+        global_transmission_trace_storage() = std::move(trace);
+    }
+}
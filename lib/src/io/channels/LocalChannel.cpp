@@ -83,4 +83,72 @@ namespace dots::io
             }
         });
     }
+
+    void LocalChannel::transmitBatchImpl(const DotsHeader& header, std::span<const type::Struct* const> instances)
+    {
+        auto other = m_peer.lock();
+
+        if (other == nullptr)
+        {
+            throw std::runtime_error{ "local channel is not linked or expired unexpectedly" };
+        }
+
+        std::vector<std::vector<uint8_t>> data;
+        data.reserve(instances.size());
+
+        for (const type::Struct* instance : instances)
+        {
+            data.emplace_back(to_cbor(*instance, header.attributes.isValid() ? *header.attributes : instance->_validProperties()));
+        }
+
+        asio::post(other->m_ioContext.get(), [peer = m_peer, header = header, data = std::move(data)]() mutable
+        {
+            auto other = peer.lock();
+
+            try
+            {
+                if (other == nullptr)
+                {
+                    return;
+                }
+
+                const type::StructDescriptor* descriptor = other->registry().findStructType(*header.typeName);
+
+                if (descriptor == nullptr)
+                {
+                    throw std::runtime_error{ "encountered unknown type: " + *header.typeName };
+                }
+
+                std::vector<Transmission> transmissions;
+                transmissions.reserve(data.size());
+                header.batchSize.reset();
+
+                for (const std::vector<uint8_t>& instanceData : data)
+                {
+                    type::AnyStruct instance{ *descriptor };
+                    from_cbor(instanceData, instance.get());
+
+                    DotsHeader instanceHeader = header;
+
+                    if (!instanceHeader.attributes.isValid())
+                    {
+                        instanceHeader.attributes = instance->_validProperties();
+                    }
+
+                    transmissions.emplace_back(std::move(instanceHeader), std::move(instance));
+                }
+
+                other->processReceive(std::move(transmissions));
+            }
+            catch (...)
+            {
+                other->processError(std::current_exception());
+            }
+        });
+    }
+
+    bool LocalChannel::supportsBatchFramesImpl() const
+    {
+        return true;
+    }
 }
@@ -17,7 +17,7 @@ namespace dots::io::details
         m_port{ std::move(port) },
         m_acceptor{ ioContext },
         m_socket{ ioContext },
-        m_payloadCache{ 0, buffer_t{} }
+        m_payloadCache{}
     {
         try
         {
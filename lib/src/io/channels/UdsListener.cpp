@@ -18,7 +18,7 @@ namespace dots::io::posix::details
         m_endpoint{ path.data() },
         m_acceptor{ ioContext },
         m_socket{ ioContext },
-        m_payloadCache{ 0, UdsChannel::buffer_t{} }
+        m_payloadCache{}
     {
         try
         {
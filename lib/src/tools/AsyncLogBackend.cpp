@@ -0,0 +1,271 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/tools/AsyncLogBackend.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <string>
+
+namespace dots::tools
+{
+    AsyncLogBackend::AsyncLogBackend(size_t capacity/* = DefaultCapacity*/, OverflowPolicy overflowPolicy/* = OverflowPolicy::drop*/, FILE* destination/* = stderr*/) :
+        m_slots(std::make_unique<Slot[]>(std::bit_ceil(std::max<size_t>(capacity, 2)))),
+        m_mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+        m_overflowPolicy(overflowPolicy),
+        m_destination(destination),
+        m_colorOut(getenv("DOTS_DISABLE_LOG_COLORS") == nullptr),
+        m_enqueuePos(0),
+        m_dequeuePos(0),
+        m_writtenPos(0),
+        m_overflowCount(0),
+        m_reportedOverflowCount(0),
+        m_sleeping(false),
+        m_stop(false)
+    {
+        for (size_t i = 0; i <= m_mask; ++i)
+        {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        m_writer = std::thread{ &AsyncLogBackend::run, this };
+    }
+
+    AsyncLogBackend::~AsyncLogBackend()
+    {
+        {
+            std::lock_guard lock{ m_mutex };
+            m_stop = true;
+        }
+
+        m_wakeUp.notify_one();
+        m_writer.join();
+    }
+
+    void AsyncLogBackend::log_p(Level level, const Flf &flf, const char* text)
+    {
+        enqueue(level, flf, text);
+    }
+
+    void AsyncLogBackend::log(Level level, const Flf &flf, const std::string& text)
+    {
+        enqueue(level, flf, text);
+    }
+
+    void AsyncLogBackend::flush()
+    {
+        size_t target = m_enqueuePos.load(std::memory_order_acquire);
+        m_wakeUp.notify_one();
+
+        std::unique_lock lock{ m_mutex };
+        m_written.wait(lock, [&]{ return m_writtenPos.load(std::memory_order_acquire) >= target || m_stop; });
+    }
+
+    size_t AsyncLogBackend::capacity() const
+    {
+        return m_mask + 1;
+    }
+
+    uint64_t AsyncLogBackend::overflowCount() const
+    {
+        return m_overflowCount.load(std::memory_order_relaxed);
+    }
+
+    void AsyncLogBackend::enqueue(Level level, const Flf& flf, std::string_view text)
+    {
+        type::TimePoint time = type::TimePoint::Now();
+
+        while (!tryEnqueue(time, level, flf, text))
+        {
+            if (m_overflowPolicy == OverflowPolicy::drop)
+            {
+                m_overflowCount.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+
+            m_wakeUp.notify_one();
+            std::this_thread::yield();
+        }
+
+        // note: the writer is only notified when it is idle. a notification
+        // that gets lost because the writer is about to wait is compensated
+        // by the timeout of the wait
+        if (m_sleeping.load())
+        {
+            m_wakeUp.notify_one();
+        }
+    }
+
+    bool AsyncLogBackend::tryEnqueue(const type::TimePoint& time, Level level, const Flf& flf, std::string_view text)
+    {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        for (;;)
+        {
+            slot = &m_slots[pos & m_mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+            if (diff == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        Record& record = slot->record;
+        record.time = time;
+        record.file = flf.file;
+        record.func = flf.func;
+        record.line = flf.line;
+        record.level = level;
+        record.truncated = text.size() > MaxTextLength;
+        record.length = static_cast<uint16_t>(std::min(text.size(), MaxTextLength));
+        std::memcpy(record.text, text.data(), record.length);
+
+        slot->sequence.store(pos + 1, std::memory_order_seq_cst);
+
+        return true;
+    }
+
+    bool AsyncLogBackend::empty() const
+    {
+        return m_slots[m_dequeuePos & m_mask].sequence.load(std::memory_order_acquire) != m_dequeuePos + 1;
+    }
+
+    size_t AsyncLogBackend::dequeue(std::string& batch)
+    {
+        size_t count = 0;
+
+        for (; count < MaxBatchSize && !empty(); ++count)
+        {
+            Slot& slot = m_slots[m_dequeuePos & m_mask];
+            const Record& record = slot.record;
+            std::string_view text{ record.text, record.length };
+
+            if (record.truncated)
+            {
+                format(batch, record.time, record.level, record.file, record.line, record.func, std::string{ text } + " [truncated]");
+            }
+            else
+            {
+                format(batch, record.time, record.level, record.file, record.line, record.func, text);
+            }
+
+            slot.sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+            ++m_dequeuePos;
+        }
+
+        return count;
+    }
+
+    void AsyncLogBackend::format(std::string& batch, const type::TimePoint& time, Level level, std::string_view file, int line, std::string_view func, std::string_view text) const
+    {
+        constexpr int MaxLengthLevel = 6;
+        const char* dark = "";
+        const char* allOff = "";
+        const char* levelColor = "";
+
+        if (m_colorOut) {
+            dark = "\33[1;30m";
+            allOff = "\33[0m";
+            levelColor = ConsoleLogBackend::level2color(level);
+        }
+
+        std::string_view levelString = level2string(level);
+
+        batch += levelColor;
+        batch += levelString;
+        batch.append(static_cast<size_t>(std::max(MaxLengthLevel - static_cast<int>(levelString.size()), 0)), ' ');
+        batch += ':';
+        batch += allOff;
+        batch += ' ';
+        batch += dark;
+        batch += '[';
+        batch += time.toString();
+        batch += ']';
+        batch += allOff;
+        batch += ' ';
+        batch += text;
+        batch += ' ';
+        batch += dark;
+        batch += '(';
+        batch += file;
+        batch += ':';
+        batch += std::to_string(line);
+        batch += " (";
+        batch += func;
+        batch += "))";
+        batch += allOff;
+        batch += '\n';
+    }
+
+    void AsyncLogBackend::write(std::string& batch)
+    {
+        std::fwrite(batch.data(), 1, batch.size(), m_destination);
+        std::fflush(m_destination);
+        batch.clear();
+    }
+
+    void AsyncLogBackend::run()
+    {
+        using namespace std::chrono_literals;
+        std::string batch;
+
+        for (;;)
+        {
+            bool stop = m_stop.load();
+
+            while (dequeue(batch) > 0)
+            {
+                if (uint64_t overflowCount = m_overflowCount.load(std::memory_order_relaxed); overflowCount != m_reportedOverflowCount)
+                {
+                    const Flf flf = FLF;
+                    std::string text = std::to_string(overflowCount - m_reportedOverflowCount) + " log message(s) dropped due to overflow";
+                    format(batch, type::TimePoint::Now(), Level::warn, flf.file, flf.line, flf.func, text);
+                    m_reportedOverflowCount = overflowCount;
+                }
+
+                write(batch);
+
+                {
+                    std::lock_guard lock{ m_mutex };
+                    m_writtenPos.store(m_dequeuePos, std::memory_order_release);
+                }
+
+                m_written.notify_all();
+            }
+
+            if (stop)
+            {
+                break;
+            }
+
+            m_sleeping.store(true);
+
+            {
+                std::unique_lock lock{ m_mutex };
+                m_wakeUp.wait_for(lock, 100ms, [&]{ return m_stop || !empty(); });
+            }
+
+            m_sleeping.store(false);
+        }
+
+        {
+            std::lock_guard lock{ m_mutex };
+            m_writtenPos.store(m_dequeuePos, std::memory_order_release);
+        }
+
+        m_written.notify_all();
+    }
+}
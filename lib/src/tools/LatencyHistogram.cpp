@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/tools/LatencyHistogram.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace dots::tools
+{
+    namespace
+    {
+        constexpr uint64_t SubBucketCount = uint64_t{ 1 } << LatencyHistogram::SubBucketBits;
+        constexpr uint64_t MaxValue = (uint64_t{ 1 } << (LatencyHistogram::MaxExponent + 1)) - 1;
+    }
+
+    LatencyHistogram::LatencyHistogram()
+    {
+        clear();
+    }
+
+    void LatencyHistogram::record(duration_t latency)
+    {
+        uint64_t value = latency.count() < 0 ? 0 : std::min(static_cast<uint64_t>(latency.count()), MaxValue);
+
+        ++m_buckets[BucketIndex(value)];
+        ++m_count;
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+
+    uint64_t LatencyHistogram::count() const
+    {
+        return m_count;
+    }
+
+    auto LatencyHistogram::min() const -> duration_t
+    {
+        return duration_t{ m_count == 0 ? 0 : static_cast<duration_t::rep>(m_min) };
+    }
+
+    auto LatencyHistogram::max() const -> duration_t
+    {
+        return duration_t{ static_cast<duration_t::rep>(m_max) };
+    }
+
+    auto LatencyHistogram::quantile(double q) const -> duration_t
+    {
+        if (m_count == 0)
+        {
+            return duration_t::zero();
+        }
+
+        auto rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(m_count))), 1);
+        uint64_t accumulated = 0;
+
+        for (size_t i = 0; i < BucketCount; ++i)
+        {
+            accumulated += m_buckets[i];
+
+            if (accumulated >= rank)
+            {
+                return duration_t{ static_cast<duration_t::rep>(std::clamp(BucketUpperBound(i), m_min, m_max)) };
+            }
+        }
+
+        return max();
+    }
+
+    void LatencyHistogram::clear()
+    {
+        m_buckets.fill(0);
+        m_count = 0;
+        m_min = MaxValue;
+        m_max = 0;
+    }
+
+    size_t LatencyHistogram::BucketIndex(uint64_t value)
+    {
+        // note: values below the sub-bucket count are mapped linearly. all
+        // other values are mapped to the sub-bucket of their power of two
+        if (value < SubBucketCount)
+        {
+            return static_cast<size_t>(value);
+        }
+
+        auto exponent = static_cast<uint32_t>(std::bit_width(value) - 1);
+        uint64_t subBucket = (value >> (exponent - SubBucketBits)) & (SubBucketCount - 1);
+
+        return static_cast<size_t>(((exponent - SubBucketBits + 1) << SubBucketBits) + subBucket);
+    }
+
+    uint64_t LatencyHistogram::BucketUpperBound(size_t index)
+    {
+        if (index < SubBucketCount)
+        {
+            return index;
+        }
+
+        uint32_t exponent = static_cast<uint32_t>(index >> SubBucketBits) + SubBucketBits - 1;
+        uint64_t subBucket = index & (SubBucketCount - 1);
+        uint64_t width = uint64_t{ 1 } << (exponent - SubBucketBits);
+
+        return ((SubBucketCount + subBucket) << (exponent - SubBucketBits)) + width - 1;
+    }
+}
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/tools/LoopTime.h>
+#include <atomic>
+#include <optional>
+
+namespace dots::tools
+{
+    namespace
+    {
+        struct scope_state_t
+        {
+            uint32_t depth = 0;
+            std::optional<type::TimePoint> time;
+        };
+
+        std::atomic<bool> loop_time_enabled{ false };
+        thread_local scope_state_t scope_state;
+    }
+
+    LoopTime::Scope::Scope()
+    {
+        ++scope_state.depth;
+    }
+
+    LoopTime::Scope::~Scope()
+    {
+        if (--scope_state.depth == 0)
+        {
+            scope_state.time = std::nullopt;
+        }
+    }
+
+    void LoopTime::Enable(bool enable/* = true*/)
+    {
+        loop_time_enabled.store(enable, std::memory_order_relaxed);
+    }
+
+    bool LoopTime::Enabled()
+    {
+        return loop_time_enabled.load(std::memory_order_relaxed);
+    }
+
+    type::TimePoint LoopTime::Now()
+    {
+        if (scope_state.depth == 0 || !Enabled())
+        {
+            return type::TimePoint::Now();
+        }
+
+        if (scope_state.time == std::nullopt)
+        {
+            scope_state.time = type::TimePoint::Now();
+        }
+
+        return *scope_state.time;
+    }
+}
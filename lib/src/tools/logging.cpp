@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #include <dots/tools/logging.h>
+#include <dots/tools/AsyncLogBackend.h>
 #ifdef __unix__
 #include <syslog.h>
 #endif
@@ -221,6 +222,10 @@ namespace dots::tools
             {
                 return std::make_shared<ConsoleLogBackend>();
             }
+            else if (name == "async")
+            {
+                return std::make_shared<AsyncLogBackend>();
+            }
             else if (name == "syslog")
             {
 #ifdef __unix__
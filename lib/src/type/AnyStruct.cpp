@@ -1,12 +1,29 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #include <dots/type/AnyStruct.h>
+#include <dots/type/InstancePool.h>
 
 namespace dots::type
 {
     AnyStruct::AnyStruct(const StructDescriptor& descriptor):
-        _instance{ static_cast<Struct*>(::operator new(descriptor.size())) }
+        _instance{ static_cast<Struct*>(InstancePool::Allocate(descriptor.size())) }
     {
-        descriptor.constructInPlace(Typeless::From(*_instance));
+        try
+        {
+            descriptor.constructInPlace(Typeless::From(*_instance));
+        }
+        catch (...)
+        {
+            InstancePool::Deallocate(_instance.release(), descriptor.size());
+            throw;
+        }
+    }
+
+    void AnyStruct::deleter::operator()(Struct* instance) const noexcept
+    {
+        const StructDescriptor& descriptor = instance->_descriptor();
+        size_t size = descriptor.size();
+        descriptor.destruct(Typeless::From(*instance));
+        InstancePool::Deallocate(instance, size);
     }
 }
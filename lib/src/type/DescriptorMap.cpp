@@ -32,7 +32,7 @@ namespace dots::type
 
     const Descriptor<>* DescriptorMap::find(std::string_view name, bool assertNotNull/* = false*/) const
     {
-        if (auto it = m_underlyingMap.find(name); it == m_underlyingMap.end())
+        if (auto it = m_index.find(name); it == m_index.end())
         {
             if (assertNotNull)
             {
@@ -45,7 +45,7 @@ namespace dots::type
         }
         else
         {
-            return it->second.get();
+            return it->second;
         }
     }
 
@@ -77,6 +77,12 @@ namespace dots::type
     std::pair<Descriptor<>*, bool> DescriptorMap::tryEmplace(Descriptor<>& descriptor)
     {
         auto [it, emplaced] = m_underlyingMap.try_emplace(descriptor.name(), descriptor.shared_from_this());
+
+        if (emplaced)
+        {
+            m_index.emplace(it->first, it->second.get());
+        }
+
         return std::make_pair(it->second.get(), emplaced);
     }
 
@@ -108,6 +114,7 @@ namespace dots::type
         }
         else
         {
+            m_index.erase(it->first);
             m_underlyingMap.erase(it);
         }
     }
@@ -119,6 +126,7 @@ namespace dots::type
 
     void DescriptorMap::clear()
     {
+        m_index.clear();
         m_underlyingMap.clear();
     }
 }
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/type/InstancePool.h>
+#include <array>
+#include <new>
+
+namespace dots::type
+{
+    namespace
+    {
+        struct FreeList
+        {
+            struct Node
+            {
+                Node* next;
+            };
+
+            Node* head = nullptr;
+            size_t size = 0;
+        };
+
+        struct ThreadPools
+        {
+            static constexpr size_t NumSizeClasses = InstancePool::MaxBlockSize / InstancePool::Granularity;
+
+            ThreadPools() = default;
+            ThreadPools(const ThreadPools& other) = delete;
+            ThreadPools(ThreadPools&& other) = delete;
+
+            ~ThreadPools()
+            {
+                trim();
+                destroyed = true;
+            }
+
+            ThreadPools& operator = (const ThreadPools& rhs) = delete;
+            ThreadPools& operator = (ThreadPools&& rhs) = delete;
+
+            void trim() noexcept
+            {
+                for (FreeList& freeList : freeLists)
+                {
+                    while (freeList.head != nullptr)
+                    {
+                        FreeList::Node* node = freeList.head;
+                        freeList.head = node->next;
+                        ::operator delete(node);
+                    }
+
+                    freeList.size = 0;
+                }
+            }
+
+            std::array<FreeList, NumSizeClasses> freeLists;
+
+            // note that this flag is used to bypass the pools for blocks
+            // that are released during thread termination (e.g. by other
+            // thread-local or static objects) after the pools were destroyed
+            inline static thread_local bool destroyed = false;
+        };
+
+        thread_local ThreadPools t_pools;
+
+        constexpr size_t size_class(size_t size)
+        {
+            return (size + InstancePool::Granularity - 1) / InstancePool::Granularity - 1;
+        }
+
+        constexpr size_t class_size(size_t sizeClass)
+        {
+            return (sizeClass + 1) * InstancePool::Granularity;
+        }
+    }
+
+    void* InstancePool::Allocate(size_t size)
+    {
+        if (size == 0 || size > MaxBlockSize)
+        {
+            return ::operator new(size);
+        }
+
+        size_t sizeClass = size_class(size);
+
+        if (ThreadPools::destroyed)
+        {
+            return ::operator new(class_size(sizeClass));
+        }
+
+        FreeList& freeList = t_pools.freeLists[sizeClass];
+
+        if (freeList.head == nullptr)
+        {
+            return ::operator new(class_size(sizeClass));
+        }
+
+        FreeList::Node* node = freeList.head;
+        freeList.head = node->next;
+        --freeList.size;
+
+        return node;
+    }
+
+    void InstancePool::Deallocate(void* block, size_t size) noexcept
+    {
+        if (block == nullptr)
+        {
+            return;
+        }
+
+        if (size == 0 || size > MaxBlockSize || ThreadPools::destroyed)
+        {
+            ::operator delete(block);
+            return;
+        }
+
+        FreeList& freeList = t_pools.freeLists[size_class(size)];
+
+        if (freeList.size >= MaxPooledBlocks)
+        {
+            ::operator delete(block);
+            return;
+        }
+
+        freeList.head = ::new(block) FreeList::Node{ freeList.head };
+        ++freeList.size;
+    }
+
+    void InstancePool::Trim() noexcept
+    {
+        t_pools.trim();
+    }
+}
@@ -4,15 +4,59 @@
 #include <dots/type/Struct.h>
 #include <dots/io/DescriptorConverter.h>
 #include <dots/type/DynamicStruct.h>
+#include <dots/type/FundamentalTypes.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 
 namespace dots::type
 {
+    namespace
+    {
+        template <typename T>
+        bool equal_value(const Descriptor<>&/* descriptor*/, const Typeless& lhs, const Typeless& rhs)
+        {
+            return lhs.to<T>() == rhs.to<T>();
+        }
+
+        template <typename T>
+        bool less_value(const Descriptor<>&/* descriptor*/, const Typeless& lhs, const Typeless& rhs)
+        {
+            return lhs.to<T>() < rhs.to<T>();
+        }
+
+        bool equal_generic(const Descriptor<>& descriptor, const Typeless& lhs, const Typeless& rhs)
+        {
+            return descriptor.equal(lhs, rhs);
+        }
+
+        bool less_generic(const Descriptor<>& descriptor, const Typeless& lhs, const Typeless& rhs)
+        {
+            return descriptor.less(lhs, rhs);
+        }
+
+        const char* area_data(const PropertyArea& area, size_t offset)
+        {
+            return reinterpret_cast<const char*>(&area) + offset;
+        }
+
+        char* area_data(PropertyArea& area, size_t offset)
+        {
+            return reinterpret_cast<char*>(&area) + offset;
+        }
+    }
+
     StructDescriptor::StructDescriptor(key_t key, std::string name, uint8_t flags, const property_descriptor_container_t& propertyDescriptors, size_t areaOffset, size_t size, size_t alignment) :
         StaticDescriptor(key, Type::Struct, std::move(name), size, alignment),
+        m_id(NextId()),
         m_flags(flags),
         m_propertyDescriptors(propertyDescriptors),
         m_areaOffset(areaOffset),
-        m_numSubStructs(0)
+        m_numSubStructs(0),
+        m_triviallyCopyable(true),
+        m_trivialOffset(0),
+        m_trivialSize(0),
+        m_preciseTimestamps(false)
     {
         for (const PropertyDescriptor& propertyDescriptor : m_propertyDescriptors)
         {
@@ -33,6 +77,8 @@ namespace dots::type
                 m_dynamicMemoryProperties += propertyDescriptor.set();
             }
         }
+
+        buildPlan();
     }
 
     Typeless& StructDescriptor::construct(Typeless& value) const
@@ -58,12 +104,7 @@ namespace dots::type
         ::new(static_cast<void*>(::std::addressof(instance))) Struct{ other };
         ::new(static_cast<void*>(::std::addressof(propertyArea(instance)))) PropertyArea{};
 
-        for (auto&[propertyInstance, propertyOther] : instance._propertyRange(other, other._validProperties()))
-        {
-            propertyInstance.assign(propertyOther);
-        }
-
-        return instance;
+        return copy(instance, other, PropertySet{ PropertySet::All });
     }
 
     Typeless& StructDescriptor::construct(Typeless& value, Typeless&& other) const
@@ -76,6 +117,15 @@ namespace dots::type
         ::new(static_cast<void*>(::std::addressof(instance))) Struct{ other };
         ::new(static_cast<void*>(::std::addressof(propertyArea(instance)))) PropertyArea{};
 
+        if (m_triviallyCopyable)
+        {
+            copyTrivially(instance._propertyArea(), other._propertyArea());
+            instance._propertyArea().validProperties() = other._validProperties();
+            other._propertyArea().validProperties() = {};
+
+            return instance;
+        }
+
         for (auto&[propertyInstance, propertyOther] : instance._propertyRange(other, other._validProperties()))
         {
             if (propertyOther.isValid())
@@ -208,17 +258,42 @@ namespace dots::type
 
     Struct& StructDescriptor::assign(Struct& instance, const Struct& other, PropertySet includedProperties) const
     {
+        PropertyArea& instanceArea = instance._propertyArea();
+        const PropertyArea& otherArea = other._propertyArea();
+        PropertySet& validProperties = instanceArea.validProperties();
         PropertySet assignProperties = other._validProperties() ^ includedProperties;
 
-        for (auto&[propertyThis, propertyOther] : instance._propertyRange(other))
+        if (m_triviallyCopyable)
         {
-            if (propertyThis.isPartOf(assignProperties))
+            copyTrivially(instanceArea, otherArea);
+            validProperties = assignProperties;
+
+            return instance;
+        }
+
+        for (const plan_run_t& run : m_planRuns)
+        {
+            PropertySet runAssignProperties = run.set ^ assignProperties;
+
+            if (run.kind != plan_run_t::kind_t::Generic && runAssignProperties == run.set)
             {
-                propertyThis.assign(propertyOther);
+                std::memcpy(area_data(instanceArea, run.offset), area_data(otherArea, run.offset), run.size);
+                validProperties += run.set;
+                continue;
             }
-            else
+
+            for (size_t i = run.first; i < run.last; ++i)
             {
-                propertyThis = dots::invalid;
+                const plan_element_t& element = m_planElements[i];
+
+                if (element.set <= runAssignProperties)
+                {
+                    CopyElement(element, instanceArea, otherArea);
+                }
+                else if (element.set <= validProperties)
+                {
+                    DestructElement(element, instanceArea);
+                }
             }
         }
 
@@ -229,6 +304,15 @@ namespace dots::type
     {
         PropertySet assignProperties = other._validProperties() ^ includedProperties;
 
+        if (m_triviallyCopyable)
+        {
+            copyTrivially(instance._propertyArea(), other._propertyArea());
+            instance._propertyArea().validProperties() = assignProperties;
+            other._propertyArea().validProperties() -= assignProperties;
+
+            return instance;
+        }
+
         for (auto&[propertyThis, propertyOther] : instance._propertyRange(other))
         {
             if (propertyThis.isPartOf(assignProperties))
@@ -247,17 +331,42 @@ namespace dots::type
 
     Struct& StructDescriptor::copy(Struct& instance, const Struct& other, PropertySet includedProperties) const
     {
-        PropertySet copyProperties = (instance._validProperties() + other._validProperties()) ^ includedProperties;
+        PropertyArea& instanceArea = instance._propertyArea();
+        const PropertyArea& otherArea = other._propertyArea();
+        PropertySet& validProperties = instanceArea.validProperties();
+        PropertySet copyProperties = other._validProperties() ^ includedProperties;
 
-        for (auto&[propertyThis, propertyOther] : instance._propertyRange(other, copyProperties))
+        if (m_triviallyCopyable && m_properties <= includedProperties)
         {
-            if (propertyOther.isValid())
+            copyTrivially(instanceArea, otherArea);
+            validProperties = copyProperties;
+
+            return instance;
+        }
+
+        for (const plan_run_t& run : m_planRuns)
+        {
+            PropertySet runCopyProperties = run.set ^ copyProperties;
+
+            if (run.kind != plan_run_t::kind_t::Generic && runCopyProperties == run.set)
             {
-                propertyThis.assign(propertyOther);
+                std::memcpy(area_data(instanceArea, run.offset), area_data(otherArea, run.offset), run.size);
+                validProperties += run.set;
+                continue;
             }
-            else
+
+            for (size_t i = run.first; i < run.last; ++i)
             {
-                propertyThis = dots::invalid;
+                const plan_element_t& element = m_planElements[i];
+
+                if (element.set <= runCopyProperties)
+                {
+                    CopyElement(element, instanceArea, otherArea);
+                }
+                else if (element.set <= includedProperties && element.set <= validProperties)
+                {
+                    DestructElement(element, instanceArea);
+                }
             }
         }
 
@@ -266,17 +375,60 @@ namespace dots::type
 
     Struct& StructDescriptor::merge(Struct& instance, const Struct& other, PropertySet includedProperties) const
     {
+        PropertyArea& instanceArea = instance._propertyArea();
+        const PropertyArea& otherArea = other._propertyArea();
+        PropertySet& validProperties = instanceArea.validProperties();
         PropertySet mergeProperties = other._validProperties() ^ includedProperties;
 
-        for (auto& [propertyThis, propertyOther] : instance._propertyRange(other, mergeProperties))
+        // note: the storage of all properties can only be overwritten if
+        // none of the properties that are not merged are valid
+        if (m_triviallyCopyable && (validProperties - mergeProperties).empty())
         {
-            if (propertyThis.descriptor().valueDescriptor().type() == Type::Struct)
+            copyTrivially(instanceArea, otherArea);
+            validProperties = mergeProperties;
+
+            return instance;
+        }
+
+        for (const plan_run_t& run : m_planRuns)
+        {
+            PropertySet runMergeProperties = run.set ^ mergeProperties;
+
+            if (runMergeProperties.empty())
             {
-                propertyThis.valueOrEmplace().to<Struct>()._merge(propertyOther->to<Struct>());
+                continue;
             }
-            else
+            else if (run.kind != plan_run_t::kind_t::Generic && runMergeProperties == run.set)
             {
-                propertyThis.assign(propertyOther);
+                std::memcpy(area_data(instanceArea, run.offset), area_data(otherArea, run.offset), run.size);
+                validProperties += run.set;
+                continue;
+            }
+
+            for (size_t i = run.first; i < run.last; ++i)
+            {
+                const plan_element_t& element = m_planElements[i];
+
+                if (!(element.set <= runMergeProperties))
+                {
+                    continue;
+                }
+                else if (const auto* structDescriptor = element.valueDescriptor->as<StructDescriptor>(); structDescriptor != nullptr)
+                {
+                    auto& instanceValue = instanceArea.getProperty<Typeless>(element.offset);
+
+                    if (!(element.set <= validProperties))
+                    {
+                        structDescriptor->constructInPlace(instanceValue);
+                        validProperties += element.set;
+                    }
+
+                    structDescriptor->merge(instanceValue.to<Struct>(), otherArea.getProperty<Typeless>(element.offset).to<Struct>(), PropertySet{ PropertySet::All });
+                }
+                else
+                {
+                    CopyElement(element, instanceArea, otherArea);
+                }
             }
         }
 
@@ -301,11 +453,42 @@ namespace dots::type
 
     bool StructDescriptor::equal(const Struct& lhs, const Struct& rhs, PropertySet includedProperties) const
     {
-        for (const auto&[propertyThis, propertyOther] : lhs._propertyRange(rhs, includedProperties))
+        PropertySet validProperties = lhs._validProperties() ^ includedProperties;
+
+        if (validProperties != (rhs._validProperties() ^ includedProperties))
+        {
+            return false;
+        }
+
+        const PropertyArea& lhsArea = lhs._propertyArea();
+        const PropertyArea& rhsArea = rhs._propertyArea();
+
+        for (const plan_run_t& run : m_planRuns)
         {
-            if (propertyThis != propertyOther)
+            PropertySet runValidProperties = run.set ^ validProperties;
+
+            if (runValidProperties.empty())
             {
-                return false;
+                continue;
+            }
+            else if (run.kind == plan_run_t::kind_t::Bitwise && runValidProperties == run.set)
+            {
+                if (std::memcmp(area_data(lhsArea, run.offset), area_data(rhsArea, run.offset), run.size) != 0)
+                {
+                    return false;
+                }
+
+                continue;
+            }
+
+            for (size_t i = run.first; i < run.last; ++i)
+            {
+                const plan_element_t& element = m_planElements[i];
+
+                if (element.set <= runValidProperties && !element.equal(*element.valueDescriptor, lhsArea.getProperty<Typeless>(element.offset), rhsArea.getProperty<Typeless>(element.offset)))
+                {
+                    return false;
+                }
             }
         }
 
@@ -325,15 +508,34 @@ namespace dots::type
         }
         else
         {
-            for (const auto&[propertyThis, propertyOther] : lhs._propertyRange(rhs, includedProperties))
+            const PropertyArea& lhsArea = lhs._propertyArea();
+            const PropertyArea& rhsArea = rhs._propertyArea();
+            PropertySet lhsValidProperties = lhs._validProperties() ^ includedProperties;
+            PropertySet rhsValidProperties = rhs._validProperties() ^ includedProperties;
+
+            for (const plan_element_t& element : m_planElements)
             {
-                if (propertyThis < propertyOther)
+                bool lhsValid = element.set <= lhsValidProperties;
+                bool rhsValid = element.set <= rhsValidProperties;
+
+                if (lhsValid && rhsValid)
                 {
-                    return true;
+                    const auto& lhsValue = lhsArea.getProperty<Typeless>(element.offset);
+                    const auto& rhsValue = rhsArea.getProperty<Typeless>(element.offset);
+
+                    if (element.less(*element.valueDescriptor, lhsValue, rhsValue))
+                    {
+                        return true;
+                    }
+                    else if (element.less(*element.valueDescriptor, rhsValue, lhsValue))
+                    {
+                        return false;
+                    }
                 }
-                else if (propertyThis > propertyOther)
+                else if (lhsValid != rhsValid)
                 {
-                    return false;
+                    // note: invalid properties are less than valid ones
+                    return rhsValid;
                 }
             }
 
@@ -363,11 +565,30 @@ namespace dots::type
 
         if (!intersection.empty())
         {
-            for (const auto&[propertyThis, propertyOther] : instance._propertyRange(other, intersection))
+            const PropertyArea& instanceArea = instance._propertyArea();
+            const PropertyArea& otherArea = other._propertyArea();
+
+            for (const plan_run_t& run : m_planRuns)
             {
-                if (propertyThis != propertyOther)
+                PropertySet runIntersection = run.set ^ intersection;
+
+                if (runIntersection.empty())
+                {
+                    continue;
+                }
+                else if (run.kind == plan_run_t::kind_t::Bitwise && runIntersection == run.set && std::memcmp(area_data(instanceArea, run.offset), area_data(otherArea, run.offset), run.size) == 0)
                 {
-                    symmetricDiff += propertyThis.descriptor().set();
+                    continue;
+                }
+
+                for (size_t i = run.first; i < run.last; ++i)
+                {
+                    const plan_element_t& element = m_planElements[i];
+
+                    if (element.set <= runIntersection && !element.equal(*element.valueDescriptor, instanceArea.getProperty<Typeless>(element.offset), otherArea.getProperty<Typeless>(element.offset)))
+                    {
+                        symmetricDiff += element.set;
+                    }
                 }
             }
         }
@@ -418,4 +639,115 @@ namespace dots::type
 
         return m_propertyPaths;
     }
+
+    uint32_t StructDescriptor::NextId()
+    {
+        static std::atomic<uint32_t> NextId_{ 0 };
+        return NextId_++;
+    }
+
+    void StructDescriptor::buildPlan()
+    {
+        for (const PropertyDescriptor& propertyDescriptor : m_propertyDescriptors)
+        {
+            const Descriptor<>& valueDescriptor = propertyDescriptor.valueDescriptor();
+            plan_element_t element{ propertyDescriptor.set(), propertyDescriptor.offset(), valueDescriptor.size(), true, &valueDescriptor, &equal_generic, &less_generic };
+            plan_run_t::kind_t kind = plan_run_t::kind_t::Trivial;
+
+            switch (valueDescriptor.type())
+            {
+                case Type::boolean:          element.equal = &equal_value<bool_t>;    element.less = &less_value<bool_t>;   kind = plan_run_t::kind_t::Bitwise; break;
+                case Type::int8:             element.equal = &equal_value<int8_t>;    element.less = &less_value<int8_t>;   kind = plan_run_t::kind_t::Bitwise; break;
+                case Type::uint8:            element.equal = &equal_value<uint8_t>;   element.less = &less_value<uint8_t>;  kind = plan_run_t::kind_t::Bitwise; break;
+                case Type::int16:            element.equal = &equal_value<int16_t>;   element.less = &less_value<int16_t>;  kind = plan_run_t::kind_t::Bitwise; break;
+                case Type::uint16:           element.equal = &equal_value<uint16_t>;  element.less = &less_value<uint16_t>; kind = plan_run_t::kind_t::Bitwise; break;
+                case Type::int32:            element.equal = &equal_value<int32_t>;   element.less = &less_value<int32_t>;  kind = plan_run_t::kind_t::Bitwise; break;
+                case Type::uint32:           element.equal = &equal_value<uint32_t>;  element.less = &less_value<uint32_t>; kind = plan_run_t::kind_t::Bitwise; break;
+                case Type::int64:            element.equal = &equal_value<int64_t>;   element.less = &less_value<int64_t>;  kind = plan_run_t::kind_t::Bitwise; break;
+                case Type::uint64:           element.equal = &equal_value<uint64_t>;  element.less = &less_value<uint64_t>; kind = plan_run_t::kind_t::Bitwise; break;
+                case Type::property_set:     kind = plan_run_t::kind_t::Bitwise; break;
+                case Type::uuid:             kind = plan_run_t::kind_t::Bitwise; break;
+                // note: enums are always stored as their underlying type
+                case Type::Enum:             element.equal = &equal_value<int32_t>;   element.less = &less_value<int32_t>;  kind = plan_run_t::kind_t::Bitwise; break;
+                // note: floating point based values are copied bitwise, but
+                // require typed comparison because of NaN and signed zeros
+                case Type::float32:          element.equal = &equal_value<float32_t>;          element.less = &less_value<float32_t>; break;
+                case Type::float64:          element.equal = &equal_value<float64_t>;          element.less = &less_value<float64_t>; break;
+                case Type::timepoint:        element.equal = &equal_value<timepoint_t>;        element.less = &less_value<timepoint_t>; break;
+                case Type::steady_timepoint: element.equal = &equal_value<steady_timepoint_t>; element.less = &less_value<steady_timepoint_t>; break;
+                case Type::duration:         element.equal = &equal_value<duration_t>;         element.less = &less_value<duration_t>; break;
+                case Type::string:
+                case Type::Vector:
+                case Type::Struct:
+                    element.trivial = false;
+                    kind = plan_run_t::kind_t::Generic;
+                    break;
+            }
+
+            size_t index = m_planElements.size();
+            m_planElements.emplace_back(element);
+
+            // note: only adjacent elements without padding in between can be
+            // handled by a single memcmp or memcpy
+            if (!m_planRuns.empty())
+            {
+                if (plan_run_t& run = m_planRuns.back(); kind != plan_run_t::kind_t::Generic && run.kind == kind && run.offset + run.size == element.offset)
+                {
+                    run.set += element.set;
+                    run.size += element.size;
+                    run.last = index + 1;
+                    continue;
+                }
+            }
+
+            m_planRuns.emplace_back(plan_run_t{ kind, element.set, element.offset, element.size, index, index + 1 });
+        }
+
+        m_triviallyCopyable = std::all_of(m_planElements.begin(), m_planElements.end(), [](const plan_element_t& element){ return element.trivial; });
+
+        if (m_triviallyCopyable && !m_planElements.empty())
+        {
+            auto [first, last] = std::minmax_element(m_planElements.begin(), m_planElements.end(), [](const plan_element_t& lhs, const plan_element_t& rhs){ return lhs.offset < rhs.offset; });
+            m_trivialOffset = first->offset;
+            m_trivialSize = last->offset + last->size - m_trivialOffset;
+        }
+    }
+
+    void StructDescriptor::copyTrivially(PropertyArea& lhsArea, const PropertyArea& rhsArea) const
+    {
+        // note: this also copies the padding and the storage of invalid
+        // properties, which is harmless because all properties are
+        // trivially copyable
+        std::memcpy(area_data(lhsArea, m_trivialOffset), area_data(rhsArea, m_trivialOffset), m_trivialSize);
+    }
+
+    void StructDescriptor::CopyElement(const plan_element_t& element, PropertyArea& lhsArea, const PropertyArea& rhsArea)
+    {
+        PropertySet& validProperties = lhsArea.validProperties();
+
+        if (element.trivial)
+        {
+            std::memcpy(area_data(lhsArea, element.offset), area_data(rhsArea, element.offset), element.size);
+        }
+        else if (element.set <= validProperties)
+        {
+            element.valueDescriptor->assign(lhsArea.getProperty<Typeless>(element.offset), rhsArea.getProperty<Typeless>(element.offset));
+        }
+        else
+        {
+            element.valueDescriptor->constructInPlace(lhsArea.getProperty<Typeless>(element.offset), rhsArea.getProperty<Typeless>(element.offset));
+        }
+
+        validProperties += element.set;
+    }
+
+    void StructDescriptor::DestructElement(const plan_element_t& element, PropertyArea& lhsArea)
+    {
+        if (!element.trivial)
+        {
+            element.valueDescriptor->destruct(lhsArea.getProperty<Typeless>(element.offset));
+        }
+
+        lhsArea.validProperties() -= element.set;
+    }
 }
@@ -1,12 +1,40 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #include <dots/type/Uuid.h>
+#include <chrono>
+#include <cstring>
+#include <random>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 
 namespace dots::type
 {
+    namespace
+    {
+        std::mt19937_64& random_engine()
+        {
+            // note: the engine is seeded only once per thread, because
+            // acquiring entropy from the OS requires a syscall. it must only
+            // be used for random bits that are not required to be secret
+            thread_local std::mt19937_64 RandomEngine = []()
+            {
+                std::random_device randomDevice;
+                std::seed_seq seedSequence{ randomDevice(), randomDevice(), randomDevice(), randomDevice(), randomDevice(), randomDevice(), randomDevice(), randomDevice() };
+
+                return std::mt19937_64{ seedSequence };
+            }();
+
+            return RandomEngine;
+        }
+
+        void set_version_and_variant(Uuid::value_t& data, uint8_t version)
+        {
+            data[6] = static_cast<uint8_t>((data[6] & 0x0F) | (version << 4));
+            data[8] = static_cast<uint8_t>((data[8] & 0x3F) | 0x80);
+        }
+    }
+
     Uuid::Uuid(const uint8_t data[16])
     {
         std::memcpy(m_data.data(), data, m_data.size());
@@ -23,6 +51,11 @@ namespace dots::type
         return m_data;
     }
 
+    uint8_t Uuid::version() const
+    {
+        return static_cast<uint8_t>(m_data[6] >> 4);
+    }
+
     bool Uuid::operator == (const Uuid& rhs) const
     {
         return m_data == rhs.m_data;
@@ -70,6 +103,56 @@ namespace dots::type
 
     Uuid Uuid::Random()
     {
-        return Uuid{ boost::uuids::random_generator{}().data };
+        // note: random UUIDs might be used as unguessable ids and are
+        // therefore created from the entropy source of the OS. the generator
+        // is cached per thread to avoid reopening the source on every call.
+        // it does not buffer any random bytes and is therefore also safe to
+        // use in forked processes
+        thread_local boost::uuids::random_generator_pure RandomGenerator;
+        return Uuid{ RandomGenerator().data };
+    }
+
+    Uuid Uuid::TimeOrdered()
+    {
+        struct state_t
+        {
+            uint64_t lastTime = 0;
+            uint16_t counter = 0;
+        };
+
+        thread_local state_t State;
+        std::mt19937_64& randomEngine = random_engine();
+        auto time = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+        if (time > State.lastTime)
+        {
+            // note: the most significant bit of the initial counter is
+            // cleared to leave room for increments within the same millisecond
+            State.lastTime = time;
+            State.counter = static_cast<uint16_t>(randomEngine() & 0x07FF);
+        }
+        else if (++State.counter > 0x0FFF)
+        {
+            // note: the timestamp is advanced on counter overflow (and kept
+            // if the clock goes backwards) to guarantee monotonicity
+            ++State.lastTime;
+            State.counter = 0;
+        }
+
+        value_t data;
+
+        for (size_t i = 0; i < 6; ++i)
+        {
+            data[i] = static_cast<uint8_t>(State.lastTime >> (40 - i * 8));
+        }
+
+        data[6] = static_cast<uint8_t>(State.counter >> 8);
+        data[7] = static_cast<uint8_t>(State.counter);
+
+        uint64_t randomBits = randomEngine();
+        std::memcpy(data.data() + 8, &randomBits, sizeof(randomBits));
+        set_version_and_variant(data, 7);
+
+        return Uuid{ data };
     }
 }
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/type/Chrono.h>
+#include <dots/tools/LoopTime.h>
+#include <Benchmark.h>
+
+namespace
+{
+    // note: corresponds to the number of transmissions that are typically
+    // processed within a single read from a channel under load
+    constexpr size_t TimestampsPerScope = 64;
+
+    struct loop_time_guard
+    {
+        explicit loop_time_guard(bool enable) :
+            m_enabled(dots::tools::LoopTime::Enabled())
+        {
+            dots::tools::LoopTime::Enable(enable);
+        }
+
+        loop_time_guard(const loop_time_guard& other) = delete;
+        loop_time_guard(loop_time_guard&& other) = delete;
+
+        ~loop_time_guard()
+        {
+            dots::tools::LoopTime::Enable(m_enabled);
+        }
+
+        loop_time_guard& operator = (const loop_time_guard& rhs) = delete;
+        loop_time_guard& operator = (loop_time_guard&& rhs) = delete;
+
+    private:
+
+        bool m_enabled;
+    };
+
+    void TakeTimestampsInScopes(dots::bench::State& state)
+    {
+        for (size_t i = 0; i < state.iterations(); ++i)
+        {
+            dots::tools::LoopTime::Scope scope;
+
+            for (size_t j = 0; j < TimestampsPerScope; ++j)
+            {
+                dots::type::TimePoint timePoint = dots::tools::LoopTime::Now();
+                dots::bench::DoNotOptimize(timePoint);
+            }
+        }
+    }
+}
+
+// note: the iterations of the scoped benchmarks each take a batch of
+// timestamps, so their results have to be divided by TimestampsPerScope
+
+DOTS_BENCHMARK(LoopTime_TimePointNow)
+{
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        dots::type::TimePoint timePoint = dots::type::TimePoint::Now();
+        dots::bench::DoNotOptimize(timePoint);
+    }
+}
+
+DOTS_BENCHMARK(LoopTime_NowDisabled)
+{
+    loop_time_guard guard{ false };
+
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        dots::type::TimePoint timePoint = dots::tools::LoopTime::Now();
+        dots::bench::DoNotOptimize(timePoint);
+    }
+}
+
+DOTS_BENCHMARK(LoopTime_Scope64TimestampsDisabled)
+{
+    loop_time_guard guard{ false };
+    TakeTimestampsInScopes(state);
+}
+
+DOTS_BENCHMARK(LoopTime_Scope64TimestampsEnabled)
+{
+    loop_time_guard guard{ true };
+    TakeTimestampsInScopes(state);
+}
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <set>
+#include <vector>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+#include <dots/type/Uuid.h>
+#include <Benchmark.h>
+
+namespace
+{
+    constexpr size_t InsertionCount = 10'000;
+
+    template <typename Generator>
+    void InsertIntoSet(dots::bench::State& state, Generator&& generator)
+    {
+        std::vector<dots::type::Uuid> uuids;
+        uuids.reserve(InsertionCount);
+
+        for (size_t i = 0; i < InsertionCount; ++i)
+        {
+            uuids.emplace_back(generator());
+        }
+
+        for (size_t i = 0; i < state.iterations(); ++i)
+        {
+            std::set<dots::type::Uuid> set;
+
+            for (const dots::type::Uuid& uuid : uuids)
+            {
+                set.emplace(uuid);
+            }
+
+            dots::bench::DoNotOptimize(set);
+        }
+    }
+}
+
+// note: baseline of the previous implementation, which constructed a new
+// generator (and gathered entropy from the OS) for every UUID
+DOTS_BENCHMARK(Uuid_BoostRandomGeneratorPerCall)
+{
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        boost::uuids::uuid uuid = boost::uuids::random_generator{}();
+        dots::bench::DoNotOptimize(uuid);
+    }
+}
+
+DOTS_BENCHMARK(Uuid_Random)
+{
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        dots::type::Uuid uuid = dots::type::Uuid::Random();
+        dots::bench::DoNotOptimize(uuid);
+    }
+}
+
+DOTS_BENCHMARK(Uuid_TimeOrdered)
+{
+    for (size_t i = 0; i < state.iterations(); ++i)
+    {
+        dots::type::Uuid uuid = dots::type::Uuid::TimeOrdered();
+        dots::bench::DoNotOptimize(uuid);
+    }
+}
+
+DOTS_BENCHMARK(Uuid_SetInsertion10kRandom)
+{
+    InsertIntoSet(state, []{ return dots::type::Uuid::Random(); });
+}
+
+DOTS_BENCHMARK(Uuid_SetInsertion10kTimeOrdered)
+{
+    InsertIntoSet(state, []{ return dots::type::Uuid::TimeOrdered(); });
+}
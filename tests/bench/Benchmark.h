@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <functional>
+
+namespace dots::bench
+{
+    /*!
+     * @brief State of a single benchmark run.
+     *
+     * A benchmark is invoked repeatedly with an increasing number of
+     * iterations until its run time exceeds the minimum measurement time.
+     * The reported result is the average time per iteration of the final
+     * run.
+     */
+    struct State
+    {
+        explicit State(size_t iterations) :
+            m_iterations(iterations)
+        {
+            /* do nothing */
+        }
+
+        size_t iterations() const
+        {
+            return m_iterations;
+        }
+
+    private:
+
+        size_t m_iterations;
+    };
+
+    using benchmark_t = std::function<void(State&)>;
+
+    bool Register(std::string name, benchmark_t benchmark);
+    int RunAll(std::string_view filter);
+
+    /*!
+     * @brief Prevent the compiler from optimizing away a computed value.
+     */
+    template <typename T>
+    void DoNotOptimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* Sink;
+        Sink = &value;
+#endif
+    }
+}
+
+#define DOTS_BENCHMARK(name)                                                                \
+    static void name(dots::bench::State& state);                                            \
+    [[maybe_unused]] static const bool name##Registered = dots::bench::Register(#name, &name); \
+    static void name(dots::bench::State& state)
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <Benchmark.h>
+
+namespace dots::bench
+{
+    namespace
+    {
+        constexpr std::chrono::milliseconds MinMeasurementTime{ 200 };
+        constexpr size_t MaxIterations = size_t{ 1 } << 30;
+
+        std::vector<std::pair<std::string, benchmark_t>>& Benchmarks()
+        {
+            static std::vector<std::pair<std::string, benchmark_t>> Benchmarks;
+            return Benchmarks;
+        }
+    }
+
+    bool Register(std::string name, benchmark_t benchmark)
+    {
+        Benchmarks().emplace_back(std::move(name), std::move(benchmark));
+        return true;
+    }
+
+    int RunAll(std::string_view filter)
+    {
+        for (const auto& [name, benchmark] : Benchmarks())
+        {
+            if (name.find(filter) == std::string::npos)
+            {
+                continue;
+            }
+
+            // note: the number of iterations is increased until a single run
+            // takes long enough to be measured reliably
+            for (size_t iterations = 1;; iterations *= 2)
+            {
+                State state{ iterations };
+                auto start = std::chrono::steady_clock::now();
+                benchmark(state);
+                auto elapsed = std::chrono::steady_clock::now() - start;
+
+                if (elapsed >= MinMeasurementTime || iterations >= MaxIterations)
+                {
+                    double nsPerIteration = std::chrono::duration<double, std::nano>{ elapsed }.count() / static_cast<double>(iterations);
+                    std::cout << std::left << std::setw(48) << name << std::right << std::setw(12) << std::fixed << std::setprecision(1) << nsPerIteration << " ns/it" << std::setw(14) << iterations << " it\n";
+                    break;
+                }
+            }
+        }
+
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    return dots::bench::RunAll(argc > 1 ? argv[1] : "");
+}
@@ -294,3 +294,59 @@ TEST(TestContainer, forEach_IterationYieldsExpectedInstances)
         EXPECT_EQ(instance, *itExpected++);
     });
 }
+
+TEST(TestContainer, version_IncrementedByEffectiveInsertAndRemove)
+{
+    dots::Container<DotsTestStruct> sut;
+    DotsTestStruct dts1{ .indKeyfField = 1, .floatField = 3.1415f };
+    DotsTestStruct dts2{ .indKeyfField = 2 };
+
+    ASSERT_EQ(sut.version(), 0u);
+
+    const auto& [created, createdCloneInfo] = sut.insert(test_helpers::make_header(dts1, 42), dts1);
+    ASSERT_EQ(sut.version(), 1u);
+    ASSERT_EQ(createdCloneInfo.version, 1u);
+
+    sut.insert(test_helpers::make_header(dts2, 42), dts2);
+    sut.remove(test_helpers::make_header(DotsTestStruct{ .indKeyfField = 3 }, 42, true), DotsTestStruct{ .indKeyfField = 3 });
+    ASSERT_EQ(sut.version(), 2u);
+
+    dots::Container<DotsTestStruct>::node_t removedNode = sut.remove(test_helpers::make_header(dts1, 21, true), dts1);
+    ASSERT_EQ(sut.version(), 3u);
+    ASSERT_EQ(removedNode.mapped().version, 3u);
+
+    ASSERT_EQ(sut.tombstones().size(), 1u);
+    const auto& [tombstone, tombstoneCloneInfo] = sut.tombstones().front();
+    ASSERT_TRUE(tombstone->_equal(DotsTestStruct{ .indKeyfField = 1 }));
+    ASSERT_EQ(tombstoneCloneInfo.lastOperation, DotsMt::remove);
+    ASSERT_EQ(tombstoneCloneInfo.version, 3u);
+}
+
+TEST(TestContainer, canResync_FalseAfterTombstoneLogTruncationOrEpochMismatch)
+{
+    dots::Container<DotsTestStruct> sut;
+    sut.setTombstoneCapacity(1);
+
+    for (int32_t i = 1; i <= 3; ++i)
+    {
+        DotsTestStruct dts{ .indKeyfField = i };
+        sut.insert(test_helpers::make_header(dts, 42), dts);
+    }
+
+    ASSERT_TRUE(sut.canResync(sut.epoch(), 0));
+    ASSERT_FALSE(sut.canResync(sut.epoch() + 1, 0));
+    ASSERT_FALSE(sut.canResync(sut.epoch(), sut.version() + 1));
+
+    sut.remove(test_helpers::make_header(DotsTestStruct{ .indKeyfField = 1 }, 42, true), DotsTestStruct{ .indKeyfField = 1 });
+    sut.remove(test_helpers::make_header(DotsTestStruct{ .indKeyfField = 2 }, 42, true), DotsTestStruct{ .indKeyfField = 2 });
+
+    ASSERT_EQ(sut.tombstones().size(), 1u);
+    ASSERT_FALSE(sut.canResync(sut.epoch(), 3));
+    ASSERT_TRUE(sut.canResync(sut.epoch(), 4));
+
+    sut.clear();
+
+    ASSERT_TRUE(sut.tombstones().empty());
+    ASSERT_FALSE(sut.canResync(sut.epoch(), 5));
+    ASSERT_TRUE(sut.canResync(sut.epoch(), sut.version()));
+}
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #include <dots/testing/gtest/gtest.h>
+#include <tuple>
+#include <vector>
 #include <dots/Dispatcher.h>
 #include <DotsHeader.dots.h>
 #include <DotsTestStruct.dots.h>
@@ -737,3 +739,43 @@ TEST_F(TestDispatcher, moveCtor_CreateEventAfterMoveContructWhenAddedHandlerForC
 
     ASSERT_EQ(i, 1);
 }
+
+TEST_F(TestDispatcher, addEventHandler_ReplayCacheIncrementallyWhenLimitsAreSet)
+{
+    DotsTestStruct dts1{ .stringField = "foo", .indKeyfField = 1 };
+    DotsTestStruct dts2{ .stringField = "foo", .indKeyfField = 2 };
+    DotsTestStruct dts3{ .stringField = "foo", .indKeyfField = 3 };
+    m_sut.dispatch(dots::Transmission{ test_helpers::make_header(dts1, 42), dts1 });
+    m_sut.dispatch(dots::Transmission{ test_helpers::make_header(dts2, 42), dts2 });
+    m_sut.dispatch(dots::Transmission{ test_helpers::make_header(dts3, 42), dts3 });
+
+    size_t scheduled = 0;
+    m_sut.setReplayLimits(1, dots::type::Duration{ 1.0 }, [&]{ ++scheduled; });
+
+    using event_t = std::tuple<DotsMt, int32_t, std::string, uint32_t>;
+    std::vector<event_t> events;
+    dots::Dispatcher::id_t id = m_sut.addEventHandler<DotsTestStruct>([&](const dots::Event<DotsTestStruct>& e)
+    {
+        events.emplace_back(e.mt(), *e.updated().indKeyfField, *e.updated().stringField, e.header().fromCache.valueOrDefault(0u));
+    });
+    (void)id;
+
+    EXPECT_TRUE(m_sut.replaying());
+    EXPECT_EQ(scheduled, 1u);
+
+    DotsTestStruct dts1Update{ .stringField = "bar", .indKeyfField = 1 };
+    DotsTestStruct dts3Update{ .stringField = "bar", .indKeyfField = 3 };
+    m_sut.dispatch(dots::Transmission{ test_helpers::make_header(dts3Update, 42), dts3Update });
+    m_sut.dispatch(dots::Transmission{ test_helpers::make_header(dts1Update, 42), dts1Update });
+    m_sut.dispatch(dots::Transmission{ test_helpers::make_header(dts2, 42, true), dts2 });
+
+    m_sut.continueReplays();
+    EXPECT_FALSE(m_sut.replaying());
+    EXPECT_EQ(scheduled, 1u);
+
+    EXPECT_EQ(events, (std::vector<event_t>{
+        event_t{ DotsMt::create, 1, "foo", 2u },
+        event_t{ DotsMt::update, 1, "bar", 0u },
+        event_t{ DotsMt::create, 3, "bar", 0u }
+    }));
+}
@@ -2,8 +2,12 @@
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #include <sstream>
 #include <optional>
+#include <span>
+#include <vector>
+#include <dots/asio.h>
 #include <dots/testing/gtest/EventTestBase.h>
 #include <DotsTestStruct.dots.h>
+#include <DotsMsgError.dots.h>
 
 struct TestGuestTransceiver : dots::testing::EventTestBase
 {
@@ -144,3 +148,366 @@ TEST_F(TestGuestTransceiver, PublishPartialInstanceWhenPropertiesAreGiven)
 
     processEvents();
 }
+
+TEST_F(TestGuestTransceiver, PublishBatchAsIndividualInstances)
+{
+    std::vector<DotsTestStruct> instances{
+        DotsTestStruct{ .indKeyfField = 1, .floatField = 1.0f, .int64Field = 1 },
+        DotsTestStruct{ .indKeyfField = 2, .int64Field = 2 }
+    };
+
+    DOTS_EXPECTATION_SEQUENCE(
+        [&]
+        {
+            dots::publish(std::span<const DotsTestStruct>{ instances });
+        },
+        EXPECT_DOTS_PUBLISH(instances[0]),
+        EXPECT_DOTS_PUBLISH(instances[1]),
+        [&]
+        {
+            dots::publish(std::span<const DotsTestStruct>{ instances }, DotsTestStruct::int64Field_p);
+        },
+        EXPECT_DOTS_PUBLISH(instances[0], DotsTestStruct::indKeyfField_p + DotsTestStruct::int64Field_p),
+        EXPECT_DOTS_PUBLISH(instances[1], DotsTestStruct::indKeyfField_p + DotsTestStruct::int64Field_p)
+    );
+
+    processEvents();
+}
+
+TEST_F(TestGuestTransceiver, DeliverEventsInBatchesOfMaximumSize)
+{
+    std::vector<std::vector<dots::int64_t>> batches;
+
+    m_testStructSubscription = dots::subscribe<DotsTestStruct>([&](const dots::EventBatch<DotsTestStruct>& batch)
+    {
+        std::vector<dots::int64_t>& values = batches.emplace_back();
+
+        for (const dots::Event<DotsTestStruct>& event : batch)
+        {
+            values.emplace_back(*event.updated().int64Field);
+        }
+    }, 2, std::chrono::hours{ 1 });
+
+    SPOOF_DOTS_PUBLISH(DotsTestStruct{ .indKeyfField = 1, .int64Field = 1 });
+    SPOOF_DOTS_PUBLISH(DotsTestStruct{ .indKeyfField = 1, .int64Field = 2 });
+    SPOOF_DOTS_PUBLISH(DotsTestStruct{ .indKeyfField = 2, .int64Field = 3 });
+    processEvents();
+
+    // note: the events of the batch refer to copies of the updated instance,
+    // which are not affected by subsequent updates of the container
+    ASSERT_EQ(batches.size(), 1u);
+    EXPECT_EQ(batches[0], (std::vector<dots::int64_t>{ 1, 2 }));
+
+    m_testStructSubscription.reset();
+    processEvents();
+
+    EXPECT_EQ(batches.size(), 1u);
+}
+
+TEST_F(TestGuestTransceiver, NarrowHostFilterWhenFilteredSubscriptionEnds)
+{
+    auto int64Filter = [](dots::int64_t value)
+    {
+        return dots::SubscriptionFilter::clauses_t{ DotsFilterClause{
+            .predicates = dots::vector_t<DotsFilterPredicate>{ dots::make_filter_predicate({ 9 }, DotsFilterOperator::equal, value) }
+        } };
+    };
+
+    dots::GuestTransceiver guest{ "dots-test-guest", ioContext() };
+    connectGuest(guest);
+    processEvents();
+
+    std::optional<dots::Subscription> subscription1 = guest.subscribe<DotsTestStruct>(int64Filter(1), [](const dots::Event<DotsTestStruct>&/* event*/){});
+    std::optional<dots::Subscription> subscription2 = guest.subscribe<DotsTestStruct>(int64Filter(2), [](const dots::Event<DotsTestStruct>&/* event*/){});
+    processEvents();
+
+    subscription2.reset();
+    processEvents();
+
+    host().publish(DotsTestStruct{ .indKeyfField = 1, .int64Field = 1 });
+    host().publish(DotsTestStruct{ .indKeyfField = 2, .int64Field = 2 });
+    processEvents();
+
+    const dots::Container<DotsTestStruct>& container = guest.container<DotsTestStruct>();
+    EXPECT_EQ(container.size(), 1u);
+    EXPECT_NE(container.find(DotsTestStruct{ .indKeyfField = 1 }), nullptr);
+
+    subscription1.reset();
+    processEvents();
+
+    host().publish(DotsTestStruct{ .indKeyfField = 1, .int64Field = 1 });
+    processEvents();
+
+    EXPECT_TRUE(container.empty());
+}
+
+TEST_F(TestGuestTransceiver, HostFilterTransmitsInstancesEnteringAndLeavingScope)
+{
+    dots::GuestTransceiver guest{ "dots-test-guest", ioContext() };
+    connectGuest(guest);
+    processEvents();
+
+    std::vector<std::pair<DotsMt, DotsTestStruct>> events;
+    dots::Subscription subscription = guest.subscribe<DotsTestStruct>(dots::SubscriptionFilter::clauses_t{ DotsFilterClause{
+        .predicates = dots::vector_t<DotsFilterPredicate>{ dots::make_filter_predicate({ 9 }, DotsFilterOperator::equal, dots::int64_t{ 1 }) }
+    } }, [&](const dots::Event<DotsTestStruct>& event)
+    {
+        events.emplace_back(event.mt(), event.updated());
+    });
+    processEvents();
+
+    host().publish(DotsTestStruct{ .indKeyfField = 1, .floatField = 1.0f, .int64Field = 2 });
+    host().publish(DotsTestStruct{ .indKeyfField = 2, .int64Field = 2 });
+    processEvents();
+
+    host().publish(DotsTestStruct{ .indKeyfField = 1, .int64Field = 1 }, DotsTestStruct::int64Field_p);
+    host().publish(DotsTestStruct{ .indKeyfField = 2, .int64Field = 3 }, DotsTestStruct::int64Field_p);
+    processEvents();
+
+    const dots::Container<DotsTestStruct>& container = guest.container<DotsTestStruct>();
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].first, DotsMt::create);
+    EXPECT_EQ(events[0].second, (DotsTestStruct{ .indKeyfField = 1, .floatField = 1.0f, .int64Field = 1 }));
+    EXPECT_EQ(container.size(), 1u);
+
+    host().publish(DotsTestStruct{ .indKeyfField = 1, .int64Field = 2 }, DotsTestStruct::int64Field_p);
+    processEvents();
+
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[1].first, DotsMt::remove);
+    EXPECT_TRUE(container.empty());
+
+    host().remove(DotsTestStruct{ .indKeyfField = 1 });
+    processEvents();
+
+    EXPECT_EQ(events.size(), 2u);
+}
+
+TEST_F(TestGuestTransceiver, RemoveStaleInstancesAfterCompleteResync)
+{
+    dots::GuestTransceiver guest{ "dots-test-guest", ioContext() };
+    connectGuest(guest);
+    processEvents();
+
+    std::vector<std::pair<DotsMt, DotsTestStruct>> events;
+    dots::Subscription subscription = guest.subscribe<DotsTestStruct>([&](const dots::Event<DotsTestStruct>& event)
+    {
+        events.emplace_back(event.mt(), event.updated());
+    });
+
+    host().publish(DotsTestStruct{ .indKeyfField = 1 });
+    host().publish(DotsTestStruct{ .indKeyfField = 2 });
+    processEvents();
+
+    const dots::Container<DotsTestStruct>& container = guest.container<DotsTestStruct>();
+    ASSERT_EQ(container.size(), 2u);
+
+    // note: the error causes the host to close the connection
+    guest.publish(DotsMsgError{ .errorCode = 1, .errorText = "test error" });
+    processEvents();
+    ASSERT_FALSE(guest.connected());
+
+    // note: removing more instances than the tombstone log of the host can
+    // hold prevents the host from transmitting only the changes
+    host().remove(DotsTestStruct{ .indKeyfField = 1 });
+
+    for (dots::int32_t i = 100; i < 100 + static_cast<dots::int32_t>(dots::Container<>::DefaultTombstoneCapacity); ++i)
+    {
+        host().publish(DotsTestStruct{ .indKeyfField = i });
+        host().remove(DotsTestStruct{ .indKeyfField = i });
+    }
+
+    events.clear();
+    connectGuest(guest);
+    processEvents();
+
+    ASSERT_TRUE(guest.connected());
+    EXPECT_EQ(container.size(), 1u);
+    EXPECT_EQ(container.find(DotsTestStruct{ .indKeyfField = 1 }), nullptr);
+    EXPECT_NE(container.find(DotsTestStruct{ .indKeyfField = 2 }), nullptr);
+
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].first, DotsMt::update);
+    EXPECT_EQ(events[0].second, DotsTestStruct{ .indKeyfField = 2 });
+    EXPECT_EQ(events[1].first, DotsMt::remove);
+    EXPECT_EQ(events[1].second, DotsTestStruct{ .indKeyfField = 1 });
+}
+
+TEST_F(TestGuestTransceiver, HostProjectionTransmitsOnlyProjectedPropertiesOfLiveUpdates)
+{
+    dots::GuestTransceiver guest{ "dots-test-guest", ioContext() };
+    connectGuest(guest);
+    processEvents();
+
+    std::vector<DotsTestStruct> events;
+    dots::Subscription subscription = guest.subscribe<DotsTestStruct>(DotsTestStruct::floatField_p, [&](const dots::Event<DotsTestStruct>& event)
+    {
+        events.emplace_back(event.updated());
+    });
+    processEvents();
+
+    host().publish(DotsTestStruct{ .stringField = "foo", .indKeyfField = 1, .floatField = 1.0f, .int64Field = 1 });
+    processEvents();
+
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0], (DotsTestStruct{ .indKeyfField = 1, .floatField = 1.0f }));
+    EXPECT_EQ(events[0]._validProperties(), DotsTestStruct::indKeyfField_p + DotsTestStruct::floatField_p);
+
+    // note: updates that do not affect any of the projected properties are
+    // not transmitted at all
+    host().publish(DotsTestStruct{ .indKeyfField = 1, .int64Field = 2 }, DotsTestStruct::int64Field_p);
+    processEvents();
+
+    EXPECT_EQ(events.size(), 1u);
+
+    host().publish(DotsTestStruct{ .stringField = "bar", .indKeyfField = 1, .floatField = 2.0f }, DotsTestStruct::stringField_p + DotsTestStruct::floatField_p);
+    processEvents();
+
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[1], (DotsTestStruct{ .indKeyfField = 1, .floatField = 2.0f }));
+    EXPECT_EQ(events[1]._validProperties(), DotsTestStruct::indKeyfField_p + DotsTestStruct::floatField_p);
+}
+
+TEST_F(TestGuestTransceiver, HostProjectionTransmitsOnlyProjectedPropertiesOfCache)
+{
+    host().publish(DotsTestStruct{ .stringField = "foo", .indKeyfField = 1, .floatField = 1.0f, .int64Field = 1 });
+    host().publish(DotsTestStruct{ .stringField = "bar", .indKeyfField = 2, .int64Field = 2 });
+    processEvents();
+
+    dots::GuestTransceiver guest{ "dots-test-guest", ioContext() };
+    connectGuest(guest);
+    processEvents();
+
+    dots::Subscription subscription = guest.subscribe<DotsTestStruct>(DotsTestStruct::floatField_p, [](const dots::Event<DotsTestStruct>&/* event*/){});
+    processEvents();
+
+    const dots::Container<DotsTestStruct>& container = guest.container<DotsTestStruct>();
+    ASSERT_EQ(container.size(), 2u);
+
+    const DotsTestStruct* instance1 = container.find(DotsTestStruct{ .indKeyfField = 1 });
+    ASSERT_NE(instance1, nullptr);
+    EXPECT_EQ(instance1->_validProperties(), DotsTestStruct::indKeyfField_p + DotsTestStruct::floatField_p);
+    EXPECT_EQ(instance1->floatField, 1.0f);
+
+    const DotsTestStruct* instance2 = container.find(DotsTestStruct{ .indKeyfField = 2 });
+    ASSERT_NE(instance2, nullptr);
+    EXPECT_EQ(instance2->_validProperties(), DotsTestStruct::indKeyfField_p);
+}
+
+TEST_F(TestGuestTransceiver, HostProjectionIsUnionOfProjectedSubscriptions)
+{
+    dots::GuestTransceiver guest{ "dots-test-guest", ioContext() };
+    connectGuest(guest);
+    processEvents();
+
+    size_t floatEvents = 0;
+    size_t int64Events = 0;
+    dots::Subscription floatSubscription = guest.subscribe<DotsTestStruct>(DotsTestStruct::floatField_p, [&](const dots::Event<DotsTestStruct>&/* event*/){ ++floatEvents; });
+    dots::Subscription int64Subscription = guest.subscribe<DotsTestStruct>(DotsTestStruct::int64Field_p, [&](const dots::Event<DotsTestStruct>&/* event*/){ ++int64Events; });
+    processEvents();
+
+    host().publish(DotsTestStruct{ .stringField = "foo", .indKeyfField = 1, .floatField = 1.0f, .int64Field = 1 });
+    processEvents();
+
+    const dots::Container<DotsTestStruct>& container = guest.container<DotsTestStruct>();
+    const DotsTestStruct* instance = container.find(DotsTestStruct{ .indKeyfField = 1 });
+    ASSERT_NE(instance, nullptr);
+    EXPECT_EQ(instance->_validProperties(), DotsTestStruct::indKeyfField_p + DotsTestStruct::floatField_p + DotsTestStruct::int64Field_p);
+    EXPECT_EQ(floatEvents, 1u);
+    EXPECT_EQ(int64Events, 1u);
+
+    host().publish(DotsTestStruct{ .stringField = "bar", .indKeyfField = 1 }, DotsTestStruct::stringField_p);
+    processEvents();
+
+    EXPECT_EQ(floatEvents, 1u);
+    EXPECT_EQ(int64Events, 1u);
+
+    // note: updates of properties of only one of the projections are only
+    // dispatched to the corresponding subscription
+    host().publish(DotsTestStruct{ .indKeyfField = 1, .int64Field = 2 }, DotsTestStruct::int64Field_p);
+    processEvents();
+
+    EXPECT_EQ(floatEvents, 1u);
+    EXPECT_EQ(int64Events, 2u);
+    EXPECT_EQ(instance->int64Field, 2);
+
+    // note: the host projection is narrowed when one of the subscriptions
+    // ends
+    int64Subscription.unsubscribe();
+    processEvents();
+
+    host().publish(DotsTestStruct{ .indKeyfField = 1, .int64Field = 3 }, DotsTestStruct::int64Field_p);
+    processEvents();
+
+    EXPECT_EQ(floatEvents, 1u);
+    EXPECT_EQ(instance->int64Field, 2);
+}
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+TEST_F(TestGuestTransceiver, AwaitCacheSyncPublishAndNextEvent)
+{
+    dots::publish(DotsTestStruct{ .indKeyfField = 1 });
+    processEvents();
+
+    std::optional<size_t> syncedSize;
+    std::optional<DotsTestStruct> nextInstance;
+    bool completed = false;
+
+    boost::asio::co_spawn(ioContext(), [&]() -> boost::asio::awaitable<void>
+    {
+        dots::Subscription subscription = dots::subscribe<DotsTestStruct>([](const dots::Event<DotsTestStruct>&/* event*/){});
+        co_await dots::cacheSynced<DotsTestStruct>();
+        syncedSize = dots::container<DotsTestStruct>().size();
+
+        DotsTestStruct instance{ .indKeyfField = 2 };
+        co_await dots::asyncPublish(instance);
+        nextInstance = co_await dots::next<DotsTestStruct>([](const dots::Event<DotsTestStruct>& event)
+        {
+            return event.updated().indKeyfField == 2;
+        });
+
+        co_await dots::sleep(std::chrono::milliseconds{ 1 });
+        completed = true;
+    }, boost::asio::detached);
+
+    processEvents(std::chrono::milliseconds{ 50 });
+
+    EXPECT_EQ(syncedSize, 1u);
+    EXPECT_EQ(nextInstance, DotsTestStruct{ .indKeyfField = 2 });
+    EXPECT_TRUE(completed);
+}
+
+TEST_F(TestGuestTransceiver, AwaitCacheSyncFailsWhenConnectionIsClosed)
+{
+    dots::GuestTransceiver guest{ "dots-test-guest", ioContext() };
+    connectGuest(guest);
+    processEvents();
+
+    std::exception_ptr error;
+    bool synced = false;
+
+    boost::asio::co_spawn(ioContext(), [&]() -> boost::asio::awaitable<void>
+    {
+        // note: the error causes the host to close the connection before the
+        // cache of the subsequently subscribed type is transferred
+        guest.publish(DotsMsgError{ .errorCode = 1, .errorText = "test error" });
+        dots::Subscription subscription = guest.subscribe<DotsTestStruct>([](const dots::Event<DotsTestStruct>&/* event*/){});
+
+        try
+        {
+            co_await guest.cacheSynced<DotsTestStruct>();
+            synced = true;
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+    }, boost::asio::detached);
+
+    processEvents(std::chrono::milliseconds{ 50 });
+
+    EXPECT_FALSE(guest.connected());
+    EXPECT_FALSE(synced);
+    EXPECT_NE(error, nullptr);
+}
+#endif
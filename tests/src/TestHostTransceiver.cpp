@@ -1,9 +1,14 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 // Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
 #include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
 #include <dots/testing/gtest/gtest.h>
 #include <dots/testing/gtest/EventTestBase.h>
 #include <dots/HostTransceiver.h>
+#include <DotsTestStruct.dots.h>
+#include <DotsUncachedTestStruct.dots.h>
 
 struct TestHostTransceiver : dots::testing::EventTestBase
 {
@@ -47,3 +52,221 @@ TEST_F(TestHostTransceiver, HandleEchoRequest)
 
     processEvents();
 }
+
+TEST_F(TestHostTransceiver, TypeStatisticsCountFanOut)
+{
+    dots::testing::mock_subscription_handler_t mockGuestSubscriber;
+    dots::Subscription guestSubscription = dots::subscribe<DotsTestStruct>(mockGuestSubscriber.AsStdFunction());
+
+    DOTS_EXPECTATION_SEQUENCE(
+        []
+        {
+            dots::publish(DotsTestStruct{ .indKeyfField = 1, .floatField = 3.1415f });
+        },
+        EXPECT_DOTS_PUBLISH_AT_SUBSCRIBER(mockGuestSubscriber, DotsTestStruct{ .indKeyfField = 1, .floatField = 3.1415f })
+    );
+
+    processEvents();
+
+    const auto& typeStatistics = host().typeStatistics();
+    auto it = typeStatistics.find(&DotsTestStruct::_Descriptor());
+
+    ASSERT_NE(it, typeStatistics.end());
+    EXPECT_EQ(it->second.publishedFrames, 1u);
+    EXPECT_EQ(it->second.transmittedFrames, 1u);
+
+    std::vector<const dots::Connection*> guestConnections = host().guestConnections();
+
+    ASSERT_EQ(guestConnections.size(), 1u);
+    EXPECT_GT(guestConnections.front()->statistics().receivedFrames, 0u);
+    EXPECT_GT(guestConnections.front()->statistics().transmittedFrames, 0u);
+}
+
+TEST_F(TestHostTransceiver, CacheTransferIsSplitIntoChunks)
+{
+    host().setCacheTransferLimits(1, std::chrono::seconds{ 1 });
+
+    dots::publish(DotsTestStruct{ .indKeyfField = 1, .floatField = 1.0f });
+    dots::publish(DotsTestStruct{ .indKeyfField = 2, .floatField = 2.0f });
+    dots::publish(DotsTestStruct{ .indKeyfField = 3, .floatField = 3.0f });
+    processEvents();
+
+    dots::testing::mock_subscription_handler_t mockGuestSubscriber;
+    EXPECT_CALL(mockGuestSubscriber, Call(::testing::_)).Times(3);
+    dots::Subscription guestSubscription = dots::subscribe<DotsTestStruct>(mockGuestSubscriber.AsStdFunction());
+
+    processEvents();
+
+    const dots::Container<DotsTestStruct>& container = dots::container<DotsTestStruct>();
+    EXPECT_EQ(container.size(), 3u);
+}
+
+TEST_F(TestHostTransceiver, RouteRpcReplyToCaller)
+{
+    dots::Subscription procedure = host().provide<DotsTestStruct, DotsUncachedTestStruct>([](const DotsTestStruct& request)
+    {
+        if (*request.indKeyfField < 0)
+        {
+            throw std::runtime_error{ "negative key" };
+        }
+
+        return DotsUncachedTestStruct{ .intKeyfField = *request.indKeyfField + 1, .value = "reply" };
+    });
+    processEvents();
+
+    std::optional<DotsUncachedTestStruct> reply;
+    dots::call<DotsUncachedTestStruct>(DotsTestStruct{ .indKeyfField = 41 }, [&](std::exception_ptr ePtr, const DotsUncachedTestStruct* reply_)
+    {
+        ASSERT_EQ(ePtr, nullptr);
+        reply = *reply_;
+    });
+    processEvents();
+
+    ASSERT_NE(reply, std::nullopt);
+    EXPECT_EQ(*reply, (DotsUncachedTestStruct{ .intKeyfField = 42, .value = "reply" }));
+
+    std::exception_ptr error;
+    dots::call<DotsUncachedTestStruct>(DotsTestStruct{ .indKeyfField = -1 }, [&](std::exception_ptr ePtr, const DotsUncachedTestStruct* reply_)
+    {
+        EXPECT_EQ(reply_, nullptr);
+        error = ePtr;
+    });
+    processEvents();
+
+    EXPECT_NE(error, nullptr);
+}
+
+TEST_F(TestHostTransceiver, DiscardRpcRepliesOfUnknownCallsAndNonProviders)
+{
+    dots::GuestTransceiver provider{ "dots-test-provider", ioContext() };
+    connectGuest(provider);
+    processEvents();
+
+    std::optional<DotsRpcRequest> request;
+    std::optional<uint32_t> callerId;
+    dots::Subscription requestSubscription = provider.subscribe<DotsRpcRequest>([&](const dots::Event<DotsRpcRequest>& event)
+    {
+        request = event.transmitted();
+        callerId = *event.header().sender;
+    });
+    processEvents();
+
+    std::vector<std::exception_ptr> errors;
+    dots::call<DotsUncachedTestStruct>(DotsTestStruct{ .indKeyfField = 1 }, [&](std::exception_ptr ePtr, const DotsUncachedTestStruct*/* reply*/)
+    {
+        errors.emplace_back(ePtr);
+    });
+    processEvents();
+
+    ASSERT_NE(request, std::nullopt);
+    ASSERT_NE(callerId, std::nullopt);
+
+    spoofGuest().publish(DotsRpcReply{ .callerId = *callerId, .callId = *request->callId, .error = "forged" });
+    processEvents();
+    EXPECT_TRUE(errors.empty());
+
+    provider.publish(DotsRpcReply{ .callerId = *callerId, .callId = *request->callId + 1, .error = "unknown" });
+    processEvents();
+    EXPECT_TRUE(errors.empty());
+
+    provider.publish(DotsRpcReply{ .callerId = *callerId, .callId = *request->callId, .error = "declined" });
+    processEvents();
+    EXPECT_EQ(errors.size(), 1u);
+
+    std::vector<DotsRpcReply> hostReplies;
+    dots::Subscription replySubscription = host().subscribe<DotsRpcReply>([&](const dots::Event<DotsRpcReply>& event)
+    {
+        hostReplies.emplace_back(event.transmitted());
+    });
+    provider.publish(DotsRpcReply{ .callId = *request->callId, .error = "forged" });
+    processEvents();
+    EXPECT_TRUE(hostReplies.empty());
+}
+
+TEST_F(TestHostTransceiver, RouteBatchFrameAsUnit)
+{
+    std::vector<size_t> batchSizes;
+    dots::Subscription guestSubscription = dots::subscribe<DotsTestStruct>([&](const dots::EventBatch<DotsTestStruct>& batch)
+    {
+        batchSizes.emplace_back(batch.size());
+    }, 10);
+    processEvents();
+
+    std::vector<const dots::Connection*> guestConnections = host().guestConnections();
+
+    ASSERT_EQ(guestConnections.size(), 1u);
+    const dots::Connection& guestConnection = *guestConnections.front();
+    EXPECT_TRUE(guestConnection.batchFrames());
+
+    uint64_t receivedFrames = guestConnection.statistics().receivedFrames;
+    uint64_t transmittedFrames = guestConnection.statistics().transmittedFrames;
+
+    std::vector<DotsTestStruct> instances{
+        DotsTestStruct{ .indKeyfField = 1, .floatField = 1.0f },
+        DotsTestStruct{ .indKeyfField = 2, .floatField = 2.0f },
+        DotsTestStruct{ .indKeyfField = 3 }
+    };
+    dots::publish(std::span<const DotsTestStruct>{ instances });
+    processEvents();
+
+    EXPECT_EQ(batchSizes, std::vector<size_t>{ 3 });
+    EXPECT_EQ(guestConnection.statistics().receivedFrames - receivedFrames, 1u);
+    EXPECT_EQ(guestConnection.statistics().transmittedFrames - transmittedFrames, 1u);
+
+    const dots::Container<DotsTestStruct>& container = dots::container<DotsTestStruct>();
+    ASSERT_EQ(container.size(), 3u);
+    EXPECT_EQ(container.get(DotsTestStruct{ .indKeyfField = 2 }).floatField, 2.0f);
+    EXPECT_FALSE(container.get(DotsTestStruct{ .indKeyfField = 3 }).floatField.isValid());
+}
+
+TEST_F(TestHostTransceiver, SuppressUnchangedUpdatesOfGuests)
+{
+    host().suppressUnchangedUpdates(DotsTestStruct::_Descriptor());
+
+    std::vector<std::pair<DotsMt, dots::property_set_t>> events;
+    dots::Subscription guestSubscription = dots::subscribe<DotsTestStruct>([&](const dots::Event<DotsTestStruct>& event)
+    {
+        events.emplace_back(event.mt(), *event.header().attributes);
+    });
+    processEvents();
+
+    dots::publish(DotsTestStruct{ .indKeyfField = 1, .floatField = 1.0f, .int64Field = 1 });
+    processEvents();
+
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].first, DotsMt::create);
+
+    // note: an identical update is dropped entirely
+    dots::publish(DotsTestStruct{ .indKeyfField = 1, .floatField = 1.0f, .int64Field = 1 });
+    processEvents();
+
+    ASSERT_EQ(events.size(), 1u);
+
+    // note: a partially changed update is narrowed to the changed properties
+    dots::publish(DotsTestStruct{ .indKeyfField = 1, .floatField = 1.0f, .int64Field = 2 });
+    processEvents();
+
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[1].first, DotsMt::update);
+    EXPECT_EQ(events[1].second, DotsTestStruct::indKeyfField_p + DotsTestStruct::int64Field_p);
+    EXPECT_EQ(dots::container<DotsTestStruct>().get(DotsTestStruct{ .indKeyfField = 1 }).int64Field, 2);
+
+    std::vector<DotsTestStruct> instances{ DotsTestStruct{ .indKeyfField = 1, .floatField = 1.0f, .int64Field = 2 } };
+    dots::publish(std::span<const DotsTestStruct>{ instances });
+    processEvents();
+
+    ASSERT_EQ(events.size(), 2u);
+
+    // note: updates that are published by the host itself are not
+    // suppressed
+    host().publish(DotsTestStruct{ .indKeyfField = 1, .floatField = 1.0f, .int64Field = 2 });
+    processEvents();
+
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[2].second, DotsTestStruct::indKeyfField_p + DotsTestStruct::floatField_p + DotsTestStruct::int64Field_p);
+
+    host().publish(std::span<const DotsTestStruct>{ instances });
+    processEvents();
+
+    EXPECT_EQ(events.size(), 4u);
+}
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/testing/gtest/gtest.h>
+#include <dots/SubscriptionFilter.h>
+#include <DotsTestStruct.dots.h>
+
+struct TestSubscriptionFilter : ::testing::Test
+{
+protected:
+
+    static dots::SubscriptionFilter::clauses_t Clauses(std::initializer_list<std::initializer_list<DotsFilterPredicate>> clauses)
+    {
+        dots::SubscriptionFilter::clauses_t filterClauses;
+
+        for (std::initializer_list<DotsFilterPredicate> predicates : clauses)
+        {
+            filterClauses.emplace_back(DotsFilterClause{ .predicates = dots::vector_t<DotsFilterPredicate>{ predicates } });
+        }
+
+        return filterClauses;
+    }
+};
+
+TEST_F(TestSubscriptionFilter, matches_EqualityPredicate)
+{
+    dots::SubscriptionFilter sut{ DotsTestStruct::_Descriptor(), Clauses({
+        { dots::make_filter_predicate({ 1 }, DotsFilterOperator::equal, dots::string_t{ "foo" }) }
+    }) };
+
+    EXPECT_TRUE(sut.matches(DotsTestStruct{ .stringField = "foo", .indKeyfField = 1 }));
+    EXPECT_FALSE(sut.matches(DotsTestStruct{ .stringField = "bar", .indKeyfField = 1 }));
+    EXPECT_FALSE(sut.matches(DotsTestStruct{ .indKeyfField = 1 }));
+}
+
+TEST_F(TestSubscriptionFilter, matches_RangePredicatesInConjunction)
+{
+    dots::SubscriptionFilter sut{ DotsTestStruct::_Descriptor(), Clauses({
+        {
+            dots::make_filter_predicate({ 2 }, DotsFilterOperator::greaterEqual, dots::int32_t{ 10 }),
+            dots::make_filter_predicate({ 2 }, DotsFilterOperator::less, dots::int32_t{ 20 })
+        }
+    }) };
+
+    EXPECT_FALSE(sut.matches(DotsTestStruct{ .indKeyfField = 9 }));
+    EXPECT_TRUE(sut.matches(DotsTestStruct{ .indKeyfField = 10 }));
+    EXPECT_TRUE(sut.matches(DotsTestStruct{ .indKeyfField = 19 }));
+    EXPECT_FALSE(sut.matches(DotsTestStruct{ .indKeyfField = 20 }));
+}
+
+TEST_F(TestSubscriptionFilter, matches_ClausesInDisjunction)
+{
+    dots::SubscriptionFilter sut{ DotsTestStruct::_Descriptor(), Clauses({
+        { dots::make_filter_predicate({ 2 }, DotsFilterOperator::equal, dots::int32_t{ 1 }) },
+        { dots::make_filter_predicate({ 2 }, DotsFilterOperator::equal, dots::int32_t{ 3 }) }
+    }) };
+
+    EXPECT_TRUE(sut.matches(DotsTestStruct{ .indKeyfField = 1 }));
+    EXPECT_FALSE(sut.matches(DotsTestStruct{ .indKeyfField = 2 }));
+    EXPECT_TRUE(sut.matches(DotsTestStruct{ .indKeyfField = 3 }));
+}
+
+TEST_F(TestSubscriptionFilter, matches_NestedPropertyPath)
+{
+    dots::SubscriptionFilter sut{ DotsTestStruct::_Descriptor(), Clauses({
+        { dots::make_filter_predicate({ 6, 1 }, DotsFilterOperator::equal, dots::bool_t{ true }) }
+    }) };
+
+    EXPECT_TRUE(sut.matches(DotsTestStruct{ .indKeyfField = 1, .subStruct = DotsTestSubStruct{ .flag1 = true } }));
+    EXPECT_FALSE(sut.matches(DotsTestStruct{ .indKeyfField = 1, .subStruct = DotsTestSubStruct{ .flag1 = false } }));
+    EXPECT_FALSE(sut.matches(DotsTestStruct{ .indKeyfField = 1, .subStruct = DotsTestSubStruct{} }));
+    EXPECT_FALSE(sut.matches(DotsTestStruct{ .indKeyfField = 1 }));
+}
+
+TEST_F(TestSubscriptionFilter, scope_UpdateOfReferencedPropertyOfCachedType)
+{
+    dots::SubscriptionFilter sut{ DotsTestStruct::_Descriptor(), Clauses({
+        { dots::make_filter_predicate({ 1 }, DotsFilterOperator::equal, dots::string_t{ "foo" }) }
+    }) };
+
+    using Scope = dots::SubscriptionFilter::Scope;
+    DotsHeader update{ .attributes = DotsTestStruct::indKeyfField_p + DotsTestStruct::stringField_p };
+    DotsTestStruct matching{ .stringField = "foo", .indKeyfField = 1 };
+    DotsTestStruct nonMatching{ .stringField = "bar", .indKeyfField = 1 };
+
+    EXPECT_TRUE(sut.affects(update));
+    EXPECT_EQ(sut.scope(update, true, matching), Scope::Inside);
+    EXPECT_EQ(sut.scope(update, false, matching), Scope::Entered);
+    EXPECT_EQ(sut.scope(update, true, nonMatching), Scope::Left);
+    EXPECT_EQ(sut.scope(update, false, nonMatching), Scope::Outside);
+    EXPECT_FALSE(sut.passes(update, false, nonMatching));
+}
+
+TEST_F(TestSubscriptionFilter, scope_UpdateOfUnreferencedPropertyOfCachedType)
+{
+    dots::SubscriptionFilter sut{ DotsTestStruct::_Descriptor(), Clauses({
+        { dots::make_filter_predicate({ 1 }, DotsFilterOperator::equal, dots::string_t{ "foo" }) }
+    }) };
+
+    using Scope = dots::SubscriptionFilter::Scope;
+    DotsHeader update{ .attributes = DotsTestStruct::indKeyfField_p + DotsTestStruct::floatField_p };
+
+    EXPECT_FALSE(sut.affects(update));
+    EXPECT_EQ(sut.scope(update, false, DotsTestStruct{ .stringField = "foo", .indKeyfField = 1, .floatField = 1.0f }), Scope::Inside);
+    EXPECT_EQ(sut.scope(update, true, DotsTestStruct{ .stringField = "bar", .indKeyfField = 1, .floatField = 1.0f }), Scope::Outside);
+}
+
+TEST_F(TestSubscriptionFilter, scope_RemoveOfCachedType)
+{
+    dots::SubscriptionFilter sut{ DotsTestStruct::_Descriptor(), Clauses({
+        { dots::make_filter_predicate({ 1 }, DotsFilterOperator::equal, dots::string_t{ "foo" }) }
+    }) };
+
+    using Scope = dots::SubscriptionFilter::Scope;
+    DotsHeader remove{ .attributes = DotsTestStruct::indKeyfField_p, .removeObj = true };
+    DotsTestStruct instance{ .indKeyfField = 1 };
+
+    EXPECT_TRUE(sut.affects(remove));
+    EXPECT_EQ(sut.scope(remove, true, instance), Scope::Left);
+    EXPECT_EQ(sut.scope(remove, false, instance), Scope::Outside);
+}
+
+TEST_F(TestSubscriptionFilter, expression_IdenticalForIdenticalClauses)
+{
+    auto clauses = Clauses({ { dots::make_filter_predicate({ 2 }, DotsFilterOperator::greater, dots::int32_t{ 42 }) } });
+    dots::SubscriptionFilter sut1{ DotsTestStruct::_Descriptor(), clauses };
+    dots::SubscriptionFilter sut2{ DotsTestStruct::_Descriptor(), clauses };
+
+    EXPECT_EQ(sut1.expression(), "(2 > 42)");
+    EXPECT_EQ(sut1.expression(), sut2.expression());
+    EXPECT_EQ(sut1.properties(), DotsTestStruct::indKeyfField_p);
+}
+
+TEST_F(TestSubscriptionFilter, ctor_ThrowOnInvalidPredicates)
+{
+    EXPECT_THROW((dots::SubscriptionFilter{ DotsTestStruct::_Descriptor(), Clauses({ { dots::make_filter_predicate({ 42 }, DotsFilterOperator::equal, dots::int32_t{ 1 }) } }) }), std::runtime_error);
+    EXPECT_THROW((dots::SubscriptionFilter{ DotsTestStruct::_Descriptor(), Clauses({ { dots::make_filter_predicate({ 6 }, DotsFilterOperator::equal, dots::int32_t{ 1 }) } }) }), std::runtime_error);
+    EXPECT_THROW((dots::SubscriptionFilter{ DotsTestStruct::_Descriptor(), dots::SubscriptionFilter::clauses_t{} }), std::runtime_error);
+}
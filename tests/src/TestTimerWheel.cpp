@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/testing/gtest/gtest.h>
+#include <optional>
+#include <vector>
+#include <dots/TimerWheel.h>
+#include <dots/asio.h>
+
+using namespace std::chrono_literals;
+
+struct TestTimerWheel : ::testing::Test
+{
+protected:
+
+    TestTimerWheel() :
+        m_sut{ m_ioContext, 1ms }
+    {
+        /* do nothing */
+    }
+
+    void processEvents(std::chrono::milliseconds duration)
+    {
+        m_ioContext.run_for(duration);
+        m_ioContext.restart();
+    }
+
+    dots::asio::io_context m_ioContext;
+    dots::TimerWheel m_sut;
+};
+
+TEST_F(TestTimerWheel, add_InvokesHandlersAfterTimeout)
+{
+    std::vector<int> invoked;
+    dots::TimerWheel::Handle handle1 = m_sut.add(20ms, [&]{ invoked.emplace_back(1); });
+    dots::TimerWheel::Handle handle2 = m_sut.add(5ms, [&]{ invoked.emplace_back(2); });
+    EXPECT_EQ(m_sut.size(), 2u);
+    EXPECT_TRUE(handle1.active());
+
+    processEvents(50ms);
+
+    EXPECT_EQ(invoked, (std::vector<int>{ 2, 1 }));
+    EXPECT_EQ(m_sut.size(), 0u);
+    EXPECT_FALSE(handle1.active());
+    EXPECT_FALSE(handle2.active());
+}
+
+TEST_F(TestTimerWheel, add_CascadesTimeoutsBeyondFirstLevel)
+{
+    dots::TimerWheel sut{ m_ioContext, 100us };
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::optional<std::chrono::steady_clock::duration> elapsed;
+    dots::TimerWheel::Handle handle = sut.add(60ms, [&]{ elapsed = std::chrono::steady_clock::now() - start; });
+
+    processEvents(100ms);
+
+    ASSERT_TRUE(elapsed.has_value());
+    EXPECT_GE(*elapsed, 60ms);
+}
+
+TEST_F(TestTimerWheel, cancel_PreventsInvocation)
+{
+    bool invoked = false;
+    dots::TimerWheel::Handle handle = m_sut.add(5ms, [&]{ invoked = true; });
+    handle.cancel();
+    EXPECT_FALSE(handle.active());
+    EXPECT_EQ(m_sut.size(), 0u);
+
+    processEvents(20ms);
+
+    EXPECT_FALSE(invoked);
+}
+
+TEST_F(TestTimerWheel, dtor_Handle_CancelsTimer)
+{
+    bool invoked = false;
+    std::optional<dots::TimerWheel::Handle> handle = m_sut.add(5ms, [&]{ invoked = true; });
+    handle.reset();
+
+    processEvents(20ms);
+
+    EXPECT_FALSE(invoked);
+}
+
+TEST_F(TestTimerWheel, reschedule_ReplacesTimeoutAndRearmsAfterInvocation)
+{
+    int invoked = 0;
+    dots::TimerWheel::Handle handle = m_sut.add(5ms, [&]{ ++invoked; });
+    handle.reschedule(40ms);
+
+    processEvents(20ms);
+    EXPECT_EQ(invoked, 0);
+
+    processEvents(40ms);
+    EXPECT_EQ(invoked, 1);
+
+    handle.reschedule(5ms);
+    processEvents(20ms);
+    EXPECT_EQ(invoked, 2);
+}
+
+TEST_F(TestTimerWheel, discard_InvokesHandlerAfterHandleIsDestroyed)
+{
+    bool invoked = false;
+    {
+        dots::TimerWheel::Handle handle = m_sut.add(5ms, [&]{ invoked = true; });
+        handle.discard();
+        EXPECT_FALSE(handle.active());
+    }
+
+    processEvents(20ms);
+
+    EXPECT_TRUE(invoked);
+    EXPECT_EQ(m_sut.size(), 0u);
+}
+
+TEST_F(TestTimerWheel, add_AllowsReschedulingFromWithinHandler)
+{
+    int invoked = 0;
+    std::optional<dots::TimerWheel::Handle> handle;
+    handle.emplace(m_sut.add(2ms, [&]
+    {
+        if (++invoked < 3)
+        {
+            handle->reschedule(2ms);
+        }
+    }));
+
+    processEvents(50ms);
+
+    EXPECT_EQ(invoked, 3);
+    EXPECT_FALSE(handle->active());
+}
+
+TEST_F(TestTimerWheel, assign_SelfMoveKeepsTimer)
+{
+    bool invoked = false;
+    dots::TimerWheel::Handle handle = m_sut.add(5ms, [&]{ invoked = true; });
+    dots::TimerWheel::Handle& self = handle;
+    handle = std::move(self);
+    EXPECT_TRUE(handle.active());
+
+    processEvents(20ms);
+
+    EXPECT_TRUE(invoked);
+}
+
+TEST_F(TestTimerWheel, add_KeepsTickingAfterHandlerThrowsNonStandardException)
+{
+    bool invoked = false;
+    dots::TimerWheel::Handle handle1 = m_sut.add(2ms, []{ throw 42; });
+    dots::TimerWheel::Handle handle2 = m_sut.add(10ms, [&]{ invoked = true; });
+
+    processEvents(30ms);
+
+    EXPECT_TRUE(invoked);
+    EXPECT_EQ(m_sut.size(), 0u);
+}
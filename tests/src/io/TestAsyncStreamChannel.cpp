@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/testing/gtest/gtest.h>
+#include <memory>
+#include <new>
+#include <vector>
+#include <dots/asio.h>
+#include <dots/io/channels/UdsChannel.h>
+#include <dots/type/Registry.h>
+#include <DotsTestStruct.dots.h>
+
+struct TestAsyncStreamChannel : ::testing::Test
+{
+protected:
+
+    using channel_t = dots::io::posix::UdsChannel;
+    using payload_cache_t = channel_t::payload_cache_t;
+    using entry_t = channel_t::base_t::cache_image_t::entry_t;
+
+    std::shared_ptr<channel_t> makeChannel()
+    {
+        boost::asio::local::stream_protocol::socket socket{ m_ioContext };
+        boost::asio::local::stream_protocol::socket& peer = m_peers.emplace_back(m_ioContext);
+        boost::asio::local::connect_pair(socket, peer);
+
+        auto channel = dots::io::make_channel<channel_t>(std::move(socket), &m_payloadCache);
+        channel->init(m_registry);
+
+        return channel;
+    }
+
+    const entry_t& entry(const dots::type::Struct& instance) const
+    {
+        return m_payloadCache.cacheImages.at(&instance._descriptor()).entries.at(&instance);
+    }
+
+    static DotsHeader Header(dots::property_set_t attributes)
+    {
+        return DotsHeader{
+            .typeName = DotsTestStruct::_Descriptor().name(),
+            .attributes = attributes,
+            .fromCache = 1u
+        };
+    }
+
+    boost::asio::io_context m_ioContext;
+    dots::type::Registry m_registry;
+    payload_cache_t m_payloadCache;
+    std::vector<boost::asio::local::stream_protocol::socket> m_peers;
+};
+
+TEST_F(TestAsyncStreamChannel, transmitFromCache_ReuseImageForSubsequentChannel)
+{
+    DotsTestStruct instance{ .stringField = "foo", .indKeyfField = 1, .floatField = 1.0f };
+    std::shared_ptr<channel_t> sut1 = makeChannel();
+    std::shared_ptr<channel_t> sut2 = makeChannel();
+
+    sut1->transmitFromCache(Header(instance._validProperties()), instance, 1);
+    const entry_t& entry1 = entry(instance);
+    const auto* data = entry1.data.data();
+    std::vector<uint8_t> bytes(entry1.data.begin(), entry1.data.end());
+
+    sut2->transmitFromCache(Header(instance._validProperties()), instance, 1);
+    const entry_t& entry2 = entry(instance);
+
+    EXPECT_EQ(entry2.data.data(), data);
+    EXPECT_EQ(std::vector<uint8_t>(entry2.data.begin(), entry2.data.end()), bytes);
+    EXPECT_EQ(sut1->statistics().transmittedBytes, sut2->statistics().transmittedBytes);
+}
+
+TEST_F(TestAsyncStreamChannel, transmitFromCache_SerializeAgainAfterUpdate)
+{
+    DotsTestStruct instance{ .stringField = "foo", .indKeyfField = 1, .floatField = 1.0f };
+    std::shared_ptr<channel_t> sut = makeChannel();
+
+    sut->transmitFromCache(Header(instance._validProperties()), instance, 1);
+    std::vector<uint8_t> bytes(entry(instance).data.begin(), entry(instance).data.end());
+
+    instance.floatField = 2.0f;
+    sut->transmitFromCache(Header(instance._validProperties()), instance, 2);
+
+    EXPECT_EQ(entry(instance).revision, 2u);
+    EXPECT_NE(std::vector<uint8_t>(entry(instance).data.begin(), entry(instance).data.end()), bytes);
+}
+
+TEST_F(TestAsyncStreamChannel, transmitFromCache_SerializeAgainWhenAddressIsReusedByDifferentInstance)
+{
+    auto instance = std::make_unique<DotsTestStruct>(DotsTestStruct{ .stringField = "foo", .indKeyfField = 1 });
+    std::shared_ptr<channel_t> sut = makeChannel();
+
+    sut->transmitFromCache(Header(instance->_validProperties()), *instance, 1);
+    std::vector<uint8_t> bytes(entry(*instance).data.begin(), entry(*instance).data.end());
+
+    // note: the revision is unique for every change of any instance of the
+    // type, so a different instance at the same address always has a
+    // different revision
+    instance->~DotsTestStruct();
+    new (instance.get()) DotsTestStruct{ .stringField = "bar", .indKeyfField = 2 };
+    sut->transmitFromCache(Header(instance->_validProperties()), *instance, 2);
+
+    EXPECT_EQ(entry(*instance).revision, 2u);
+    EXPECT_NE(std::vector<uint8_t>(entry(*instance).data.begin(), entry(*instance).data.end()), bytes);
+    EXPECT_EQ(m_payloadCache.cacheImages.at(&DotsTestStruct::_Descriptor()).entries.size(), 1u);
+}
+
+TEST_F(TestAsyncStreamChannel, transmitFromCache_SerializeAgainWhenProjectionChanges)
+{
+    DotsTestStruct instance{ .stringField = "foo", .indKeyfField = 1, .floatField = 1.0f };
+    std::shared_ptr<channel_t> sut1 = makeChannel();
+    std::shared_ptr<channel_t> sut2 = makeChannel();
+
+    sut1->transmitFromCache(Header(instance._validProperties()), instance, 1);
+    std::vector<uint8_t> bytes(entry(instance).data.begin(), entry(instance).data.end());
+
+    dots::property_set_t projection = DotsTestStruct::indKeyfField_p + DotsTestStruct::floatField_p;
+    sut2->transmitFromCache(Header(projection), instance, 1);
+
+    EXPECT_EQ(entry(instance).properties, projection);
+    EXPECT_NE(std::vector<uint8_t>(entry(instance).data.begin(), entry(instance).data.end()), bytes);
+    EXPECT_LT(sut2->statistics().transmittedBytes, sut1->statistics().transmittedBytes);
+}
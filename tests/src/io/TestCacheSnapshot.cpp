@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/testing/gtest/gtest.h>
+#include <filesystem>
+#include <dots/io/CacheSnapshot.h>
+#include <DotsHeader.dots.h>
+#include <DotsPersistentTestType.dots.h>
+#include <DotsTestStruct.dots.h>
+
+struct TestCacheSnapshot : ::testing::Test
+{
+protected:
+
+    TestCacheSnapshot() :
+        m_path{ std::filesystem::temp_directory_path() / "dots-test-cache-snapshot.bin" }
+    {
+        removeFiles();
+    }
+
+    ~TestCacheSnapshot() override
+    {
+        removeFiles();
+    }
+
+    void removeFiles()
+    {
+        std::filesystem::remove(m_path);
+        std::filesystem::remove(m_path.string() + ".journal");
+    }
+
+    static DotsHeader make_header(const dots::type::Struct& instance, bool remove = false)
+    {
+        return DotsHeader{
+            .typeName = instance._descriptor().name(),
+            .sentTime = dots::timepoint_t::Now(),
+            .attributes = instance._validProperties(),
+            .sender = 42,
+            .removeObj = remove
+        };
+    }
+
+    dots::type::Registry m_registry;
+    std::filesystem::path m_path;
+};
+
+TEST_F(TestCacheSnapshot, load_RestoresPersistentInstancesOfWrittenSnapshot)
+{
+    dots::ContainerPool pool;
+    DotsPersistentTestType instance1{ .name = "foo", .value = "bar" };
+    DotsPersistentTestType instance2{ .name = "baz" };
+    DotsTestStruct instance3{ .indKeyfField = 1 };
+    const DotsCloneInformation& cloneInfo1 = pool.get<DotsPersistentTestType>().insert(make_header(instance1), instance1).second;
+    pool.get<DotsPersistentTestType>().insert(make_header(instance2), instance2);
+    pool.get<DotsTestStruct>().insert(make_header(instance3), instance3);
+
+    EXPECT_EQ(dots::io::CacheSnapshot(m_registry, m_path).write(pool), 2u);
+
+    dots::ContainerPool restoredPool;
+    EXPECT_EQ(dots::io::CacheSnapshot(m_registry, m_path).load(restoredPool), 2u);
+
+    const dots::Container<DotsPersistentTestType>& container = restoredPool.get<DotsPersistentTestType>();
+    ASSERT_EQ(container.size(), 2u);
+    EXPECT_TRUE(container.get(instance1)._equal(instance1));
+    EXPECT_TRUE(container.get(instance2)._equal(instance2));
+    EXPECT_EQ(container.getClone(instance1).second.created, cloneInfo1.created);
+    EXPECT_EQ(container.getClone(instance1).second.createdFrom, 42u);
+    EXPECT_EQ(restoredPool.find<DotsTestStruct>(), nullptr);
+}
+
+TEST_F(TestCacheSnapshot, load_AppliesJournaledChanges)
+{
+    {
+        dots::ContainerPool pool;
+        dots::io::CacheSnapshot sut{ m_registry, m_path, true };
+        sut.load(pool);
+
+        DotsPersistentTestType instance1{ .name = "foo", .value = "bar" };
+        DotsPersistentTestType instance2{ .name = "baz" };
+        sut.journal(instance1, pool.get<DotsPersistentTestType>().insert(make_header(instance1), instance1).second);
+        sut.journal(instance2, pool.get<DotsPersistentTestType>().insert(make_header(instance2), instance2).second);
+        pool.get<DotsPersistentTestType>().remove(make_header(instance1, true), instance1);
+        sut.journal(instance1, DotsCloneInformation{}, true);
+    }
+
+    dots::ContainerPool restoredPool;
+    EXPECT_EQ(dots::io::CacheSnapshot(m_registry, m_path, true).load(restoredPool), 2u);
+
+    const dots::Container<DotsPersistentTestType>& container = restoredPool.get<DotsPersistentTestType>();
+    ASSERT_EQ(container.size(), 1u);
+    EXPECT_TRUE(container.get(DotsPersistentTestType{ .name = "baz" })._equal(DotsPersistentTestType{ .name = "baz" }));
+}
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/testing/gtest/gtest.h>
+#include <filesystem>
+#include <dots/io/Recording.h>
+#include <dots/serialization/CborSerializer.h>
+#include <DotsHeader.dots.h>
+#include <DotsTestStruct.dots.h>
+
+struct TestRecording : ::testing::Test
+{
+protected:
+
+    TestRecording() :
+        m_directory{ std::filesystem::temp_directory_path() / "dots-test-recording" }
+    {
+        std::filesystem::remove_all(m_directory);
+    }
+
+    ~TestRecording() override
+    {
+        std::filesystem::remove_all(m_directory);
+    }
+
+    static std::vector<uint8_t> make_frame(const dots::type::Struct& instance)
+    {
+        dots::serialization::CborSerializer serializer;
+        serializer.serialize(DotsHeader{
+            .typeName = instance._descriptor().name(),
+            .attributes = instance._validProperties()
+        });
+        serializer.serialize(instance);
+
+        return serializer.output();
+    }
+
+    static dots::timepoint_t make_time(int seconds)
+    {
+        return dots::timepoint_t{ dots::duration_t{ static_cast<double>(seconds) } };
+    }
+
+    std::filesystem::path m_directory;
+};
+
+TEST_F(TestRecording, read_ReturnsAppendedFramesAcrossSegments)
+{
+    std::vector<uint8_t> frame1 = make_frame(DotsTestStruct{ .indKeyfField = 1 });
+    std::vector<uint8_t> frame2 = make_frame(DotsHeader{ .typeName = "foo" });
+    std::vector<uint8_t> frame3 = make_frame(DotsTestStruct{ .indKeyfField = 3 });
+
+    {
+        // note: the segment size only allows for a single frame per segment
+        dots::io::Recording recording{ m_directory, dots::io::Recording::SegmentMagic.size() + dots::io::Recording::FrameHeaderSize + frame1.size() };
+        recording.append(make_time(1), "DotsTestStruct", frame1.data(), frame1.size());
+        recording.append(make_time(2), "DotsHeader", frame2.data(), frame2.size());
+        recording.append(make_time(3), "DotsTestStruct", frame3.data(), frame3.size());
+
+        EXPECT_EQ(recording.frames(), 3u);
+        EXPECT_EQ(recording.segments(), 3u);
+    }
+
+    dots::io::RecordingReader reader{ m_directory };
+    EXPECT_EQ(reader.segments(), 3u);
+    EXPECT_EQ(reader.frames(), 3u);
+
+    std::vector<dots::io::RecordingReader::Frame> frames = reader.read();
+    ASSERT_EQ(frames.size(), 3u);
+    EXPECT_EQ(frames[0].time, make_time(1));
+    EXPECT_EQ(frames[1].typeName, "DotsHeader");
+    EXPECT_EQ(std::vector<uint8_t>(frames[2].payload, frames[2].payload + frames[2].size), frame3);
+
+    std::vector<dots::io::RecordingReader::Frame> typeFrames = reader.read(std::unordered_set<std::string>{ "DotsTestStruct" }, make_time(2));
+    ASSERT_EQ(typeFrames.size(), 1u);
+    EXPECT_EQ(typeFrames[0].time, make_time(3));
+}
+
+TEST_F(TestRecording, read_ScansSegmentsThatWereNotSealed)
+{
+    std::vector<uint8_t> frame1 = make_frame(DotsTestStruct{ .indKeyfField = 1 });
+    std::vector<uint8_t> frame2 = make_frame(DotsTestStruct{ .indKeyfField = 2 });
+
+    dots::io::Recording recording{ m_directory };
+    recording.append(make_time(1), "DotsTestStruct", frame1.data(), frame1.size());
+    recording.append(make_time(2), "DotsTestStruct", frame2.data(), frame2.size());
+    recording.flush();
+
+    dots::io::RecordingReader reader{ m_directory };
+    std::vector<dots::io::RecordingReader::Frame> frames = reader.read();
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_EQ(frames[1].typeName, "DotsTestStruct");
+    EXPECT_EQ(std::vector<uint8_t>(frames[1].payload, frames[1].payload + frames[1].size), frame2);
+}
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/testing/gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <dots/io/TransmissionTrace.h>
+
+namespace
+{
+    std::vector<dots::io::TransmissionTrace::Frame> dump_and_read(const dots::io::TransmissionTrace& trace)
+    {
+        std::stringstream ss;
+        trace.dump(ss);
+
+        return dots::io::TransmissionTrace::Read(ss);
+    }
+
+    void record(dots::io::TransmissionTrace& trace, dots::io::TransmissionTrace::Direction direction, uint32_t peerId, const std::string& payload, bool descriptor = false)
+    {
+        trace.record(direction, peerId, reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), descriptor);
+    }
+}
+
+TEST(TestTransmissionTrace, dump_ReadReturnsRecordedFramesInOrder)
+{
+    using dots::io::TransmissionTrace;
+    TransmissionTrace sut;
+    record(sut, TransmissionTrace::Direction::receive, 1, "foo");
+    record(sut, TransmissionTrace::Direction::transmit, 2, "barbaz");
+
+    std::vector<TransmissionTrace::Frame> frames = dump_and_read(sut);
+
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_EQ(frames[0].peerId, 1u);
+    EXPECT_EQ(frames[0].direction, TransmissionTrace::Direction::receive);
+    EXPECT_EQ(std::string(frames[0].payload.begin(), frames[0].payload.end()), "foo");
+    EXPECT_EQ(frames[1].peerId, 2u);
+    EXPECT_EQ(frames[1].direction, TransmissionTrace::Direction::transmit);
+    EXPECT_EQ(std::string(frames[1].payload.begin(), frames[1].payload.end()), "barbaz");
+    EXPECT_LE(frames[0].time, frames[1].time);
+}
+
+TEST(TestTransmissionTrace, record_DiscardsOldestFramesWhenFull)
+{
+    using dots::io::TransmissionTrace;
+    TransmissionTrace sut{ 3 * (TransmissionTrace::FrameHeaderSize + 4) };
+
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        record(sut, TransmissionTrace::Direction::receive, i, "f" + std::to_string(i) + "__");
+    }
+
+    std::vector<TransmissionTrace::Frame> frames = dump_and_read(sut);
+
+    ASSERT_EQ(frames.size(), 3u);
+    EXPECT_EQ(sut.discarded(), 7u);
+    EXPECT_EQ(frames[0].peerId, 7u);
+    EXPECT_EQ(frames[1].peerId, 8u);
+    EXPECT_EQ(frames[2].peerId, 9u);
+    EXPECT_EQ(std::string(frames[2].payload.begin(), frames[2].payload.end()), "f9__");
+}
+
+TEST(TestTransmissionTrace, record_RetainsDescriptorFramesOnce)
+{
+    using dots::io::TransmissionTrace;
+    TransmissionTrace sut{ 2 * (TransmissionTrace::FrameHeaderSize + 4) };
+    record(sut, TransmissionTrace::Direction::receive, 1, "desc", true);
+    record(sut, TransmissionTrace::Direction::receive, 2, "desc", true);
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        record(sut, TransmissionTrace::Direction::receive, 3, "inst");
+    }
+
+    sut.clear();
+    record(sut, TransmissionTrace::Direction::transmit, 4, "last");
+
+    std::vector<TransmissionTrace::Frame> frames = dump_and_read(sut);
+
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_EQ(frames[0].peerId, 1u);
+    EXPECT_EQ(std::string(frames[0].payload.begin(), frames[0].payload.end()), "desc");
+    EXPECT_EQ(frames[1].peerId, 4u);
+}
+
+TEST(TestTransmissionTrace, Read_ThrowsOnInvalidMagic)
+{
+    std::stringstream ss{ "NOTATRACE" };
+    EXPECT_THROW(dots::io::TransmissionTrace::Read(ss), std::runtime_error);
+}
+
+TEST(TestTransmissionTrace, dumpIncident_WritesUniqueFileOncePerWindow)
+{
+    using dots::io::TransmissionTrace;
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / ("dots-test-trace-" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    std::filesystem::create_directories(directory);
+
+    TransmissionTrace sut{ TransmissionTrace::DefaultCapacity, directory / "trace.bin", std::chrono::hours{ 1 } };
+    record(sut, TransmissionTrace::Direction::receive, 1, "foo");
+
+    std::optional<std::filesystem::path> path = sut.dumpIncident(7);
+    ASSERT_NE(path, std::nullopt);
+    EXPECT_EQ(path->parent_path(), directory);
+    EXPECT_NE(path->filename().string().find("-peer7.bin"), std::string::npos);
+
+    std::ifstream ifs{ *path, std::ios::binary };
+    EXPECT_EQ(TransmissionTrace::Read(ifs).size(), 1u);
+
+    EXPECT_EQ(sut.dumpIncident(8), std::nullopt);
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator{ directory }, std::filesystem::directory_iterator{}), 1);
+
+    std::filesystem::remove_all(directory);
+}
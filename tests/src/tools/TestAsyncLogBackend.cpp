@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/testing/gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <dots/tools/AsyncLogBackend.h>
+
+struct TestAsyncLogBackend : ::testing::Test
+{
+protected:
+
+    TestAsyncLogBackend() :
+        m_file(std::tmpfile())
+    {
+        /* do nothing */
+    }
+
+    ~TestAsyncLogBackend() override
+    {
+        std::fclose(m_file);
+    }
+
+    std::vector<std::string> readLines()
+    {
+        std::vector<std::string> lines;
+        std::rewind(m_file);
+
+        for (std::string line; !std::feof(m_file);)
+        {
+            int c = std::fgetc(m_file);
+
+            if (c == '\n' || c == EOF)
+            {
+                if (!line.empty())
+                {
+                    lines.emplace_back(std::move(line));
+                    line.clear();
+                }
+            }
+            else
+            {
+                line += static_cast<char>(c);
+            }
+        }
+
+        return lines;
+    }
+
+    FILE* m_file;
+};
+
+TEST_F(TestAsyncLogBackend, log_WritesMessagesInOrder)
+{
+    dots::tools::AsyncLogBackend sut{ 16, dots::tools::AsyncLogBackend::OverflowPolicy::block, m_file };
+
+    for (int i = 0; i < 100; ++i)
+    {
+        sut.log(dots::tools::Level::info, FLF, "message " + std::to_string(i) + ";");
+    }
+
+    sut.flush();
+    std::vector<std::string> lines = readLines();
+
+    ASSERT_EQ(lines.size(), 100u);
+    EXPECT_EQ(sut.overflowCount(), 0u);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_NE(lines[i].find("message " + std::to_string(i) + ";"), std::string::npos);
+    }
+}
+
+TEST_F(TestAsyncLogBackend, log_TruncatesLongMessages)
+{
+    dots::tools::AsyncLogBackend sut{ 16, dots::tools::AsyncLogBackend::OverflowPolicy::block, m_file };
+    sut.log(dots::tools::Level::warn, FLF, std::string(dots::tools::AsyncLogBackend::MaxTextLength + 1, 'x'));
+    sut.flush();
+
+    std::vector<std::string> lines = readLines();
+
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_NE(lines[0].find(std::string(dots::tools::AsyncLogBackend::MaxTextLength, 'x') + " [truncated]"), std::string::npos);
+}
+
+TEST_F(TestAsyncLogBackend, dtor_WritesPendingMessages)
+{
+    {
+        dots::tools::AsyncLogBackend sut{ 64, dots::tools::AsyncLogBackend::OverflowPolicy::drop, m_file };
+
+        for (int i = 0; i < 32; ++i)
+        {
+            sut.log_p(dots::tools::Level::error, FLF, "pending");
+        }
+    }
+
+    EXPECT_EQ(readLines().size(), 32u);
+}
@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/testing/gtest/gtest.h>
+#include <array>
+#include <memory>
+#include <dots/tools/Handler.h>
+
+struct TestHandler : ::testing::Test
+{
+protected:
+
+    struct Base
+    {
+        virtual ~Base() = default;
+    };
+
+    struct Derived : Base
+    {
+        int value = 42;
+    };
+
+    struct Foo
+    {
+        void add(int i)
+        {
+            sum += i;
+        }
+
+        int addBound(int& bound, int i) const
+        {
+            return bound + i + sum;
+        }
+
+        int sum = 0;
+    };
+};
+
+TEST_F(TestHandler, ctor_InvocableStoredInline)
+{
+    int sum = 0;
+    dots::tools::Handler<void(int)> sut{ [&sum](int i){ sum += i; } };
+
+    sut(1);
+    sut(2);
+
+    EXPECT_EQ(sum, 3);
+}
+
+TEST_F(TestHandler, ctor_MemberFunction)
+{
+    Foo foo;
+    dots::tools::Handler<void(int)> sut{ &Foo::add, &foo };
+
+    sut(3);
+
+    EXPECT_EQ(foo.sum, 3);
+}
+
+TEST_F(TestHandler, ctor_MemberFunctionWithBoundArguments)
+{
+    Foo foo{ 1 };
+    dots::tools::Handler<int(int)> sut{ &Foo::addBound, &foo, 2 };
+
+    EXPECT_EQ(sut(3), 6);
+}
+
+TEST_F(TestHandler, ctor_LargeInvocableStoredOnHeap)
+{
+    std::array<int, 64> values{};
+    values.back() = 7;
+    dots::tools::Handler<int()> sut{ [values]{ return values.back(); } };
+
+    dots::tools::Handler<int()> sutCopy = sut;
+    dots::tools::Handler<int()> sutMoved = std::move(sut);
+
+    EXPECT_EQ(sutCopy(), 7);
+    EXPECT_EQ(sutMoved(), 7);
+}
+
+TEST_F(TestHandler, ctor_MutableInvocableKeepsStateAcrossInvocations)
+{
+    dots::tools::Handler<int()> sut{ [i = 0]() mutable { return ++i; } };
+
+    EXPECT_EQ(sut(), 1);
+    EXPECT_EQ(sut(), 2);
+}
+
+TEST_F(TestHandler, ctor_RequiresCopyableInvocable)
+{
+    auto moveOnlyInvocable = [ptr = std::make_unique<int>(21)]{ return *ptr * 2; };
+    auto copyableInvocable = [ptr = std::make_shared<int>(21)]{ return *ptr * 2; };
+
+    static_assert(!std::is_constructible_v<dots::tools::Handler<int()>, decltype(moveOnlyInvocable)>);
+    dots::tools::Handler<int()> sut{ std::move(copyableInvocable) };
+    dots::tools::Handler<int()> sutCopy{ sut };
+
+    EXPECT_EQ(sut(), 42);
+    EXPECT_EQ(sutCopy(), 42);
+}
+
+TEST_F(TestHandler, ctor_StaticArgumentCast)
+{
+    dots::tools::Handler<int(const Derived&)> handler{ [](const Derived& derived){ return derived.value; } };
+    dots::tools::Handler<int(const Base&)> sut{ dots::tools::static_argument_cast, std::move(handler) };
+    dots::tools::Handler<int(const Base&)> sutCopy = sut;
+
+    Derived derived;
+    EXPECT_EQ(sut(derived), 42);
+    EXPECT_EQ(sutCopy(derived), 42);
+}
+
+TEST_F(TestHandler, invoke_MovedFromHandlerThrows)
+{
+    dots::tools::Handler<void()> sut{ []{} };
+    dots::tools::Handler<void()> sutMoved = std::move(sut);
+
+    EXPECT_NO_THROW(sutMoved());
+    EXPECT_THROW(sut(), std::bad_function_call);
+}
+
+TEST_F(TestHandler, assign_SelfMoveKeepsInvocable)
+{
+    dots::tools::Handler<int()> sut{ []{ return 42; } };
+    dots::tools::Handler<int()>& self = sut;
+    sut = std::move(self);
+
+    EXPECT_EQ(sut(), 42);
+}
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/testing/gtest/gtest.h>
+#include <dots/tools/LatencyHistogram.h>
+
+using namespace std::chrono_literals;
+
+TEST(TestLatencyHistogram, quantile_ReturnsZeroWhenEmpty)
+{
+    dots::tools::LatencyHistogram sut;
+
+    EXPECT_EQ(sut.count(), 0u);
+    EXPECT_EQ(sut.quantile(0.5), 0ns);
+    EXPECT_EQ(sut.min(), 0ns);
+    EXPECT_EQ(sut.max(), 0ns);
+}
+
+TEST(TestLatencyHistogram, quantile_IsExactForSmallValues)
+{
+    dots::tools::LatencyHistogram sut;
+
+    for (int i = 1; i <= 10; ++i)
+    {
+        sut.record(std::chrono::nanoseconds{ i });
+    }
+
+    EXPECT_EQ(sut.count(), 10u);
+    EXPECT_EQ(sut.quantile(0.5), 5ns);
+    EXPECT_EQ(sut.quantile(1.0), 10ns);
+    EXPECT_EQ(sut.min(), 1ns);
+}
+
+TEST(TestLatencyHistogram, quantile_IsWithinRelativeErrorBound)
+{
+    dots::tools::LatencyHistogram sut;
+
+    for (int i = 1; i <= 1000; ++i)
+    {
+        sut.record(std::chrono::microseconds{ i });
+    }
+
+    auto expect_near = [](std::chrono::nanoseconds actual, std::chrono::nanoseconds expected)
+    {
+        EXPECT_GE(actual, expected);
+        EXPECT_LE(actual.count(), expected.count() + expected.count() / 8);
+    };
+
+    expect_near(sut.quantile(0.5), 500us);
+    expect_near(sut.quantile(0.99), 990us);
+    EXPECT_EQ(sut.quantile(1.0), 1000us);
+    EXPECT_EQ(sut.max(), 1000us);
+}
+
+TEST(TestLatencyHistogram, record_ClampsNegativeAndExcessiveValues)
+{
+    dots::tools::LatencyHistogram sut;
+    sut.record(-5ms);
+    sut.record(std::chrono::hours{ 100 });
+
+    EXPECT_EQ(sut.count(), 2u);
+    EXPECT_EQ(sut.min(), 0ns);
+    EXPECT_LT(sut.max(), std::chrono::hours{ 100 });
+    EXPECT_EQ(sut.quantile(0.5), 0ns);
+}
+
+TEST(TestLatencyHistogram, clear_DiscardsRecordedValues)
+{
+    dots::tools::LatencyHistogram sut;
+    sut.record(1ms);
+    sut.clear();
+
+    EXPECT_EQ(sut.count(), 0u);
+    EXPECT_EQ(sut.quantile(0.99), 0ns);
+}
@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/testing/gtest/gtest.h>
+#include <thread>
+#include <dots/tools/LoopTime.h>
+#include <DotsTestStruct.dots.h>
+
+using namespace std::chrono_literals;
+
+struct TestLoopTime : ::testing::Test
+{
+protected:
+
+    TestLoopTime()
+    {
+        dots::tools::LoopTime::Enable();
+    }
+
+    ~TestLoopTime() override
+    {
+        dots::tools::LoopTime::Enable(false);
+        DotsTestStruct::_Descriptor().setPreciseTimestamps(false);
+    }
+};
+
+TEST_F(TestLoopTime, Now_IsConstantWithinScope)
+{
+    dots::tools::LoopTime::Scope scope;
+    dots::timepoint_t first = dots::tools::LoopTime::Now();
+    std::this_thread::sleep_for(1ms);
+
+    EXPECT_EQ(dots::tools::LoopTime::Now(), first);
+
+    {
+        dots::tools::LoopTime::Scope nestedScope;
+        EXPECT_EQ(dots::tools::LoopTime::Now(), first);
+    }
+
+    EXPECT_EQ(dots::tools::LoopTime::Now(DotsTestStruct::_Descriptor()), first);
+}
+
+TEST_F(TestLoopTime, Now_AdvancesOutsideOfScopeAndWhenDisabled)
+{
+    dots::timepoint_t first;
+
+    {
+        dots::tools::LoopTime::Scope scope;
+        first = dots::tools::LoopTime::Now();
+        std::this_thread::sleep_for(1ms);
+    }
+
+    EXPECT_GT(dots::tools::LoopTime::Now(), first);
+
+    dots::tools::LoopTime::Enable(false);
+    dots::tools::LoopTime::Scope scope;
+    first = dots::tools::LoopTime::Now();
+    std::this_thread::sleep_for(1ms);
+
+    EXPECT_GT(dots::tools::LoopTime::Now(), first);
+}
+
+TEST_F(TestLoopTime, Now_AdvancesForTypesWithPreciseTimestamps)
+{
+    DotsTestStruct::_Descriptor().setPreciseTimestamps(true);
+
+    dots::tools::LoopTime::Scope scope;
+    dots::timepoint_t first = dots::tools::LoopTime::Now();
+    std::this_thread::sleep_for(1ms);
+
+    EXPECT_EQ(dots::tools::LoopTime::Now(), first);
+    EXPECT_GT(dots::tools::LoopTime::Now(DotsTestStruct::_Descriptor()), first);
+}
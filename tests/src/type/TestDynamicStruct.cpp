@@ -1096,6 +1096,59 @@ TEST_F(TestDynamicStruct, diffProperties)
     EXPECT_EQ(sutLhs._diffProperties(sutRhs, (~sutLhs._get("floatVectorProperty").descriptor().set())), sutLhs._get("stringProperty").descriptor().set());
 }
 
+TEST_F(TestDynamicStruct, equal_less_diffProperties_copy_AdjacentTrivialProperties)
+{
+    StructDescriptorData testDynamicFlatStructData{
+        .name = "TestDynamicFlatStruct",
+        .properties = vector_t<StructPropertyData>{
+            StructPropertyData{ .name = "keyProperty", .tag = 1, .isKey = true, .type = "int32" },
+            StructPropertyData{ .name = "uint32Property", .tag = 2, .isKey = false, .type = "uint32" },
+            StructPropertyData{ .name = "int16Property", .tag = 3, .isKey = false, .type = "int16" },
+            StructPropertyData{ .name = "uint16Property", .tag = 4, .isKey = false, .type = "uint16" },
+            StructPropertyData{ .name = "floatProperty1", .tag = 5, .isKey = false, .type = "float32" },
+            StructPropertyData{ .name = "floatProperty2", .tag = 6, .isKey = false, .type = "float32" }
+        }
+    };
+    const auto& descriptor = static_cast<Descriptor<DynamicStruct>&>(m_descriptorConverter(testDynamicFlatStructData));
+
+    DynamicStruct sutLhs{ descriptor,
+        DynamicStruct::property_i<int32_t>{ "keyProperty", -1 },
+        DynamicStruct::property_i<uint32_t>{ "uint32Property", 2 },
+        DynamicStruct::property_i<int16_t>{ "int16Property", 3 },
+        DynamicStruct::property_i<uint16_t>{ "uint16Property", 4 },
+        DynamicStruct::property_i<float32_t>{ "floatProperty1", -0.0f }
+    };
+
+    DynamicStruct sutRhs{ descriptor,
+        DynamicStruct::property_i<int32_t>{ "keyProperty", 1 },
+        DynamicStruct::property_i<uint32_t>{ "uint32Property", 2 },
+        DynamicStruct::property_i<int16_t>{ "int16Property", 4 },
+        DynamicStruct::property_i<uint16_t>{ "uint16Property", 4 },
+        DynamicStruct::property_i<float32_t>{ "floatProperty1", 0.0f }
+    };
+
+    PropertySet keyProperty = descriptor.keyProperties();
+    PropertySet int16Property = sutLhs._get("int16Property").descriptor().set();
+
+    EXPECT_FALSE(sutLhs._equal(sutRhs));
+    EXPECT_TRUE(sutLhs._equal(sutRhs, ~(keyProperty + int16Property)));
+    EXPECT_EQ(sutLhs._diffProperties(sutRhs), keyProperty + int16Property);
+
+    EXPECT_TRUE(sutLhs._less(sutRhs, keyProperty));
+    EXPECT_FALSE(sutRhs._less(sutLhs, keyProperty));
+    EXPECT_TRUE(sutLhs._less(sutRhs, ~keyProperty));
+    EXPECT_FALSE(sutRhs._less(sutLhs, ~keyProperty));
+
+    DynamicStruct sutCopy{ descriptor,
+        DynamicStruct::property_i<float32_t>{ "floatProperty2", 5.0f }
+    };
+    sutCopy._copy(sutRhs, ~keyProperty);
+
+    EXPECT_FALSE(sutCopy._get("keyProperty").isValid());
+    EXPECT_FALSE(sutCopy._get("floatProperty2").isValid());
+    EXPECT_TRUE(sutCopy._equal(sutRhs, ~keyProperty));
+}
+
 TEST_F(TestDynamicStruct, assertProperties)
 {
     DynamicStruct sut{ *m_testDynamicStructDescriptor,
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <dots/testing/gtest/gtest.h>
+#include <dots/type/InstancePool.h>
+
+using dots::type::InstancePool;
+
+struct TestInstancePool : ::testing::Test
+{
+protected:
+
+    TestInstancePool()
+    {
+        InstancePool::Trim();
+    }
+
+    ~TestInstancePool() override
+    {
+        InstancePool::Trim();
+    }
+};
+
+TEST_F(TestInstancePool, Allocate_ReusesReleasedBlockOfSameSizeClass)
+{
+    void* block = InstancePool::Allocate(40);
+    InstancePool::Deallocate(block, 40);
+
+    void* reusedBlock = InstancePool::Allocate(48);
+    EXPECT_EQ(reusedBlock, block);
+
+    InstancePool::Deallocate(reusedBlock, 48);
+}
+
+TEST_F(TestInstancePool, Allocate_DoesNotReuseBlockOfDifferentSizeClass)
+{
+    void* block = InstancePool::Allocate(40);
+    InstancePool::Deallocate(block, 40);
+
+    void* otherBlock = InstancePool::Allocate(64);
+    EXPECT_NE(otherBlock, block);
+
+    InstancePool::Deallocate(otherBlock, 64);
+}
+
+TEST_F(TestInstancePool, Allocate_LargeBlocksAreNotPooled)
+{
+    void* block = InstancePool::Allocate(InstancePool::MaxBlockSize + 1);
+    EXPECT_NE(block, nullptr);
+
+    InstancePool::Deallocate(block, InstancePool::MaxBlockSize + 1);
+}
@@ -381,6 +381,37 @@ TEST_F(TestStaticStruct, merge_PartialMergeSubStruct)
     EXPECT_EQ(sutThis.subStruct->p2, true);
 }
 
+TEST_F(TestStaticStruct, assign_copy_merge_TriviallyCopyable)
+{
+    static_assert(TestSubStruct::_IsTriviallyCopyable());
+    static_assert(!TestStruct::_IsTriviallyCopyable());
+    EXPECT_TRUE(TestSubStruct::_Descriptor().triviallyCopyable());
+    EXPECT_FALSE(TestStruct::_Descriptor().triviallyCopyable());
+
+    TestSubStruct sutOther{
+        .p1 = true,
+        .p3 = 3.1415
+    };
+
+    TestSubStruct sutAssign{ .p2 = true };
+    sutAssign._assign(sutOther, ~TestSubStruct::p1_p);
+    EXPECT_FALSE(sutAssign.p1.isValid());
+    EXPECT_FALSE(sutAssign.p2.isValid());
+    EXPECT_EQ(sutAssign.p3, 3.1415);
+
+    TestSubStruct sutCopy{ .p2 = true };
+    sutCopy._copy(sutOther);
+    EXPECT_EQ(sutCopy.p1, true);
+    EXPECT_FALSE(sutCopy.p2.isValid());
+    EXPECT_EQ(sutCopy.p3, 3.1415);
+
+    TestSubStruct sutMerge{ .p1 = false };
+    sutMerge._merge(sutOther);
+    EXPECT_EQ(sutMerge.p1, true);
+    EXPECT_FALSE(sutMerge.p2.isValid());
+    EXPECT_EQ(sutMerge.p3, 3.1415);
+}
+
 TEST_F(TestStaticStruct, swap_CompleteSwap)
 {
     TestStruct sutThis{
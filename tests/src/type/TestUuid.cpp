@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+// Copyright 2015-2022 Thomas Schaetzlein <thomas@pnxs.de>, Christopher Gerlach <gerlachch@gmx.com>
+#include <set>
+#include <dots/testing/gtest/gtest.h>
+#include <dots/type/Uuid.h>
+
+using dots::type::Uuid;
+
+TEST(TestUuid, Random_HasVersion4AndVariant1)
+{
+    Uuid uuid = Uuid::Random();
+
+    EXPECT_EQ(uuid.version(), 4);
+    EXPECT_EQ(uuid.data()[8] & 0xC0, 0x80);
+    EXPECT_EQ(Uuid::FromString(uuid.toString()), uuid);
+}
+
+TEST(TestUuid, Random_CreatesDistinctUuids)
+{
+    std::set<Uuid> uuids;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(uuids.emplace(Uuid::Random()).second);
+    }
+}
+
+TEST(TestUuid, TimeOrdered_HasVersion7AndVariant1)
+{
+    Uuid uuid = Uuid::TimeOrdered();
+
+    EXPECT_EQ(uuid.version(), 7);
+    EXPECT_EQ(uuid.data()[8] & 0xC0, 0x80);
+    EXPECT_EQ(Uuid::FromString(uuid.toString()), uuid);
+}
+
+TEST(TestUuid, TimeOrdered_CreatesStrictlyIncreasingUuids)
+{
+    Uuid previous = Uuid::TimeOrdered();
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        Uuid next = Uuid::TimeOrdered();
+        EXPECT_LT(previous, next);
+        previous = next;
+    }
+}